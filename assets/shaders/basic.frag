@@ -1,14 +1,69 @@
 #version 450 core
 
-out vec4 FragColor;
+// Variant defines (see ShaderFeature): HAS_TEXTURE, ALPHA_MASK, OIT_BLEND, POINT_LIGHTS, DEBUG_VIEW,
+// PROBE_VOLUME, VISIBILITY_RESOLVE
+
+layout(location = 0) out vec4 FragColor;
+#ifdef OIT_BLEND
+layout(location = 1) out float Revealage;
+#else
+// Ambient share of FragColor, scaled down afterwards by screen-space AO when it is enabled
+layout(location = 1) out vec3 AmbientColor;
+#endif
+#ifdef VISIBILITY_RESOLVE
+// Rebuilt per pixel from the visibility buffer by reconstructSurface()
+vec2 v_TexCoord;
+vec3 v_Normal;
+vec3 v_WorldPos;
+float v_Occlusion;
+vec2 s_TexCoordDx;
+vec2 s_TexCoordDy;
+
+uniform usampler2D u_VisibilityIds;
+uniform uint u_TriangleBase;
+uniform uint u_TriangleCount;  // Triangles per instance
+uniform uint u_InstanceBase;
+uniform uint u_InstanceCount;
+uniform int u_InstanceStride;  // Floats per InstanceData
+
+// Instances of every visibility draw this frame, see Renderer::drawVisibility
+layout(std430, binding = 7) readonly buffer VisibilityInstances {
+    float u_InstanceData[];
+};
+// The record's mesh buffers: interleaved Mesh::kVertexFloats vertices and triangle indices
+layout(std430, binding = 8) readonly buffer MeshVertices {
+    float u_Vertices[];
+};
+layout(std430, binding = 9) readonly buffer MeshIndices {
+    uint u_Indices[];
+};
+#else
 in vec2 v_TexCoord;
 in vec3 v_Normal;
 in vec3 v_WorldPos;
+in float v_Occlusion;
+#endif
 
+#ifdef HAS_TEXTURE
 uniform sampler2D u_Texture;
-uniform bool u_HasTexture;
+#endif
 uniform vec4 u_BaseColorFactor;
+#ifdef ALPHA_MASK
 uniform float u_AlphaCutoff;
+#endif
+#ifdef PROBE_VOLUME
+// L1 irradiance per color channel, see ProbeVolume::upload
+uniform sampler3D u_ProbeRed;
+uniform sampler3D u_ProbeGreen;
+uniform sampler3D u_ProbeBlue;
+uniform vec3 u_ProbeMin;
+uniform vec3 u_ProbeMax;
+uniform vec3 u_ProbeResolution;
+#endif
+#ifdef DEBUG_VIEW
+uniform int u_DebugView;
+uniform float u_DebugId;
+#endif
 struct PointLight {
     vec4 positionRange;
     vec4 colorIntensity;
@@ -21,17 +76,107 @@ layout(std140, binding = 0) uniform FrameData {
     vec4 u_Ambient;
     vec4 u_LightCounts;
     PointLight u_PointLights[4];
+    vec4 u_Time;  // x: seconds, wrapped every hour
 };
 
+#ifdef VISIBILITY_RESOLVE
+const uint kVertexFloats = 9u;
+
+vec3 fetchVertex(uint vertex, uint offset) {
+    uint base = vertex * kVertexFloats + offset;
+    return vec3(u_Vertices[base], u_Vertices[base + 1u], u_Vertices[base + 2u]);
+}
+
+// Perspective-correct barycentrics of the pixel and their change over one pixel step, computed
+// from the triangle's clip positions (the visibility buffer formulation of The Forge)
+void computeBarycentrics(vec4 p0, vec4 p1, vec4 p2, vec2 ndc, vec2 size,
+                         out vec3 lambda, out vec3 ddx, out vec3 ddy) {
+    vec3 invW = 1.0 / vec3(p0.w, p1.w, p2.w);
+    vec2 ndc0 = p0.xy * invW.x;
+    vec2 ndc1 = p1.xy * invW.y;
+    vec2 ndc2 = p2.xy * invW.z;
+    float invDet = 1.0 / determinant(mat2(ndc2 - ndc1, ndc0 - ndc1));
+    ddx = vec3(ndc1.y - ndc2.y, ndc2.y - ndc0.y, ndc0.y - ndc1.y) * invDet * invW;
+    ddy = vec3(ndc2.x - ndc1.x, ndc0.x - ndc2.x, ndc1.x - ndc0.x) * invDet * invW;
+    float ddxSum = dot(ddx, vec3(1.0));
+    float ddySum = dot(ddy, vec3(1.0));
+
+    // Barycentrics over w are linear in screen space
+    vec2 delta = ndc - ndc0;
+    float interpInvW = invW.x + delta.x * ddxSum + delta.y * ddySum;
+    lambda = (vec3(invW.x, 0.0, 0.0) + delta.x * ddx + delta.y * ddy) / interpInvW;
+
+    vec2 pixel = 2.0 / size;
+    ddx *= pixel.x;
+    ddy *= pixel.y;
+    ddxSum *= pixel.x;
+    ddySum *= pixel.y;
+    ddx = (lambda * interpInvW + ddx) / (interpInvW + ddxSum) - lambda;
+    ddy = (lambda * interpInvW + ddy) / (interpInvW + ddySum) - lambda;
+}
+
+void reconstructSurface() {
+    uint id = texelFetch(u_VisibilityIds, ivec2(gl_FragCoord.xy), 0).r;
+    // Helper invocations may sit on another record's pixels, keep their fetches in range
+    uint local = id - u_TriangleBase;
+    uint instance = min(local / u_TriangleCount, u_InstanceCount - 1u);
+    uint triangle = min(local - instance * u_TriangleCount, u_TriangleCount - 1u);
+
+    uint first = (u_InstanceBase + instance) * uint(u_InstanceStride);
+    mat4 model;
+    for (int c = 0; c < 4; ++c) {
+        model[c] = vec4(u_InstanceData[first + c * 4], u_InstanceData[first + c * 4 + 1],
+                        u_InstanceData[first + c * 4 + 2], u_InstanceData[first + c * 4 + 3]);
+    }
+    mat3 normalMatrix;
+    for (int c = 0; c < 3; ++c) {
+        uint column = first + 16u + uint(c) * 3u;
+        normalMatrix[c] = vec3(u_InstanceData[column], u_InstanceData[column + 1u], u_InstanceData[column + 2u]);
+    }
+
+    uint i0 = u_Indices[triangle * 3u];
+    uint i1 = u_Indices[triangle * 3u + 1u];
+    uint i2 = u_Indices[triangle * 3u + 2u];
+    vec3 world0 = (model * vec4(fetchVertex(i0, 0u), 1.0)).xyz;
+    vec3 world1 = (model * vec4(fetchVertex(i1, 0u), 1.0)).xyz;
+    vec3 world2 = (model * vec4(fetchVertex(i2, 0u), 1.0)).xyz;
+
+    vec2 size = vec2(textureSize(u_VisibilityIds, 0));
+    vec2 ndc = gl_FragCoord.xy / size * 2.0 - 1.0;
+    vec3 lambda, ddx, ddy;
+    computeBarycentrics(u_ViewProj * vec4(world0, 1.0), u_ViewProj * vec4(world1, 1.0),
+                        u_ViewProj * vec4(world2, 1.0), ndc, size, lambda, ddx, ddy);
+
+    v_WorldPos = mat3(world0, world1, world2) * lambda;
+    vec3 normal = mat3(fetchVertex(i0, 3u), fetchVertex(i1, 3u), fetchVertex(i2, 3u)) * lambda;
+    v_Normal = normalMatrix * normal;
+    mat3x2 uvs = mat3x2(fetchVertex(i0, 6u).xy, fetchVertex(i1, 6u).xy, fetchVertex(i2, 6u).xy);
+    v_TexCoord = uvs * lambda;
+    s_TexCoordDx = uvs * ddx;
+    s_TexCoordDy = uvs * ddy;
+    v_Occlusion = dot(vec3(u_Vertices[i0 * kVertexFloats + 8u], u_Vertices[i1 * kVertexFloats + 8u],
+                           u_Vertices[i2 * kVertexFloats + 8u]), lambda);
+}
+#endif
+
 vec4 sampleBaseColor() {
-    vec4 baseColor = u_HasTexture ? texture(u_Texture, v_TexCoord) : vec4(1.0);
-    return baseColor * u_BaseColorFactor;
+#if defined(HAS_TEXTURE) && defined(VISIBILITY_RESOLVE)
+    // No quad derivatives across triangles, the analytic ones pick the mip
+    return textureGrad(u_Texture, v_TexCoord, s_TexCoordDx, s_TexCoordDy) * u_BaseColorFactor;
+#elif defined(HAS_TEXTURE)
+    return texture(u_Texture, v_TexCoord) * u_BaseColorFactor;
+#else
+    return u_BaseColorFactor;
+#endif
 }
 
 void applyAlphaCutoff(float alpha) {
+    // The visibility pass already alpha tested the pixels a resolve draw covers
+#if defined(ALPHA_MASK) && !defined(VISIBILITY_RESOLVE)
     if (alpha < u_AlphaCutoff) {
         discard;
     }
+#endif
 }
 
 vec3 computeSunDiffuse(vec3 baseColor, vec3 normal) {
@@ -42,6 +187,7 @@ vec3 computeSunDiffuse(vec3 baseColor, vec3 normal) {
 
 vec3 computePointLights(vec3 baseColor, vec3 normal) {
     vec3 pointAccum = vec3(0.0);
+#ifdef POINT_LIGHTS
     int pointCount = int(u_LightCounts.x);
     for (int i = 0; i < pointCount; ++i) {
         vec3 lightPos = u_PointLights[i].positionRange.xyz;
@@ -56,22 +202,97 @@ vec3 computePointLights(vec3 baseColor, vec3 normal) {
         float attenuation = clamp(1.0 - dist / range, 0.0, 1.0);
         pointAccum += baseColor * NdotLp * lightColor * intensity * attenuation;
     }
+#endif
     return pointAccum;
 }
 
-vec3 computeLighting(vec3 baseColor, vec3 normal) {
+#ifdef PROBE_VOLUME
+vec3 sampleProbeIrradiance(vec3 normal) {
+    vec3 uvw = clamp((v_WorldPos - u_ProbeMin) / (u_ProbeMax - u_ProbeMin), 0.0, 1.0);
+    uvw = uvw * (u_ProbeResolution - 1.0) / u_ProbeResolution + 0.5 / u_ProbeResolution;
+    vec4 basis = vec4(1.0, normal.y, normal.z, normal.x);
+    vec3 irradiance = vec3(dot(texture(u_ProbeRed, uvw), basis),
+                           dot(texture(u_ProbeGreen, uvw), basis),
+                           dot(texture(u_ProbeBlue, uvw), basis));
+    return max(irradiance, vec3(0.0));
+}
+#endif
+
+vec3 computeAmbient(vec3 baseColor, vec3 normal) {
+#ifdef PROBE_VOLUME
+    // Baked sky and bounce light replace the constant ambient term
+    vec3 ambient = baseColor * sampleProbeIrradiance(normal) / 3.14159265;
+#else
     vec3 ambient = baseColor * u_Ambient.xyz * u_Ambient.w;
-    vec3 diffuse = computeSunDiffuse(baseColor, normal);
-    vec3 points = computePointLights(baseColor, normal);
-    return ambient + diffuse + points;
+#endif
+    // Baked per-vertex occlusion, 1 when the import bake is disabled
+    return ambient * v_Occlusion;
+}
+
+vec3 computeDirectLighting(vec3 baseColor, vec3 normal) {
+    return computeSunDiffuse(baseColor, normal) + computePointLights(baseColor, normal);
 }
 
+#ifdef DEBUG_VIEW
+int countLights(vec3 normal) {
+    int count = dot(normal, -u_SunDir.xyz) > 0.0 ? 1 : 0;
+#ifdef POINT_LIGHTS
+    int pointCount = int(u_LightCounts.x);
+    for (int i = 0; i < pointCount; ++i) {
+        vec3 toLight = u_PointLights[i].positionRange.xyz - v_WorldPos;
+        if (length(toLight) < u_PointLights[i].positionRange.w && dot(normal, toLight) > 0.0) {
+            ++count;
+        }
+    }
+#endif
+    return count;
+}
+
+// Debug views write (value, coverage) into an RG32F target, ids match Renderer::DebugView
+vec2 computeDebugValue(vec3 normal) {
+    if (u_DebugView == 1) {
+        return vec2(1.0);
+    }
+    if (u_DebugView == 2) {
+        return vec2(float(countLights(normal)), 1.0);
+    }
+    if (u_DebugView == 3) {
+#ifdef HAS_TEXTURE
+        return vec2(textureQueryLod(u_Texture, v_TexCoord).x, 1.0);
+#else
+        return vec2(0.0);
+#endif
+    }
+    return vec2(u_DebugId, 1.0);
+}
+#endif
+
+#ifdef OIT_BLEND
+// Weighted blended OIT: the weight favours closer and more opaque fragments
+void writeTransparent(vec3 color, float alpha) {
+    float weight = clamp(pow(min(1.0, alpha * 10.0) + 0.01, 3.0) * 1e8 *
+                         pow(1.0 - gl_FragCoord.z * 0.9, 3.0), 1e-2, 3e3);
+    FragColor = vec4(color * alpha, alpha) * weight;
+    Revealage = alpha;
+}
+#endif
+
 void main() {
+#ifdef VISIBILITY_RESOLVE
+    reconstructSurface();
+#endif
     vec4 baseColor = sampleBaseColor();
     applyAlphaCutoff(baseColor.a);
 
     vec3 normal = normalize(v_Normal);
-    vec3 color = computeLighting(baseColor.rgb, normal);
-
-    FragColor = vec4(color, baseColor.a);
+#if defined(DEBUG_VIEW)
+    FragColor = vec4(computeDebugValue(normal), 0.0, 1.0);
+#elif defined(OIT_BLEND)
+    vec3 color = computeAmbient(baseColor.rgb, normal) + computeDirectLighting(baseColor.rgb, normal);
+    writeTransparent(color, baseColor.a);
+#else
+    vec3 ambient = computeAmbient(baseColor.rgb, normal);
+    FragColor = vec4(ambient + computeDirectLighting(baseColor.rgb, normal), baseColor.a);
+    AmbientColor = ambient;
+#endif
 }
@@ -9,9 +9,48 @@ layout (location = 7) in vec3 i_NormalMatrix0;
 layout (location = 8) in vec3 i_NormalMatrix1;
 layout (location = 9) in vec3 i_NormalMatrix2;
 
+layout (location = 10) in float a_Occlusion;
+
+#ifdef SKINNED
+layout (location = 11) in uvec4 a_Joints;
+layout (location = 12) in vec4 a_Weights;
+layout (location = 13) in uint i_PaletteOffset;
+
+// Joint matrices of every skinned instance in the frame, see Renderer::submitSkinned
+layout(std430, binding = 4) readonly buffer JointPalettes {
+    mat4 u_Joints[];
+};
+#endif
+
+#ifdef VERTEX_ANIMATION
+layout (location = 14) in uvec2 i_Animation;  // Clip index, time offset as float bits
+
+struct VertexAnimationClip {
+    uint firstFrame;
+    uint frameCount;
+    float frameRate;
+    float duration;
+};
+
+// Baked clips of the batch's mesh, see VertexAnimationTexture
+layout(std430, binding = 5) readonly buffer VertexAnimationClips {
+    VertexAnimationClip u_Clips[];
+};
+uniform sampler2D u_VatPositions;
+uniform sampler2D u_VatNormals;
+uniform int u_VatVertexCount;
+uniform int u_VatWidth;
+
+ivec2 vatTexel(uint frame) {
+    uint index = frame * uint(u_VatVertexCount) + uint(gl_VertexID);
+    return ivec2(index % uint(u_VatWidth), index / uint(u_VatWidth));
+}
+#endif
+
 out vec2 v_TexCoord;
 out vec3 v_Normal;
 out vec3 v_WorldPos;
+out float v_Occlusion;
 
 struct PointLight {
     vec4 positionRange;
@@ -25,13 +64,48 @@ layout(std140, binding = 0) uniform FrameData {
     vec4 u_Ambient;
     vec4 u_LightCounts;
     PointLight u_PointLights[4];
+    vec4 u_Time;  // x: seconds, wrapped every hour
 };
 
+#ifdef VISIBILITY_RESOLVE
+// Full-screen triangle at the record's material depth; the fragment shader rebuilds the surface
+uniform float u_ResolveDepth;
+
 void main() {
-    vec4 worldPos = i_Model * vec4(a_Position, 1.0);
+    vec2 pos = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    gl_Position = vec4(pos * 2.0 - 1.0, u_ResolveDepth * 2.0 - 1.0, 1.0);
+}
+#else
+void main() {
+    vec3 position = a_Position;
+    vec3 normal = a_Normal;
+#ifdef SKINNED
+    mat4 skin = a_Weights.x * u_Joints[i_PaletteOffset + a_Joints.x] +
+                a_Weights.y * u_Joints[i_PaletteOffset + a_Joints.y] +
+                a_Weights.z * u_Joints[i_PaletteOffset + a_Joints.z] +
+                a_Weights.w * u_Joints[i_PaletteOffset + a_Joints.w];
+    position = vec3(skin * vec4(position, 1.0));
+    // Joints are assumed to scale uniformly, so the upper 3x3 also transforms normals
+    normal = mat3(skin) * normal;
+#endif
+#ifdef VERTEX_ANIMATION
+    VertexAnimationClip clip = u_Clips[i_Animation.x];
+    float frame = mod(u_Time.x + uintBitsToFloat(i_Animation.y), max(clip.duration, 1e-4)) * clip.frameRate;
+    uint frame0 = min(uint(frame), clip.frameCount - 1u);
+    uint frame1 = min(frame0 + 1u, clip.frameCount - 1u);
+    ivec2 texel0 = vatTexel(clip.firstFrame + frame0);
+    ivec2 texel1 = vatTexel(clip.firstFrame + frame1);
+    float blend = fract(frame);
+    position = mix(texelFetch(u_VatPositions, texel0, 0).xyz, texelFetch(u_VatPositions, texel1, 0).xyz, blend);
+    normal = mix(texelFetch(u_VatNormals, texel0, 0).xyz, texelFetch(u_VatNormals, texel1, 0).xyz, blend);
+#endif
+
+    vec4 worldPos = i_Model * vec4(position, 1.0);
     v_WorldPos = worldPos.xyz;
     v_TexCoord = a_TexCoord;
+    v_Occlusion = a_Occlusion;
     mat3 normalMatrix = mat3(i_NormalMatrix0, i_NormalMatrix1, i_NormalMatrix2);
-    v_Normal = normalize(normalMatrix * a_Normal);
+    v_Normal = normalize(normalMatrix * normal);
     gl_Position = u_ViewProj * worldPos;
 }
+#endif
@@ -0,0 +1,48 @@
+#version 450 core
+
+out vec4 FragColor;
+
+uniform sampler2D u_DebugValue;
+uniform int u_DebugView;
+
+// Must match Renderer::DebugView
+const int kOverdraw = 1;
+const int kLightCount = 2;
+const int kMipLevel = 3;
+
+// Black -> blue -> green -> yellow -> red
+vec3 heatmap(float t) {
+    const vec3 stops[5] = vec3[](vec3(0.0), vec3(0.0, 0.0, 1.0), vec3(0.0, 1.0, 0.0),
+                                 vec3(1.0, 1.0, 0.0), vec3(1.0, 0.0, 0.0));
+    float x = clamp(t, 0.0, 1.0) * 4.0;
+    int i = min(int(x), 3);
+    return mix(stops[i], stops[i + 1], x - float(i));
+}
+
+// Stable, well separated colors for consecutive ids
+vec3 idColor(uint id) {
+    uint h = id * 2654435761u;
+    h ^= h >> 16;
+    return vec3(float(h & 255u), float((h >> 8) & 255u), float((h >> 16) & 255u)) / 255.0 * 0.8 + 0.2;
+}
+
+void main() {
+    // r = value, g = coverage (the overdraw view accumulates both)
+    vec2 debug = texelFetch(u_DebugValue, ivec2(gl_FragCoord.xy), 0).rg;
+    if (debug.g <= 0.0) {
+        FragColor = vec4(vec3(0.05), 1.0);
+        return;
+    }
+
+    vec3 color;
+    if (u_DebugView == kOverdraw) {
+        color = heatmap(debug.r / 8.0);
+    } else if (u_DebugView == kLightCount) {
+        color = heatmap(debug.r / 5.0);
+    } else if (u_DebugView == kMipLevel) {
+        color = heatmap(debug.r / 10.0);
+    } else {
+        color = idColor(uint(debug.r));
+    }
+    FragColor = vec4(color, 1.0);
+}
@@ -0,0 +1,10 @@
+#version 450 core
+
+out vec2 v_TexCoord;
+
+// Full-screen triangle generated from gl_VertexID, no vertex buffer needed
+void main() {
+    vec2 pos = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    v_TexCoord = pos;
+    gl_Position = vec4(pos * 2.0 - 1.0, 0.0, 1.0);
+}
@@ -0,0 +1,20 @@
+#version 450 core
+
+out vec4 FragColor;
+
+uniform sampler2D u_Accum;
+uniform sampler2D u_Revealage;
+
+void main() {
+    ivec2 coord = ivec2(gl_FragCoord.xy);
+    float revealage = texelFetch(u_Revealage, coord, 0).r;
+    if (revealage >= 1.0) {
+        discard;  // No transparent fragment covered this pixel
+    }
+
+    vec4 accum = texelFetch(u_Accum, coord, 0);
+    vec3 averageColor = accum.rgb / clamp(accum.a, 1e-4, 5e4);
+
+    // Blended with (ONE_MINUS_SRC_ALPHA, SRC_ALPHA): opaque color is kept in proportion to revealage
+    FragColor = vec4(averageColor, revealage);
+}
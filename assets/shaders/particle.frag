@@ -0,0 +1,20 @@
+#version 450 core
+
+layout(location = 0) out vec4 FragColor;
+layout(location = 1) out float Revealage;
+
+in vec2 v_Corner;
+in vec4 v_Color;
+
+// Same weighting as basic.frag's OIT_BLEND path so particles composite with other blended geometry
+void main() {
+    float falloff = 1.0 - dot(v_Corner, v_Corner);
+    if (falloff <= 0.0) {
+        discard;
+    }
+    float alpha = v_Color.a * falloff;
+    float weight = clamp(pow(min(1.0, alpha * 10.0) + 0.01, 3.0) * 1e8 *
+                         pow(1.0 - gl_FragCoord.z * 0.9, 3.0), 1e-2, 3e3);
+    FragColor = vec4(v_Color.rgb * alpha, alpha) * weight;
+    Revealage = alpha;
+}
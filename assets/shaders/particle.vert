@@ -0,0 +1,55 @@
+#version 450 core
+
+// Billboard quad per instance; the instance indexes the alive list the simulate pass wrote
+struct Particle {
+    vec4 positionAge;
+    vec4 velocityLifetime;
+};
+
+layout(std430, binding = 0) readonly buffer Particles {
+    Particle particles[];
+};
+
+layout(std430, binding = 2) readonly buffer AliveLists {
+    uint aliveLists[];
+};
+
+struct PointLight {
+    vec4 positionRange;
+    vec4 colorIntensity;
+};
+
+layout(std140, binding = 0) uniform FrameData {
+    mat4 u_ViewProj;
+    vec4 u_SunDir;
+    vec4 u_SunColor;
+    vec4 u_Ambient;
+    vec4 u_LightCounts;
+    PointLight u_PointLights[4];
+    vec4 u_Time;  // x: seconds, wrapped every hour
+};
+
+uniform int u_AliveOffset;
+uniform vec3 u_CameraRight;
+uniform vec3 u_CameraUp;
+uniform vec4 u_StartColor;
+uniform vec4 u_EndColor;
+uniform float u_StartSize;
+uniform float u_EndSize;
+
+out vec2 v_Corner;
+out vec4 v_Color;
+
+const vec2 kCorners[6] = vec2[](vec2(-1.0, -1.0), vec2(1.0, -1.0), vec2(1.0, 1.0),
+                                vec2(-1.0, -1.0), vec2(1.0, 1.0), vec2(-1.0, 1.0));
+
+void main() {
+    Particle p = particles[aliveLists[uint(u_AliveOffset + gl_InstanceID)]];
+    float t = clamp(p.positionAge.w / p.velocityLifetime.w, 0.0, 1.0);
+    float size = mix(u_StartSize, u_EndSize, t);
+
+    v_Corner = kCorners[gl_VertexID];
+    v_Color = mix(u_StartColor, u_EndColor, t);
+    vec3 worldPos = p.positionAge.xyz + (u_CameraRight * v_Corner.x + u_CameraUp * v_Corner.y) * size;
+    gl_Position = u_ViewProj * vec4(worldPos, 1.0);
+}
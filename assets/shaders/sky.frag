@@ -0,0 +1,81 @@
+#version 450 core
+
+// Background sky: sky-view LUT radiance for the pixel's view direction plus the sun disk,
+// scaled from a unit sun to the scene's sun.
+
+in vec2 v_Ndc;
+
+out vec4 FragColor;
+
+uniform sampler2D u_SkyView;
+uniform sampler2D u_Transmittance;
+uniform mat4 u_InverseViewProjection;
+uniform vec3 u_SunDirection;  // Towards the sun, as the LUT was rendered for
+uniform vec3 u_SunIlluminance;
+uniform float u_ViewHeight;  // km from the planet center
+
+const float kPi = 3.14159265;
+const float kGroundRadius = 6360.0;
+const float kTopRadius = 6460.0;
+const float kSunAngularRadius = 0.00467;
+
+float raySphere(vec3 origin, vec3 direction, float radius) {
+    float b = dot(origin, direction);
+    float c = dot(origin, origin) - radius * radius;
+    float discriminant = b * b - c;
+    if (discriminant < 0.0) {
+        return -1.0;
+    }
+    float root = sqrt(discriminant);
+    if (-b - root >= 0.0) {
+        return -b - root;
+    }
+    return -b + root >= 0.0 ? -b + root : -1.0;
+}
+
+vec3 sampleTransmittance(float r, float mu) {
+    float horizon = sqrt(kTopRadius * kTopRadius - kGroundRadius * kGroundRadius);
+    float rho = sqrt(max(r * r - kGroundRadius * kGroundRadius, 0.0));
+    float boundaryDistance = max(0.0, -r * mu + sqrt(max(r * r * (mu * mu - 1.0) + kTopRadius * kTopRadius, 0.0)));
+    float minDistance = kTopRadius - r;
+    float maxDistance = rho + horizon;
+    vec2 uv = vec2((boundaryDistance - minDistance) / (maxDistance - minDistance), rho / horizon);
+    return textureLod(u_Transmittance, uv, 0.0).rgb;
+}
+
+// Inverse of the mapping in sky_view.frag
+vec2 skyViewUv(vec3 direction) {
+    float horizonDistance = sqrt(max(u_ViewHeight * u_ViewHeight - kGroundRadius * kGroundRadius, 0.0));
+    float beta = acos(horizonDistance / u_ViewHeight);
+    float zenithHorizonAngle = kPi - beta;
+    float viewZenith = acos(clamp(direction.y, -1.0, 1.0));
+    float v;
+    if (viewZenith < zenithHorizonAngle) {
+        v = (1.0 - sqrt(max(1.0 - viewZenith / zenithHorizonAngle, 0.0))) * 0.5;
+    } else {
+        v = sqrt(clamp((viewZenith - zenithHorizonAngle) / beta, 0.0, 1.0)) * 0.5 + 0.5;
+    }
+    vec2 viewHorizontal = direction.xz;
+    vec2 sunHorizontal = u_SunDirection.xz;
+    float lengths = length(viewHorizontal) * length(sunHorizontal);
+    float cosAzimuth = lengths > 1e-5 ? dot(viewHorizontal, sunHorizontal) / lengths : 1.0;
+    return vec2(sqrt(clamp(0.5 - 0.5 * cosAzimuth, 0.0, 1.0)), v);
+}
+
+void main() {
+    vec4 nearPoint = u_InverseViewProjection * vec4(v_Ndc, -1.0, 1.0);
+    vec4 farPoint = u_InverseViewProjection * vec4(v_Ndc, 1.0, 1.0);
+    vec3 direction = normalize(farPoint.xyz / farPoint.w - nearPoint.xyz / nearPoint.w);
+
+    vec3 radiance = texture(u_SkyView, skyViewUv(direction)).rgb;
+
+    // Sun disk of unit illuminance over its solid angle, dimmed by the atmosphere
+    vec3 origin = vec3(0.0, u_ViewHeight, 0.0);
+    float sunEdge = cos(kSunAngularRadius);
+    float disk = smoothstep(sunEdge - 2e-5, sunEdge, dot(direction, u_SunDirection));
+    if (disk > 0.0 && raySphere(origin, direction, kGroundRadius) < 0.0) {
+        vec3 transmittance = sampleTransmittance(u_ViewHeight, u_SunDirection.y);
+        radiance += disk * transmittance / (kPi * kSunAngularRadius * kSunAngularRadius);
+    }
+    FragColor = vec4(radiance * u_SunIlluminance, 1.0);
+}
@@ -0,0 +1,10 @@
+#version 450 core
+
+out vec2 v_Ndc;
+
+// Full-screen triangle on the far plane, so depth testing keeps it behind the scene
+void main() {
+    vec2 pos = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2) * 2.0 - 1.0;
+    v_Ndc = pos;
+    gl_Position = vec4(pos, 1.0, 1.0);
+}
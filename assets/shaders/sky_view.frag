@@ -0,0 +1,134 @@
+#version 450 core
+
+// Sky-view LUT of Hillaire 2020: in-scattered radiance towards the viewer per direction,
+// for a sun of unit illuminance. u is the azimuth from the sun (cos = 1 - 2u^2), v the
+// zenith angle with the horizon at v = 0.5 and quadratic detail around it. Single
+// scattering is marched against the transmittance LUT, higher orders come from the
+// multiple-scattering LUT.
+
+in vec2 v_TexCoord;
+
+out vec4 FragColor;
+
+uniform sampler2D u_Transmittance;
+uniform sampler2D u_MultiScattering;
+uniform vec3 u_SunDirection;  // Towards the sun
+uniform float u_ViewHeight;  // km from the planet center
+
+const float kPi = 3.14159265;
+const float kGroundRadius = 6360.0;
+const float kTopRadius = 6460.0;
+const vec3 kRayleighScattering = vec3(5.802, 13.558, 33.1) * 1e-3;
+const float kRayleighScaleHeight = 8.0;
+const float kMieScattering = 3.996e-3;
+const float kMieExtinction = 4.440e-3;
+const float kMieScaleHeight = 1.2;
+const float kMieAnisotropy = 0.8;
+const vec3 kOzoneAbsorption = vec3(0.650, 1.881, 0.085) * 1e-3;
+const int kSteps = 30;
+
+struct Medium {
+    vec3 rayleigh;
+    float mie;
+    vec3 extinction;
+};
+
+Medium sampleMedium(float altitude) {
+    float rayleigh = exp(-altitude / kRayleighScaleHeight);
+    float mie = exp(-altitude / kMieScaleHeight);
+    float ozone = max(0.0, 1.0 - abs(altitude - 25.0) / 15.0);
+    Medium medium;
+    medium.rayleigh = kRayleighScattering * rayleigh;
+    medium.mie = kMieScattering * mie;
+    medium.extinction = medium.rayleigh + kMieExtinction * mie + kOzoneAbsorption * ozone;
+    return medium;
+}
+
+float raySphere(vec3 origin, vec3 direction, float radius) {
+    float b = dot(origin, direction);
+    float c = dot(origin, origin) - radius * radius;
+    float discriminant = b * b - c;
+    if (discriminant < 0.0) {
+        return -1.0;
+    }
+    float root = sqrt(discriminant);
+    if (-b - root >= 0.0) {
+        return -b - root;
+    }
+    return -b + root >= 0.0 ? -b + root : -1.0;
+}
+
+vec3 sampleTransmittance(float r, float mu) {
+    float horizon = sqrt(kTopRadius * kTopRadius - kGroundRadius * kGroundRadius);
+    float rho = sqrt(max(r * r - kGroundRadius * kGroundRadius, 0.0));
+    float boundaryDistance = max(0.0, -r * mu + sqrt(max(r * r * (mu * mu - 1.0) + kTopRadius * kTopRadius, 0.0)));
+    float minDistance = kTopRadius - r;
+    float maxDistance = rho + horizon;
+    vec2 uv = vec2((boundaryDistance - minDistance) / (maxDistance - minDistance), rho / horizon);
+    return textureLod(u_Transmittance, uv, 0.0).rgb;
+}
+
+vec3 sampleMultiScattering(float r, float sunCos) {
+    vec2 uv = vec2(sunCos * 0.5 + 0.5, (r - kGroundRadius) / (kTopRadius - kGroundRadius));
+    return textureLod(u_MultiScattering, clamp(uv, 0.0, 1.0), 0.0).rgb;
+}
+
+float rayleighPhase(float cosTheta) {
+    return 3.0 / (16.0 * kPi) * (1.0 + cosTheta * cosTheta);
+}
+
+// Cornette-Shanks
+float miePhase(float cosTheta) {
+    float g = kMieAnisotropy;
+    float k = 3.0 / (8.0 * kPi) * (1.0 - g * g) / (2.0 + g * g);
+    return k * (1.0 + cosTheta * cosTheta) / pow(1.0 + g * g - 2.0 * g * cosTheta, 1.5);
+}
+
+void main() {
+    float horizonDistance = sqrt(max(u_ViewHeight * u_ViewHeight - kGroundRadius * kGroundRadius, 0.0));
+    float beta = acos(horizonDistance / u_ViewHeight);
+    float zenithHorizonAngle = kPi - beta;
+    float viewZenith;
+    if (v_TexCoord.y < 0.5) {
+        float coord = 1.0 - 2.0 * v_TexCoord.y;
+        viewZenith = zenithHorizonAngle * (1.0 - coord * coord);
+    } else {
+        float coord = v_TexCoord.y * 2.0 - 1.0;
+        viewZenith = zenithHorizonAngle + beta * coord * coord;
+    }
+    float cosAzimuth = 1.0 - 2.0 * v_TexCoord.x * v_TexCoord.x;
+    float sinAzimuth = sqrt(max(1.0 - cosAzimuth * cosAzimuth, 0.0));
+
+    // LUT frame: the sun lies in the x-y plane
+    vec3 direction = vec3(sin(viewZenith) * cosAzimuth, cos(viewZenith), sin(viewZenith) * sinAzimuth);
+    float sunCos = u_SunDirection.y;
+    vec3 sunDirection = vec3(sqrt(max(1.0 - sunCos * sunCos, 0.0)), sunCos, 0.0);
+    vec3 origin = vec3(0.0, u_ViewHeight, 0.0);
+
+    float groundDistance = raySphere(origin, direction, kGroundRadius);
+    float rayLength = groundDistance > 0.0 ? groundDistance : raySphere(origin, direction, kTopRadius);
+    float stepLength = max(rayLength, 0.0) / float(kSteps);
+    float cosTheta = dot(direction, sunDirection);
+    float phaseRayleigh = rayleighPhase(cosTheta);
+    float phaseMie = miePhase(cosTheta);
+
+    vec3 radiance = vec3(0.0);
+    vec3 throughput = vec3(1.0);
+    for (int i = 0; i < kSteps; ++i) {
+        vec3 position = origin + direction * ((float(i) + 0.5) * stepLength);
+        float r = length(position);
+        Medium medium = sampleMedium(r - kGroundRadius);
+        vec3 extinction = max(medium.extinction, vec3(1e-6));
+        vec3 stepTransmittance = exp(-medium.extinction * stepLength);
+
+        float localSunCos = dot(position / r, sunDirection);
+        vec3 sunlight = raySphere(position, sunDirection, kGroundRadius) > 0.0 ? vec3(0.0)
+                                                                               : sampleTransmittance(r, localSunCos);
+        vec3 scattering = medium.rayleigh + vec3(medium.mie);
+        vec3 inScattered = sunlight * (medium.rayleigh * phaseRayleigh + medium.mie * phaseMie) +
+                           sampleMultiScattering(r, localSunCos) * scattering;
+        radiance += throughput * (inScattered - inScattered * stepTransmittance) / extinction;
+        throughput *= stepTransmittance;
+    }
+    FragColor = vec4(radiance, 1.0);
+}
@@ -0,0 +1,52 @@
+#version 450 core
+
+// Depth-aware upsample of the AO result; blended with reverse subtract, so the occluded share
+// of the opaque pass's ambient term is removed from scene color
+
+out vec4 FragColor;
+
+uniform sampler2D u_Occlusion;
+uniform sampler2D u_LinearDepth;
+uniform sampler2D u_SceneDepth;
+uniform sampler2D u_Ambient;
+uniform vec2 u_DepthParams;  // projection[3][2], projection[2][2]
+
+const float kDepthTolerance = 0.02;
+
+void main() {
+    ivec2 coord = ivec2(gl_FragCoord.xy);
+    float sceneDepth = texelFetch(u_SceneDepth, coord, 0).r;
+    if (sceneDepth >= 1.0) {
+        discard;  // Sky
+    }
+    float depth = u_DepthParams.x / (sceneDepth * 2.0 - 1.0 + u_DepthParams.y);
+
+    // Bilinear footprint in the AO target, each tap weighted down by its depth difference
+    ivec2 lowSize = textureSize(u_Occlusion, 0);
+    vec2 position = gl_FragCoord.xy * vec2(lowSize) / vec2(textureSize(u_SceneDepth, 0)) - 0.5;
+    ivec2 base = ivec2(floor(position));
+    vec2 f = position - vec2(base);
+    float sum = 0.0;
+    float weightSum = 0.0;
+    float nearest = 1.0;
+    float nearestDifference = 1e30;
+    for (int i = 0; i < 4; ++i) {
+        ivec2 offset = ivec2(i & 1, i >> 1);
+        ivec2 tap = clamp(base + offset, ivec2(0), lowSize - 1);
+        float occlusion = texelFetch(u_Occlusion, tap, 0).r;
+        float difference = abs(texelFetch(u_LinearDepth, tap, 0).r - depth) / depth;
+        vec2 bilinear = mix(1.0 - f, f, vec2(offset));
+        float weight = bilinear.x * bilinear.y * max(1.0 - difference / kDepthTolerance, 0.0);
+        sum += occlusion * weight;
+        weightSum += weight;
+        if (difference < nearestDifference) {
+            nearestDifference = difference;
+            nearest = occlusion;
+        }
+    }
+    // No tap on this surface (thin geometry): take the closest one in depth
+    float occlusion = weightSum > 1e-4 ? sum / weightSum : nearest;
+
+    vec3 ambient = texelFetch(u_Ambient, coord, 0).rgb;
+    FragColor = vec4(ambient * (1.0 - occlusion), 0.0);
+}
@@ -0,0 +1,38 @@
+#version 450 core
+
+layout(location = 0) out vec4 FragColor;
+layout(location = 1) out vec3 AmbientColor;  // Scaled by screen-space AO, see basic.frag
+
+in vec3 v_Normal;
+in vec3 v_WorldPos;
+in float v_Height;
+
+struct PointLight {
+    vec4 positionRange;
+    vec4 colorIntensity;
+};
+
+layout(std140, binding = 0) uniform FrameData {
+    mat4 u_ViewProj;
+    vec4 u_SunDir;
+    vec4 u_SunColor;
+    vec4 u_Ambient;
+    vec4 u_LightCounts;
+    PointLight u_PointLights[4];
+    vec4 u_Time;  // x: seconds, wrapped every hour
+};
+
+void main() {
+    vec3 normal = normalize(v_Normal);
+    // Grass on flat ground, rock on slopes, snow near the top
+    vec3 grass = vec3(0.22, 0.36, 0.14);
+    vec3 rock = vec3(0.38, 0.34, 0.30);
+    vec3 snow = vec3(0.90, 0.92, 0.95);
+    vec3 albedo = mix(rock, grass, smoothstep(0.7, 0.85, normal.y));
+    albedo = mix(albedo, snow, smoothstep(0.75, 0.85, v_Height) * smoothstep(0.5, 0.8, normal.y));
+
+    float diffuse = max(dot(normal, -normalize(u_SunDir.xyz)), 0.0);
+    vec3 ambient = albedo * u_Ambient.rgb * u_Ambient.a;
+    FragColor = vec4(albedo * u_SunColor.rgb * diffuse + ambient, 1.0);
+    AmbientColor = ambient;
+}
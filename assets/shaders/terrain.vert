@@ -0,0 +1,82 @@
+#version 450 core
+
+// Shared grid vertex in [0, 1]^2 and the per-node instance written by Terrain::render
+layout (location = 0) in vec2 a_Grid;
+layout (location = 1) in vec4 i_Node;   // xz origin, size, level
+layout (location = 2) in vec2 i_Morph;  // Morph start and end distance
+
+out vec3 v_Normal;
+out vec3 v_WorldPos;
+out float v_Height;
+
+struct PointLight {
+    vec4 positionRange;
+    vec4 colorIntensity;
+};
+
+layout(std140, binding = 0) uniform FrameData {
+    mat4 u_ViewProj;
+    vec4 u_SunDir;
+    vec4 u_SunColor;
+    vec4 u_Ambient;
+    vec4 u_LightCounts;
+    PointLight u_PointLights[4];
+    vec4 u_Time;  // x: seconds, wrapped every hour
+};
+
+uniform vec3 u_CameraPos;
+uniform vec4 u_Terrain;  // xz origin, size
+uniform float u_BaseHeight;
+uniform float u_HeightScale;
+uniform float u_GridResolution;
+uniform int u_TilesPerSide;
+uniform float u_TileResolution;
+uniform float u_CoarseResolution;
+uniform sampler2D u_CoarseHeights;
+uniform sampler2DArray u_TileHeights;
+uniform isampler2D u_PageTable;
+
+// Maps [0, 1] across a map of `resolution` samples onto its texel centers
+vec2 sampleCoord(vec2 uv, float resolution) {
+    return uv * (resolution - 1.0) / resolution + 0.5 / resolution;
+}
+
+// Normalized height from the streamed tile when resident, else the coarse map
+float sampleHeight(vec2 worldXZ) {
+    vec2 uv = clamp((worldXZ - u_Terrain.xy) / u_Terrain.z, 0.0, 1.0);
+    vec2 tileCoord = uv * float(u_TilesPerSide);
+    ivec2 tile = clamp(ivec2(floor(tileCoord)), ivec2(0), ivec2(u_TilesPerSide - 1));
+    int slot = texelFetch(u_PageTable, tile, 0).r;
+    if (slot >= 0) {
+        vec2 local = tileCoord - vec2(tile);
+        return textureLod(u_TileHeights, vec3(sampleCoord(local, u_TileResolution), float(slot)), 0.0).r;
+    }
+    return textureLod(u_CoarseHeights, sampleCoord(uv, u_CoarseResolution), 0.0).r;
+}
+
+float worldHeight(vec2 worldXZ) {
+    return u_BaseHeight + sampleHeight(worldXZ) * u_HeightScale;
+}
+
+void main() {
+    float nodeSize = i_Node.z;
+    vec2 worldXZ = i_Node.xy + a_Grid * nodeSize;
+    float height = worldHeight(worldXZ);
+
+    // Odd grid vertices slide onto the edge midpoint of the next coarser grid as the
+    // camera distance approaches the end of this node's LOD range
+    float distance = length(u_CameraPos - vec3(worldXZ.x, height, worldXZ.y));
+    float morph = clamp((distance - i_Morph.x) / (i_Morph.y - i_Morph.x), 0.0, 1.0);
+    vec2 offset = fract(a_Grid * u_GridResolution * 0.5) * 2.0 / u_GridResolution;
+    vec2 grid = a_Grid - offset * morph;
+    worldXZ = i_Node.xy + grid * nodeSize;
+    height = worldHeight(worldXZ);
+
+    float step = nodeSize / u_GridResolution;
+    float dx = worldHeight(worldXZ + vec2(step, 0.0)) - worldHeight(worldXZ - vec2(step, 0.0));
+    float dz = worldHeight(worldXZ + vec2(0.0, step)) - worldHeight(worldXZ - vec2(0.0, step));
+    v_Normal = normalize(vec3(-dx, 2.0 * step, -dz));
+    v_WorldPos = vec3(worldXZ.x, height, worldXZ.y);
+    v_Height = sampleHeight(worldXZ);
+    gl_Position = u_ViewProj * vec4(v_WorldPos, 1.0);
+}
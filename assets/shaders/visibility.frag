@@ -0,0 +1,31 @@
+#version 450 core
+
+// Writes the frame-wide triangle id, see Renderer::drawVisibility
+layout(location = 0) out uint VisibilityId;
+
+in vec2 v_TexCoord;
+flat in uint v_Instance;
+
+uniform uint u_TriangleBase;
+uniform uint u_TriangleCount;  // Triangles per instance
+#ifdef ALPHA_MASK
+#ifdef HAS_TEXTURE
+uniform sampler2D u_Texture;
+#endif
+uniform vec4 u_BaseColorFactor;
+uniform float u_AlphaCutoff;
+#endif
+
+void main() {
+#ifdef ALPHA_MASK
+#ifdef HAS_TEXTURE
+    float alpha = texture(u_Texture, v_TexCoord).a * u_BaseColorFactor.a;
+#else
+    float alpha = u_BaseColorFactor.a;
+#endif
+    if (alpha < u_AlphaCutoff) {
+        discard;
+    }
+#endif
+    VisibilityId = u_TriangleBase + v_Instance * u_TriangleCount + uint(gl_PrimitiveID);
+}
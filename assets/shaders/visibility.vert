@@ -0,0 +1,31 @@
+#version 450 core
+
+// Variant defines: HAS_TEXTURE, ALPHA_MASK (alpha tested materials sample their base color)
+
+layout (location = 0) in vec3 a_Position;
+layout (location = 2) in vec2 a_TexCoord;
+layout (location = 3) in mat4 i_Model;
+
+out vec2 v_TexCoord;
+flat out uint v_Instance;
+
+struct PointLight {
+    vec4 positionRange;
+    vec4 colorIntensity;
+};
+
+layout(std140, binding = 0) uniform FrameData {
+    mat4 u_ViewProj;
+    vec4 u_SunDir;
+    vec4 u_SunColor;
+    vec4 u_Ambient;
+    vec4 u_LightCounts;
+    PointLight u_PointLights[4];
+    vec4 u_Time;  // x: seconds, wrapped every hour
+};
+
+void main() {
+    v_TexCoord = a_TexCoord;
+    v_Instance = uint(gl_InstanceID);
+    gl_Position = u_ViewProj * i_Model * vec4(a_Position, 1.0);
+}
@@ -0,0 +1,35 @@
+#version 450 core
+
+// Turns each pixel's triangle id into the index of the visibility record that drew it and
+// stores it as depth, so every record's resolve draw only shades its own pixels (depth equal)
+
+in vec2 v_TexCoord;
+
+uniform usampler2D u_VisibilityIds;
+uniform int u_RecordCount;
+uniform float u_RecordDepthScale;
+
+// First triangle id of every record, ascending
+layout(std430, binding = 6) readonly buffer VisibilityRecords {
+    uint u_RecordTriangleBase[];
+};
+
+void main() {
+    uint id = texelFetch(u_VisibilityIds, ivec2(gl_FragCoord.xy), 0).r;
+    if (id == 0xFFFFFFFFu) {
+        discard;  // Nothing drawn through the visibility pass
+    }
+
+    // Last record whose base is <= id
+    int low = 0;
+    int high = u_RecordCount - 1;
+    while (low < high) {
+        int mid = (low + high + 1) >> 1;
+        if (u_RecordTriangleBase[mid] <= id) {
+            low = mid;
+        } else {
+            high = mid - 1;
+        }
+    }
+    gl_FragDepth = float(low) * u_RecordDepthScale;
+}
@@ -0,0 +1,156 @@
+#include "AnimationClip.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "core/Float4.h"
+
+AnimationClip::AnimationClip(std::string name, const std::vector<AnimationChannel>& channels, size_t nodeCount)
+    : m_Name(std::move(name)) {
+    // Translation, rotation and scale tracks each fill their own groups so a group blends one way
+    const AnimationChannel::Path paths[] = {AnimationChannel::Path::Translation, AnimationChannel::Path::Rotation,
+                                            AnimationChannel::Path::Scale};
+    for (auto path : paths) {
+        TrackGroup group;
+        group.path = path;
+        for (const auto& channel : channels) {
+            if (channel.path != path || channel.node < 0 || channel.node >= static_cast<int>(nodeCount) ||
+                channel.times.empty()) {
+                continue;
+            }
+            size_t keys = std::min(channel.times.size(), channel.values.size());
+            if (keys == 0) {
+                continue;
+            }
+
+            uint32_t lane = group.lanes++;
+            group.node[lane] = channel.node;
+            group.firstKey[lane] = static_cast<uint32_t>(m_Times.size());
+            group.keyCount[lane] = static_cast<uint32_t>(keys);
+            group.step[lane] = channel.step;
+            for (size_t k = 0; k < keys; ++k) {
+                glm::vec4 value = channel.values[k];
+                if (path == AnimationChannel::Path::Rotation) {
+                    float length = glm::length(value);
+                    value = length > 0.0f ? value / length : glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+                }
+                m_Times.push_back(channel.times[k]);
+                m_X.push_back(value.x);
+                m_Y.push_back(value.y);
+                m_Z.push_back(value.z);
+                m_W.push_back(value.w);
+            }
+            m_Duration = std::max(m_Duration, channel.times[keys - 1]);
+            ++m_TrackCount;
+
+            if (group.lanes == kLanes) {
+                m_Groups.push_back(group);
+                group = TrackGroup();
+                group.path = path;
+            }
+        }
+        if (group.lanes > 0) {
+            for (uint32_t lane = group.lanes; lane < kLanes; ++lane) {
+                group.node[lane] = group.node[0];
+                group.firstKey[lane] = group.firstKey[0];
+                group.keyCount[lane] = group.keyCount[0];
+                group.step[lane] = group.step[0];
+            }
+            m_Groups.push_back(group);
+        }
+    }
+}
+
+uint32_t AnimationClip::findKey(const TrackGroup& group, uint32_t lane, float time, bool resume, uint32_t key) const {
+    const float* times = &m_Times[group.firstKey[lane]];
+    uint32_t count = group.keyCount[lane];
+    if (!resume || key >= count) {
+        auto next = static_cast<uint32_t>(std::upper_bound(times, times + count, time) - times);
+        return next > 0 ? next - 1 : 0;
+    }
+    while (key + 1 < count && times[key + 1] <= time) {
+        ++key;
+    }
+    return key;
+}
+
+void AnimationClip::sample(float time, AnimationCursor& cursor, Pose& pose) const {
+    if (m_Groups.empty()) {
+        return;
+    }
+    if (m_Duration > 0.0f) {
+        time = std::fmod(time, m_Duration);
+        if (time < 0.0f) {
+            time += m_Duration;
+        }
+    } else {
+        time = 0.0f;
+    }
+
+    bool resume = cursor.keys.size() == m_Groups.size() * kLanes && time >= cursor.time;
+    cursor.keys.resize(m_Groups.size() * kLanes);
+    cursor.time = time;
+
+    alignas(16) float blend[kLanes];
+    alignas(16) float out[4][kLanes];
+    uint32_t a[kLanes], b[kLanes];
+    for (size_t g = 0; g < m_Groups.size(); ++g) {
+        const TrackGroup& group = m_Groups[g];
+        uint32_t* keys = &cursor.keys[g * kLanes];
+        for (uint32_t lane = 0; lane < kLanes; ++lane) {
+            uint32_t key = findKey(group, lane, time, resume, keys[lane]);
+            keys[lane] = key;
+            a[lane] = group.firstKey[lane] + key;
+            b[lane] = a[lane];
+            blend[lane] = 0.0f;
+            if (!group.step[lane] && key + 1 < group.keyCount[lane]) {
+                float t0 = m_Times[a[lane]];
+                float t1 = m_Times[a[lane] + 1];
+                if (time > t0 && t1 > t0) {
+                    b[lane] = a[lane] + 1;
+                    blend[lane] = std::min((time - t0) / (t1 - t0), 1.0f);
+                }
+            }
+        }
+
+        Float4 t = Float4::load(blend);
+        Float4 ax = Float4::set(m_X[a[0]], m_X[a[1]], m_X[a[2]], m_X[a[3]]);
+        Float4 ay = Float4::set(m_Y[a[0]], m_Y[a[1]], m_Y[a[2]], m_Y[a[3]]);
+        Float4 az = Float4::set(m_Z[a[0]], m_Z[a[1]], m_Z[a[2]], m_Z[a[3]]);
+        Float4 bx = Float4::set(m_X[b[0]], m_X[b[1]], m_X[b[2]], m_X[b[3]]);
+        Float4 by = Float4::set(m_Y[b[0]], m_Y[b[1]], m_Y[b[2]], m_Y[b[3]]);
+        Float4 bz = Float4::set(m_Z[b[0]], m_Z[b[1]], m_Z[b[2]], m_Z[b[3]]);
+
+        if (group.path == AnimationChannel::Path::Rotation) {
+            Float4 aw = Float4::set(m_W[a[0]], m_W[a[1]], m_W[a[2]], m_W[a[3]]);
+            Float4 bw = Float4::set(m_W[b[0]], m_W[b[1]], m_W[b[2]], m_W[b[3]]);
+            // Blend towards whichever of b and -b is nearer so the rotation takes the short arc
+            Float4 flip = (ax * bx + ay * by + az * bz + aw * bw) < Float4::splat(0.0f);
+            bx = Float4::select(flip, -bx, bx);
+            by = Float4::select(flip, -by, by);
+            bz = Float4::select(flip, -bz, bz);
+            bw = Float4::select(flip, -bw, bw);
+            Float4 x = ax + (bx - ax) * t;
+            Float4 y = ay + (by - ay) * t;
+            Float4 z = az + (bz - az) * t;
+            Float4 w = aw + (bw - aw) * t;
+            Float4 inverseLength = (x * x + y * y + z * z + w * w).sqrt().reciprocal();
+            (x * inverseLength).store(out[0]);
+            (y * inverseLength).store(out[1]);
+            (z * inverseLength).store(out[2]);
+            (w * inverseLength).store(out[3]);
+            for (uint32_t lane = 0; lane < group.lanes; ++lane) {
+                pose.rotations[group.node[lane]] = glm::quat(out[3][lane], out[0][lane], out[1][lane], out[2][lane]);
+            }
+            continue;
+        }
+
+        (ax + (bx - ax) * t).store(out[0]);
+        (ay + (by - ay) * t).store(out[1]);
+        (az + (bz - az) * t).store(out[2]);
+        auto& target = group.path == AnimationChannel::Path::Translation ? pose.translations : pose.scales;
+        for (uint32_t lane = 0; lane < group.lanes; ++lane) {
+            target[group.node[lane]] = glm::vec3(out[0][lane], out[1][lane], out[2][lane]);
+        }
+    }
+}
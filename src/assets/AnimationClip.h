@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+
+#include "Skeleton.h"
+
+// One imported glTF channel, the input AnimationClip is built from
+struct AnimationChannel {
+    enum class Path { Translation, Rotation, Scale };
+
+    int node = -1;
+    Path path = Path::Translation;
+    bool step = false;  // STEP interpolation, otherwise LINEAR
+    std::vector<float> times;
+    std::vector<glm::vec4> values;  // xyz for translation/scale, xyzw quaternion for rotation
+};
+
+// Playback state of one instance: the key each track sampled last
+struct AnimationCursor {
+    std::vector<uint32_t> keys;
+    float time = 0.0f;
+};
+
+// Keys of every track in SoA arrays, with tracks grouped in fours by path so one sample
+// blends four tracks in Float4 lanes (rotations by normalized lerp). Each track resumes its
+// key search from the cursor, which makes sequential playback O(1) per track; only a jump
+// backwards in time falls back to a binary search.
+class AnimationClip {
+   public:
+    AnimationClip() = default;
+    // Channels without keys or targeting a node outside [0, nodeCount) are dropped
+    AnimationClip(std::string name, const std::vector<AnimationChannel>& channels, size_t nodeCount);
+
+    const std::string& getName() const { return m_Name; }
+    float getDuration() const { return m_Duration; }
+    size_t getTrackCount() const { return m_TrackCount; }
+
+    // Writes the animated local transforms at `time` (wrapped to the duration) into `pose`,
+    // other nodes keep their values. `pose` must cover the skeleton the clip was built for.
+    void sample(float time, AnimationCursor& cursor, Pose& pose) const;
+
+   private:
+    static const uint32_t kLanes = 4;
+
+    struct TrackGroup {
+        AnimationChannel::Path path = AnimationChannel::Path::Translation;
+        uint32_t lanes = 0;  // Tracks in use, unused lanes repeat lane 0
+        int32_t node[kLanes] = {};
+        uint32_t firstKey[kLanes] = {};
+        uint32_t keyCount[kLanes] = {};
+        bool step[kLanes] = {};
+    };
+
+    uint32_t findKey(const TrackGroup& group, uint32_t lane, float time, bool resume, uint32_t key) const;
+
+    std::string m_Name;
+    float m_Duration = 0.0f;
+    size_t m_TrackCount = 0;
+    std::vector<TrackGroup> m_Groups;
+    std::vector<float> m_Times;
+    std::vector<float> m_X, m_Y, m_Z, m_W;
+};
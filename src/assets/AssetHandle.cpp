@@ -8,6 +8,12 @@ std::shared_ptr<T> AssetHandle<T>::get() const {
     return m_AssetManager->template getAssetPtr<T>(m_Id);
 }
 
+template <typename T>
+AssetState AssetHandle<T>::getState() const {
+    if (!isValid()) return AssetState::Failed;
+    return m_AssetManager->getState(m_Id);
+}
+
 template class AssetHandle<Model>;
 template class AssetHandle<Shader>;
 template class AssetHandle<Texture>;
@@ -1,4 +1,5 @@
 #pragma once
+#include <cstdint>
 #include <memory>
 
 #include "UUID.h"
@@ -10,6 +11,13 @@ class Shader;
 class Texture;
 class Material;
 
+// Assets loaded asynchronously stay Pending until their GL objects exist
+enum class AssetState : uint8_t {
+    Pending,
+    Ready,
+    Failed
+};
+
 template <typename T>
 class AssetHandle {
    public:
@@ -17,7 +25,10 @@ class AssetHandle {
     AssetHandle(AssetManager* manager, UUID id)
         : m_AssetManager(manager), m_Id(id) {}
 
+    // Null while the asset is still loading
     std::shared_ptr<T> get() const;
+    AssetState getState() const;
+    bool isReady() const { return getState() == AssetState::Ready; }
 
     bool isValid() const { return m_AssetManager != nullptr && m_Id != 0; }
     UUID getId() const { return m_Id; }
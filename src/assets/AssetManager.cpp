@@ -0,0 +1,232 @@
+#include "AssetManager.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+AssetManager::~AssetManager() {
+    stopLoaders();
+}
+
+ModelHandle AssetManager::loadModelAsync(const std::string& gltfPath, const std::string& shaderPath) {
+    UUID id;
+    if (beginLoad("model_" + gltfPath, id)) {
+        return ModelHandle(this, id);
+    }
+    queueLoad(id, [this, id, gltfPath, shaderPath]() -> UploadStep {
+        auto source = std::make_shared<ModelSource>(Model::cook(gltfPath));
+        // Textures on the first step, then one material and after them one submesh per step;
+        // embedded textures queue behind the model, so geometry shows before it is fully textured
+        return [this, id, source, shaderPath, model = std::shared_ptr<Model>()]() mutable -> std::shared_ptr<Asset> {
+            if (!model) {
+                model = std::make_shared<Model>(std::move(*source), shaderPath, *this, true);
+                // update() only runs steps of loads that are still pending
+                m_States.at(id).partial = model;
+                return nullptr;
+            }
+            return model->uploadNext() ? nullptr : model;
+        };
+    });
+    return ModelHandle(this, id);
+}
+
+TextureHandle AssetManager::loadTextureAsync(const std::string& path) {
+    UUID id = startLoad("texture_" + path, [path]() -> UploadStep {
+        auto data = std::make_shared<TextureData>(Texture::decode(path));
+        return [path, data]() -> std::shared_ptr<Asset> { return std::make_shared<Texture>(path, *data); };
+    });
+    return TextureHandle(this, id);
+}
+
+TextureHandle AssetManager::loadTextureAsync(const std::string& name, TextureData data) {
+    auto pixels = std::make_shared<TextureData>(std::move(data));
+    UUID id = startUpload("texture_" + name, [name, pixels]() -> std::shared_ptr<Asset> {
+        return std::make_shared<Texture>(name, *pixels);
+    });
+    return TextureHandle(this, id);
+}
+
+std::shared_ptr<const Model> AssetManager::getLoadingModel(const ModelHandle& handle) const {
+    auto status = m_States.find(handle.getId());
+    if (status == m_States.end() || status->second.state != AssetState::Pending) {
+        return nullptr;
+    }
+    return std::dynamic_pointer_cast<const Model>(status->second.partial);
+}
+
+AssetState AssetManager::getState(UUID id) const {
+    if (m_Assets.find(id) != m_Assets.end()) {
+        return AssetState::Ready;
+    }
+    auto status = m_States.find(id);
+    return status != m_States.end() ? status->second.state : AssetState::Failed;
+}
+
+bool AssetManager::beginLoad(const std::string& key, UUID& id) {
+    auto it = m_PathToId.find(key);
+    if (it != m_PathToId.end()) {
+        id = it->second;
+        return true;
+    }
+    id = UUID();
+    m_PathToId[key] = id;
+    m_States[id] = LoadStatus{AssetState::Pending, key, nullptr};
+    ++m_PendingLoads;
+    return false;
+}
+
+UUID AssetManager::startLoad(const std::string& key, std::function<UploadStep()> load) {
+    UUID id;
+    if (!beginLoad(key, id)) {
+        queueLoad(id, std::move(load));
+    }
+    return id;
+}
+
+void AssetManager::queueLoad(UUID id, std::function<UploadStep()> load) {
+    startLoaders();
+    {
+        std::lock_guard<std::mutex> lock(m_LoadMutex);
+        m_LoadQueue.push_back(LoadJob{id, std::move(load)});
+    }
+    m_LoadReady.notify_one();
+}
+
+UUID AssetManager::startUpload(const std::string& key, UploadStep upload) {
+    UUID id;
+    if (!beginLoad(key, id)) {
+        m_Uploads.push_back(PendingUpload{id, std::move(upload)});
+    }
+    return id;
+}
+
+void AssetManager::failLoad(UUID id, std::exception_ptr error) {
+    auto status = m_States.find(id);
+    if (status == m_States.end() || status->second.state != AssetState::Pending) {
+        return;
+    }
+    status->second.state = AssetState::Failed;
+    status->second.partial.reset();
+    --m_PendingLoads;
+    ++m_CompletedLoads;
+    try {
+        std::rethrow_exception(error);
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to load '" << status->second.key << "': " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "Failed to load '" << status->second.key << "'" << std::endl;
+    }
+}
+
+void AssetManager::update(double budgetMs) {
+    {
+        std::lock_guard<std::mutex> lock(m_LoadMutex);
+        for (auto& finished : m_Finished) {
+            if (finished.error) {
+                failLoad(finished.id, finished.error);
+            } else {
+                m_Uploads.push_back(PendingUpload{finished.id, std::move(finished.upload)});
+            }
+        }
+        m_Finished.clear();
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    bool first = true;
+    while (!m_Uploads.empty()) {
+        double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (!first && elapsedMs >= budgetMs) {
+            break;
+        }
+        first = false;
+
+        // Steps may queue more uploads; deque references survive push_back
+        PendingUpload& upload = m_Uploads.front();
+        auto status = m_States.find(upload.id);
+        if (status == m_States.end() || status->second.state != AssetState::Pending) {
+            m_Uploads.pop_front();  // Removed while loading
+            continue;
+        }
+        std::shared_ptr<Asset> asset;
+        try {
+            asset = upload.upload();
+        } catch (...) {
+            failLoad(upload.id, std::current_exception());
+            m_Uploads.pop_front();
+            continue;
+        }
+        if (asset) {
+            m_Assets[upload.id] = std::move(asset);
+            m_States.erase(upload.id);  // The step may have rehashed m_States
+            --m_PendingLoads;
+            ++m_CompletedLoads;
+            m_Uploads.pop_front();
+        }
+    }
+}
+
+void AssetManager::clear() {
+    {
+        // Jobs already running finish into m_Finished and are dropped by update()
+        std::lock_guard<std::mutex> lock(m_LoadMutex);
+        m_LoadQueue.clear();
+        m_Finished.clear();
+    }
+    m_Uploads.clear();
+    m_States.clear();
+    m_PendingLoads = 0;
+    m_Assets.clear();
+    m_PathToId.clear();
+}
+
+void AssetManager::startLoaders() {
+    if (!m_Loaders.empty()) {
+        return;
+    }
+    unsigned int count = m_LoaderThreadCount;
+    if (count == 0) {
+        count = std::max(2u, std::thread::hardware_concurrency()) - 1;
+    }
+    for (unsigned int i = 0; i < count; ++i) {
+        m_Loaders.emplace_back(&AssetManager::loaderLoop, this);
+    }
+}
+
+void AssetManager::stopLoaders() {
+    {
+        std::lock_guard<std::mutex> lock(m_LoadMutex);
+        m_Running = false;
+        m_LoadQueue.clear();
+    }
+    m_LoadReady.notify_all();
+    for (auto& loader : m_Loaders) {
+        loader.join();
+    }
+    m_Loaders.clear();
+}
+
+void AssetManager::loaderLoop() {
+    for (;;) {
+        std::function<UploadStep()> load;
+        UUID id(0);
+        {
+            std::unique_lock<std::mutex> lock(m_LoadMutex);
+            m_LoadReady.wait(lock, [this] { return !m_Running || !m_LoadQueue.empty(); });
+            if (!m_Running) {
+                return;
+            }
+            id = m_LoadQueue.front().id;
+            load = std::move(m_LoadQueue.front().load);
+            m_LoadQueue.pop_front();
+        }
+
+        FinishedLoad finished{id, UploadStep(), nullptr};
+        try {
+            finished.upload = load();
+        } catch (...) {
+            finished.error = std::current_exception();
+        }
+        std::lock_guard<std::mutex> lock(m_LoadMutex);
+        m_Finished.push_back(std::move(finished));
+    }
+}
@@ -1,9 +1,17 @@
 #pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <typeindex>
 #include <unordered_map>
+#include <vector>
 
 #include "Asset.h"
 #include "AssetHandle.h"
@@ -16,7 +24,10 @@
 class AssetManager {
    public:
     AssetManager() = default;
-    ~AssetManager() = default;
+    ~AssetManager();
+
+    AssetManager(const AssetManager&) = delete;
+    AssetManager& operator=(const AssetManager&) = delete;
 
     ShaderHandle getOrLoadShader(const std::string& shaderPath) {
         return getOrLoadAsset<Shader>("shader_" + shaderPath, shaderPath);
@@ -27,6 +38,9 @@ class AssetManager {
     TextureHandle getOrLoadTexture(const std::string& path) {
         return getOrLoadAsset<Texture>("texture_" + path, path);
     }
+    TextureHandle getOrLoadTexture(const std::string& name, const TextureData& data) {
+        return getOrLoadAsset<Texture>("texture_" + name, name, data);
+    }
     TextureHandle getOrLoadTextureFromMemory(const uint8_t* data, int width, int height, int channels) {
         std::string key = "texture_<memory>_" + std::to_string(reinterpret_cast<uintptr_t>(data));
         auto it = m_PathToId.find(key);
@@ -48,6 +62,28 @@ class AssetManager {
         return getOrLoadAsset<Material>("material_" + name, name, shader, textures, params, state);
     }
 
+    // Asynchronous loads return a pending handle at once. Files are parsed, decoded and cooked on
+    // loader threads, and update() creates the GL objects on the main thread; get() returns null
+    // until then. A synchronous load of an asset that is still pending returns the pending handle.
+    ModelHandle loadModelAsync(const std::string& gltfPath, const std::string& shaderPath);
+    TextureHandle loadTextureAsync(const std::string& path);
+    // Pixels decoded elsewhere, only the upload is deferred to update()
+    TextureHandle loadTextureAsync(const std::string& name, TextureData data);
+
+    // Loader threads started by the first asynchronous load, 0 for one per hardware thread but one
+    void setLoaderThreads(unsigned int threads) { m_LoaderThreadCount = threads; }
+    // Advances finished loads on the main thread until `budgetMs` is spent. A model creates one
+    // material or uploads one submesh per step and a texture is one step; at least one step runs
+    // per call.
+    void update(double budgetMs);
+    // A model load that is still uploading, with the submeshes created so far; null before its
+    // first upload step and once the load finished or failed (use get() from then on)
+    std::shared_ptr<const Model> getLoadingModel(const ModelHandle& handle) const;
+    bool hasPendingLoads() const { return m_PendingLoads > 0; }
+    // Loads that became ready or failed so far, bumped when the visible scene may change
+    uint64_t getCompletedLoads() const { return m_CompletedLoads; }
+    AssetState getState(UUID id) const;
+
     void removeShader(const std::string& shaderPath) {
         removeAssetByPath("shader_" + shaderPath);
     }
@@ -66,12 +102,43 @@ class AssetManager {
     TextureHandle getTexture(UUID id) const { return getAssetById<Texture>(id); }
     MaterialHandle getMaterial(UUID id) const { return getAssetById<Material>(id); }
 
-    void clear() {
-        m_Assets.clear();
-        m_PathToId.clear();
-    }
+    void clear();
 
    private:
+    // Main-thread half of an asynchronous load, called by update() until it returns the asset
+    using UploadStep = std::function<std::shared_ptr<Asset>()>;
+
+    struct LoadStatus {
+        AssetState state;
+        std::string key;
+        std::shared_ptr<Asset> partial;  // Set by upload steps that expose unfinished assets
+    };
+    struct LoadJob {
+        UUID id;
+        std::function<UploadStep()> load;
+    };
+    struct FinishedLoad {
+        UUID id;
+        UploadStep upload;
+        std::exception_ptr error;
+    };
+    struct PendingUpload {
+        UUID id;
+        UploadStep upload;
+    };
+
+    // Registers `key` as pending and returns false, or returns true with the id it already has
+    bool beginLoad(const std::string& key, UUID& id);
+    // Runs `load` on a loader thread, then its upload steps in update()
+    UUID startLoad(const std::string& key, std::function<UploadStep()> load);
+    void queueLoad(UUID id, std::function<UploadStep()> load);
+    // Skips the loader threads
+    UUID startUpload(const std::string& key, UploadStep upload);
+    void failLoad(UUID id, std::exception_ptr error);
+    void startLoaders();
+    void stopLoaders();
+    void loaderLoop();
+
     template <typename T, typename... Args>
     AssetHandle<T> getOrLoadAsset(const std::string& path, Args&&... args) {
         auto it = m_PathToId.find(path);
@@ -89,6 +156,12 @@ class AssetManager {
         auto it = m_PathToId.find(path);
         if (it != m_PathToId.end()) {
             m_Assets.erase(it->second);
+            // A pending load finishing later is dropped by update()
+            auto status = m_States.find(it->second);
+            if (status != m_States.end()) {
+                if (status->second.state == AssetState::Pending) --m_PendingLoads;
+                m_States.erase(status);
+            }
             m_PathToId.erase(it);
         }
     }
@@ -111,9 +184,21 @@ class AssetManager {
         return nullptr;
     }
 
-    // No multithreading support, so no need for mutexes. If you add multithreading, you'll need to add mutexes to protect these maps.
+    // Only touched on the main thread; loader threads see nothing but m_LoadQueue and m_Finished
     std::unordered_map<UUID, std::shared_ptr<Asset>> m_Assets;
     std::unordered_map<std::string, UUID> m_PathToId;
+    std::unordered_map<UUID, LoadStatus> m_States;  // Pending and failed asynchronous loads
+    std::deque<PendingUpload> m_Uploads;
+    size_t m_PendingLoads = 0;
+    uint64_t m_CompletedLoads = 0;
+
+    unsigned int m_LoaderThreadCount = 0;
+    std::vector<std::thread> m_Loaders;
+    std::mutex m_LoadMutex;
+    std::condition_variable m_LoadReady;
+    std::deque<LoadJob> m_LoadQueue;
+    std::vector<FinishedLoad> m_Finished;
+    bool m_Running = true;
 
     template <typename T>
     friend class AssetHandle;
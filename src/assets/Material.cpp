@@ -1,8 +1,28 @@
 #include "Material.h"
 
+#include "Shader.h"
+
 Material::Material(const std::string& name,
                    ShaderHandle shader,
                    const MaterialTextures& textures,
                    const MaterialParams& params,
                    const RenderState& state)
-    : Asset(name), m_Shader(shader), m_Textures(textures), m_Params(params), m_State(state) {}
+    : Asset(name), m_Shader(shader), m_Textures(textures), m_Params(params), m_State(state) {
+    if (m_Textures.baseColor.isValid()) {
+        m_ShaderFeatures |= ShaderFeature::HasTexture;
+    }
+    if (m_State.blend) {
+        m_ShaderFeatures |= ShaderFeature::OitBlend;
+    } else if (m_Params.alphaCutoff > 0.0f) {
+        m_ShaderFeatures |= ShaderFeature::AlphaMask;
+    }
+
+    // Start compiling the material's variant now; with parallel compilation it finishes in
+    // the background and the renderer uses a fallback until then. The fallbacks of the
+    // transparent and debug passes are shared by all materials of the shader.
+    if (auto shaderPtr = m_Shader.get()) {
+        shaderPtr->prepareVariant(m_ShaderFeatures);
+        shaderPtr->prepareVariant(m_ShaderFeatures & ShaderFeature::PassFeatures);
+        shaderPtr->prepareVariant(ShaderFeature::DebugView);
+    }
+}
@@ -2,6 +2,7 @@
 
 #include <glm/vec3.hpp>
 #include <glm/vec4.hpp>
+#include <cstdint>
 #include <string>
 
 #include "Asset.h"
@@ -44,6 +45,8 @@ class Material : public Asset {
     const MaterialTextures& getTextures() const { return m_Textures; }
     const MaterialParams& getParams() const { return m_Params; }
     const RenderState& getState() const { return m_State; }
+    // ShaderFeature bits implied by the textures, params and state
+    uint32_t getShaderFeatures() const { return m_ShaderFeatures; }
 
     const std::string& getPath() const override { return m_Path; }
 
@@ -52,4 +55,5 @@ class Material : public Asset {
     MaterialTextures m_Textures;
     MaterialParams m_Params;
     RenderState m_State;
+    uint32_t m_ShaderFeatures = 0;
 };
@@ -3,14 +3,21 @@
 #define TINYGLTF_IMPLEMENTATION
 #include <tiny_gltf.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <cstdint>
 #include <glm/common.hpp>
+#include <glm/gtc/type_ptr.hpp>
 #include <glm/vec3.hpp>
 #include <glm/vec4.hpp>
 #include <iostream>
 #include <stdexcept>
 
 #include "AssetManager.h"
+#include "VertexOcclusionCache.h"
+#include "bake/VertexAnimationBake.h"
+#include "rendering/Meshlets.h"
 
 namespace {
 
@@ -31,38 +38,58 @@ tinygltf::Model loadGltfModel(const std::string& gltfPath) {
     return gltfModel;
 }
 
-std::vector<TextureHandle> loadGltfTextures(const tinygltf::Model& gltfModel,
-                                            const std::string& gltfDir,
-                                            AssetManager& assetManager) {
-    std::vector<TextureHandle> gltfTextures;
-    gltfTextures.reserve(gltfModel.textures.size());
+std::vector<ModelTextureSource> readTextures(const tinygltf::Model& gltfModel, const std::string& gltfDir) {
+    std::vector<ModelTextureSource> textures;
+    textures.reserve(gltfModel.textures.size());
 
     for (const auto& texture : gltfModel.textures) {
         if (texture.source < 0 || texture.source >= static_cast<int>(gltfModel.images.size()))
             throw std::runtime_error("Invalid texture source: " + std::to_string(texture.source));
 
         const auto& image = gltfModel.images[texture.source];
-        TextureHandle handle;
+        ModelTextureSource source;
 
         if (!image.uri.empty()) {
             // External file
-            std::string path = gltfDir + "/" + image.uri;
-            handle = assetManager.getOrLoadTexture(path);
+            source.path = gltfDir + "/" + image.uri;
         } else if (!image.image.empty()) {
             // Embedded texture
-            handle = assetManager.getOrLoadTextureFromMemory(
-                image.image.data(), image.width, image.height, image.component);
+            source.data = Texture::fromMemory(image.image.data(), image.width, image.height, image.component);
         } else {
             throw std::runtime_error("Texture has no URI or embedded image");
         }
 
+        textures.push_back(std::move(source));
+    }
+
+    return textures;
+}
+
+std::vector<TextureHandle> resolveTextures(std::vector<ModelTextureSource>& sources,
+                                           const std::string& modelPath,
+                                           AssetManager& assetManager,
+                                           bool async) {
+    std::vector<TextureHandle> textures;
+    textures.reserve(sources.size());
+
+    for (size_t i = 0; i < sources.size(); ++i) {
+        auto& source = sources[i];
+        TextureHandle handle;
+        if (!source.path.empty()) {
+            handle = async ? assetManager.loadTextureAsync(source.path) : assetManager.getOrLoadTexture(source.path);
+        } else {
+            std::string name = modelPath + "#texture_" + std::to_string(i);
+            handle = async ? assetManager.loadTextureAsync(name, std::move(source.data))
+                           : assetManager.getOrLoadTexture(name, source.data);
+        }
+
         if (!handle.isValid())
-            throw std::runtime_error("Failed to load texture: " + (image.uri.empty() ? "embedded" : image.uri));
+            throw std::runtime_error("Failed to load texture: " + (source.path.empty() ? "embedded" : source.path));
 
-        gltfTextures.push_back(handle);
+        textures.push_back(handle);
     }
 
-    return gltfTextures;
+    return textures;
 }
 
 MaterialHandle createDefaultMaterial(const std::string& name,
@@ -73,28 +100,20 @@ MaterialHandle createDefaultMaterial(const std::string& name,
     return assetManager.getOrLoadMaterial(name, shader, defaultTextures, defaultParams, RenderState{});
 }
 
-std::vector<MaterialHandle> buildMaterials(const tinygltf::Model& gltfModel,
-                                           AssetManager& assetManager,
-                                           const ShaderHandle& shader,
-                                           const std::vector<TextureHandle>& textures) {
-    std::vector<MaterialHandle> materials;
+std::vector<ModelMaterialSource> readMaterials(const tinygltf::Model& gltfModel) {
+    std::vector<ModelMaterialSource> materials;
     materials.reserve(gltfModel.materials.size());
 
     for (size_t i = 0; i < gltfModel.materials.size(); ++i) {
         const auto& mat = gltfModel.materials[i];
-        MaterialTextures matTextures;
-        MaterialParams params;
+        ModelMaterialSource source;
+        MaterialParams& params = source.params;
 
-        auto assignTexture = [&](int texIndex, TextureHandle& dst) {
-            if (texIndex >= 0 && texIndex < static_cast<int>(textures.size()))
-                dst = textures[texIndex];
-        };
-
-        assignTexture(mat.pbrMetallicRoughness.baseColorTexture.index, matTextures.baseColor);
-        assignTexture(mat.pbrMetallicRoughness.metallicRoughnessTexture.index, matTextures.metallicRoughness);
-        assignTexture(mat.normalTexture.index, matTextures.normal);
-        assignTexture(mat.emissiveTexture.index, matTextures.emissive);
-        assignTexture(mat.occlusionTexture.index, matTextures.occlusion);
+        source.baseColor = mat.pbrMetallicRoughness.baseColorTexture.index;
+        source.metallicRoughness = mat.pbrMetallicRoughness.metallicRoughnessTexture.index;
+        source.normal = mat.normalTexture.index;
+        source.emissive = mat.emissiveTexture.index;
+        source.occlusion = mat.occlusionTexture.index;
 
         if (mat.pbrMetallicRoughness.baseColorFactor.size() == 4) {
             params.baseColorFactor = glm::vec4(
@@ -115,18 +134,38 @@ std::vector<MaterialHandle> buildMaterials(const tinygltf::Model& gltfModel,
 
         params.alphaCutoff = (mat.alphaMode == "MASK") ? static_cast<float>(mat.alphaCutoff) : 0.0f;
 
-        RenderState state;
+        RenderState& state = source.state;
         state.blend = (mat.alphaMode == "BLEND");
         state.depthWrite = !state.blend;
         state.cull = !mat.doubleSided;
 
-        std::string matName = mat.name.empty() ? "material_" + std::to_string(i) : mat.name;
-        materials.push_back(assetManager.getOrLoadMaterial(matName, shader, matTextures, params, state));
+        source.name = mat.name.empty() ? "material_" + std::to_string(i) : mat.name;
+        materials.push_back(std::move(source));
     }
 
     return materials;
 }
 
+MaterialHandle buildMaterial(const ModelMaterialSource& source,
+                             AssetManager& assetManager,
+                             const ShaderHandle& shader,
+                             const std::vector<TextureHandle>& textures) {
+    MaterialTextures matTextures;
+
+    auto assignTexture = [&](int texIndex, TextureHandle& dst) {
+        if (texIndex >= 0 && texIndex < static_cast<int>(textures.size()))
+            dst = textures[texIndex];
+    };
+
+    assignTexture(source.baseColor, matTextures.baseColor);
+    assignTexture(source.metallicRoughness, matTextures.metallicRoughness);
+    assignTexture(source.normal, matTextures.normal);
+    assignTexture(source.emissive, matTextures.emissive);
+    assignTexture(source.occlusion, matTextures.occlusion);
+
+    return assetManager.getOrLoadMaterial(source.name, shader, matTextures, source.params, source.state);
+}
+
 std::vector<unsigned int> readIndices(const tinygltf::Model& gltfModel,
                                       const tinygltf::Primitive& primitive,
                                       size_t vertexCount) {
@@ -207,16 +246,261 @@ void readStridedVec(const tinygltf::Model& gltfModel, const tinygltf::Accessor&
     }
 }
 
-std::unique_ptr<Mesh> buildMeshFromPrimitive(const tinygltf::Model& gltfModel,
-                                             const tinygltf::Primitive& primitive) {
+// Reads any float or integer accessor as floats; normalized integers are mapped to [0, 1],
+// signed ones to [-1, 1]
+void readComponents(const tinygltf::Model& gltfModel, const tinygltf::Accessor& acc, int components, std::vector<float>& out) {
+    if (acc.bufferView < 0 || acc.bufferView >= static_cast<int>(gltfModel.bufferViews.size()))
+        throw std::runtime_error("Invalid bufferView for accessor");
+    const auto& bv = gltfModel.bufferViews[acc.bufferView];
+    if (bv.buffer < 0 || bv.buffer >= static_cast<int>(gltfModel.buffers.size()))
+        throw std::runtime_error("Invalid buffer for accessor");
+    const auto& buf = gltfModel.buffers[bv.buffer];
+    const uint8_t* base = buf.data.data() + bv.byteOffset + acc.byteOffset;
+
+    size_t elemSize = 0;
+    float scale = 1.0f;
+    switch (acc.componentType) {
+        case TINYGLTF_COMPONENT_TYPE_FLOAT:
+            elemSize = sizeof(float);
+            break;
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+            elemSize = sizeof(uint8_t);
+            scale = acc.normalized ? 1.0f / 255.0f : 1.0f;
+            break;
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+            elemSize = sizeof(uint16_t);
+            scale = acc.normalized ? 1.0f / 65535.0f : 1.0f;
+            break;
+        case TINYGLTF_COMPONENT_TYPE_BYTE:
+            elemSize = sizeof(int8_t);
+            scale = acc.normalized ? 1.0f / 127.0f : 1.0f;
+            break;
+        case TINYGLTF_COMPONENT_TYPE_SHORT:
+            elemSize = sizeof(int16_t);
+            scale = acc.normalized ? 1.0f / 32767.0f : 1.0f;
+            break;
+        default:
+            throw std::runtime_error("Unsupported accessor component type");
+    }
+    size_t stride = bv.byteStride > 0 ? bv.byteStride : components * elemSize;
+    out.reserve(out.size() + acc.count * components);
+    for (size_t i = 0; i < acc.count; ++i) {
+        const uint8_t* elem = base + i * stride;
+        for (int c = 0; c < components; ++c) {
+            const uint8_t* component = elem + c * elemSize;
+            switch (acc.componentType) {
+                case TINYGLTF_COMPONENT_TYPE_FLOAT:
+                    out.push_back(*reinterpret_cast<const float*>(component));
+                    break;
+                case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+                    out.push_back(static_cast<float>(*component) * scale);
+                    break;
+                case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+                    out.push_back(static_cast<float>(*reinterpret_cast<const uint16_t*>(component)) * scale);
+                    break;
+                // The most negative value also maps to -1 when normalized
+                case TINYGLTF_COMPONENT_TYPE_BYTE: {
+                    float value = static_cast<float>(*reinterpret_cast<const int8_t*>(component)) * scale;
+                    out.push_back(acc.normalized ? std::max(value, -1.0f) : value);
+                    break;
+                }
+                case TINYGLTF_COMPONENT_TYPE_SHORT: {
+                    float value = static_cast<float>(*reinterpret_cast<const int16_t*>(component)) * scale;
+                    out.push_back(acc.normalized ? std::max(value, -1.0f) : value);
+                    break;
+                }
+            }
+        }
+    }
+}
+
+Skeleton readSkeleton(const tinygltf::Model& gltfModel) {
+    std::vector<SkeletonNode> nodes(gltfModel.nodes.size());
+    for (size_t i = 0; i < gltfModel.nodes.size(); ++i) {
+        const auto& node = gltfModel.nodes[i];
+        for (int child : node.children) {
+            if (child >= 0 && child < static_cast<int>(nodes.size())) nodes[child].parent = static_cast<int>(i);
+        }
+
+        SkeletonNode& dst = nodes[i];
+        if (node.matrix.size() == 16) {
+            glm::mat4 m = glm::make_mat4(node.matrix.data());
+            dst.translation = glm::vec3(m[3]);
+            dst.scale = glm::vec3(glm::length(glm::vec3(m[0])), glm::length(glm::vec3(m[1])), glm::length(glm::vec3(m[2])));
+            glm::mat3 rotation(glm::vec3(m[0]) / dst.scale.x, glm::vec3(m[1]) / dst.scale.y, glm::vec3(m[2]) / dst.scale.z);
+            dst.rotation = glm::quat_cast(rotation);
+            continue;
+        }
+        if (node.translation.size() == 3) {
+            dst.translation = glm::vec3(static_cast<float>(node.translation[0]), static_cast<float>(node.translation[1]),
+                                        static_cast<float>(node.translation[2]));
+        }
+        if (node.rotation.size() == 4) {
+            dst.rotation = glm::quat(static_cast<float>(node.rotation[3]), static_cast<float>(node.rotation[0]),
+                                     static_cast<float>(node.rotation[1]), static_cast<float>(node.rotation[2]));
+        }
+        if (node.scale.size() == 3) {
+            dst.scale = glm::vec3(static_cast<float>(node.scale[0]), static_cast<float>(node.scale[1]),
+                                  static_cast<float>(node.scale[2]));
+        }
+    }
+    Skeleton skeleton;
+    skeleton.setNodes(std::move(nodes));
+    return skeleton;
+}
+
+std::vector<Skin> readSkins(const tinygltf::Model& gltfModel) {
+    std::vector<Skin> skins;
+    skins.reserve(gltfModel.skins.size());
+    for (const auto& gltfSkin : gltfModel.skins) {
+        // 8-bit joint indices in the vertex stream
+        if (gltfSkin.joints.size() > 256)
+            throw std::runtime_error("Skin has more than 256 joints");
+
+        Skin skin;
+        skin.joints = gltfSkin.joints;
+        skin.inverseBindMatrices.assign(skin.joints.size(), glm::mat4(1.0f));
+        skin.jointRadius.assign(skin.joints.size(), 0.0f);
+        if (gltfSkin.inverseBindMatrices >= 0) {
+            std::vector<float> matrices;
+            readComponents(gltfModel, gltfModel.accessors[gltfSkin.inverseBindMatrices], 16, matrices);
+            for (size_t j = 0; j < skin.joints.size() && (j + 1) * 16 <= matrices.size(); ++j) {
+                skin.inverseBindMatrices[j] = glm::make_mat4(&matrices[j * 16]);
+            }
+        }
+        skins.push_back(std::move(skin));
+    }
+    return skins;
+}
+
+std::vector<AnimationClip> readAnimations(const tinygltf::Model& gltfModel) {
+    std::vector<AnimationClip> clips;
+    clips.reserve(gltfModel.animations.size());
+    for (size_t i = 0; i < gltfModel.animations.size(); ++i) {
+        const auto& animation = gltfModel.animations[i];
+        std::vector<AnimationChannel> channels;
+        for (const auto& gltfChannel : animation.channels) {
+            if (gltfChannel.sampler < 0 || gltfChannel.sampler >= static_cast<int>(animation.samplers.size())) continue;
+            AnimationChannel channel;
+            channel.node = gltfChannel.target_node;
+            int components = 3;
+            if (gltfChannel.target_path == "translation") {
+                channel.path = AnimationChannel::Path::Translation;
+            } else if (gltfChannel.target_path == "rotation") {
+                channel.path = AnimationChannel::Path::Rotation;
+                components = 4;
+            } else if (gltfChannel.target_path == "scale") {
+                channel.path = AnimationChannel::Path::Scale;
+            } else {
+                continue;  // Morph target weights are not supported
+            }
+
+            const auto& sampler = animation.samplers[gltfChannel.sampler];
+            channel.step = sampler.interpolation == "STEP";
+            std::vector<float> values;
+            try {
+                int accessors = static_cast<int>(gltfModel.accessors.size());
+                if (sampler.input < 0 || sampler.input >= accessors || sampler.output < 0 || sampler.output >= accessors)
+                    throw std::runtime_error("Invalid sampler accessor");
+                readComponents(gltfModel, gltfModel.accessors[sampler.input], 1, channel.times);
+                readComponents(gltfModel, gltfModel.accessors[sampler.output], components, values);
+            } catch (const std::exception& e) {
+                // One bad channel should not cost the whole model, the clip plays without it
+                std::cerr << "Skipping " << gltfChannel.target_path << " channel of node " << channel.node
+                          << " in animation '" << animation.name << "': " << e.what() << std::endl;
+                continue;
+            }
+            // CUBICSPLINE stores in-tangent, value, out-tangent per key; keep the values only
+            size_t perKey = sampler.interpolation == "CUBICSPLINE" ? 3 : 1;
+            size_t keys = std::min(channel.times.size(), values.size() / (components * perKey));
+            channel.times.resize(keys);
+            for (size_t k = 0; k < keys; ++k) {
+                const float* v = &values[(k * perKey + (perKey == 3 ? 1 : 0)) * components];
+                channel.values.emplace_back(v[0], v[1], v[2], components == 4 ? v[3] : 0.0f);
+            }
+            channels.push_back(std::move(channel));
+        }
+        std::string name = animation.name.empty() ? "animation_" + std::to_string(i) : animation.name;
+        clips.emplace_back(std::move(name), channels, gltfModel.nodes.size());
+    }
+    return clips;
+}
+
+// Skin index per glTF mesh, taken from the nodes that instance it
+std::vector<int> resolveMeshSkins(const tinygltf::Model& gltfModel) {
+    std::vector<int> meshSkins(gltfModel.meshes.size(), -1);
+    for (const auto& node : gltfModel.nodes) {
+        if (node.mesh >= 0 && node.mesh < static_cast<int>(meshSkins.size()) && node.skin >= 0 &&
+            node.skin < static_cast<int>(gltfModel.skins.size())) {
+            meshSkins[node.mesh] = node.skin;
+        }
+    }
+    return meshSkins;
+}
+
+// Packs JOINTS_0/WEIGHTS_0 into 8-bit joints and 16-bit weights normalized to sum to one
+void readSkinStream(const tinygltf::Model& gltfModel, const tinygltf::Primitive& primitive, size_t vertexCount,
+                    size_t jointCount, std::vector<SkinVertex>& skin) {
+    std::vector<float> joints;
+    std::vector<float> weights;
+    readComponents(gltfModel, gltfModel.accessors[primitive.attributes.at("JOINTS_0")], 4, joints);
+    readComponents(gltfModel, gltfModel.accessors[primitive.attributes.at("WEIGHTS_0")], 4, weights);
+    if (joints.size() < vertexCount * 4 || weights.size() < vertexCount * 4)
+        throw std::runtime_error("Skinned primitive has fewer joints or weights than vertices");
+
+    skin.resize(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v) {
+        SkinVertex& out = skin[v];
+        float sum = 0.0f;
+        for (int i = 0; i < 4; ++i) sum += std::max(weights[v * 4 + i], 0.0f);
+
+        int heaviest = 0;
+        uint32_t total = 0;
+        for (int i = 0; i < 4; ++i) {
+            auto joint = static_cast<size_t>(joints[v * 4 + i]);
+            if (joint >= jointCount) throw std::runtime_error("Skinned primitive references a missing joint");
+            out.joints[i] = static_cast<uint8_t>(joint);
+            float weight = sum > 0.0f ? std::max(weights[v * 4 + i], 0.0f) / sum : (i == 0 ? 1.0f : 0.0f);
+            out.weights[i] = static_cast<uint16_t>(std::lround(weight * 65535.0f));
+            total += out.weights[i];
+            if (out.weights[i] > out.weights[heaviest]) heaviest = i;
+        }
+        // Put the rounding error on the heaviest influence so weights sum to exactly one
+        out.weights[heaviest] = static_cast<uint16_t>(static_cast<int>(out.weights[heaviest]) + 65535 - static_cast<int>(total));
+    }
+}
+
+// Distance from each joint to the furthest bind pose vertex it influences
+void accumulateJointRadii(const MeshData& cooked, Skin& skin) {
+    std::vector<glm::vec3> jointPositions(skin.joints.size());
+    for (size_t j = 0; j < skin.joints.size(); ++j) {
+        jointPositions[j] = glm::vec3(glm::inverse(skin.inverseBindMatrices[j])[3]);
+    }
+    for (size_t v = 0; v < cooked.skin.size(); ++v) {
+        const float* vertex = &cooked.vertices[v * Mesh::kVertexFloats];
+        glm::vec3 position(vertex[0], vertex[1], vertex[2]);
+        for (int i = 0; i < 4; ++i) {
+            if (cooked.skin[v].weights[i] == 0) continue;
+            uint8_t joint = cooked.skin[v].joints[i];
+            skin.jointRadius[joint] = std::max(skin.jointRadius[joint], glm::length(position - jointPositions[joint]));
+        }
+    }
+}
+
+// Converts a primitive to the interleaved vertex layout of Mesh with occlusion set to 1,
+// plus the skin stream when `skin` is given and the packed position stream of static
+// primitives when `positionStream` is set. Returns false for primitives without usable
+// float3 positions.
+bool cookPrimitive(const tinygltf::Model& gltfModel, const tinygltf::Primitive& primitive, const Skin* skin,
+                   bool positionStream, MeshData& cooked) {
     auto posIt = primitive.attributes.find("POSITION");
-    if (posIt == primitive.attributes.end()) return nullptr;
+    if (posIt == primitive.attributes.end()) return false;
 
     const auto& posAccessor = gltfModel.accessors[posIt->second];
     if (posAccessor.componentType != TINYGLTF_COMPONENT_TYPE_FLOAT || posAccessor.type != TINYGLTF_TYPE_VEC3)
-        return nullptr;
+        return false;
     if (posAccessor.bufferView < 0 || posAccessor.bufferView >= static_cast<int>(gltfModel.bufferViews.size()))
-        return nullptr;
+        return false;
     const size_t vertexCount = posAccessor.count;
 
     std::vector<float> positions;
@@ -232,10 +516,15 @@ std::unique_ptr<Mesh> buildMeshFromPrimitive(const tinygltf::Model& gltfModel,
         readStridedVec(gltfModel, tAccessor, 2, texCoords);
     }
 
-    std::vector<float> vertices;
-    vertices.reserve(vertexCount * 8);  // 3 pos + 3 normal + 2 tex
+    const bool skinned = skin && primitive.attributes.count("JOINTS_0") && primitive.attributes.count("WEIGHTS_0");
+    std::vector<float>& vertices = cooked.vertices;
+    vertices.reserve(vertexCount * Mesh::kVertexFloats);  // 3 pos + 3 normal + 2 tex + 1 occlusion
+    // Skinned vertices move in the vertex shader, the depth-only layout cannot place them
+    const bool packPositions = positionStream && !skinned;
+    std::vector<float>& packed = cooked.positions;
+    if (packPositions) packed.reserve(vertexCount * 3);
 
-    AABB aabb;
+    AABB& aabb = cooked.aabb;
     if (vertexCount > 0 && positions.size() >= 3) {
         aabb.min = aabb.max = glm::vec3(positions[0], positions[1], positions[2]);
     }
@@ -248,6 +537,11 @@ std::unique_ptr<Mesh> buildMeshFromPrimitive(const tinygltf::Model& gltfModel,
         vertices.push_back(pos.x);
         vertices.push_back(pos.y);
         vertices.push_back(pos.z);
+        if (packPositions) {
+            packed.push_back(pos.x);
+            packed.push_back(pos.y);
+            packed.push_back(pos.z);
+        }
 
         if (i > 0) {
             aabb.min = glm::min(aabb.min, pos);
@@ -273,53 +567,229 @@ std::unique_ptr<Mesh> buildMeshFromPrimitive(const tinygltf::Model& gltfModel,
             vertices.push_back(0.0f);
             vertices.push_back(0.0f);
         }
+
+        // Occlusion, filled in by the optional bake
+        vertices.push_back(1.0f);
+    }
+
+    cooked.indices = readIndices(gltfModel, primitive, vertexCount);
+    if (skinned) {
+        readSkinStream(gltfModel, primitive, vertexCount, skin->joints.size(), cooked.skin);
     }
+    return true;
+}
 
-    auto indices = readIndices(gltfModel, primitive, vertexCount);
+// Bakes occlusion over all primitives of a model at once, so they shadow each other
+void bakeModelOcclusion(const std::string& path, std::vector<MeshData>& meshes,
+                        const VertexOcclusionSettings& settings) {
+    size_t vertexCount = 0;
+    for (const auto& mesh : meshes) vertexCount += mesh.vertices.size() / Mesh::kVertexFloats;
+    if (vertexCount == 0) return;
+
+    std::string key = VertexOcclusionCache::makeKey(meshes, settings);
+    std::vector<float> occlusion;
+    if (!VertexOcclusionCache::load(key, vertexCount, occlusion)) {
+        std::vector<glm::vec3> positions;
+        std::vector<glm::vec3> normals;
+        std::vector<uint32_t> indices;
+        positions.reserve(vertexCount);
+        normals.reserve(vertexCount);
+        for (const auto& mesh : meshes) {
+            auto base = static_cast<uint32_t>(positions.size());
+            for (size_t v = 0; v + Mesh::kVertexFloats <= mesh.vertices.size(); v += Mesh::kVertexFloats) {
+                const float* vertex = &mesh.vertices[v];
+                positions.emplace_back(vertex[0], vertex[1], vertex[2]);
+                normals.emplace_back(vertex[3], vertex[4], vertex[5]);
+            }
+            for (unsigned int index : mesh.indices) indices.push_back(base + index);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        occlusion = bakeVertexOcclusion(positions, normals, indices, settings);
+        float ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "Baked vertex AO for '" << path << "': " << vertexCount << " vertices in " << ms << " ms"
+                  << std::endl;
+        VertexOcclusionCache::store(key, occlusion);
+    }
+
+    size_t next = 0;
+    for (auto& mesh : meshes) {
+        for (size_t v = Mesh::kOcclusionOffset; v < mesh.vertices.size(); v += Mesh::kVertexFloats) {
+            mesh.vertices[v] = occlusion[next++];
+        }
+    }
+}
 
-    return std::make_unique<Mesh>(vertices.data(), vertices.size() * sizeof(float),
-                                  indices.data(), indices.size(), aabb);
+std::unique_ptr<Mesh> buildMesh(MeshData& cooked, const std::vector<Meshlet>& meshlets) {
+    auto mesh = std::make_unique<Mesh>(cooked.vertices.data(), cooked.vertices.size() * sizeof(float),
+                                       cooked.indices.data(), cooked.indices.size(), cooked.aabb);
+    if (!cooked.skin.empty()) {
+        mesh->setSkin(cooked.skin);
+    } else if (!meshlets.empty()) {
+        mesh->setMeshlets(meshlets);
+    }
+    if (!cooked.positions.empty()) {
+        mesh->setPositionStream(cooked.positions);
+    }
+    return mesh;
 }
 
-MaterialHandle resolveMaterial(const tinygltf::Primitive& primitive,
-                               const std::vector<MaterialHandle>& materials,
-                               const MaterialHandle& fallback) {
-    if (primitive.material >= 0 && primitive.material < static_cast<int>(materials.size()))
-        return materials[primitive.material];
-    return fallback;
 }
 
+size_t Model::s_MeshletMinTriangles = 0;
+bool Model::s_VertexOcclusion = false;
+VertexOcclusionSettings Model::s_VertexOcclusionSettings;
+float Model::s_VertexAnimationFrameRate = 0.0f;
+bool Model::s_PositionStreams = false;
+bool Model::s_RetainMeshData = false;
+
+void Model::setVertexOcclusion(bool enabled, const VertexOcclusionSettings& settings) {
+    s_VertexOcclusion = enabled;
+    s_VertexOcclusionSettings = settings;
 }
 
 Model::Model(const std::string& gltfPath, const std::string& shaderPath, AssetManager& assetManager)
-    : Asset(gltfPath) {
+    : Model(cook(gltfPath), shaderPath, assetManager, false) {
+    while (uploadNext()) {
+    }
+}
+
+Model::Model(ModelSource source, const std::string& shaderPath, AssetManager& assetManager, bool asyncTextures)
+    : Asset(source.path), m_Source(std::make_unique<ModelSource>(std::move(source))), m_AssetManager(&assetManager) {
+    m_SourceTextures = resolveTextures(m_Source->textures, m_Path, assetManager, asyncTextures);
+    m_SourceShader = assetManager.getOrLoadShader(shaderPath);
+    m_DefaultMaterial = createDefaultMaterial(m_Path + "#default", assetManager, m_SourceShader);
+    m_SourceMaterials.reserve(m_Source->materials.size());
+
+    m_Bounds = m_Source->bounds;
+    m_Skeleton = std::move(m_Source->skeleton);
+    m_Skins = std::move(m_Source->skins);
+    m_Animations = std::move(m_Source->animations);
+    m_SubMeshes.reserve(m_Source->meshes.size());
+}
+
+ModelSource Model::cook(const std::string& gltfPath) {
     try {
+        ModelSource source;
+        source.path = gltfPath;
         tinygltf::Model gltfModel = loadGltfModel(gltfPath);
-        std::string gltfDir = getDirectory(gltfPath);
-
-        auto gltfTextures = loadGltfTextures(gltfModel, gltfDir, assetManager);
-        auto shader = assetManager.getOrLoadShader(shaderPath);
-        auto defaultMaterial = createDefaultMaterial(m_Path + "#default", assetManager, shader);
-        auto gltfMaterials = buildMaterials(gltfModel, assetManager, shader, gltfTextures);
+        source.textures = readTextures(gltfModel, getDirectory(gltfPath));
+        source.materials = readMaterials(gltfModel);
 
         size_t totalPrimitives = 0;
         for (const auto& mesh : gltfModel.meshes) totalPrimitives += mesh.primitives.size();
-        m_SubMeshes.reserve(totalPrimitives);
-
-        for (const auto& mesh : gltfModel.meshes) {
-            for (const auto& primitive : mesh.primitives) {
-                auto meshPtr = buildMeshFromPrimitive(gltfModel, primitive);
-                if (!meshPtr) continue;
-                auto mat = resolveMaterial(primitive, gltfMaterials, defaultMaterial);
-                m_SubMeshes.push_back({std::move(meshPtr), mat});
+
+        source.skeleton = readSkeleton(gltfModel);
+        source.skins = readSkins(gltfModel);
+        source.animations = readAnimations(gltfModel);
+        auto meshSkins = resolveMeshSkins(gltfModel);
+
+        std::vector<MeshData>& cooked = source.meshes;
+        cooked.reserve(totalPrimitives);
+        source.meshMaterials.reserve(totalPrimitives);
+        source.meshSkins.reserve(totalPrimitives);
+        for (size_t m = 0; m < gltfModel.meshes.size(); ++m) {
+            const Skin* skin = meshSkins[m] >= 0 ? &source.skins[meshSkins[m]] : nullptr;
+            for (const auto& primitive : gltfModel.meshes[m].primitives) {
+                MeshData data;
+                if (!cookPrimitive(gltfModel, primitive, skin, s_PositionStreams, data)) continue;
+                if (!data.skin.empty()) accumulateJointRadii(data, source.skins[meshSkins[m]]);
+                source.meshSkins.push_back(data.skin.empty() ? -1 : meshSkins[m]);
+                cooked.push_back(std::move(data));
+                bool hasMaterial = primitive.material >= 0 &&
+                                   primitive.material < static_cast<int>(source.materials.size());
+                source.meshMaterials.push_back(hasMaterial ? primitive.material : -1);
+            }
+        }
+
+        if (s_VertexOcclusion) {
+            bakeModelOcclusion(gltfPath, cooked, s_VertexOcclusionSettings);
+        }
+
+        for (size_t i = 0; i < cooked.size(); ++i) {
+            source.bounds.min = i == 0 ? cooked[i].aabb.min : glm::min(source.bounds.min, cooked[i].aabb.min);
+            source.bounds.max = i == 0 ? cooked[i].aabb.max : glm::max(source.bounds.max, cooked[i].aabb.max);
+        }
+
+        // Meshlet bounds and cones only hold for the bind pose, so skinned meshes skip them
+        source.meshlets.resize(cooked.size());
+        for (size_t i = 0; i < cooked.size(); ++i) {
+            if (cooked[i].skin.empty() && s_MeshletMinTriangles > 0 &&
+                cooked[i].indices.size() / 3 >= s_MeshletMinTriangles) {
+                source.meshlets[i] = buildMeshlets(cooked[i].vertices.data(), cooked[i].vertices.size() / Mesh::kVertexFloats,
+                                                   Mesh::kVertexFloats, cooked[i].indices);
+            }
+        }
+
+        bool bakeAnimation = s_VertexAnimationFrameRate > 0.0f && !source.animations.empty();
+        auto bakeStart = std::chrono::steady_clock::now();
+        size_t bakedFrames = 0;
+        source.vertexAnimations.resize(cooked.size());
+        for (size_t i = 0; i < cooked.size(); ++i) {
+            if (bakeAnimation && source.meshSkins[i] >= 0) {
+                VertexAnimationData& animation = source.vertexAnimations[i];
+                animation = bakeVertexAnimation(cooked[i], source.skeleton, source.skins[source.meshSkins[i]],
+                                                source.animations, s_VertexAnimationFrameRate);
+                bakedFrames = animation.positions.size() / animation.vertexCount;
             }
         }
+        if (bakedFrames > 0) {
+            float ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - bakeStart).count();
+            std::cout << "Baked vertex animation for '" << gltfPath << "': " << source.animations.size() << " clips, "
+                      << bakedFrames << " frames in " << ms << " ms" << std::endl;
+        }
+        return source;
     } catch (const std::exception& e) {
         std::cerr << "Error loading model '" << gltfPath << "': " << e.what() << std::endl;
         throw;
     }
 }
 
+bool Model::uploadNext() {
+    if (!m_Source) {
+        return false;
+    }
+    // Materials first, each one prepares its shader variants
+    size_t material = m_SourceMaterials.size();
+    if (material < m_Source->materials.size()) {
+        m_SourceMaterials.push_back(
+            buildMaterial(m_Source->materials[material], *m_AssetManager, m_SourceShader, m_SourceTextures));
+        return true;
+    }
+    size_t i = m_SubMeshes.size();
+    if (i < m_Source->meshes.size()) {
+        auto mesh = buildMesh(m_Source->meshes[i], m_Source->meshlets[i]);
+        if (m_Source->vertexAnimations[i].vertexCount > 0) {
+            mesh->setVertexAnimation(m_Source->vertexAnimations[i]);
+        }
+        std::shared_ptr<const MeshData> data;
+        MeshData& cooked = m_Source->meshes[i];
+        if (s_RetainMeshData && cooked.skin.empty()) {
+            auto retained = std::make_shared<MeshData>();
+            retained->vertices = std::move(cooked.vertices);
+            retained->indices = std::move(cooked.indices);
+            retained->aabb = cooked.aabb;
+            data = std::move(retained);
+        }
+        int meshMaterial = m_Source->meshMaterials[i];
+        const MaterialHandle& handle = meshMaterial >= 0 ? m_SourceMaterials[meshMaterial] : m_DefaultMaterial;
+        m_SubMeshes.push_back({std::move(mesh), handle, m_Source->meshSkins[i], std::move(data)});
+        // The GL copies are all that is needed from here on
+        m_Source->meshes[i] = MeshData();
+        m_Source->meshlets[i] = std::vector<Meshlet>();
+        m_Source->vertexAnimations[i] = VertexAnimationData();
+    }
+    if (m_SubMeshes.size() < m_Source->meshes.size()) {
+        return true;
+    }
+    m_Source.reset();
+    m_SourceTextures.clear();
+    m_SourceMaterials.clear();
+    m_DefaultMaterial = MaterialHandle();
+    m_SourceShader = ShaderHandle();
+    return false;
+}
+
 std::string Model::getDirectory(const std::string& filepath) {
     size_t lastSlash = filepath.find_last_of("/\\");
     return (lastSlash == std::string::npos) ? "." : filepath.substr(0, lastSlash);
@@ -4,28 +4,122 @@
 #include <string>
 #include <vector>
 
+#include "AnimationClip.h"
 #include "Asset.h"
 #include "Material.h"
+#include "Skeleton.h"
+#include "Texture.h"
+#include "bake/VertexOcclusion.h"
 #include "rendering/Mesh.h"
+#include "rendering/Meshlets.h"
+#include "rendering/VertexAnimation.h"
 
 class AssetManager;
 
 struct SubMesh {
     std::unique_ptr<Mesh> mesh;
     MaterialHandle material;
+    int skin = -1;  // Index into Model::getSkins() for skinned meshes
+    // Cooked vertices and indices of static submeshes, kept when Model::setRetainMeshData is on
+    std::shared_ptr<const MeshData> data;
+};
+
+// A glTF image: an external file left to the asset manager, or embedded pixels already decoded
+struct ModelTextureSource {
+    std::string path;  // Empty for embedded images
+    TextureData data;
+};
+
+struct ModelMaterialSource {
+    std::string name;
+    // Indices into ModelSource::textures, -1 when unused
+    int baseColor = -1;
+    int metallicRoughness = -1;
+    int normal = -1;
+    int emissive = -1;
+    int occlusion = -1;
+    MaterialParams params;
+    RenderState state;
+};
+
+// Everything a model holds short of GL objects: parsed, cooked and baked by Model::cook
+struct ModelSource {
+    std::string path;
+    std::vector<ModelTextureSource> textures;
+    std::vector<ModelMaterialSource> materials;
+    Skeleton skeleton;
+    std::vector<Skin> skins;
+    std::vector<AnimationClip> animations;
+    // One entry per submesh
+    std::vector<MeshData> meshes;
+    AABB bounds{glm::vec3(0.0f), glm::vec3(0.0f)};  // Union of the submesh bounds
+    std::vector<int> meshMaterials;  // Index into materials, -1 for the default material
+    std::vector<int> meshSkins;
+    std::vector<std::vector<Meshlet>> meshlets;  // Empty below the meshlet threshold
+    std::vector<VertexAnimationData> vertexAnimations;  // vertexCount 0 unless baked
 };
 
 class Model : public Asset {
    public:
+    // Loads the whole model before returning
     Model(const std::string& gltfPath,
           const std::string& shaderPath,
           AssetManager& assetManager);
+    // GL half of a load: resolves textures, through asynchronous texture loads when
+    // `asyncTextures` is set, and leaves the materials and submeshes to uploadNext()
+    Model(ModelSource source, const std::string& shaderPath, AssetManager& assetManager, bool asyncTextures);
+
+    // CPU half of a load, safe on any thread once the static settings below are in place
+    static ModelSource cook(const std::string& gltfPath);
+    // Creates the next material, or once they all exist the GL objects of the next submesh;
+    // returns true while more remain
+    bool uploadNext();
+
+    // Primitives with at least this many triangles are split into meshlets at import, 0 disables
+    static void setMeshletMinTriangles(size_t triangles) { s_MeshletMinTriangles = triangles; }
+    static size_t getMeshletMinTriangles() { return s_MeshletMinTriangles; }
+    // Bake per-vertex ambient occlusion at import, cached through VertexOcclusionCache
+    static void setVertexOcclusion(bool enabled, const VertexOcclusionSettings& settings);
+    // Bake the clips of skinned primitives into vertex animation textures at this many frames
+    // per second at import, 0 disables
+    static void setVertexAnimationFrameRate(float framesPerSecond) { s_VertexAnimationFrameRate = framesPerSecond; }
+    // Cook a packed position stream next to the interleaved vertices of static primitives, so
+    // depth-only passes fetch 12 bytes per vertex
+    static void setPositionStreams(bool enabled) { s_PositionStreams = enabled; }
+    static bool getPositionStreams() { return s_PositionStreams; }
+    // Keep a CPU copy of every static submesh next to its GL mesh for build-time passes such
+    // as static batching, which would otherwise have to read the buffers back from the GPU
+    static void setRetainMeshData(bool enabled) { s_RetainMeshData = enabled; }
 
+    // Submeshes uploadNext() has created so far, all of them once the model is loaded
     const std::vector<SubMesh>& getSubMeshes() const { return m_SubMeshes; }
+    // Model-space bounds of every submesh from cook(), known before any of them is uploaded,
+    // so a model that is still streaming in can be placed or stood in for
+    const AABB& getBounds() const { return m_Bounds; }
+    const Skeleton& getSkeleton() const { return m_Skeleton; }
+    const std::vector<Skin>& getSkins() const { return m_Skins; }
+    const std::vector<AnimationClip>& getAnimations() const { return m_Animations; }
     const std::string& getPath() const override { return m_Path; }
 
    private:
     static std::string getDirectory(const std::string& filepath);
 
     std::vector<SubMesh> m_SubMeshes;
+    AABB m_Bounds{glm::vec3(0.0f), glm::vec3(0.0f)};
+    // Cooked data, textures and materials of what uploadNext() has not created yet
+    std::unique_ptr<ModelSource> m_Source;
+    AssetManager* m_AssetManager = nullptr;
+    ShaderHandle m_SourceShader;
+    std::vector<TextureHandle> m_SourceTextures;
+    std::vector<MaterialHandle> m_SourceMaterials;  // One per ModelSource::materials entry
+    MaterialHandle m_DefaultMaterial;
+    Skeleton m_Skeleton;
+    std::vector<Skin> m_Skins;
+    std::vector<AnimationClip> m_Animations;
+    static size_t s_MeshletMinTriangles;
+    static bool s_VertexOcclusion;
+    static VertexOcclusionSettings s_VertexOcclusionSettings;
+    static float s_VertexAnimationFrameRate;
+    static bool s_PositionStreams;
+    static bool s_RetainMeshData;
 };
\ No newline at end of file
@@ -0,0 +1,163 @@
+#include "ProgramBinaryCache.h"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include "core/FileUtils.h"
+
+std::string ProgramBinaryCache::s_Directory;
+std::string ProgramBinaryCache::s_DriverId;
+
+namespace {
+const uint32_t kMagic = 0x42505345;  // "ESPB"
+// Bumped whenever the entry layout changes
+const uint32_t kVersion = 2;
+
+struct EntryHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t format;
+    uint32_t length;
+};
+
+uint64_t fnv1a(const std::string& data, uint64_t hash = 1469598103934665603ull) {
+    for (unsigned char c : data) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+std::string glString(GLenum name) {
+    const GLubyte* value = glGetString(name);
+    return value ? reinterpret_cast<const char*>(value) : "";
+}
+
+bool isSupportedFormat(GLenum format) {
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &count);
+    if (count <= 0) {
+        return false;
+    }
+    std::vector<GLint> formats(static_cast<size_t>(count));
+    glGetIntegerv(GL_PROGRAM_BINARY_FORMATS, formats.data());
+    return std::find(formats.begin(), formats.end(), static_cast<GLint>(format)) != formats.end();
+}
+}
+
+void ProgramBinaryCache::setDirectory(const std::string& directory) {
+    s_Directory = directory;
+    if (s_Directory.empty()) {
+        return;
+    }
+
+    GLint formatCount = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+    if (formatCount <= 0) {
+        std::cerr << "Shader cache: driver exposes no program binary formats, cache disabled" << std::endl;
+        s_Directory.clear();
+        return;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(s_Directory, error);
+    if (error) {
+        std::cerr << "Shader cache: failed to create " << s_Directory << ", cache disabled" << std::endl;
+        s_Directory.clear();
+        return;
+    }
+    s_DriverId = glString(GL_VENDOR) + "|" + glString(GL_RENDERER) + "|" + glString(GL_VERSION);
+}
+
+bool ProgramBinaryCache::isEnabled() {
+    return !s_Directory.empty();
+}
+
+std::string ProgramBinaryCache::makeKey(const std::string& sources) {
+    uint64_t hash = fnv1a(sources, fnv1a(s_DriverId));
+    char buffer[17];
+    std::snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(hash));
+    return buffer;
+}
+
+std::string ProgramBinaryCache::entryPath(const std::string& key) {
+    return (std::filesystem::path(s_Directory) / (key + ".bin")).string();
+}
+
+unsigned int ProgramBinaryCache::load(const std::string& key, bool& rejected) {
+    rejected = false;
+    if (!isEnabled()) {
+        return 0;
+    }
+
+    std::string path = entryPath(key);
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return 0;
+    }
+    auto fileSize = static_cast<uint64_t>(file.tellg());
+    file.seekg(0);
+
+    // The header is trusted only once it matches this build and the file length, so a
+    // truncated or foreign entry never sizes an allocation
+    EntryHeader header{};
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    bool valid = file && header.magic == kMagic && header.version == kVersion && header.length > 0 &&
+                 fileSize == sizeof(header) + static_cast<uint64_t>(header.length);
+    std::vector<char> binary;
+    if (valid) {
+        binary.resize(header.length);
+        file.read(binary.data(), static_cast<std::streamsize>(binary.size()));
+        valid = file && isSupportedFormat(header.format);
+    }
+    file.close();
+
+    GLuint program = 0;
+    if (valid) {
+        program = glCreateProgram();
+        glProgramBinary(program, header.format, binary.data(), static_cast<GLsizei>(binary.size()));
+        GLint linked = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        if (!linked) {
+            glDeleteProgram(program);
+            program = 0;
+        }
+    }
+
+    if (program == 0) {
+        rejected = true;
+        std::error_code error;
+        std::filesystem::remove(path, error);
+    }
+    return program;
+}
+
+void ProgramBinaryCache::store(const std::string& key, unsigned int program) {
+    if (!isEnabled()) {
+        return;
+    }
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return;
+    }
+
+    std::vector<char> binary(static_cast<size_t>(length));
+    GLenum format = 0;
+    GLsizei written = 0;
+    glGetProgramBinary(program, length, &written, &format, binary.data());
+    if (written <= 0) {
+        return;
+    }
+
+    EntryHeader header{kMagic, kVersion, format, static_cast<uint32_t>(written)};
+    writeFileAtomic(entryPath(key), {{&header, sizeof(header)}, {binary.data(), static_cast<size_t>(written)}});
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <string>
+
+// On-disk cache of linked GL program binaries. Entries are keyed by a hash of every stage
+// source, the injected defines and the driver vendor/renderer/version strings, so a driver
+// update or a shader edit simply misses the cache. A binary the driver rejects is deleted
+// and the caller falls back to compiling from source.
+class ProgramBinaryCache {
+   public:
+    // An empty directory disables the cache
+    static void setDirectory(const std::string& directory);
+    static bool isEnabled();
+
+    // `sources` is the concatenated stage sources and defines of one program
+    static std::string makeKey(const std::string& sources);
+
+    // Returns a linked program, or 0 on a miss or when the driver rejects the binary
+    static unsigned int load(const std::string& key, bool& rejected);
+    // The program must have been linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT set
+    static void store(const std::string& key, unsigned int program);
+
+   private:
+    static std::string entryPath(const std::string& key);
+
+    static std::string s_Directory;
+    static std::string s_DriverId;
+};
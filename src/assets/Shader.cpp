@@ -2,10 +2,21 @@
 
 #include <glad/glad.h>
 
+#include <algorithm>
+#include <filesystem>
 #include <fstream>
+#include <iostream>
 #include <sstream>
 #include <stdexcept>
 
+#include "ProgramBinaryCache.h"
+#include "core/Timer.h"
+#include "rendering/GlExtensions.h"
+
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
 static std::string loadFile(const std::string& path) {
     std::ifstream file(path);
     if (!file.is_open()) {
@@ -36,47 +47,337 @@ static void checkProgramLinking(unsigned int program) {
     }
 }
 
+static const char* stageName(unsigned int type) {
+    switch (type) {
+        case GL_VERTEX_SHADER:
+            return "VERTEX";
+        case GL_FRAGMENT_SHADER:
+            return "FRAGMENT";
+        case GL_COMPUTE_SHADER:
+            return "COMPUTE";
+        default:
+            return "UNKNOWN";
+    }
+}
+
+// Issues the compile without querying its status, so drivers with parallel compilation can
+// run it on their own threads
+static unsigned int compileStage(unsigned int type, const std::string& source) {
+    const char* src = source.c_str();
+    unsigned int stage = glCreateShader(type);
+    glShaderSource(stage, 1, &src, nullptr);
+    glCompileShader(stage);
+    return stage;
+}
+
+Shader::LoadStats Shader::s_LoadStats;
+bool Shader::s_ParallelCompile = false;
+unsigned int Shader::s_PendingPrograms = 0;
+double Shader::s_WaitMs = 0.0;
+
+void Shader::setBinaryCacheDirectory(const std::string& directory) {
+    ProgramBinaryCache::setDirectory(directory);
+}
+
+void Shader::enableParallelCompile(bool enabled) {
+    s_ParallelCompile = enabled && GlExtensions::maxShaderCompilerThreads != nullptr;
+    if (s_ParallelCompile) {
+        GlExtensions::maxShaderCompilerThreads(0xFFFFFFFFu);  // Let the driver pick the thread count
+    }
+}
+
+double Shader::consumeWaitMs() {
+    double waitMs = s_WaitMs;
+    s_WaitMs = 0.0;
+    return waitMs;
+}
+
 Shader::Shader(const std::string& shaderPath)
     : Asset(shaderPath), m_Path(shaderPath) {
-    std::string vSrc = loadFile(shaderPath + ".vert");
-    std::string fSrc = loadFile(shaderPath + ".frag");
+    if (std::filesystem::exists(shaderPath + ".comp")) {
+        m_Stages = {{GL_COMPUTE_SHADER, loadFile(shaderPath + ".comp")}};
+    } else {
+        m_Stages = {{GL_VERTEX_SHADER, loadFile(shaderPath + ".vert")},
+                    {GL_FRAGMENT_SHADER, loadFile(shaderPath + ".frag")}};
+    }
+    // The base variant is built eagerly so source errors surface at load time and every
+    // shader has a fallback while other variants compile
+    m_Active = &getReadyVariant(ShaderFeature::None);
+}
+
+Shader::Shader(const std::string& vertexPath, const std::string& fragmentPath)
+    : Asset(vertexPath + "|" + fragmentPath), m_Path(vertexPath + "|" + fragmentPath) {
+    m_Stages = {{GL_VERTEX_SHADER, loadFile(vertexPath)},
+                {GL_FRAGMENT_SHADER, loadFile(fragmentPath)}};
+    m_Active = &getReadyVariant(ShaderFeature::None);
+}
+
+static const std::pair<uint32_t, const char*> kDefines[] = {
+    {ShaderFeature::HasTexture, "HAS_TEXTURE"},
+    {ShaderFeature::AlphaMask, "ALPHA_MASK"},
+    {ShaderFeature::OitBlend, "OIT_BLEND"},
+    {ShaderFeature::PointLights, "POINT_LIGHTS"},
+    {ShaderFeature::DebugView, "DEBUG_VIEW"},
+    {ShaderFeature::ProbeVolume, "PROBE_VOLUME"},
+    {ShaderFeature::Skinned, "SKINNED"},
+    {ShaderFeature::VertexAnimation, "VERTEX_ANIMATION"},
+    {ShaderFeature::VisibilityResolve, "VISIBILITY_RESOLVE"},
+};
+
+// Defines of a variant for error messages, e.g. "HAS_TEXTURE ALPHA_MASK"
+static std::string describeVariant(uint32_t features) {
+    std::string names;
+    for (const auto& [bit, name] : kDefines) {
+        if (features & bit) {
+            names += names.empty() ? name : std::string(" ") + name;
+        }
+    }
+    return names.empty() ? "base" : names;
+}
+
+std::string Shader::injectDefines(const std::string& source, uint32_t features) {
+    if (features == ShaderFeature::None) {
+        return source;
+    }
+
+    std::string defines;
+    for (const auto& [bit, name] : kDefines) {
+        if (features & bit) {
+            defines += std::string("#define ") + name + "\n";
+        }
+    }
+
+    // #version must stay the first statement, #line keeps compiler messages on source lines
+    size_t versionPos = source.find("#version");
+    if (versionPos == std::string::npos) {
+        return defines + "#line 1\n" + source;
+    }
+    size_t lineEnd = source.find('\n', versionPos);
+    if (lineEnd == std::string::npos) {
+        return source + "\n" + defines;
+    }
+    size_t versionLine = static_cast<size_t>(std::count(source.begin(), source.begin() + static_cast<std::ptrdiff_t>(lineEnd), '\n')) + 1;
+    return source.substr(0, lineEnd + 1) + defines +
+           "#line " + std::to_string(versionLine + 1) + "\n" + source.substr(lineEnd + 1);
+}
+
+Shader::Program& Shader::requestVariant(uint32_t features) const {
+    auto it = m_Variants.find(features);
+    if (it != m_Variants.end()) {
+        return *it->second;
+    }
+
+    std::vector<Stage> stages = m_Stages;
+    for (auto& stage : stages) {
+        stage.source = injectDefines(stage.source, features);
+    }
+    auto program = beginProgram(stages);
+    Program& result = *program;
+    m_Variants.emplace(features, std::move(program));
+    return result;
+}
+
+Shader::Program& Shader::getReadyVariant(uint32_t features) const {
+    Program& program = requestVariant(features);
+    if (program.state == Program::State::Compiling) {
+        try {
+            finishProgram(program);
+        } catch (const std::exception&) {
+            // Reported below together with the variant, also on later calls
+        }
+    }
+    if (program.state == Program::State::Failed) {
+        throw std::runtime_error("Shader " + m_Path + " variant [" + describeVariant(features) +
+                                 "] failed to build: " + program.error);
+    }
+    return program;
+}
+
+bool Shader::pollVariant(Program& program) const {
+    if (program.state == Program::State::Ready) {
+        return true;
+    }
+
+    // Only the completion status may be queried while the driver is still working on it
+    GLint complete = GL_TRUE;
+    if (s_ParallelCompile) {
+        glGetProgramiv(program.id, GL_COMPLETION_STATUS_KHR, &complete);
+    }
+    if (!complete) {
+        return false;
+    }
+    finishProgram(program);
+    return true;
+}
+
+void Shader::prepareVariant(uint32_t features) const {
+    requestVariant(features);
+}
+
+std::unique_ptr<Shader::Program> Shader::beginProgram(const std::vector<Stage>& stages) {
+    Timer timer;
+    auto program = std::make_unique<Program>();
+
+    if (ProgramBinaryCache::isEnabled()) {
+        std::string sources;
+        for (const auto& stage : stages) {
+            sources += std::to_string(stage.type) + ":" + stage.source + "\n";
+        }
+        program->cacheKey = ProgramBinaryCache::makeKey(sources);
+
+        bool rejected = false;
+        program->id = ProgramBinaryCache::load(program->cacheKey, rejected);
+        if (program->id != 0) {
+            program->state = Program::State::Ready;
+            double elapsed = timer.get_milliseconds();
+            s_LoadStats.fromCache++;
+            s_LoadStats.cacheMs += elapsed;
+            s_WaitMs += elapsed;
+            return program;
+        }
+        if (rejected) {
+            s_LoadStats.rejected++;
+        }
+    }
+
+    for (const auto& stage : stages) {
+        program->stages.push_back(compileStage(stage.type, stage.source));
+    }
+
+    program->id = glCreateProgram();
+    if (!program->cacheKey.empty()) {
+        glProgramParameteri(program->id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+    for (unsigned int id : program->stages) {
+        glAttachShader(program->id, id);
+    }
+    glLinkProgram(program->id);
+    program->state = Program::State::Compiling;
+    s_PendingPrograms++;
+
+    double elapsed = timer.get_milliseconds();
+    s_LoadStats.compileMs += elapsed;
+    s_WaitMs += elapsed;
+    return program;
+}
+
+// Blocks if the driver has not finished yet; errors surface here rather than at begin time
+void Shader::finishProgram(Program& program) {
+    Timer timer;
+    s_PendingPrograms--;
+    std::string error;
+
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program.id, GL_LINK_STATUS, &linked);
+    if (!linked) {
+        for (unsigned int id : program.stages) {
+            GLint type = 0;
+            glGetShaderiv(id, GL_SHADER_TYPE, &type);
+            try {
+                checkShaderCompilation(id, stageName(static_cast<unsigned int>(type)));
+            } catch (const std::exception& e) {
+                error = e.what();
+                break;
+            }
+        }
+        if (error.empty()) {
+            try {
+                checkProgramLinking(program.id);
+            } catch (const std::exception& e) {
+                error = e.what();
+            }
+        }
+    }
+
+    for (unsigned int id : program.stages) {
+        glDetachShader(program.id, id);
+        glDeleteShader(id);
+    }
+    program.stages.clear();
+
+    if (!error.empty()) {
+        program.state = Program::State::Failed;
+        program.error = error;
+        throw std::runtime_error(error);
+    }
 
-    const char* v = vSrc.c_str();
-    const char* f = fSrc.c_str();
+    if (!program.cacheKey.empty()) {
+        ProgramBinaryCache::store(program.cacheKey, program.id);
+    }
+    program.state = Program::State::Ready;
 
-    unsigned int vs = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vs, 1, &v, nullptr);
-    glCompileShader(vs);
-    checkShaderCompilation(vs, "VERTEX");
+    double elapsed = timer.get_milliseconds();
+    s_LoadStats.compiled++;
+    s_LoadStats.compileMs += elapsed;
+    s_WaitMs += elapsed;
+}
 
-    unsigned int fs = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fs, 1, &f, nullptr);
-    glCompileShader(fs);
-    checkShaderCompilation(fs, "FRAGMENT");
+Shader::Program::~Program() {
+    for (unsigned int stage : stages) {
+        glDeleteShader(stage);
+    }
+    glDeleteProgram(id);
+}
 
-    m_ID = glCreateProgram();
-    glAttachShader(m_ID, vs);
-    glAttachShader(m_ID, fs);
-    glLinkProgram(m_ID);
-    checkProgramLinking(m_ID);
+Shader::~Shader() {
+    for (const auto& [features, program] : m_Variants) {
+        if (program->state == Program::State::Compiling) {
+            s_PendingPrograms--;
+        }
+    }
+}
+
+void Shader::bind(uint32_t features) const {
+    m_Active = &getReadyVariant(features);
+    glUseProgram(m_Active->id);
+}
 
-    glDeleteShader(vs);
-    glDeleteShader(fs);
+bool Shader::tryBindVariant(uint32_t features, bool wait) const {
+    Program& program = requestVariant(features);
+    if (program.state == Program::State::Failed) {
+        return false;
+    }
+    try {
+        if (wait && program.state == Program::State::Compiling) {
+            finishProgram(program);
+        } else if (!pollVariant(program)) {
+            return false;
+        }
+    } catch (const std::exception& e) {
+        // The variant stays Failed, so this is only reported once
+        std::cerr << "Shader " << m_Path << " variant [" << describeVariant(features)
+                  << "] failed to build, draws using it are skipped: " << e.what() << std::endl;
+        return false;
+    }
+    m_Active = &program;
+    glUseProgram(program.id);
+    return true;
 }
 
-Shader::~Shader() { glDeleteProgram(m_ID); }
+// A fallback missing a required feature would write the wrong targets or put vertices in the
+// wrong place, so the required variant is waited for rather than dropping down further
+std::optional<uint32_t> Shader::bindAvailable(uint32_t features, uint32_t requiredFeatures) const {
+    if (tryBindVariant(features, false)) {
+        return features;
+    }
+    uint32_t required = features & requiredFeatures;
+    if (tryBindVariant(required, true)) {
+        return required;
+    }
+    return std::nullopt;
+}
 
-void Shader::bind() const { glUseProgram(m_ID); }
 void Shader::unbind() const { glUseProgram(0); }
 
 int Shader::getUniformLocation(const std::string& name) const {
-    auto it = m_UniformLocations.find(name);
-    if (it != m_UniformLocations.end()) {
+    auto& locations = m_Active->uniformLocations;
+    auto it = locations.find(name);
+    if (it != locations.end()) {
         return it->second;
     }
 
-    int loc = glGetUniformLocation(m_ID, name.c_str());
-    m_UniformLocations.emplace(name, loc);
+    int loc = glGetUniformLocation(m_Active->id, name.c_str());
+    locations.emplace(name, loc);
     return loc;
 }
 
@@ -101,11 +402,23 @@ void Shader::setVec3(const std::string& name, const float* value) const {
     }
 }
 
+void Shader::setVec2(const std::string& name, const float* value) const {
+    int loc = getUniformLocation(name);
+    if (loc != -1) {
+        glUniform2fv(loc, 1, value);
+    }
+}
+
 void Shader::setInt(const std::string& name, int value) const {
     int loc = getUniformLocation(name);
     if (loc != -1) glUniform1i(loc, value);
 }
 
+void Shader::setUint(const std::string& name, unsigned int value) const {
+    int loc = getUniformLocation(name);
+    if (loc != -1) glUniform1ui(loc, value);
+}
+
 void Shader::setFloat(const std::string& name, float value) const {
     int loc = getUniformLocation(name);
     if (loc != -1) glUniform1f(loc, value);
@@ -117,18 +430,19 @@ void Shader::setBool(const std::string& name, bool value) const {
 }
 
 void Shader::bindUniformBlock(const std::string& name, unsigned int binding) const {
-    auto it = m_BlockIndices.find(name);
+    auto& blockIndices = m_Active->blockIndices;
+    auto it = blockIndices.find(name);
     unsigned int index = 0;
-    if (it != m_BlockIndices.end()) {
+    if (it != blockIndices.end()) {
         index = it->second;
     } else {
-        index = glGetUniformBlockIndex(m_ID, name.c_str());
-        m_BlockIndices.emplace(name, index);
+        index = glGetUniformBlockIndex(m_Active->id, name.c_str());
+        blockIndices.emplace(name, index);
     }
 
     if (index == GL_INVALID_INDEX) {
         throw std::runtime_error("Uniform block not found: " + name);
     }
 
-    glUniformBlockBinding(m_ID, index, binding);
+    glUniformBlockBinding(m_Active->id, index, binding);
 }
@@ -1,12 +1,58 @@
 #pragma once
+#include <cstdint>
+#include <memory>
+#include <optional>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "Asset.h"
 
+// Compile-time feature bits. Each set bit is injected as a #define after the #version line,
+// so a shader variant only contains the code paths its material needs.
+namespace ShaderFeature {
+enum : uint32_t {
+    None = 0,
+    HasTexture = 1u << 0,   // HAS_TEXTURE
+    AlphaMask = 1u << 1,    // ALPHA_MASK
+    OitBlend = 1u << 2,     // OIT_BLEND
+    PointLights = 1u << 3,  // POINT_LIGHTS
+    DebugView = 1u << 4,    // DEBUG_VIEW
+    ProbeVolume = 1u << 5,  // PROBE_VOLUME
+    Skinned = 1u << 6,      // SKINNED
+    VertexAnimation = 1u << 7,  // VERTEX_ANIMATION
+    VisibilityResolve = 1u << 8,  // VISIBILITY_RESOLVE
+    // Bits a fallback variant must keep: they pick the targets a pass writes and where
+    // vertices end up
+    PassFeatures = OitBlend | DebugView | Skinned | VertexAnimation,
+};
+}
+
 class Shader : public Asset {
    public:
+    // Cold (compiled from source) versus warm (loaded from the binary cache) program loads
+    struct LoadStats {
+        unsigned int compiled = 0;
+        unsigned int fromCache = 0;
+        unsigned int rejected = 0;
+        double compileMs = 0.0;
+        double cacheMs = 0.0;
+    };
+
+    // Needs a current GL context, an empty directory disables the program binary cache
+    static void setBinaryCacheDirectory(const std::string& directory);
+    static const LoadStats& getLoadStats() { return s_LoadStats; }
+    // Uses GL_KHR/ARB_parallel_shader_compile when exposed (see GlExtensions::load);
+    // otherwise variants compile synchronously
+    static void enableParallelCompile(bool enabled);
+    static bool isParallelCompileEnabled() { return s_ParallelCompile; }
+    static unsigned int getPendingPrograms() { return s_PendingPrograms; }
+    // Main-thread time spent compiling, linking or waiting on programs since the last call
+    static double consumeWaitMs();
+
+    // Loads <path>.comp as a compute program if it exists, <path>.vert + <path>.frag otherwise
     Shader(const std::string& shaderPath);
+    Shader(const std::string& vertexPath, const std::string& fragmentPath);
     ~Shader();
 
     Shader(const Shader&) = delete;
@@ -14,13 +60,25 @@ class Shader : public Asset {
     Shader(Shader&&) = delete;
     Shader& operator=(Shader&&) = delete;
 
-    void bind() const;
+    // Binds the variant for `features`, waiting for it to finish compiling. Throws with the
+    // variant's defines and info log if it failed to build, binding nothing; draws that can do
+    // without it use bindAvailable() instead. Uniform setters apply to the variant bound last.
+    void bind(uint32_t features = ShaderFeature::None) const;
+    // Binds the exact variant if ready, else the variant limited to `requiredFeatures`,
+    // waiting for that one if it is still compiling. Returns the features actually bound, or
+    // nothing (and binds nothing) when neither variant builds; failures are logged once.
+    std::optional<uint32_t> bindAvailable(uint32_t features, uint32_t requiredFeatures) const;
     void unbind() const;
+    // Starts compiling a variant ahead of its first draw
+    void prepareVariant(uint32_t features) const;
+    size_t getVariantCount() const { return m_Variants.size(); }
 
     void setMat4(const std::string& name, const float* value) const;
     void setVec4(const std::string& name, const float* value) const;
     void setVec3(const std::string& name, const float* value) const;
+    void setVec2(const std::string& name, const float* value) const;
     void setInt(const std::string& name, int value) const;
+    void setUint(const std::string& name, unsigned int value) const;
     void setFloat(const std::string& name, float value) const;
     void setBool(const std::string& name, bool value) const;
     void bindUniformBlock(const std::string& name, unsigned int binding) const;
@@ -28,10 +86,47 @@ class Shader : public Asset {
     const std::string& getPath() const override { return m_Path; }
 
    private:
+    struct Stage {
+        unsigned int type;
+        std::string source;
+    };
+
+    struct Program {
+        enum class State : uint8_t {
+            Compiling,
+            Ready,
+            Failed
+        };
+
+        ~Program();
+
+        unsigned int id = 0;
+        State state = State::Compiling;
+        std::vector<unsigned int> stages;  // Kept until the link completes
+        std::string cacheKey;
+        std::string error;  // Compile or link log once Failed
+        std::unordered_map<std::string, int> uniformLocations;
+        std::unordered_map<std::string, unsigned int> blockIndices;
+    };
+
+    static std::unique_ptr<Program> beginProgram(const std::vector<Stage>& stages);
+    static void finishProgram(Program& program);
+    static std::string injectDefines(const std::string& source, uint32_t features);
+
+    Program& requestVariant(uint32_t features) const;
+    Program& getReadyVariant(uint32_t features) const;
+    bool pollVariant(Program& program) const;
+    // Binds the variant if it is ready (or finishes it when `wait`), false if it failed
+    bool tryBindVariant(uint32_t features, bool wait) const;
     int getUniformLocation(const std::string& name) const;
 
-    unsigned int m_ID;
+    std::vector<Stage> m_Stages;
     std::string m_Path;
-    mutable std::unordered_map<std::string, int> m_UniformLocations;
-    mutable std::unordered_map<std::string, unsigned int> m_BlockIndices;
+    mutable std::unordered_map<uint32_t, std::unique_ptr<Program>> m_Variants;
+    mutable Program* m_Active = nullptr;
+
+    static LoadStats s_LoadStats;
+    static bool s_ParallelCompile;
+    static unsigned int s_PendingPrograms;
+    static double s_WaitMs;
 };
@@ -0,0 +1,78 @@
+#include "Skeleton.h"
+
+#include <algorithm>
+#include <cmath>
+
+void Skeleton::setNodes(std::vector<SkeletonNode> nodes) {
+    m_Nodes = std::move(nodes);
+
+    // glTF does not order nodes, so sort them by depth once
+    std::vector<int> depth(m_Nodes.size(), 0);
+    for (size_t i = 0; i < m_Nodes.size(); ++i) {
+        int steps = 0;
+        for (int p = m_Nodes[i].parent; p >= 0 && steps <= static_cast<int>(m_Nodes.size()); p = m_Nodes[p].parent) {
+            ++steps;
+        }
+        depth[i] = steps;
+    }
+    m_Order.resize(m_Nodes.size());
+    for (size_t i = 0; i < m_Order.size(); ++i) {
+        m_Order[i] = static_cast<int>(i);
+    }
+    std::stable_sort(m_Order.begin(), m_Order.end(), [&](int a, int b) { return depth[a] < depth[b]; });
+}
+
+void Skeleton::getRestPose(Pose& pose) const {
+    pose.translations.resize(m_Nodes.size());
+    pose.rotations.resize(m_Nodes.size());
+    pose.scales.resize(m_Nodes.size());
+    for (size_t i = 0; i < m_Nodes.size(); ++i) {
+        pose.translations[i] = m_Nodes[i].translation;
+        pose.rotations[i] = m_Nodes[i].rotation;
+        pose.scales[i] = m_Nodes[i].scale;
+    }
+}
+
+void Skeleton::computeGlobals(const Pose& pose, std::vector<glm::mat4>& globals) const {
+    globals.resize(m_Nodes.size());
+    for (int index : m_Order) {
+        // T * R * S without building the three matrices
+        glm::mat4 local = glm::mat4_cast(pose.rotations[index]);
+        local[0] *= pose.scales[index].x;
+        local[1] *= pose.scales[index].y;
+        local[2] *= pose.scales[index].z;
+        local[3] = glm::vec4(pose.translations[index], 1.0f);
+        int parent = m_Nodes[index].parent;
+        globals[index] = parent >= 0 ? globals[parent] * local : local;
+    }
+}
+
+AABB Skeleton::computePalette(const Skin& skin, const std::vector<glm::mat4>& globals, const AABB& restBounds,
+                              std::vector<glm::mat4>& palette) {
+    palette.resize(skin.joints.size());
+    AABB bounds{glm::vec3(0.0f), glm::vec3(0.0f)};
+    bool empty = true;
+    for (size_t j = 0; j < skin.joints.size(); ++j) {
+        const glm::mat4& global = globals[skin.joints[j]];
+        palette[j] = global * skin.inverseBindMatrices[j];
+
+        float radius = j < skin.jointRadius.size() ? skin.jointRadius[j] : 0.0f;
+        if (radius <= 0.0f) {
+            continue;
+        }
+        // Vertices keep their distance to the joint up to the palette matrix scale
+        const glm::mat4& joint = palette[j];
+        float scale = std::max(glm::length(glm::vec3(joint[0])),
+                               std::max(glm::length(glm::vec3(joint[1])), glm::length(glm::vec3(joint[2]))));
+        glm::vec3 center(global[3]);
+        glm::vec3 extent(radius * scale);
+        if (empty) {
+            bounds = {center - extent, center + extent};
+            empty = false;
+        } else {
+            bounds.min = glm::min(bounds.min, center - extent);
+            bounds.max = glm::max(bounds.max, center + extent);
+        }
+    }
+    return empty ? restBounds : bounds;
+}
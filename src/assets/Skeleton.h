@@ -0,0 +1,48 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <vector>
+
+#include "rendering/Mesh.h"
+
+// glTF node hierarchy with its rest pose, shared by every skin and clip of a model
+struct SkeletonNode {
+    int parent = -1;
+    glm::vec3 translation{0.0f};
+    glm::quat rotation{1, 0, 0, 0};
+    glm::vec3 scale{1.0f};
+};
+
+struct Skin {
+    std::vector<int> joints;  // Node index of each joint
+    std::vector<glm::mat4> inverseBindMatrices;
+    // Furthest bind pose vertex influenced by each joint, used to bound the posed mesh
+    std::vector<float> jointRadius;
+};
+
+// Local transform of every node, indexed like Skeleton nodes
+struct Pose {
+    std::vector<glm::vec3> translations;
+    std::vector<glm::quat> rotations;
+    std::vector<glm::vec3> scales;
+};
+
+class Skeleton {
+   public:
+    void setNodes(std::vector<SkeletonNode> nodes);
+    size_t getNodeCount() const { return m_Nodes.size(); }
+
+    void getRestPose(Pose& pose) const;
+    // Model-space transform of every node in `pose`
+    void computeGlobals(const Pose& pose, std::vector<glm::mat4>& globals) const;
+
+    // Joint matrices (global * inverse bind) for the skinning shader. Returns the
+    // model-space bounds of the posed mesh, or `restBounds` when the skin has no radii.
+    static AABB computePalette(const Skin& skin, const std::vector<glm::mat4>& globals, const AABB& restBounds,
+                               std::vector<glm::mat4>& palette);
+
+   private:
+    std::vector<SkeletonNode> m_Nodes;
+    std::vector<int> m_Order;  // Parents before children
+};
@@ -27,66 +27,60 @@ void applyAnisotropy(GLuint textureId) {
 }
 
 Texture::Texture(const std::string& path, bool flipVertically)
+    : Texture(path, decode(path, flipVertically)) {}
+
+Texture::Texture(const uint8_t* data, int width, int height, int channels)
+    : Texture("<memory>", fromMemory(data, width, height, channels)) {}
+
+Texture::Texture(const std::string& path, const TextureData& data)
     : Asset(path) {
-    int width, height, channels;
-    stbi_set_flip_vertically_on_load(flipVertically);
-    unsigned char* data = stbi_load(path.c_str(), &width, &height, &channels, 0);
+    upload(data);
+}
+
+TextureData Texture::decode(const std::string& path, bool flipVertically) {
+    // The flip flag is per thread, so loader threads do not race the main thread; it is reset
+    // afterwards because tinygltf decodes embedded images through the same stbi calls
+    stbi_set_flip_vertically_on_load_thread(flipVertically);
+    TextureData texture;
+    unsigned char* data = stbi_load(path.c_str(), &texture.width, &texture.height, &texture.channels, 0);
+    stbi_set_flip_vertically_on_load_thread(false);
     if (!data) {
         throw std::runtime_error("Failed to load texture: " + path);
     }
+    texture.pixels.assign(data, data + static_cast<size_t>(texture.width) * texture.height * texture.channels);
+    stbi_image_free(data);
+    return texture;
+}
 
-    glCreateTextures(GL_TEXTURE_2D, 1, &m_ID);
-    glTextureParameteri(m_ID, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTextureParameteri(m_ID, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTextureParameteri(m_ID, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTextureParameteri(m_ID, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    applyAnisotropy(m_ID);
+TextureData Texture::fromMemory(const uint8_t* data, int width, int height, int channels) {
+    // Flip image vertically (GLB embedded images are stored top-left, OpenGL expects bottom-left)
+    TextureData texture{width, height, channels, {}};
+    size_t rowSize = static_cast<size_t>(width) * channels;
+    texture.pixels.resize(rowSize * height);
+    for (int y = 0; y < height; ++y) {
+        const uint8_t* source = data + (height - 1 - y) * rowSize;
+        std::copy(source, source + rowSize, texture.pixels.begin() + y * rowSize);
+    }
+    return texture;
+}
 
+void Texture::upload(const TextureData& data) {
     GLenum internalFormat, format;
-    if (channels == 4) {
+    if (data.channels == 4) {
         internalFormat = GL_RGBA8;
         format = GL_RGBA;
-    } else if (channels == 3) {
+    } else if (data.channels == 3) {
         internalFormat = GL_RGB8;
         format = GL_RGB;
-        // Fix pixel alignment for RGB textures
-        // https://stackoverflow.com/questions/71284184/opengl-distorted-texture
-        if (3 * width % 4 == 0) {
-            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
-        } else {
-            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-        }
-    } else if (channels == 2) {
+    } else if (data.channels == 2) {
         internalFormat = GL_RG8;
         format = GL_RG;
-    } else if (channels == 1) {
+    } else if (data.channels == 1) {
         internalFormat = GL_R8;
         format = GL_RED;
     } else {
-        stbi_image_free(data);
-        throw std::runtime_error("Unsupported texture format: " + path + " (" + std::to_string(channels) + " channels)");
-    }
-
-    int mipLevels = calcMipLevels(width, height);
-    glTextureStorage2D(m_ID, mipLevels, internalFormat, width, height);
-    glTextureSubImage2D(m_ID, 0, 0, 0, width, height, format, GL_UNSIGNED_BYTE, data);
-    glGenerateTextureMipmap(m_ID);
-
-    // Reset alignment to default
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
-
-    stbi_image_free(data);
-}
-
-Texture::Texture(const uint8_t* data, int width, int height, int channels)
-    : Asset("<memory>") {
-    // Flip image vertically (GLB embedded images are stored top-left, OpenGL expects bottom-left)
-    size_t rowSize = width * channels;
-    std::vector<uint8_t> flipped(data, data + rowSize * height);
-    for (int y = 0; y < height / 2; ++y) {
-        uint8_t* row1 = &flipped[y * rowSize];
-        uint8_t* row2 = &flipped[(height - 1 - y) * rowSize];
-        for (size_t x = 0; x < rowSize; ++x) std::swap(row1[x], row2[x]);
+        throw std::runtime_error("Unsupported texture format: " + m_Path + " (" + std::to_string(data.channels) +
+                                 " channels)");
     }
 
     glCreateTextures(GL_TEXTURE_2D, 1, &m_ID);
@@ -96,31 +90,15 @@ Texture::Texture(const uint8_t* data, int width, int height, int channels)
     glTextureParameteri(m_ID, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     applyAnisotropy(m_ID);
 
-    GLenum internalFormat, format;
-    if (channels == 4) {
-        internalFormat = GL_RGBA8;
-        format = GL_RGBA;
-    } else if (channels == 3) {
-        internalFormat = GL_RGB8;
-        format = GL_RGB;
-        // Fix pixel alignment for RGB textures
-        if (3 * width % 4 == 0) {
-            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
-        } else {
-            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-        }
-    } else if (channels == 2) {
-        internalFormat = GL_RG8;
-        format = GL_RG;
-    } else if (channels == 1) {
-        internalFormat = GL_R8;
-        format = GL_RED;
-    } else
-        throw std::runtime_error("Unsupported texture format from memory");
+    // Fix pixel alignment for RGB textures
+    // https://stackoverflow.com/questions/71284184/opengl-distorted-texture
+    if (data.channels == 3 && 3 * data.width % 4 != 0) {
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    }
 
-    int mipLevels = calcMipLevels(width, height);
-    glTextureStorage2D(m_ID, mipLevels, internalFormat, width, height);
-    glTextureSubImage2D(m_ID, 0, 0, 0, width, height, format, GL_UNSIGNED_BYTE, flipped.data());
+    int mipLevels = calcMipLevels(data.width, data.height);
+    glTextureStorage2D(m_ID, mipLevels, internalFormat, data.width, data.height);
+    glTextureSubImage2D(m_ID, 0, 0, 0, data.width, data.height, format, GL_UNSIGNED_BYTE, data.pixels.data());
     glGenerateTextureMipmap(m_ID);
 
     // Reset alignment to default
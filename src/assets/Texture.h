@@ -1,15 +1,26 @@
 #pragma once
 #include <string>
 #include <cstdint>
+#include <vector>
 
 #include "Asset.h"
 
+// Decoded 8-bit pixels with rows bottom to top as OpenGL expects; produced on any thread
+struct TextureData {
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    std::vector<uint8_t> pixels;
+};
+
 class Texture : public Asset {
    public:
     // For textures loaded from files with stbi, we default to flipping vertically since OpenGL's texture coordinate system has (0,0) at the bottom left
     Texture(const std::string& path, bool flipVertically = true);
     // For textures created from memory GLB embedded images, we assume they are already in the correct orientation since they are not subject to the same coordinate system mismatch
     Texture(const uint8_t* data, int width, int height, int channels);
+    // Uploads pixels decoded earlier, the GL half of an asynchronous load
+    Texture(const std::string& path, const TextureData& data);
     ~Texture();
     void bind(unsigned int slot = 0) const;
 
@@ -18,8 +29,14 @@ class Texture : public Asset {
     Texture(Texture&&) = delete;
     Texture& operator=(Texture&&) = delete;
 
+    // CPU halves of the constructors above, safe to call from loader threads
+    static TextureData decode(const std::string& path, bool flipVertically = true);
+    static TextureData fromMemory(const uint8_t* data, int width, int height, int channels);
+
     const std::string& getPath() const override { return m_Path; }
 
    private:
+    void upload(const TextureData& data);
+
     unsigned int m_ID;
 };
@@ -0,0 +1,96 @@
+#include "VertexOcclusionCache.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+#include "core/FileUtils.h"
+
+std::string VertexOcclusionCache::s_Directory;
+
+namespace {
+const uint32_t kMagic = 0x4f415345;  // "ESAO"
+const uint32_t kVersion = 1;
+
+struct EntryHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t count;
+};
+
+uint64_t fnv1a(const void* data, size_t size, uint64_t hash) {
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+}
+
+void VertexOcclusionCache::setDirectory(const std::string& directory) {
+    s_Directory = directory;
+    if (s_Directory.empty()) {
+        return;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(s_Directory, error);
+    if (error) {
+        std::cerr << "Vertex AO cache: failed to create " << s_Directory << ", cache disabled" << std::endl;
+        s_Directory.clear();
+    }
+}
+
+bool VertexOcclusionCache::isEnabled() {
+    return !s_Directory.empty();
+}
+
+std::string VertexOcclusionCache::makeKey(const std::vector<MeshData>& meshes, const VertexOcclusionSettings& settings) {
+    uint64_t hash = 1469598103934665603ull;
+    hash = fnv1a(&kVersion, sizeof(kVersion), hash);
+    hash = fnv1a(&settings.samples, sizeof(settings.samples), hash);
+    hash = fnv1a(&settings.radius, sizeof(settings.radius), hash);
+    for (const auto& mesh : meshes) {
+        hash = fnv1a(mesh.vertices.data(), mesh.vertices.size() * sizeof(float), hash);
+        hash = fnv1a(mesh.indices.data(), mesh.indices.size() * sizeof(unsigned int), hash);
+    }
+    char buffer[17];
+    std::snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(hash));
+    return buffer;
+}
+
+std::string VertexOcclusionCache::entryPath(const std::string& key) {
+    return (std::filesystem::path(s_Directory) / (key + ".ao")).string();
+}
+
+bool VertexOcclusionCache::load(const std::string& key, size_t vertexCount, std::vector<float>& occlusion) {
+    if (!isEnabled()) {
+        return false;
+    }
+
+    std::ifstream file(entryPath(key), std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    EntryHeader header{};
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file || header.magic != kMagic || header.version != kVersion || header.count != vertexCount) {
+        return false;
+    }
+    occlusion.resize(vertexCount);
+    file.read(reinterpret_cast<char*>(occlusion.data()), static_cast<std::streamsize>(vertexCount * sizeof(float)));
+    return static_cast<bool>(file);
+}
+
+void VertexOcclusionCache::store(const std::string& key, const std::vector<float>& occlusion) {
+    if (!isEnabled()) {
+        return;
+    }
+
+    EntryHeader header{kMagic, kVersion, occlusion.size()};
+    writeFileAtomic(entryPath(key), {{&header, sizeof(header)}, {occlusion.data(), occlusion.size() * sizeof(float)}});
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "bake/VertexOcclusion.h"
+#include "rendering/Mesh.h"
+
+// On-disk cache of baked per-vertex occlusion, one entry per model. Entries are keyed by a
+// hash of the cooked vertex and index data of every primitive plus the bake settings, so
+// re-exporting the model or changing the settings simply misses the cache.
+class VertexOcclusionCache {
+   public:
+    // An empty directory disables the cache
+    static void setDirectory(const std::string& directory);
+    static bool isEnabled();
+
+    static std::string makeKey(const std::vector<MeshData>& meshes, const VertexOcclusionSettings& settings);
+
+    // Fails on a miss or when the entry does not hold exactly `vertexCount` values
+    static bool load(const std::string& key, size_t vertexCount, std::vector<float>& occlusion);
+    static void store(const std::string& key, const std::vector<float>& occlusion);
+
+   private:
+    static std::string entryPath(const std::string& key);
+
+    static std::string s_Directory;
+};
@@ -0,0 +1,270 @@
+#include "Bvh.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+const int kBins = 12;
+const uint32_t kMaxLeafTriangles = 4;
+const int kStackSize = 64;
+
+struct Bounds {
+    glm::vec3 min{std::numeric_limits<float>::max()};
+    glm::vec3 max{std::numeric_limits<float>::lowest()};
+
+    void grow(const glm::vec3& p) {
+        min = glm::min(min, p);
+        max = glm::max(max, p);
+    }
+    void grow(const Bounds& b) {
+        min = glm::min(min, b.min);
+        max = glm::max(max, b.max);
+    }
+    float area() const {
+        glm::vec3 e = max - min;
+        return e.x < 0.0f ? 0.0f : e.x * e.y + e.y * e.z + e.z * e.x;
+    }
+};
+
+// Slab test; returns the entry distance or +inf on a miss
+float intersectBox(const glm::vec3& origin, const glm::vec3& invDir, float tMax,
+                   const glm::vec3& boxMin, const glm::vec3& boxMax) {
+    glm::vec3 t0 = (boxMin - origin) * invDir;
+    glm::vec3 t1 = (boxMax - origin) * invDir;
+    glm::vec3 tNear = glm::min(t0, t1);
+    glm::vec3 tFar = glm::max(t0, t1);
+    float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+    float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, tMax));
+    return enter <= exit ? enter : std::numeric_limits<float>::infinity();
+}
+}
+
+void Bvh::build(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices) {
+    m_Nodes.clear();
+    m_Triangles.clear();
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0) {
+        return;
+    }
+
+    m_Triangles.reserve(triangleCount);
+    std::vector<glm::vec3> centroids;
+    centroids.reserve(triangleCount);
+    for (size_t i = 0; i < triangleCount; ++i) {
+        const glm::vec3& a = positions[indices[i * 3]];
+        const glm::vec3& b = positions[indices[i * 3 + 1]];
+        const glm::vec3& c = positions[indices[i * 3 + 2]];
+        m_Triangles.push_back({a, b - a, c - a, static_cast<uint32_t>(i)});
+        centroids.push_back((a + b + c) / 3.0f);
+    }
+
+    m_Nodes.reserve(triangleCount * 2);
+    Node root{};
+    root.leftOrFirst = 0;
+    root.count = static_cast<uint32_t>(triangleCount);
+    m_Nodes.push_back(root);
+    updateBounds(m_Nodes[0]);
+    subdivide(0, centroids);
+}
+
+void Bvh::updateBounds(Node& node) const {
+    Bounds bounds;
+    for (uint32_t i = 0; i < node.count; ++i) {
+        const Triangle& tri = m_Triangles[node.leftOrFirst + i];
+        bounds.grow(tri.v0);
+        bounds.grow(tri.v0 + tri.e1);
+        bounds.grow(tri.v0 + tri.e2);
+    }
+    node.min = bounds.min;
+    node.max = bounds.max;
+}
+
+void Bvh::subdivide(uint32_t nodeIndex, std::vector<glm::vec3>& centroids) {
+    Node node = m_Nodes[nodeIndex];
+    if (node.count <= kMaxLeafTriangles) {
+        return;
+    }
+
+    Bounds centroidBounds;
+    for (uint32_t i = 0; i < node.count; ++i) {
+        centroidBounds.grow(centroids[node.leftOrFirst + i]);
+    }
+
+    // Binned SAH over the three axes
+    int bestAxis = -1;
+    int bestSplit = 0;
+    float bestCost = std::numeric_limits<float>::max();
+    for (int axis = 0; axis < 3; ++axis) {
+        float lo = centroidBounds.min[axis];
+        float extent = centroidBounds.max[axis] - lo;
+        if (extent <= 0.0f) {
+            continue;
+        }
+        Bounds bins[kBins];
+        uint32_t counts[kBins] = {};
+        float scale = static_cast<float>(kBins) / extent;
+        for (uint32_t i = 0; i < node.count; ++i) {
+            uint32_t t = node.leftOrFirst + i;
+            int bin = std::min(kBins - 1, static_cast<int>((centroids[t][axis] - lo) * scale));
+            counts[bin]++;
+            const Triangle& tri = m_Triangles[t];
+            bins[bin].grow(tri.v0);
+            bins[bin].grow(tri.v0 + tri.e1);
+            bins[bin].grow(tri.v0 + tri.e2);
+        }
+
+        float leftArea[kBins - 1];
+        uint32_t leftCount[kBins - 1];
+        Bounds left;
+        uint32_t sum = 0;
+        for (int i = 0; i < kBins - 1; ++i) {
+            left.grow(bins[i]);
+            sum += counts[i];
+            leftArea[i] = left.area();
+            leftCount[i] = sum;
+        }
+        Bounds right;
+        sum = 0;
+        for (int i = kBins - 1; i > 0; --i) {
+            right.grow(bins[i]);
+            sum += counts[i];
+            float cost = leftArea[i - 1] * static_cast<float>(leftCount[i - 1]) + right.area() * static_cast<float>(sum);
+            if (cost < bestCost && leftCount[i - 1] > 0 && sum > 0) {
+                bestCost = cost;
+                bestAxis = axis;
+                bestSplit = i;
+            }
+        }
+    }
+
+    Bounds nodeBounds{node.min, node.max};
+    if (bestAxis < 0 || bestCost >= nodeBounds.area() * static_cast<float>(node.count)) {
+        return;  // Splitting does not pay off
+    }
+
+    // Partition triangles (and their centroids) around the chosen bin boundary
+    float lo = centroidBounds.min[bestAxis];
+    float scale = static_cast<float>(kBins) / (centroidBounds.max[bestAxis] - lo);
+    uint32_t i = node.leftOrFirst;
+    uint32_t j = node.leftOrFirst + node.count;
+    while (i < j) {
+        int bin = std::min(kBins - 1, static_cast<int>((centroids[i][bestAxis] - lo) * scale));
+        if (bin < bestSplit) {
+            ++i;
+        } else {
+            --j;
+            std::swap(m_Triangles[i], m_Triangles[j]);
+            std::swap(centroids[i], centroids[j]);
+        }
+    }
+    uint32_t leftCount = i - node.leftOrFirst;
+    if (leftCount == 0 || leftCount == node.count) {
+        return;
+    }
+
+    auto leftIndex = static_cast<uint32_t>(m_Nodes.size());
+    Node leftNode{};
+    leftNode.leftOrFirst = node.leftOrFirst;
+    leftNode.count = leftCount;
+    Node rightNode{};
+    rightNode.leftOrFirst = i;
+    rightNode.count = node.count - leftCount;
+    m_Nodes.push_back(leftNode);
+    m_Nodes.push_back(rightNode);
+    updateBounds(m_Nodes[leftIndex]);
+    updateBounds(m_Nodes[leftIndex + 1]);
+
+    m_Nodes[nodeIndex].leftOrFirst = leftIndex;
+    m_Nodes[nodeIndex].count = 0;
+    subdivide(leftIndex, centroids);
+    subdivide(leftIndex + 1, centroids);
+}
+
+template <bool AnyHit>
+bool Bvh::traverse(const glm::vec3& origin, const glm::vec3& direction, float tMax, Hit* hit) const {
+    if (m_Nodes.empty()) {
+        return false;
+    }
+    glm::vec3 invDir = 1.0f / direction;
+    float closest = tMax;
+    bool found = false;
+
+    uint32_t stack[kStackSize];
+    int stackSize = 0;
+    uint32_t current = 0;
+    if (intersectBox(origin, invDir, closest, m_Nodes[0].min, m_Nodes[0].max) == std::numeric_limits<float>::infinity()) {
+        return false;
+    }
+
+    while (true) {
+        const Node& node = m_Nodes[current];
+        if (node.count > 0) {
+            for (uint32_t i = 0; i < node.count; ++i) {
+                const Triangle& tri = m_Triangles[node.leftOrFirst + i];
+                // Moller-Trumbore
+                glm::vec3 p = glm::cross(direction, tri.e2);
+                float det = glm::dot(tri.e1, p);
+                if (std::abs(det) < 1e-12f) {
+                    continue;
+                }
+                float invDet = 1.0f / det;
+                glm::vec3 s = origin - tri.v0;
+                float u = glm::dot(s, p) * invDet;
+                if (u < 0.0f || u > 1.0f) {
+                    continue;
+                }
+                glm::vec3 q = glm::cross(s, tri.e1);
+                float v = glm::dot(direction, q) * invDet;
+                if (v < 0.0f || u + v > 1.0f) {
+                    continue;
+                }
+                float t = glm::dot(tri.e2, q) * invDet;
+                if (t <= 0.0f || t >= closest) {
+                    continue;
+                }
+                if (AnyHit) {
+                    return true;
+                }
+                closest = t;
+                found = true;
+                hit->t = t;
+                hit->triangle = tri.source;
+                hit->u = u;
+                hit->v = v;
+                hit->normal = glm::cross(tri.e1, tri.e2);
+            }
+        } else {
+            // Visit the nearer child first and defer the other
+            uint32_t first = node.leftOrFirst;
+            uint32_t second = first + 1;
+            float tFirst = intersectBox(origin, invDir, closest, m_Nodes[first].min, m_Nodes[first].max);
+            float tSecond = intersectBox(origin, invDir, closest, m_Nodes[second].min, m_Nodes[second].max);
+            if (tSecond < tFirst) {
+                std::swap(first, second);
+                std::swap(tFirst, tSecond);
+            }
+            if (tFirst != std::numeric_limits<float>::infinity()) {
+                if (tSecond != std::numeric_limits<float>::infinity() && stackSize < kStackSize) {
+                    stack[stackSize++] = second;
+                }
+                current = first;
+                continue;
+            }
+        }
+
+        if (stackSize == 0) {
+            break;
+        }
+        current = stack[--stackSize];
+    }
+    return found;
+}
+
+bool Bvh::intersect(const glm::vec3& origin, const glm::vec3& direction, float tMax, Hit& hit) const {
+    return traverse<false>(origin, direction, tMax, &hit);
+}
+
+bool Bvh::occluded(const glm::vec3& origin, const glm::vec3& direction, float tMax) const {
+    return traverse<true>(origin, direction, tMax, nullptr);
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+// Triangle BVH for offline ray casting (baking). Built with binned SAH over triangle
+// centroids and stored as a flat array of nodes in depth-first order.
+class Bvh {
+   public:
+    struct Hit {
+        float t = 0.0f;
+        uint32_t triangle = 0;
+        float u = 0.0f;  // Barycentrics of corners 1 and 2
+        float v = 0.0f;
+        glm::vec3 normal{0.0f};  // Unnormalized geometric normal, e1 x e2
+    };
+
+    // `indices` holds three vertex indices per triangle
+    void build(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices);
+
+    // Closest hit along origin + t * direction for t in (0, tMax)
+    bool intersect(const glm::vec3& origin, const glm::vec3& direction, float tMax, Hit& hit) const;
+    // Any hit, for shadow and occlusion rays
+    bool occluded(const glm::vec3& origin, const glm::vec3& direction, float tMax) const;
+
+    size_t getTriangleCount() const { return m_Triangles.size(); }
+    size_t getNodeCount() const { return m_Nodes.size(); }
+
+   private:
+    friend class Bvh4;
+
+    struct Node {
+        glm::vec3 min;
+        uint32_t leftOrFirst;  // Left child index for inner nodes, first triangle for leaves
+        glm::vec3 max;
+        uint32_t count;  // Triangles in a leaf, 0 for inner nodes whose children are adjacent
+    };
+
+    // Pre-transformed for Moller-Trumbore
+    struct Triangle {
+        glm::vec3 v0;
+        glm::vec3 e1;
+        glm::vec3 e2;
+        uint32_t source;  // Index of the triangle in the build input, reported in Hit
+    };
+
+    void subdivide(uint32_t nodeIndex, std::vector<glm::vec3>& centroids);
+    void updateBounds(Node& node) const;
+    template <bool AnyHit>
+    bool traverse(const glm::vec3& origin, const glm::vec3& direction, float tMax, Hit* hit) const;
+
+    std::vector<Node> m_Nodes;
+    std::vector<Triangle> m_Triangles;
+};
@@ -0,0 +1,199 @@
+#include "Bvh4.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+#include "core/Float4.h"
+
+namespace {
+// Covers trees up to 42 inner levels without touching the heap
+const size_t kStackSize = 128;
+
+float surfaceArea(const glm::vec3& min, const glm::vec3& max) {
+    glm::vec3 e = max - min;
+    return e.x * e.y + e.y * e.z + e.z * e.x;
+}
+}
+
+void Bvh4::build(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices) {
+    m_Nodes.clear();
+    m_Blocks.clear();
+    m_MaxDepth = 0;
+    m_StackSize = 0;
+
+    Bvh bvh;
+    bvh.build(positions, indices);
+    if (bvh.m_Nodes.empty()) {
+        return;
+    }
+
+    m_Nodes.reserve(bvh.m_Nodes.size() / 2 + 1);
+    m_Blocks.reserve(bvh.m_Triangles.size() / 2 + 1);
+    const Bvh::Node& root = bvh.m_Nodes[0];
+    if (root.count > 0) {
+        collapse(bvh, {0}, 0);
+    } else {
+        collapse(bvh, {root.leftOrFirst, root.leftOrFirst + 1}, 0);
+    }
+    // Each inner level popped pushes at most four children in place of itself
+    m_StackSize = 3 * static_cast<size_t>(m_MaxDepth) + 1;
+}
+
+uint32_t Bvh4::collapse(const Bvh& bvh, const std::vector<uint32_t>& binaryChildren, uint32_t depth) {
+    m_MaxDepth = std::max(m_MaxDepth, depth);
+    // Pull grandchildren up until four slots are filled, opening the largest inner child first
+    std::vector<uint32_t> children = binaryChildren;
+    while (children.size() < 4) {
+        int widest = -1;
+        float widestArea = -1.0f;
+        for (size_t i = 0; i < children.size(); ++i) {
+            const Bvh::Node& node = bvh.m_Nodes[children[i]];
+            float area = surfaceArea(node.min, node.max);
+            if (node.count == 0 && area > widestArea) {
+                widest = static_cast<int>(i);
+                widestArea = area;
+            }
+        }
+        if (widest < 0) {
+            break;
+        }
+        uint32_t left = bvh.m_Nodes[children[widest]].leftOrFirst;
+        children[widest] = left;
+        children.push_back(left + 1);
+    }
+
+    auto index = static_cast<uint32_t>(m_Nodes.size());
+    m_Nodes.emplace_back();
+    Node node{};
+    for (int lane = 0; lane < 4; ++lane) {
+        node.minX[lane] = node.minY[lane] = node.minZ[lane] = 0.0f;
+        node.maxX[lane] = node.maxY[lane] = node.maxZ[lane] = 0.0f;
+        node.child[lane] = kEmptySlot;
+        node.blockCount[lane] = 0;
+    }
+    for (size_t lane = 0; lane < children.size(); ++lane) {
+        const Bvh::Node& child = bvh.m_Nodes[children[lane]];
+        node.minX[lane] = child.min.x;
+        node.minY[lane] = child.min.y;
+        node.minZ[lane] = child.min.z;
+        node.maxX[lane] = child.max.x;
+        node.maxY[lane] = child.max.y;
+        node.maxZ[lane] = child.max.z;
+        if (child.count > 0) {
+            node.child[lane] = packLeaf(bvh, child, node.blockCount[lane]);
+        } else {
+            node.child[lane] =
+                static_cast<int32_t>(collapse(bvh, {child.leftOrFirst, child.leftOrFirst + 1}, depth + 1));
+        }
+    }
+    m_Nodes[index] = node;
+    return index;
+}
+
+int32_t Bvh4::packLeaf(const Bvh& bvh, const Bvh::Node& leaf, uint32_t& blockCount) {
+    auto first = static_cast<int32_t>(m_Blocks.size());
+    blockCount = (leaf.count + 3) / 4;
+    for (uint32_t b = 0; b < blockCount; ++b) {
+        TriangleBlock block{};
+        for (uint32_t lane = 0; lane < 4; ++lane) {
+            uint32_t t = b * 4 + lane;
+            if (t >= leaf.count) {
+                break;
+            }
+            const Bvh::Triangle& tri = bvh.m_Triangles[leaf.leftOrFirst + t];
+            block.v0x[lane] = tri.v0.x;
+            block.v0y[lane] = tri.v0.y;
+            block.v0z[lane] = tri.v0.z;
+            block.e1x[lane] = tri.e1.x;
+            block.e1y[lane] = tri.e1.y;
+            block.e1z[lane] = tri.e1.z;
+            block.e2x[lane] = tri.e2.x;
+            block.e2y[lane] = tri.e2.y;
+            block.e2z[lane] = tri.e2.z;
+        }
+        m_Blocks.push_back(block);
+    }
+    return ~first;
+}
+
+bool Bvh4::occluded(const glm::vec3& origin, const glm::vec3& direction, float tMax) const {
+    if (m_Nodes.empty()) {
+        return false;
+    }
+    const Float4 ox = Float4::splat(origin.x), oy = Float4::splat(origin.y), oz = Float4::splat(origin.z);
+    const Float4 dx = Float4::splat(direction.x), dy = Float4::splat(direction.y), dz = Float4::splat(direction.z);
+    const Float4 ix = Float4::splat(1.0f / direction.x);
+    const Float4 iy = Float4::splat(1.0f / direction.y);
+    const Float4 iz = Float4::splat(1.0f / direction.z);
+    const Float4 zero = Float4::splat(0.0f);
+    const Float4 one = Float4::splat(1.0f);
+    const Float4 limit = Float4::splat(tMax);
+    const Float4 epsilon = Float4::splat(1e-12f);
+
+    // Degenerate trees deeper than the local array get a per-thread stack sized at build time
+    int32_t localStack[kStackSize];
+    int32_t* stack = localStack;
+    if (m_StackSize > kStackSize) {
+        thread_local std::vector<int32_t> deepStack;
+        if (deepStack.size() < m_StackSize) {
+            deepStack.resize(m_StackSize);
+        }
+        stack = deepStack.data();
+    }
+    size_t stackSize = 0;
+    stack[stackSize++] = 0;
+    while (stackSize > 0) {
+        const Node& node = m_Nodes[stack[--stackSize]];
+
+        Float4 tx0 = (Float4::load(node.minX) - ox) * ix;
+        Float4 tx1 = (Float4::load(node.maxX) - ox) * ix;
+        Float4 ty0 = (Float4::load(node.minY) - oy) * iy;
+        Float4 ty1 = (Float4::load(node.maxY) - oy) * iy;
+        Float4 tz0 = (Float4::load(node.minZ) - oz) * iz;
+        Float4 tz1 = (Float4::load(node.maxZ) - oz) * iz;
+        Float4 enter = max(max(min(tx0, tx1), min(ty0, ty1)), max(min(tz0, tz1), zero));
+        Float4 exit = min(min(max(tx0, tx1), max(ty0, ty1)), min(max(tz0, tz1), limit));
+        int hitMask = (enter <= exit).mask();
+
+        for (int lane = 0; lane < 4; ++lane) {
+            int32_t child = node.child[lane];
+            if (!(hitMask & (1 << lane)) || child == kEmptySlot) {
+                continue;
+            }
+            if (child >= 0) {
+                assert(stackSize < std::max(m_StackSize, kStackSize));
+                stack[stackSize++] = child;
+                continue;
+            }
+
+            // Moller-Trumbore against four triangles at once
+            const TriangleBlock* block = &m_Blocks[~child];
+            for (uint32_t b = 0; b < node.blockCount[lane]; ++b, ++block) {
+                Float4 e1x = Float4::load(block->e1x), e1y = Float4::load(block->e1y), e1z = Float4::load(block->e1z);
+                Float4 e2x = Float4::load(block->e2x), e2y = Float4::load(block->e2y), e2z = Float4::load(block->e2z);
+                Float4 px = dy * e2z - dz * e2y;
+                Float4 py = dz * e2x - dx * e2z;
+                Float4 pz = dx * e2y - dy * e2x;
+                Float4 det = e1x * px + e1y * py + e1z * pz;
+                Float4 invDet = det.reciprocal();
+                Float4 sx = ox - Float4::load(block->v0x);
+                Float4 sy = oy - Float4::load(block->v0y);
+                Float4 sz = oz - Float4::load(block->v0z);
+                Float4 u = (sx * px + sy * py + sz * pz) * invDet;
+                Float4 qx = sy * e1z - sz * e1y;
+                Float4 qy = sz * e1x - sx * e1z;
+                Float4 qz = sx * e1y - sy * e1x;
+                Float4 v = (dx * qx + dy * qy + dz * qz) * invDet;
+                Float4 t = (e2x * qx + e2y * qy + e2z * qz) * invDet;
+                Float4 hit = (det.abs() > epsilon) & (u >= zero) & (v >= zero) & (u + v <= one) &
+                             (t > zero) & (t < limit);
+                if (hit.mask() != 0) {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
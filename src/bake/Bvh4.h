@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "Bvh.h"
+
+// Four-wide BVH for occlusion rays, collapsed from a binary Bvh. Nodes keep the bounds of
+// up to four children and leaves pack triangles in blocks of four, both in SoA form, so
+// one slab test and one Moller-Trumbore test cover four lanes with SSE (scalar lanes on
+// targets without it).
+class Bvh4 {
+   public:
+    // `indices` holds three vertex indices per triangle
+    void build(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices);
+
+    // Any hit along origin + t * direction for t in (0, tMax)
+    bool occluded(const glm::vec3& origin, const glm::vec3& direction, float tMax) const;
+
+    size_t getNodeCount() const { return m_Nodes.size(); }
+    // Traversal stack entries occluded() needs for this tree
+    size_t getStackSize() const { return m_StackSize; }
+
+   private:
+    static const int32_t kEmptySlot = INT32_MIN;
+
+    struct alignas(16) Node {
+        float minX[4], minY[4], minZ[4];
+        float maxX[4], maxY[4], maxZ[4];
+        // >= 0: inner node index. < 0: leaf whose blocks start at ~child. kEmptySlot: unused
+        int32_t child[4];
+        uint32_t blockCount[4];
+    };
+
+    // Pre-transformed for Moller-Trumbore; unused lanes have zero edges and never hit
+    struct alignas(16) TriangleBlock {
+        float v0x[4], v0y[4], v0z[4];
+        float e1x[4], e1y[4], e1z[4];
+        float e2x[4], e2y[4], e2z[4];
+    };
+
+    uint32_t collapse(const Bvh& bvh, const std::vector<uint32_t>& children, uint32_t depth);
+    int32_t packLeaf(const Bvh& bvh, const Bvh::Node& leaf, uint32_t& blockCount);
+
+    std::vector<Node> m_Nodes;
+    std::vector<TriangleBlock> m_Blocks;
+    uint32_t m_MaxDepth = 0;  // Of inner nodes, the root is 0
+    size_t m_StackSize = 0;
+};
@@ -0,0 +1,208 @@
+#include "ProbeBaker.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <glm/gtc/constants.hpp>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+
+#include "Sampling.h"
+
+namespace {
+// Offsets ray origins off the surface they leave, relative to the scene size
+const float kRayEpsilon = 1e-4f;
+// Probes that see more back faces than this are inside geometry and get replaced
+const float kMaxBackfaceRatio = 0.25f;
+
+// Real SH basis, same ordering as ProbeVolume::upload expects (y, z, x for band 1)
+void evaluateSh(const glm::vec3& d, float* basis) {
+    basis[0] = 0.282095f;
+    basis[1] = 0.488603f * d.y;
+    basis[2] = 0.488603f * d.z;
+    basis[3] = 0.488603f * d.x;
+    basis[4] = 1.092548f * d.x * d.y;
+    basis[5] = 1.092548f * d.y * d.z;
+    basis[6] = 0.315392f * (3.0f * d.z * d.z - 1.0f);
+    basis[7] = 1.092548f * d.x * d.z;
+    basis[8] = 0.546274f * (d.x * d.x - d.y * d.y);
+}
+}
+
+void ProbeBaker::addMesh(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices,
+                         const glm::vec3& albedo) {
+    if (positions.empty() || indices.size() < 3) {
+        return;
+    }
+    if (m_Positions.empty()) {
+        m_BoundsMin = m_BoundsMax = positions[0];
+    }
+    auto base = static_cast<uint32_t>(m_Positions.size());
+    for (const auto& p : positions) {
+        m_Positions.push_back(p);
+        m_BoundsMin = glm::min(m_BoundsMin, p);
+        m_BoundsMax = glm::max(m_BoundsMax, p);
+    }
+    auto albedoIndex = static_cast<uint32_t>(m_Albedos.size());
+    m_Albedos.push_back(glm::clamp(albedo, glm::vec3(0.0f), glm::vec3(0.95f)));
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        m_Indices.push_back(base + indices[i]);
+        m_Indices.push_back(base + indices[i + 1]);
+        m_Indices.push_back(base + indices[i + 2]);
+        m_TriangleAlbedo.push_back(albedoIndex);
+    }
+}
+
+glm::vec3 ProbeBaker::traceRadiance(glm::vec3 origin, glm::vec3 direction, uint32_t& rng, bool& backface) const {
+    float epsilon = kRayEpsilon * glm::length(m_BoundsMax - m_BoundsMin);
+    glm::vec3 sunDir = -glm::normalize(m_Environment.sunDirection);
+    glm::vec3 radiance(0.0f);
+    glm::vec3 throughput(1.0f);
+    backface = false;
+
+    for (int bounce = 0; bounce <= m_Settings.bounces; ++bounce) {
+        Bvh::Hit hit;
+        if (!m_Bvh.intersect(origin, direction, std::numeric_limits<float>::max(), hit)) {
+            radiance += throughput * m_Environment.skyRadiance;
+            break;
+        }
+
+        glm::vec3 normal = glm::normalize(hit.normal);
+        if (glm::dot(normal, direction) > 0.0f) {
+            if (bounce == 0) {
+                backface = true;
+            }
+            normal = -normal;
+        }
+        glm::vec3 position = origin + direction * hit.t + normal * epsilon;
+        const glm::vec3& albedo = m_Albedos[m_TriangleAlbedo[hit.triangle]];
+
+        // Direct sun at the hit, shaded like computeSunDiffuse
+        float cosSun = glm::dot(normal, sunDir);
+        if (cosSun > 0.0f && !m_Bvh.occluded(position, sunDir, std::numeric_limits<float>::max())) {
+            radiance += throughput * albedo * m_Environment.sunColor * cosSun;
+        }
+
+        // Cosine-weighted continuation: the pdf cancels the Lambert cosine, leaving the albedo
+        throughput *= albedo;
+        direction = cosineHemisphere(normal, random01(rng), random01(rng));
+        origin = position;
+    }
+    return radiance;
+}
+
+ProbeGrid ProbeBaker::bake(const Settings& settings, const Environment& environment, const Progress& progress) {
+    if (m_Indices.empty()) {
+        throw std::runtime_error("Probe bake has no geometry");
+    }
+    if (settings.coefficientCount != 4 && settings.coefficientCount != 9) {
+        throw std::runtime_error("Probe bake supports 4 (L1) or 9 (L2) SH coefficients");
+    }
+    if (settings.resolution.x < 1 || settings.resolution.y < 1 || settings.resolution.z < 1 ||
+        settings.samplesPerProbe < 1) {
+        throw std::runtime_error("Probe bake resolution and sample count must be positive");
+    }
+    m_Settings = settings;
+    m_Environment = environment;
+    m_Bvh.build(m_Positions, m_Indices);
+
+    ProbeGrid grid;
+    grid.resolution = settings.resolution;
+    // Keep outer probes off the boundary walls
+    glm::vec3 inset = (m_BoundsMax - m_BoundsMin) * 0.02f;
+    grid.boundsMin = m_BoundsMin + inset;
+    grid.boundsMax = m_BoundsMax - inset;
+    grid.coefficientCount = settings.coefficientCount;
+    size_t probeCount = grid.getProbeCount();
+    grid.coefficients.assign(probeCount * grid.coefficientCount, glm::vec3(0.0f));
+    std::vector<uint8_t> valid(probeCount, 1);
+
+    // Progress is reported from the calling thread only
+    const std::thread::id caller = std::this_thread::get_id();
+    std::atomic<size_t> nextProbe{0};
+    std::atomic<size_t> finished{0};
+    auto worker = [&]() {
+        float basis[9];
+        for (size_t probe = nextProbe++; probe < probeCount; probe = nextProbe++) {
+            int x = static_cast<int>(probe % grid.resolution.x);
+            int y = static_cast<int>((probe / grid.resolution.x) % grid.resolution.y);
+            int z = static_cast<int>(probe / (static_cast<size_t>(grid.resolution.x) * grid.resolution.y));
+            glm::vec3 origin = grid.getProbePosition(x, y, z);
+            uint32_t rng = static_cast<uint32_t>(probe) * 9781u + 6271u;
+
+            glm::vec3* sh = &grid.coefficients[probe * grid.coefficientCount];
+            int backfaces = 0;
+            // Stratified over a sqrt(N) x sqrt(N) grid of the unit square
+            int strata = std::max(1, static_cast<int>(std::sqrt(static_cast<float>(settings.samplesPerProbe))));
+            int samples = strata * strata;
+            float weight = 4.0f * glm::pi<float>() / static_cast<float>(samples);
+            for (int s = 0; s < samples; ++s) {
+                float u = (static_cast<float>(s % strata) + random01(rng)) / static_cast<float>(strata);
+                float v = (static_cast<float>(s / strata) + random01(rng)) / static_cast<float>(strata);
+                glm::vec3 direction = uniformSphere(u, v);
+                bool backface = false;
+                glm::vec3 radiance = traceRadiance(origin, direction, rng, backface);
+                backfaces += backface ? 1 : 0;
+
+                evaluateSh(direction, basis);
+                for (uint32_t c = 0; c < grid.coefficientCount; ++c) {
+                    sh[c] += radiance * (basis[c] * weight);
+                }
+            }
+            valid[probe] = static_cast<float>(backfaces) <= kMaxBackfaceRatio * static_cast<float>(samples);
+
+            size_t done = ++finished;
+            if (progress && std::this_thread::get_id() == caller) {
+                progress(done, probeCount);
+            }
+        }
+    };
+
+    unsigned int threadCount = settings.threads > 0 ? settings.threads : std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::thread> threads;
+    for (unsigned int t = 1; t < threadCount; ++t) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // Probes buried in walls see mostly back faces; give them the average of valid neighbours
+    for (size_t probe = 0; probe < probeCount; ++probe) {
+        if (valid[probe]) {
+            continue;
+        }
+        int x = static_cast<int>(probe % grid.resolution.x);
+        int y = static_cast<int>((probe / grid.resolution.x) % grid.resolution.y);
+        int z = static_cast<int>(probe / (static_cast<size_t>(grid.resolution.x) * grid.resolution.y));
+        std::vector<glm::vec3> sum(grid.coefficientCount, glm::vec3(0.0f));
+        int count = 0;
+        for (int dz = -1; dz <= 1; ++dz) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dx = -1; dx <= 1; ++dx) {
+                    glm::ivec3 n(x + dx, y + dy, z + dz);
+                    if (n.x < 0 || n.y < 0 || n.z < 0 || n.x >= grid.resolution.x || n.y >= grid.resolution.y ||
+                        n.z >= grid.resolution.z) {
+                        continue;
+                    }
+                    size_t neighbour = (static_cast<size_t>(n.z) * grid.resolution.y + n.y) * grid.resolution.x + n.x;
+                    if (!valid[neighbour]) {
+                        continue;
+                    }
+                    for (uint32_t c = 0; c < grid.coefficientCount; ++c) {
+                        sum[c] += grid.coefficients[neighbour * grid.coefficientCount + c];
+                    }
+                    count++;
+                }
+            }
+        }
+        if (count > 0) {
+            for (uint32_t c = 0; c < grid.coefficientCount; ++c) {
+                grid.coefficients[probe * grid.coefficientCount + c] = sum[c] / static_cast<float>(count);
+            }
+        }
+    }
+    return grid;
+}
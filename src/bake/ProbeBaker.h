@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "Bvh.h"
+#include "rendering/ProbeVolume.h"
+
+// Offline irradiance probe bake: world-space triangles go into a BVH, then every probe of
+// a grid spanning the geometry path-traces uniformly distributed directions on all cores
+// and projects the incoming radiance onto L1 or L2 spherical harmonics. Direct sunlight
+// is left out of the probes because basic.frag already shades it per pixel; the probes
+// carry sky light and sun light bounced off the scene.
+class ProbeBaker {
+   public:
+    struct Settings {
+        glm::ivec3 resolution{24, 12, 12};
+        int samplesPerProbe = 512;
+        int bounces = 2;
+        uint32_t coefficientCount = 9;  // 4 for L1, 9 for L2
+        unsigned int threads = 0;       // 0 uses every hardware thread
+    };
+
+    // Matches the lighting model of basic.frag
+    struct Environment {
+        glm::vec3 skyRadiance{0.7f};  // Sky ambient color * strength
+        glm::vec3 sunDirection{0.0f, -1.0f, 0.0f};
+        glm::vec3 sunColor{1.0f};
+    };
+
+    using Progress = std::function<void(size_t done, size_t total)>;
+
+    void addMesh(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices,
+                 const glm::vec3& albedo);
+    size_t getTriangleCount() const { return m_Indices.size() / 3; }
+
+    // Probes span the bounds of every added mesh
+    ProbeGrid bake(const Settings& settings, const Environment& environment, const Progress& progress = Progress());
+
+   private:
+    glm::vec3 traceRadiance(glm::vec3 origin, glm::vec3 direction, uint32_t& rng, bool& backface) const;
+
+    std::vector<glm::vec3> m_Positions;
+    std::vector<uint32_t> m_Indices;
+    std::vector<uint32_t> m_TriangleAlbedo;
+    std::vector<glm::vec3> m_Albedos;
+    glm::vec3 m_BoundsMin{0.0f};
+    glm::vec3 m_BoundsMax{0.0f};
+    Bvh m_Bvh;
+    Settings m_Settings;
+    Environment m_Environment;
+};
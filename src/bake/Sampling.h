@@ -0,0 +1,38 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+
+// Random numbers and direction sampling shared by the bakers
+
+inline uint32_t nextRandom(uint32_t& state) {
+    // xorshift32
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+inline float random01(uint32_t& state) {
+    return static_cast<float>(nextRandom(state) >> 8) / 16777216.0f;
+}
+
+inline glm::vec3 uniformSphere(float u, float v) {
+    float z = 1.0f - 2.0f * u;
+    float r = std::sqrt(std::max(0.0f, 1.0f - z * z));
+    float phi = glm::two_pi<float>() * v;
+    return glm::vec3(r * std::cos(phi), r * std::sin(phi), z);
+}
+
+inline glm::vec3 cosineHemisphere(const glm::vec3& normal, float u, float v) {
+    float r = std::sqrt(u);
+    float phi = glm::two_pi<float>() * v;
+    glm::vec3 local(r * std::cos(phi), r * std::sin(phi), std::sqrt(std::max(0.0f, 1.0f - u)));
+    glm::vec3 tangent = std::abs(normal.x) > 0.9f ? glm::vec3(0.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.0f, 0.0f);
+    tangent = glm::normalize(glm::cross(tangent, normal));
+    glm::vec3 bitangent = glm::cross(normal, tangent);
+    return tangent * local.x + bitangent * local.y + normal * local.z;
+}
@@ -0,0 +1,73 @@
+#include "VertexAnimationBake.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+VertexAnimationData bakeVertexAnimation(const MeshData& mesh, const Skeleton& skeleton, const Skin& skin,
+                                        const std::vector<AnimationClip>& clips, float frameRate) {
+    size_t vertexCount = mesh.vertices.size() / Mesh::kVertexFloats;
+    if (mesh.skin.size() != vertexCount) {
+        throw std::invalid_argument("Vertex animation bake needs a skinned mesh");
+    }
+    if (frameRate <= 0.0f) {
+        throw std::invalid_argument("Vertex animation frame rate must be > 0");
+    }
+
+    VertexAnimationData data;
+    data.vertexCount = static_cast<uint32_t>(vertexCount);
+    data.clips.reserve(clips.size());
+
+    Pose pose;
+    AnimationCursor cursor;
+    std::vector<glm::mat4> globals;
+    std::vector<glm::mat4> palette;
+    uint32_t frame = 0;
+    for (const auto& clip : clips) {
+        VertexAnimationClip baked;
+        baked.firstFrame = frame;
+        baked.frameCount = static_cast<uint32_t>(std::ceil(clip.getDuration() * frameRate)) + 1;
+        baked.duration = clip.getDuration();
+        // Stretch the rate slightly so the last frame lands exactly on the clip end
+        baked.frameRate = baked.frameCount > 1 ? static_cast<float>(baked.frameCount - 1) / baked.duration : frameRate;
+
+        skeleton.getRestPose(pose);
+        cursor = AnimationCursor();
+        bool empty = true;
+        for (uint32_t f = 0; f < baked.frameCount; ++f) {
+            // Sampling exactly at the duration would wrap back to the first key
+            float time = std::min(static_cast<float>(f) / baked.frameRate, std::nextafter(baked.duration, 0.0f));
+            clip.sample(baked.frameCount > 1 ? time : 0.0f, cursor, pose);
+            skeleton.computeGlobals(pose, globals);
+            Skeleton::computePalette(skin, globals, mesh.aabb, palette);
+
+            for (size_t v = 0; v < vertexCount; ++v) {
+                const float* vertex = &mesh.vertices[v * Mesh::kVertexFloats];
+                const SkinVertex& influence = mesh.skin[v];
+                glm::mat4 matrix(0.0f);
+                for (int i = 0; i < 4; ++i) {
+                    float weight = static_cast<float>(influence.weights[i]) / 65535.0f;
+                    if (weight > 0.0f && influence.joints[i] < palette.size()) {
+                        matrix += palette[influence.joints[i]] * weight;
+                    }
+                }
+                glm::vec3 position(matrix * glm::vec4(vertex[0], vertex[1], vertex[2], 1.0f));
+                glm::vec3 normal(matrix * glm::vec4(vertex[3], vertex[4], vertex[5], 0.0f));
+                float length = glm::length(normal);
+                data.positions.emplace_back(position, 1.0f);
+                data.normals.emplace_back(length > 0.0f ? normal / length : glm::vec3(0.0f, 1.0f, 0.0f), 0.0f);
+
+                if (empty) {
+                    baked.bounds = {position, position};
+                    empty = false;
+                } else {
+                    baked.bounds.min = glm::min(baked.bounds.min, position);
+                    baked.bounds.max = glm::max(baked.bounds.max, position);
+                }
+            }
+        }
+        frame += baked.frameCount;
+        data.clips.push_back(baked);
+    }
+    return data;
+}
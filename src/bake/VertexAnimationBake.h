@@ -0,0 +1,13 @@
+#pragma once
+
+#include <vector>
+
+#include "assets/AnimationClip.h"
+#include "assets/Skeleton.h"
+#include "rendering/VertexAnimation.h"
+
+// Plays every clip on the CPU with `skin` and records the skinned position and normal of
+// each vertex at `frameRate` frames per second, the first and last frame landing on the clip
+// start and end. `mesh` must carry its skin stream.
+VertexAnimationData bakeVertexAnimation(const MeshData& mesh, const Skeleton& skeleton, const Skin& skin,
+                                        const std::vector<AnimationClip>& clips, float frameRate);
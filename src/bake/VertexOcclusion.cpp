@@ -0,0 +1,81 @@
+#include "VertexOcclusion.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+#include "Bvh4.h"
+#include "Sampling.h"
+
+namespace {
+// Offsets ray origins off the surface, relative to the geometry size
+const float kRayEpsilon = 1e-4f;
+// Vertices handed to a worker at a time
+const size_t kChunkSize = 256;
+}
+
+std::vector<float> bakeVertexOcclusion(const std::vector<glm::vec3>& positions,
+                                       const std::vector<glm::vec3>& normals,
+                                       const std::vector<uint32_t>& indices,
+                                       const VertexOcclusionSettings& settings) {
+    std::vector<float> occlusion(positions.size(), 1.0f);
+    if (positions.empty() || indices.size() < 3 || normals.size() != positions.size() || settings.samples < 1) {
+        return occlusion;
+    }
+
+    glm::vec3 boundsMin = positions[0];
+    glm::vec3 boundsMax = positions[0];
+    for (const auto& p : positions) {
+        boundsMin = glm::min(boundsMin, p);
+        boundsMax = glm::max(boundsMax, p);
+    }
+    float diagonal = glm::length(boundsMax - boundsMin);
+    float rayLength = settings.radius * diagonal;
+    float epsilon = kRayEpsilon * diagonal;
+
+    Bvh4 bvh;
+    bvh.build(positions, indices);
+
+    // Stratified over a sqrt(N) x sqrt(N) grid of the unit square
+    int strata = std::max(1, static_cast<int>(std::sqrt(static_cast<float>(settings.samples))));
+    int samples = strata * strata;
+
+    std::atomic<size_t> nextChunk{0};
+    auto worker = [&]() {
+        for (size_t begin = nextChunk.fetch_add(kChunkSize); begin < positions.size();
+             begin = nextChunk.fetch_add(kChunkSize)) {
+            size_t end = std::min(begin + kChunkSize, positions.size());
+            for (size_t vertex = begin; vertex < end; ++vertex) {
+                float normalLength = glm::length(normals[vertex]);
+                if (!(normalLength > 0.0f)) {
+                    continue;
+                }
+                glm::vec3 normal = normals[vertex] / normalLength;
+                glm::vec3 origin = positions[vertex] + normal * epsilon;
+                uint32_t rng = static_cast<uint32_t>(vertex) * 9781u + 6271u;
+
+                // The cosine-weighted pdf cancels the Lambert term, so occlusion is a plain hit ratio
+                int open = 0;
+                for (int s = 0; s < samples; ++s) {
+                    float u = (static_cast<float>(s % strata) + random01(rng)) / static_cast<float>(strata);
+                    float v = (static_cast<float>(s / strata) + random01(rng)) / static_cast<float>(strata);
+                    glm::vec3 direction = cosineHemisphere(normal, u, v);
+                    open += bvh.occluded(origin, direction, rayLength) ? 0 : 1;
+                }
+                occlusion[vertex] = static_cast<float>(open) / static_cast<float>(samples);
+            }
+        }
+    };
+
+    unsigned int threadCount = settings.threads > 0 ? settings.threads : std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::thread> threads;
+    for (unsigned int t = 1; t < threadCount; ++t) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return occlusion;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+struct VertexOcclusionSettings {
+    int samples = 64;
+    float radius = 0.05f;     // Ray length as a fraction of the geometry's bounding box diagonal
+    unsigned int threads = 0;  // 0 uses every hardware thread
+};
+
+// Per-vertex ambient occlusion: casts cosine-weighted hemisphere rays around each vertex
+// normal against every input triangle and returns the unoccluded fraction per vertex
+// (1 = open sky). Runs on worker threads over a Bvh4.
+std::vector<float> bakeVertexOcclusion(const std::vector<glm::vec3>& positions,
+                                       const std::vector<glm::vec3>& normals,
+                                       const std::vector<uint32_t>& indices,
+                                       const VertexOcclusionSettings& settings = VertexOcclusionSettings());
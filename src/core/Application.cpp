@@ -3,8 +3,36 @@
 #include <GLFW/glfw3.h>
 
 #include <algorithm>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
 
 #include "MemoryUtils.h"
+#include "assets/VertexOcclusionCache.h"
+#include "rendering/GlExtensions.h"
+
+namespace {
+// Frames still rendered after the last change so async readbacks (GPU timers, meshlet
+// counts, debug view averages) land before the loop goes idle
+const int kSettleFrames = 4;
+
+bool sameLights(const Renderer::LightSet& a, const Renderer::LightSet& b) {
+    if (a.sunDir != b.sunDir || a.sunColor != b.sunColor || a.ambientColor != b.ambientColor ||
+        a.ambientStrength != b.ambientStrength || a.pointLights.size() != b.pointLights.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.pointLights.size(); ++i) {
+        const auto& la = a.pointLights[i];
+        const auto& lb = b.pointLights[i];
+        if (la.position != lb.position || la.color != lb.color || la.intensity != lb.intensity ||
+            la.range != lb.range) {
+            return false;
+        }
+    }
+    return true;
+}
+}
 
 Application::Application()
     : m_Config(Config::load("config.ini")),
@@ -12,6 +40,7 @@ Application::Application()
       m_Renderer(),
       m_Scene(static_cast<float>(m_Config.window().width) / static_cast<float>(m_Config.window().height), m_AssetManager) {
     setupWindow();
+    setupRenderer();
     subscribeEvents();
 
     if (m_Config.window().startFullscreen) {
@@ -21,7 +50,30 @@ Application::Application()
     m_EventBus.dispatchQueued();
 
     m_Renderer.setCamera(m_Scene.getPlayer().getCamera());
+    m_Scene.setStaticBatching(m_Config.scene().staticBatching, m_Config.scene().chunkSize);
+    Model::setRetainMeshData(m_Config.scene().staticBatching);
+    const auto& scatter = m_Config.scatter();
+    ScatterField::Settings scatterSettings;
+    scatterSettings.cellSize = scatter.cellSize;
+    scatterSettings.lodStart = scatter.lodStart;
+    scatterSettings.fadeStart = scatter.fadeStart;
+    scatterSettings.fadeEnd = scatter.fadeEnd;
+    scatterSettings.minDensity = scatter.minDensity;
+    m_Scene.setScatterBenchmark(static_cast<size_t>(scatter.benchmarkInstances), scatter.area, scatterSettings);
+    const auto& skinning = m_Config.skinning();
+    if (skinning.enabled) {
+        m_Scene.setSkinnedCharacters(skinning.model, skinning.instances, skinning.spacing, skinning.scale,
+                                     static_cast<unsigned int>(skinning.animationThreads));
+    }
+    const auto& crowd = m_Config.crowd();
+    if (crowd.enabled) {
+        m_Scene.setCrowd(crowd.model, crowd.instances, crowd.spacing, crowd.scale);
+    }
+    const auto& assets = m_Config.assets();
+    m_AssetManager.setLoaderThreads(static_cast<unsigned int>(assets.loaderThreads));
+    m_Scene.setAsyncLoading(assets.asyncLoading, assets.uploadBudgetMs);
     m_Scene.initialize();
+    reportShaderLoadTimes();
     applyConfigToCamera();
     resetMouseState();
     m_Scene.getPlayer().update(0.0f, m_Input);
@@ -42,6 +94,29 @@ float Application::updateDeltaTime(float& lastTime) {
     return dt;
 }
 
+bool Application::isBackground() const {
+    return !m_WindowFocused || m_Window.isMinimized();
+}
+
+void Application::waitForWork() {
+    const auto& frame = m_Config.frame();
+    if (m_Window.isMinimized()) {
+        m_Window.waitEvents(frame.idleTimeout);
+        return;
+    }
+    if (isBackground() && frame.backgroundFps > 0.0f) {
+        double remaining = 1.0 / frame.backgroundFps - (glfwGetTime() - m_LastRenderTime);
+        if (remaining > 0.0) {
+            m_Window.waitEvents(remaining);
+        }
+        return;
+    }
+    if (frame.onDemand && !m_FrameDirty && m_SettleFrames == 0 && !m_Renderer.needsRedraw() &&
+        !m_AssetManager.hasPendingLoads()) {
+        m_Window.waitEvents(frame.idleTimeout);
+    }
+}
+
 void Application::beginFrame() {
     m_Input.beginFrame();
     m_Window.pollEvents();
@@ -55,6 +130,8 @@ void Application::updateStats(float deltaTime) {
 
     m_StatsTimer += deltaTime;
     m_StatsFrames++;
+    // Compile stalls are short spikes, so report the worst frame of the interval
+    m_StatsShaderWaitMs = std::max(m_StatsShaderWaitMs, m_Renderer.getStats().shaderWaitMs);
     if (m_StatsTimer >= m_Config.stats().interval) {
         float fps = m_StatsFrames / m_StatsTimer;
         const auto& stats = m_Renderer.getStats();
@@ -63,8 +140,65 @@ void Application::updateStats(float deltaTime) {
                             " | FPS: " + std::to_string(static_cast<int>(fps)) +
                             " | Draws: " + std::to_string(stats.drawCalls) +
                             " | Triangles: " + std::to_string(stats.triangles) +
+                            " | Path: " + Renderer::renderPathName(m_Renderer.getRenderPath()) +
                             " | RAM: " + std::to_string(memKB / 1024) + "MB";
+        if (m_Config.profiler().enabled) {
+            std::ostringstream gpu;
+            gpu << std::fixed << std::setprecision(2) << " | GPU: " << stats.gpuFrameMs << "ms";
+            for (const auto& scope : stats.gpuScopes) {
+                if (scope.depth == 0) {
+                    gpu << " " << scope.name << " " << scope.avgMs;
+                }
+            }
+            title += gpu.str();
+        }
+        if (stats.visibilityDraws > 0) {
+            title += " | Resolved batches: " + std::to_string(stats.visibilityDraws);
+        }
+        if (stats.viewDraws > 0) {
+            title += " | View draws: " + std::to_string(stats.viewDraws);
+        }
+        if (stats.meshletsTested > 0) {
+            title += " | Meshlets: " + std::to_string(stats.meshletsVisible) + "/" +
+                     std::to_string(stats.meshletsTested);
+        }
+        if (m_Renderer.getParticles().isActive()) {
+            title += " | Particles: " + std::to_string(stats.particlesAlive);
+        }
+        if (!m_Scene.getScatterFields().empty()) {
+            title += " | Scatter: " + std::to_string(stats.scatterInstances) + " in " +
+                     std::to_string(stats.scatterCells) + " cells";
+        }
+        if (!m_Scene.getSkinnedCharacters().empty()) {
+            title += " | Skinned: " + std::to_string(stats.skinnedInstances);
+        }
+        if (m_Scene.getCrowd()) {
+            title += " | Crowd: " + std::to_string(stats.crowdInstances);
+        }
+        if (m_Renderer.getTerrain().isActive()) {
+            title += " | Terrain: " + std::to_string(stats.terrainNodes) + " nodes, " +
+                     std::to_string(stats.terrainTiles) + " tiles";
+        }
+        if (m_StatsShaderWaitMs > 0.0f || stats.shadersPending > 0) {
+            std::ostringstream shaders;
+            shaders << std::fixed << std::setprecision(2) << " | Shader wait: " << m_StatsShaderWaitMs << "ms";
+            if (stats.shadersPending > 0) {
+                shaders << " (" << stats.shadersPending << " compiling)";
+            }
+            title += shaders.str();
+        }
+        const auto& glCounters = m_Window.glDiagnostics().getCounters();
+        if (glCounters.performance > 0) {
+            title += " | GL perf warnings: " + std::to_string(glCounters.performance);
+        }
+        if (m_Renderer.getDebugView() != Renderer::DebugView::None) {
+            std::ostringstream debug;
+            debug << std::fixed << std::setprecision(2) << " | "
+                  << Renderer::debugViewName(m_Renderer.getDebugView()) << ": " << stats.debugViewValue;
+            title += debug.str();
+        }
         m_Window.setTitle(title);
+        m_StatsShaderWaitMs = 0.0f;
         m_StatsFrames = 0;
         m_StatsTimer = 0.0f;
     }
@@ -76,18 +210,148 @@ void Application::setupWindow() {
     m_ShowStats = m_Config.stats().showStats;
 }
 
+void Application::reportShaderLoadTimes() const {
+    const auto& stats = Shader::getLoadStats();
+    std::cout << std::fixed << std::setprecision(1)
+              << "Shaders: " << stats.compiled << " compiled in " << stats.compileMs << " ms (cold), "
+              << stats.fromCache << " loaded from binary cache in " << stats.cacheMs << " ms (warm)";
+    if (stats.rejected > 0) {
+        std::cout << ", " << stats.rejected << " cached binaries rejected by the driver";
+    }
+    std::cout << std::defaultfloat << std::endl;
+}
+
+void Application::setupRenderer() {
+    GlExtensions::load(reinterpret_cast<GlExtensions::ProcLoader>(glfwGetProcAddress));
+    const auto& shaders = m_Config.shaders();
+    Shader::enableParallelCompile(shaders.parallelCompile);
+    Shader::setBinaryCacheDirectory(shaders.binaryCache ? shaders.binaryCacheDir : std::string());
+    m_Renderer.loadShaders();
+
+    m_Renderer.setRenderPath(m_Config.renderer().path == "visibility" ? Renderer::RenderPath::Visibility
+                                                                      : Renderer::RenderPath::Forward);
+    Model::setPositionStreams(m_Config.renderer().positionStream);
+
+    const auto& ssao = m_Config.ssao();
+    AmbientOcclusion::Settings ssaoSettings;
+    ssaoSettings.enabled = ssao.enabled;
+    ssaoSettings.halfResolution = ssao.halfResolution;
+    ssaoSettings.samples = ssao.samples;
+    ssaoSettings.radius = ssao.radius;
+    ssaoSettings.intensity = ssao.intensity;
+    ssaoSettings.blurRadius = ssao.blurRadius;
+    m_Renderer.getAmbientOcclusion().configure(ssaoSettings);
+
+    const auto& atmosphere = m_Config.atmosphere();
+    Atmosphere::Settings atmosphereSettings;
+    atmosphereSettings.enabled = atmosphere.enabled;
+    atmosphereSettings.updateFrames = atmosphere.updateFrames;
+    m_Renderer.getAtmosphere().configure(atmosphereSettings);
+
+    const auto& minimap = m_Config.minimap();
+    if (minimap.enabled) {
+        // Yaw -90 keeps -Z at the top of the map
+        m_MinimapCamera.setOrientation(-90.0f, -89.0f);
+        m_MinimapView = m_Renderer.addView(m_MinimapCamera, minimap.size, minimap.size);
+        placeMinimap(m_Config.window().width, m_Config.window().height);
+    }
+
+    const auto& meshlets = m_Config.meshlets();
+    Model::setMeshletMinTriangles(meshlets.enabled ? static_cast<size_t>(meshlets.minTriangles) : 0);
+    m_Renderer.setMeshletCulling(meshlets.enabled, meshlets.coneCulling);
+
+    const auto& vertexAO = m_Config.vertexAO();
+    VertexOcclusionSettings occlusionSettings;
+    occlusionSettings.samples = vertexAO.samples;
+    occlusionSettings.radius = vertexAO.radius;
+    Model::setVertexOcclusion(vertexAO.enabled, occlusionSettings);
+    VertexOcclusionCache::setDirectory(vertexAO.cache ? vertexAO.cacheDir : std::string());
+    const auto& crowd = m_Config.crowd();
+    Model::setVertexAnimationFrameRate(crowd.enabled ? crowd.frameRate : 0.0f);
+
+    const auto& profiler = m_Config.profiler();
+    GpuProfiler::Settings settings;
+    settings.enabled = profiler.enabled;
+    settings.perBatchScopes = profiler.perBatchScopes;
+    settings.averageFrames = profiler.averageFrames;
+    settings.exportPath = profiler.exportEnabled ? profiler.exportPath : std::string();
+    m_Renderer.setProfilerSettings(settings);
+
+    const auto& capture = m_Config.capture();
+    FrameCapture::Settings captureSettings;
+    captureSettings.latency = capture.latency;
+    captureSettings.outputDir = capture.outputDir;
+    captureSettings.videoPath = capture.videoPath;
+    m_Renderer.getCapture().configure(captureSettings);
+
+    const auto& particles = m_Config.particles();
+    if (particles.enabled) {
+        ParticleSystem::EmitterSettings emitter;
+        emitter.position = {particles.posX, particles.posY, particles.posZ};
+        emitter.maxParticles = static_cast<uint32_t>(particles.maxParticles);
+        emitter.emitRate = particles.emitRate;
+        emitter.lifetime = particles.lifetime;
+        m_Renderer.getParticles().addEmitter(emitter);
+    }
+
+    const auto& terrain = m_Config.terrain();
+    if (terrain.enabled) {
+        Terrain::Settings terrainSettings;
+        terrainSettings.origin = glm::vec2(-terrain.size * 0.5f);
+        terrainSettings.size = terrain.size;
+        terrainSettings.baseHeight = terrain.baseHeight;
+        terrainSettings.heightScale = terrain.heightScale;
+        terrainSettings.gridResolution = terrain.gridResolution;
+        terrainSettings.lodLevels = terrain.lodLevels;
+        terrainSettings.tilesPerSide = terrain.tilesPerSide;
+        terrainSettings.tileResolution = terrain.tileResolution;
+        terrainSettings.maxResidentTiles = terrain.maxResidentTiles;
+        terrainSettings.tilesPerFrame = terrain.tilesPerFrame;
+        terrainSettings.streamRadius = terrain.streamRadius;
+        m_Renderer.getTerrain().initialize(terrainSettings);
+    }
+
+    const auto& probes = m_Config.probes();
+    if (probes.enabled) {
+        if (std::filesystem::exists(probes.path)) {
+            m_Renderer.setProbeVolume(ProbeGrid::load(probes.path));
+        } else {
+            std::cerr << "Probe volume " << probes.path << " not found, run bake_probes to create it" << std::endl;
+        }
+    }
+}
+
 void Application::subscribeEvents() {
     m_Subscriptions.push_back(m_EventBus.subscribeScoped<FramebufferResizeEvent>([this](const FramebufferResizeEvent& e) {
         if (e.width > 0 && e.height > 0) {
             m_Scene.getPlayer().getCamera().setAspect(
                 static_cast<float>(e.width) / static_cast<float>(e.height));
+            m_Renderer.resize(e.width, e.height);
+            placeMinimap(e.width, e.height);
         }
+        m_FrameDirty = true;
+    }));
+    m_Subscriptions.push_back(m_EventBus.subscribeScoped<KeyEvent>([this](const KeyEvent& e) {
+        m_Input.onKeyEvent(e);
+        m_FrameDirty = true;
+    }));
+    m_Subscriptions.push_back(m_EventBus.subscribeScoped<MouseButtonEvent>([this](const MouseButtonEvent& e) {
+        m_Input.onMouseButtonEvent(e);
+        m_FrameDirty = true;
+    }));
+    m_Subscriptions.push_back(m_EventBus.subscribeScoped<MouseMoveEvent>([this](const MouseMoveEvent& e) {
+        m_Input.onMouseMoveEvent(e);
+        m_FrameDirty = true;
+    }));
+    m_Subscriptions.push_back(m_EventBus.subscribeScoped<ScrollEvent>([this](const ScrollEvent& e) {
+        m_Input.onScrollEvent(e);
+        m_FrameDirty = true;
+    }));
+    m_Subscriptions.push_back(m_EventBus.subscribeScoped<WindowFocusEvent>([this](const WindowFocusEvent& e) {
+        m_Input.onWindowFocusEvent(e);
+        m_WindowFocused = e.focused;
+        m_FrameDirty = true;
     }));
-    m_Subscriptions.push_back(m_EventBus.subscribeScoped<KeyEvent>([this](const KeyEvent& e) { m_Input.onKeyEvent(e); }));
-    m_Subscriptions.push_back(m_EventBus.subscribeScoped<MouseButtonEvent>([this](const MouseButtonEvent& e) { m_Input.onMouseButtonEvent(e); }));
-    m_Subscriptions.push_back(m_EventBus.subscribeScoped<MouseMoveEvent>([this](const MouseMoveEvent& e) { m_Input.onMouseMoveEvent(e); }));
-    m_Subscriptions.push_back(m_EventBus.subscribeScoped<ScrollEvent>([this](const ScrollEvent& e) { m_Input.onScrollEvent(e); }));
-    m_Subscriptions.push_back(m_EventBus.subscribeScoped<WindowFocusEvent>([this](const WindowFocusEvent& e) { m_Input.onWindowFocusEvent(e); }));
 }
 
 void Application::applyConfigToCamera() {
@@ -114,10 +378,39 @@ void Application::handleShortcuts() {
         glfwSetWindowShouldClose(m_Window.native(), true);
     }
 
+    if (m_Input.isKeyPressed(GLFW_KEY_F2)) {
+        m_Renderer.getCapture().requestScreenshot();
+    }
+
+    if (m_Input.isKeyPressed(GLFW_KEY_F9)) {
+        auto& capture = m_Renderer.getCapture();
+        capture.setContinuous(!capture.isContinuous());
+    }
+
     if (m_Input.isKeyPressed(GLFW_KEY_F3)) {
         m_Renderer.toggleWireframe();
     }
 
+    if (m_Input.isKeyPressed(GLFW_KEY_F4)) {
+        m_Renderer.toggleDebugView(Renderer::DebugView::Overdraw);
+    }
+
+    if (m_Input.isKeyPressed(GLFW_KEY_F5)) {
+        m_Renderer.toggleDebugView(Renderer::DebugView::LightCount);
+    }
+
+    if (m_Input.isKeyPressed(GLFW_KEY_F6)) {
+        m_Renderer.toggleDebugView(Renderer::DebugView::MipLevel);
+    }
+
+    if (m_Input.isKeyPressed(GLFW_KEY_F7)) {
+        m_Renderer.toggleDebugView(Renderer::DebugView::BatchId);
+    }
+
+    if (m_Input.isKeyPressed(GLFW_KEY_F8)) {
+        m_Renderer.toggleRenderPath();
+    }
+
     if (m_Input.isKeyPressed(GLFW_KEY_F12)) {
         m_Window.toggleFullscreen();
         resetMouseState();
@@ -125,11 +418,46 @@ void Application::handleShortcuts() {
 }
 
 void Application::updateScene(float deltaTime) {
+    m_AssetManager.update(m_Config.assets().uploadBudgetMs);
     m_Scene.update(deltaTime, m_Input);
+    m_Renderer.getParticles().update(deltaTime);
+}
+
+bool Application::shouldRender(const Renderer::LightSet& lights) {
+    if (m_Window.isMinimized()) {
+        return false;
+    }
+    const auto& frame = m_Config.frame();
+    if (isBackground() && frame.backgroundFps > 0.0f &&
+        glfwGetTime() - m_LastRenderTime < 1.0 / frame.backgroundFps) {
+        return false;
+    }
+
+    glm::mat4 viewProj = m_Scene.getPlayer().getCamera().getViewProjection();
+    bool compareScheduled = m_Config.capture().compareFrame >= 0 && !m_CompareRequested;
+    bool changed = m_FrameDirty || viewProj != m_LastViewProj || m_Scene.getRevision() != m_LastSceneRevision ||
+                   !sameLights(lights, m_LastLights) || m_Renderer.needsRedraw() || compareScheduled ||
+                   m_AssetManager.getCompletedLoads() != m_LastCompletedLoads;
+    m_FrameDirty = false;
+    m_LastViewProj = viewProj;
+    m_LastSceneRevision = m_Scene.getRevision();
+    m_LastCompletedLoads = m_AssetManager.getCompletedLoads();
+    m_LastLights = lights;
+
+    if (changed) {
+        m_SettleFrames = kSettleFrames;
+    } else if (m_SettleFrames > 0) {
+        --m_SettleFrames;
+    } else if (frame.onDemand) {
+        return false;
+    }
+    return true;
 }
 
-void Application::renderFrame() {
-    m_Renderer.setLights(buildLightSet());
+void Application::renderFrame(const Renderer::LightSet& lights) {
+    m_LastRenderTime = glfwGetTime();
+    m_Renderer.setTime(m_LastRenderTime);
+    m_Renderer.setLights(lights);
     renderScene();
 }
 
@@ -159,17 +487,60 @@ Renderer::LightSet Application::buildLightSet() const {
     return lights;
 }
 
+void Application::placeMinimap(int width, int height) {
+    if (m_MinimapView == 0) {
+        return;
+    }
+    int size = std::min({m_Config.minimap().size, width / 3, height / 3});
+    const int margin = 8;
+    m_Renderer.setViewOverlay(m_MinimapView, glm::ivec4(width - size - margin, height - size - margin, size, size));
+}
+
 void Application::renderScene() {
+    if (m_MinimapView != 0) {
+        glm::vec3 position = m_Scene.getPlayer().getCamera().getPosition();
+        m_MinimapCamera.setPosition(position + glm::vec3(0.0f, m_Config.minimap().height, 0.0f));
+    }
     m_Renderer.clear();
     for (const auto& renderable : m_Scene.getRenderables()) {
         m_Renderer.submit(renderable);
     }
+    for (const auto& field : m_Scene.getScatterFields()) {
+        m_Renderer.submitScatter(*field);
+    }
+    for (const auto& character : m_Scene.getSkinnedCharacters()) {
+        character->submit(m_Renderer);
+    }
+    if (const Crowd* crowd = m_Scene.getCrowd()) {
+        m_Renderer.submitCrowd(*crowd);
+    }
     m_Renderer.flush();
+    m_Renderer.present();
+}
+
+void Application::updateCapture() {
+    const auto& config = m_Config.capture();
+    auto& capture = m_Renderer.getCapture();
+    if (config.compareFrame >= 0 && !m_CompareRequested &&
+        m_FrameIndex >= static_cast<uint64_t>(config.compareFrame)) {
+        capture.requestCompare(config.goldenPath, config.tolerance, config.maxMismatchPercent);
+        m_CompareRequested = true;
+    }
+
+    if (m_CompareRequested && config.exitAfterCompare) {
+        auto result = capture.getLastCompareResult();
+        if (result.valid && !capture.hasPendingWork()) {
+            m_ExitCode = result.passed ? 0 : 1;
+            glfwSetWindowShouldClose(m_Window.native(), true);
+        }
+    }
+    m_FrameIndex++;
 }
 
 void Application::run() {
     float lastTime = 0.0f;
     while (!m_Window.shouldClose()) {
+        waitForWork();
         float dt = updateDeltaTime(lastTime);
 
         beginFrame();
@@ -177,7 +548,23 @@ void Application::run() {
         handleShortcuts();
 
         updateScene(dt);
-        renderFrame();
+
+        Renderer::LightSet lights = buildLightSet();
+        if (!shouldRender(lights)) {
+            m_Renderer.updateSkippedFrame();
+            // Nothing changed: show the cached frame again in case the window was damaged
+            if (!m_Window.isMinimized()) {
+                m_Renderer.presentCached();
+                m_Window.swapBuffers();
+            }
+            m_Window.glDiagnostics().drain();
+            updateStats(dt);
+            continue;
+        }
+
+        updateCapture();
+        renderFrame(lights);
+        m_Window.glDiagnostics().drain();
 
         updateStats(dt);
 
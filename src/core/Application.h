@@ -1,4 +1,5 @@
 #pragma once
+#include <cstdint>
 #include <vector>
 
 #include "assets/AssetManager.h"
@@ -15,20 +16,28 @@ class Application {
     ~Application();
 
     void run();
+    int exitCode() const { return m_ExitCode; }
 
    private:
     float updateDeltaTime(float& lastTime);
+    void waitForWork();
     void beginFrame();
     void setupWindow();
+    void setupRenderer();
+    void reportShaderLoadTimes() const;
     void subscribeEvents();
     void applyConfigToCamera();
+    void placeMinimap(int width, int height);
     void resetMouseState();
     void handleShortcuts();
     void updateScene(float deltaTime);
-    void renderFrame();
+    bool isBackground() const;
+    bool shouldRender(const Renderer::LightSet& lights);
+    void renderFrame(const Renderer::LightSet& lights);
     Renderer::LightSet buildLightSet() const;
     void renderScene();
     void updateStats(float deltaTime);
+    void updateCapture();
 
     Config m_Config;
     EventBus m_EventBus;
@@ -38,7 +47,23 @@ class Application {
     AssetManager m_AssetManager;
     Renderer m_Renderer;
     Scene m_Scene;
+    // Top-down view following the player, drawn into the top-right corner
+    Camera m_MinimapCamera{1.0f};
+    uint32_t m_MinimapView = 0;
     bool m_ShowStats = true;
     float m_StatsTimer = 0.0f;
     int m_StatsFrames = 0;
+    float m_StatsShaderWaitMs = 0.0f;
+    uint64_t m_FrameIndex = 0;
+    bool m_CompareRequested = false;
+    // Render-on-demand state: what the last rendered frame was built from
+    bool m_FrameDirty = true;
+    bool m_WindowFocused = true;
+    int m_SettleFrames = 0;
+    double m_LastRenderTime = 0.0;
+    uint64_t m_LastSceneRevision = 0;
+    uint64_t m_LastCompletedLoads = 0;
+    glm::mat4 m_LastViewProj{0.0f};
+    Renderer::LightSet m_LastLights;
+    int m_ExitCode = 0;
 };
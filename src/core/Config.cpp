@@ -166,6 +166,39 @@ void Config::readStats(const CSimpleIniA& ini, Stats& stats) {
     }
 }
 
+void Config::readProfiler(const CSimpleIniA& ini, Profiler& profiler) {
+    profiler.enabled = readBool(ini, "profiler", "enabled");
+    profiler.perBatchScopes = readBool(ini, "profiler", "perBatchScopes");
+    profiler.averageFrames = readInt(ini, "profiler", "averageFrames");
+    profiler.exportEnabled = readBool(ini, "profiler", "export");
+    profiler.exportPath = readString(ini, "profiler", "exportPath");
+
+    if (profiler.averageFrames <= 0) {
+        throwConfigError("[profiler] averageFrames must be > 0");
+    }
+}
+
+void Config::readCapture(const CSimpleIniA& ini, Capture& capture) {
+    capture.latency = readInt(ini, "capture", "latency");
+    capture.outputDir = readString(ini, "capture", "outputDir");
+    capture.videoPath = readString(ini, "capture", "videoPath");
+    capture.goldenPath = readString(ini, "capture", "goldenPath");
+    capture.tolerance = readInt(ini, "capture", "tolerance");
+    capture.maxMismatchPercent = readFloat(ini, "capture", "maxMismatchPercent");
+    capture.compareFrame = readInt(ini, "capture", "compareFrame");
+    capture.exitAfterCompare = readBool(ini, "capture", "exitAfterCompare");
+
+    if (capture.latency < 1) {
+        throwConfigError("[capture] latency must be >= 1");
+    }
+    if (capture.tolerance < 0 || capture.tolerance > 255) {
+        throwConfigError("[capture] tolerance must be in [0, 255]");
+    }
+    if (capture.maxMismatchPercent < 0.0f || capture.maxMismatchPercent > 100.0f) {
+        throwConfigError("[capture] maxMismatchPercent must be in [0, 100]");
+    }
+}
+
 Config Config::load(const std::string& path) {
     Config config;
     CSimpleIniA ini;
@@ -177,6 +210,294 @@ Config Config::load(const std::string& path) {
     readInput(ini, config.m_Input);
     readCamera(ini, config.m_Camera);
     readStats(ini, config.m_Stats);
+    readProfiler(ini, config.m_Profiler);
+    readCapture(ini, config.m_Capture);
+    readShaders(ini, config.m_Shaders);
+    readRenderer(ini, config.m_Renderer);
+    readSsao(ini, config.m_Ssao);
+    readAtmosphere(ini, config.m_Atmosphere);
+    readMinimap(ini, config.m_Minimap);
+    readMeshlets(ini, config.m_Meshlets);
+    readVertexAO(ini, config.m_VertexAO);
+    readScene(ini, config.m_Scene);
+    readAssets(ini, config.m_Assets);
+    readFrame(ini, config.m_Frame);
+    readParticles(ini, config.m_Particles);
+    readTerrain(ini, config.m_Terrain);
+    readScatter(ini, config.m_Scatter);
+    readSkinning(ini, config.m_Skinning);
+    readCrowd(ini, config.m_Crowd);
+    readProbes(ini, config.m_Probes);
 
     return config;
 }
+
+void Config::readShaders(const CSimpleIniA& ini, Shaders& shaders) {
+    shaders.binaryCache = readBool(ini, "shaders", "binaryCache");
+    shaders.binaryCacheDir = readString(ini, "shaders", "binaryCacheDir");
+    shaders.parallelCompile = readBool(ini, "shaders", "parallelCompile");
+
+    if (shaders.binaryCache && shaders.binaryCacheDir.empty()) {
+        throwConfigError("[shaders] binaryCacheDir must not be empty when binaryCache is enabled");
+    }
+}
+
+void Config::readRenderer(const CSimpleIniA& ini, RendererSettings& renderer) {
+    renderer.path = readString(ini, "renderer", "path");
+    renderer.positionStream = readBool(ini, "renderer", "positionStream");
+
+    if (renderer.path != "forward" && renderer.path != "visibility") {
+        throwConfigError("[renderer] path must be forward or visibility");
+    }
+}
+
+void Config::readSsao(const CSimpleIniA& ini, Ssao& ssao) {
+    ssao.enabled = readBool(ini, "ssao", "enabled");
+    ssao.halfResolution = readBool(ini, "ssao", "halfResolution");
+    ssao.samples = readInt(ini, "ssao", "samples");
+    ssao.radius = readFloat(ini, "ssao", "radius");
+    ssao.intensity = readFloat(ini, "ssao", "intensity");
+    ssao.blurRadius = readInt(ini, "ssao", "blurRadius");
+
+    if (ssao.samples < 1 || ssao.samples > 64) {
+        throwConfigError("[ssao] samples must be in [1, 64]");
+    }
+    if (ssao.radius <= 0.0f) {
+        throwConfigError("[ssao] radius must be > 0");
+    }
+    if (ssao.intensity < 0.0f) {
+        throwConfigError("[ssao] intensity must be >= 0");
+    }
+    if (ssao.blurRadius < 0 || ssao.blurRadius > 16) {
+        throwConfigError("[ssao] blurRadius must be in [0, 16]");
+    }
+}
+
+void Config::readAtmosphere(const CSimpleIniA& ini, AtmosphereSettings& atmosphere) {
+    atmosphere.enabled = readBool(ini, "atmosphere", "enabled");
+    atmosphere.updateFrames = readInt(ini, "atmosphere", "updateFrames");
+
+    if (atmosphere.updateFrames < 1 || atmosphere.updateFrames > 64) {
+        throwConfigError("[atmosphere] updateFrames must be in [1, 64]");
+    }
+}
+
+void Config::readMinimap(const CSimpleIniA& ini, Minimap& minimap) {
+    minimap.enabled = readBool(ini, "minimap", "enabled");
+    minimap.size = readInt(ini, "minimap", "size");
+    minimap.height = readFloat(ini, "minimap", "height");
+
+    if (minimap.size < 32 || minimap.size > 2048) {
+        throwConfigError("[minimap] size must be in [32, 2048]");
+    }
+    if (minimap.height <= 0.0f) {
+        throwConfigError("[minimap] height must be > 0");
+    }
+}
+
+void Config::readMeshlets(const CSimpleIniA& ini, Meshlets& meshlets) {
+    meshlets.enabled = readBool(ini, "meshlets", "enabled");
+    meshlets.minTriangles = readInt(ini, "meshlets", "minTriangles");
+    meshlets.coneCulling = readBool(ini, "meshlets", "coneCulling");
+
+    if (meshlets.minTriangles < 1) {
+        throwConfigError("[meshlets] minTriangles must be >= 1");
+    }
+}
+
+void Config::readVertexAO(const CSimpleIniA& ini, VertexAO& vertexAO) {
+    vertexAO.enabled = readBool(ini, "vertexAO", "enabled");
+    vertexAO.samples = readInt(ini, "vertexAO", "samples");
+    vertexAO.radius = readFloat(ini, "vertexAO", "radius");
+    vertexAO.cache = readBool(ini, "vertexAO", "cache");
+    vertexAO.cacheDir = readString(ini, "vertexAO", "cacheDir");
+
+    if (vertexAO.samples < 1) {
+        throwConfigError("[vertexAO] samples must be >= 1");
+    }
+    if (vertexAO.radius <= 0.0f) {
+        throwConfigError("[vertexAO] radius must be > 0");
+    }
+    if (vertexAO.cache && vertexAO.cacheDir.empty()) {
+        throwConfigError("[vertexAO] cacheDir must not be empty when cache is enabled");
+    }
+}
+
+void Config::readScene(const CSimpleIniA& ini, SceneSettings& scene) {
+    scene.staticBatching = readBool(ini, "scene", "staticBatching");
+    scene.chunkSize = readFloat(ini, "scene", "chunkSize");
+
+    if (scene.chunkSize <= 0.0f) {
+        throwConfigError("[scene] chunkSize must be > 0");
+    }
+}
+
+void Config::readAssets(const CSimpleIniA& ini, Assets& assets) {
+    assets.asyncLoading = readBool(ini, "assets", "asyncLoading");
+    assets.loaderThreads = readInt(ini, "assets", "loaderThreads");
+    assets.uploadBudgetMs = readFloat(ini, "assets", "uploadBudgetMs");
+
+    if (assets.loaderThreads < 0 || assets.loaderThreads > 64) {
+        throwConfigError("[assets] loaderThreads must be in [0, 64]");
+    }
+    if (assets.uploadBudgetMs <= 0.0f) {
+        throwConfigError("[assets] uploadBudgetMs must be > 0");
+    }
+}
+
+void Config::readFrame(const CSimpleIniA& ini, Frame& frame) {
+    frame.onDemand = readBool(ini, "frame", "onDemand");
+    frame.idleTimeout = readFloat(ini, "frame", "idleTimeout");
+    frame.backgroundFps = readFloat(ini, "frame", "backgroundFps");
+
+    if (frame.idleTimeout <= 0.0f) {
+        throwConfigError("[frame] idleTimeout must be > 0");
+    }
+    if (frame.backgroundFps < 0.0f) {
+        throwConfigError("[frame] backgroundFps must be >= 0");
+    }
+}
+
+void Config::readParticles(const CSimpleIniA& ini, Particles& particles) {
+    particles.enabled = readBool(ini, "particles", "enabled");
+    particles.maxParticles = readInt(ini, "particles", "maxParticles");
+    particles.emitRate = readFloat(ini, "particles", "emitRate");
+    particles.lifetime = readFloat(ini, "particles", "lifetime");
+    particles.posX = readFloat(ini, "particles", "posX");
+    particles.posY = readFloat(ini, "particles", "posY");
+    particles.posZ = readFloat(ini, "particles", "posZ");
+
+    if (particles.maxParticles < 1) {
+        throwConfigError("[particles] maxParticles must be >= 1");
+    }
+    if (particles.emitRate < 0.0f) {
+        throwConfigError("[particles] emitRate must be >= 0");
+    }
+    if (particles.lifetime <= 0.0f) {
+        throwConfigError("[particles] lifetime must be > 0");
+    }
+}
+
+void Config::readTerrain(const CSimpleIniA& ini, Terrain& terrain) {
+    terrain.enabled = readBool(ini, "terrain", "enabled");
+    terrain.size = readFloat(ini, "terrain", "size");
+    terrain.baseHeight = readFloat(ini, "terrain", "baseHeight");
+    terrain.heightScale = readFloat(ini, "terrain", "heightScale");
+    terrain.gridResolution = readInt(ini, "terrain", "gridResolution");
+    terrain.lodLevels = readInt(ini, "terrain", "lodLevels");
+    terrain.tilesPerSide = readInt(ini, "terrain", "tilesPerSide");
+    terrain.tileResolution = readInt(ini, "terrain", "tileResolution");
+    terrain.maxResidentTiles = readInt(ini, "terrain", "maxResidentTiles");
+    terrain.tilesPerFrame = readInt(ini, "terrain", "tilesPerFrame");
+    terrain.streamRadius = readFloat(ini, "terrain", "streamRadius");
+
+    if (terrain.size <= 0.0f) {
+        throwConfigError("[terrain] size must be > 0");
+    }
+    if (terrain.gridResolution < 2 || terrain.gridResolution % 2 != 0) {
+        throwConfigError("[terrain] gridResolution must be an even number >= 2");
+    }
+    if (terrain.lodLevels < 1 || terrain.lodLevels > 16) {
+        throwConfigError("[terrain] lodLevels must be in [1, 16]");
+    }
+    if (terrain.tilesPerSide < 1 || terrain.tilesPerSide > 32767) {
+        throwConfigError("[terrain] tilesPerSide must be in [1, 32767]");
+    }
+    if (terrain.tileResolution < 2) {
+        throwConfigError("[terrain] tileResolution must be >= 2");
+    }
+    if (terrain.maxResidentTiles < 1 || terrain.maxResidentTiles > 2048) {
+        throwConfigError("[terrain] maxResidentTiles must be in [1, 2048]");
+    }
+    if (terrain.tilesPerFrame < 1) {
+        throwConfigError("[terrain] tilesPerFrame must be >= 1");
+    }
+    if (terrain.streamRadius < 0.0f) {
+        throwConfigError("[terrain] streamRadius must be >= 0");
+    }
+}
+
+void Config::readScatter(const CSimpleIniA& ini, Scatter& scatter) {
+    scatter.benchmarkInstances = readInt(ini, "scatter", "benchmarkInstances");
+    scatter.area = readFloat(ini, "scatter", "area");
+    scatter.cellSize = readFloat(ini, "scatter", "cellSize");
+    scatter.lodStart = readFloat(ini, "scatter", "lodStart");
+    scatter.fadeStart = readFloat(ini, "scatter", "fadeStart");
+    scatter.fadeEnd = readFloat(ini, "scatter", "fadeEnd");
+    scatter.minDensity = readFloat(ini, "scatter", "minDensity");
+
+    if (scatter.benchmarkInstances < 0) {
+        throwConfigError("[scatter] benchmarkInstances must be >= 0");
+    }
+    if (scatter.area <= 0.0f || scatter.cellSize <= 0.0f) {
+        throwConfigError("[scatter] area and cellSize must be > 0");
+    }
+    if (scatter.lodStart < 0.0f || scatter.fadeStart < scatter.lodStart || scatter.fadeEnd < scatter.fadeStart) {
+        throwConfigError("[scatter] distances must satisfy 0 <= lodStart <= fadeStart <= fadeEnd");
+    }
+    if (scatter.minDensity < 0.0f || scatter.minDensity > 1.0f) {
+        throwConfigError("[scatter] minDensity must be in [0, 1]");
+    }
+}
+
+void Config::readSkinning(const CSimpleIniA& ini, Skinning& skinning) {
+    skinning.enabled = readBool(ini, "skinning", "enabled");
+    skinning.model = readString(ini, "skinning", "model");
+    skinning.instances = readInt(ini, "skinning", "instances");
+    skinning.spacing = readFloat(ini, "skinning", "spacing");
+    skinning.scale = readFloat(ini, "skinning", "scale");
+    skinning.animationThreads = readInt(ini, "skinning", "animationThreads");
+
+    if (skinning.instances < 0) {
+        throwConfigError("[skinning] instances must be >= 0");
+    }
+    if (skinning.spacing <= 0.0f || skinning.scale <= 0.0f) {
+        throwConfigError("[skinning] spacing and scale must be > 0");
+    }
+    if (skinning.animationThreads < 0) {
+        throwConfigError("[skinning] animationThreads must be >= 0");
+    }
+}
+
+void Config::readCrowd(const CSimpleIniA& ini, Crowd& crowd) {
+    crowd.enabled = readBool(ini, "crowd", "enabled");
+    crowd.model = readString(ini, "crowd", "model");
+    crowd.instances = readInt(ini, "crowd", "instances");
+    crowd.spacing = readFloat(ini, "crowd", "spacing");
+    crowd.scale = readFloat(ini, "crowd", "scale");
+    crowd.frameRate = readFloat(ini, "crowd", "frameRate");
+
+    if (crowd.instances < 0) {
+        throwConfigError("[crowd] instances must be >= 0");
+    }
+    if (crowd.spacing <= 0.0f || crowd.scale <= 0.0f) {
+        throwConfigError("[crowd] spacing and scale must be > 0");
+    }
+    if (crowd.frameRate <= 0.0f) {
+        throwConfigError("[crowd] frameRate must be > 0");
+    }
+}
+
+void Config::readProbes(const CSimpleIniA& ini, Probes& probes) {
+    probes.enabled = readBool(ini, "probes", "enabled");
+    probes.path = readString(ini, "probes", "path");
+    probes.resolutionX = readInt(ini, "probes", "resolutionX");
+    probes.resolutionY = readInt(ini, "probes", "resolutionY");
+    probes.resolutionZ = readInt(ini, "probes", "resolutionZ");
+    probes.samples = readInt(ini, "probes", "samples");
+    probes.bounces = readInt(ini, "probes", "bounces");
+    probes.shOrder = readInt(ini, "probes", "shOrder");
+
+    if (probes.path.empty()) {
+        throwConfigError("[probes] path must not be empty");
+    }
+    if (probes.resolutionX < 1 || probes.resolutionY < 1 || probes.resolutionZ < 1) {
+        throwConfigError("[probes] resolution must be >= 1 on every axis");
+    }
+    if (probes.samples < 1 || probes.bounces < 0) {
+        throwConfigError("[probes] samples must be >= 1 and bounces >= 0");
+    }
+    if (probes.shOrder != 1 && probes.shOrder != 2) {
+        throwConfigError("[probes] shOrder must be 1 or 2");
+    }
+}
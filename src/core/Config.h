@@ -36,12 +36,174 @@ class Config {
         float interval = 0.25f;
     };
 
+    struct Profiler {
+        bool enabled = false;
+        bool perBatchScopes = false;
+        int averageFrames = 30;
+        bool exportEnabled = false;
+        std::string exportPath = "gpu_profile.csv";
+    };
+
+    struct Capture {
+        int latency = 3;
+        std::string outputDir = "captures";
+        std::string videoPath = "captures/capture.rgba";
+        std::string goldenPath = "captures/golden.png";
+        int tolerance = 2;
+        float maxMismatchPercent = 0.1f;
+        int compareFrame = -1;
+        bool exitAfterCompare = false;
+    };
+
+    struct Shaders {
+        bool binaryCache = true;
+        std::string binaryCacheDir = "shader_cache";
+        bool parallelCompile = true;
+    };
+
+    struct RendererSettings {
+        std::string path = "forward";  // forward or visibility
+        bool positionStream = false;   // Packed position stream for depth-only draws
+    };
+
+    struct Ssao {
+        bool enabled = true;
+        bool halfResolution = true;
+        int samples = 8;
+        float radius = 0.5f;
+        float intensity = 1.0f;
+        int blurRadius = 4;
+    };
+
+    struct AtmosphereSettings {
+        bool enabled = true;
+        int updateFrames = 4;  // Frames a sky-view LUT update after a sun change is spread over
+    };
+
+    struct Minimap {
+        bool enabled = false;
+        int size = 256;        // Pixels per side of the minimap view
+        float height = 80.0f;  // Height of the top-down camera above the main camera
+    };
+
+    struct Meshlets {
+        bool enabled = true;
+        int minTriangles = 2048;
+        bool coneCulling = true;
+    };
+
+    struct VertexAO {
+        bool enabled = false;
+        int samples = 64;
+        float radius = 0.05f;
+        bool cache = true;
+        std::string cacheDir = "mesh_cache";
+    };
+
+    struct Skinning {
+        bool enabled = false;
+        std::string model = "assets/models/character/character.glb";
+        int instances = 64;
+        float spacing = 2.0f;
+        float scale = 1.0f;
+        int animationThreads = 0;  // 0: one per hardware thread
+    };
+
+    struct Crowd {
+        bool enabled = false;
+        std::string model = "assets/models/character/character.glb";
+        int instances = 4096;
+        float spacing = 1.5f;
+        float scale = 1.0f;
+        float frameRate = 30.0f;  // Vertex animation bake rate
+    };
+
+    struct Particles {
+        bool enabled = false;
+        int maxParticles = 1000000;
+        float emitRate = 250000.0f;
+        float lifetime = 4.0f;
+        float posX = 0.0f;
+        float posY = 1.0f;
+        float posZ = 0.0f;
+    };
+
+    struct Terrain {
+        bool enabled = false;
+        float size = 4096.0f;
+        float baseHeight = -50.0f;
+        float heightScale = 300.0f;
+        int gridResolution = 32;
+        int lodLevels = 8;
+        int tilesPerSide = 32;
+        int tileResolution = 129;
+        int maxResidentTiles = 64;
+        int tilesPerFrame = 2;
+        float streamRadius = 512.0f;
+    };
+
+    struct Scatter {
+        int benchmarkInstances = 0;
+        float area = 100.0f;
+        float cellSize = 8.0f;
+        float lodStart = 20.0f;
+        float fadeStart = 60.0f;
+        float fadeEnd = 80.0f;
+        float minDensity = 0.25f;
+    };
+
+    struct Probes {
+        bool enabled = false;
+        std::string path = "probes.bin";
+        int resolutionX = 24;
+        int resolutionY = 12;
+        int resolutionZ = 12;
+        int samples = 512;
+        int bounces = 2;
+        int shOrder = 1;  // 2 also bakes the L2 band, which the runtime does not sample yet
+    };
+
+    struct Frame {
+        bool onDemand = false;
+        float idleTimeout = 0.5f;
+        float backgroundFps = 10.0f;
+    };
+
+    struct SceneSettings {
+        bool staticBatching = false;
+        float chunkSize = 16.0f;
+    };
+
+    struct Assets {
+        bool asyncLoading = true;
+        int loaderThreads = 0;        // 0: one per hardware thread but one
+        float uploadBudgetMs = 2.0f;  // Main-thread time per frame spent creating GL objects of loaded assets
+    };
+
     static Config load(const std::string& path);
 
     const Window& window() const { return m_Window; }
     const Input& input() const { return m_Input; }
     const Camera& camera() const { return m_Camera; }
     const Stats& stats() const { return m_Stats; }
+    const Profiler& profiler() const { return m_Profiler; }
+    const Capture& capture() const { return m_Capture; }
+    const Shaders& shaders() const { return m_Shaders; }
+    const RendererSettings& renderer() const { return m_Renderer; }
+    const Ssao& ssao() const { return m_Ssao; }
+    const AtmosphereSettings& atmosphere() const { return m_Atmosphere; }
+    const Minimap& minimap() const { return m_Minimap; }
+    const Meshlets& meshlets() const { return m_Meshlets; }
+    const VertexAO& vertexAO() const { return m_VertexAO; }
+    const SceneSettings& scene() const { return m_Scene; }
+    const Assets& assets() const { return m_Assets; }
+    const Frame& frame() const { return m_Frame; }
+    const Particles& particles() const { return m_Particles; }
+    const Terrain& terrain() const { return m_Terrain; }
+    const Scatter& scatter() const { return m_Scatter; }
+    const Skinning& skinning() const { return m_Skinning; }
+    const Crowd& crowd() const { return m_Crowd; }
+    const Probes& probes() const { return m_Probes; }
 
    private:
     static const char* requireValue(const CSimpleIniA& ini, const char* section, const char* key);
@@ -54,9 +216,45 @@ class Config {
     static void readInput(const CSimpleIniA& ini, Input& input);
     static void readCamera(const CSimpleIniA& ini, Camera& camera);
     static void readStats(const CSimpleIniA& ini, Stats& stats);
+    static void readProfiler(const CSimpleIniA& ini, Profiler& profiler);
+    static void readCapture(const CSimpleIniA& ini, Capture& capture);
+    static void readShaders(const CSimpleIniA& ini, Shaders& shaders);
+    static void readRenderer(const CSimpleIniA& ini, RendererSettings& renderer);
+    static void readSsao(const CSimpleIniA& ini, Ssao& ssao);
+    static void readAtmosphere(const CSimpleIniA& ini, AtmosphereSettings& atmosphere);
+    static void readMinimap(const CSimpleIniA& ini, Minimap& minimap);
+    static void readMeshlets(const CSimpleIniA& ini, Meshlets& meshlets);
+    static void readVertexAO(const CSimpleIniA& ini, VertexAO& vertexAO);
+    static void readScene(const CSimpleIniA& ini, SceneSettings& scene);
+    static void readAssets(const CSimpleIniA& ini, Assets& assets);
+    static void readFrame(const CSimpleIniA& ini, Frame& frame);
+    static void readParticles(const CSimpleIniA& ini, Particles& particles);
+    static void readTerrain(const CSimpleIniA& ini, Terrain& terrain);
+    static void readScatter(const CSimpleIniA& ini, Scatter& scatter);
+    static void readSkinning(const CSimpleIniA& ini, Skinning& skinning);
+    static void readCrowd(const CSimpleIniA& ini, Crowd& crowd);
+    static void readProbes(const CSimpleIniA& ini, Probes& probes);
 
     Window m_Window;
     Input m_Input;
     Camera m_Camera;
     Stats m_Stats;
+    Profiler m_Profiler;
+    Capture m_Capture;
+    Shaders m_Shaders;
+    RendererSettings m_Renderer;
+    Ssao m_Ssao;
+    AtmosphereSettings m_Atmosphere;
+    Minimap m_Minimap;
+    Meshlets m_Meshlets;
+    VertexAO m_VertexAO;
+    SceneSettings m_Scene;
+    Assets m_Assets;
+    Frame m_Frame;
+    Particles m_Particles;
+    Terrain m_Terrain;
+    Scatter m_Scatter;
+    Skinning m_Skinning;
+    Crowd m_Crowd;
+    Probes m_Probes;
 };
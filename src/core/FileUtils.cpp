@@ -0,0 +1,30 @@
+#include "FileUtils.h"
+
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+bool writeFileAtomic(const std::string& path, std::initializer_list<FileChunk> chunks) {
+    std::string tempPath = path + ".tmp";
+    std::error_code error;
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            return false;
+        }
+        for (const auto& chunk : chunks) {
+            file.write(static_cast<const char*>(chunk.data), static_cast<std::streamsize>(chunk.size));
+        }
+        if (!file) {
+            file.close();
+            std::filesystem::remove(tempPath, error);
+            return false;
+        }
+    }
+    std::filesystem::rename(tempPath, path, error);
+    if (error) {
+        std::filesystem::remove(tempPath, error);
+        return false;
+    }
+    return true;
+}
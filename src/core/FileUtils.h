@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstddef>
+#include <initializer_list>
+#include <string>
+
+struct FileChunk {
+    const void* data;
+    size_t size;
+};
+
+// Writes `chunks` back to back to a temporary file next to `path` and renames it into place,
+// so a crash or a full disk never leaves a truncated file behind. False if nothing was written.
+bool writeFileAtomic(const std::string& path, std::initializer_list<FileChunk> chunks);
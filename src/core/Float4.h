@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FLOAT4_SSE 1
+#include <xmmintrin.h>
+#endif
+
+// Four float lanes backed by SSE, with a scalar fallback on targets without it.
+// Comparisons return lane masks usable with operator& and select().
+struct Float4 {
+#ifdef FLOAT4_SSE
+    __m128 v;
+
+    // load/store need 16-byte aligned pointers
+    static Float4 load(const float* p) { return {_mm_load_ps(p)}; }
+    static Float4 splat(float f) { return {_mm_set1_ps(f)}; }
+    static Float4 set(float a, float b, float c, float d) { return {_mm_setr_ps(a, b, c, d)}; }
+    // Lanes of `a` where `mask` is set, `b` elsewhere
+    static Float4 select(Float4 mask, Float4 a, Float4 b) {
+        return {_mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v))};
+    }
+    void store(float* p) const { _mm_store_ps(p, v); }
+    Float4 operator+(Float4 o) const { return {_mm_add_ps(v, o.v)}; }
+    Float4 operator-(Float4 o) const { return {_mm_sub_ps(v, o.v)}; }
+    Float4 operator*(Float4 o) const { return {_mm_mul_ps(v, o.v)}; }
+    Float4 operator/(Float4 o) const { return {_mm_div_ps(v, o.v)}; }
+    Float4 operator-() const { return {_mm_xor_ps(v, _mm_set1_ps(-0.0f))}; }
+    Float4 operator&(Float4 o) const { return {_mm_and_ps(v, o.v)}; }
+    Float4 operator<(Float4 o) const { return {_mm_cmplt_ps(v, o.v)}; }
+    Float4 operator<=(Float4 o) const { return {_mm_cmple_ps(v, o.v)}; }
+    Float4 operator>(Float4 o) const { return {_mm_cmpgt_ps(v, o.v)}; }
+    Float4 operator>=(Float4 o) const { return {_mm_cmpge_ps(v, o.v)}; }
+    Float4 abs() const { return {_mm_andnot_ps(_mm_set1_ps(-0.0f), v)}; }
+    Float4 sqrt() const { return {_mm_sqrt_ps(v)}; }
+    Float4 reciprocal() const { return {_mm_div_ps(_mm_set1_ps(1.0f), v)}; }
+    int mask() const { return _mm_movemask_ps(v); }
+    friend Float4 min(Float4 a, Float4 b) { return {_mm_min_ps(a.v, b.v)}; }
+    friend Float4 max(Float4 a, Float4 b) { return {_mm_max_ps(a.v, b.v)}; }
+#else
+    float v[4];
+
+    template <typename Op>
+    static Float4 map(const Float4& a, const Float4& b, Op op) {
+        return {{op(a.v[0], b.v[0]), op(a.v[1], b.v[1]), op(a.v[2], b.v[2]), op(a.v[3], b.v[3])}};
+    }
+    static float lane(bool b) { return b ? 1.0f : 0.0f; }
+
+    static Float4 load(const float* p) { return {{p[0], p[1], p[2], p[3]}}; }
+    static Float4 splat(float f) { return {{f, f, f, f}}; }
+    static Float4 set(float a, float b, float c, float d) { return {{a, b, c, d}}; }
+    static Float4 select(Float4 mask, Float4 a, Float4 b) {
+        return {{mask.v[0] != 0.0f ? a.v[0] : b.v[0], mask.v[1] != 0.0f ? a.v[1] : b.v[1],
+                 mask.v[2] != 0.0f ? a.v[2] : b.v[2], mask.v[3] != 0.0f ? a.v[3] : b.v[3]}};
+    }
+    void store(float* p) const { p[0] = v[0], p[1] = v[1], p[2] = v[2], p[3] = v[3]; }
+    Float4 operator+(Float4 o) const { return map(*this, o, [](float a, float b) { return a + b; }); }
+    Float4 operator-(Float4 o) const { return map(*this, o, [](float a, float b) { return a - b; }); }
+    Float4 operator*(Float4 o) const { return map(*this, o, [](float a, float b) { return a * b; }); }
+    Float4 operator/(Float4 o) const { return map(*this, o, [](float a, float b) { return a / b; }); }
+    Float4 operator-() const { return {{-v[0], -v[1], -v[2], -v[3]}}; }
+    Float4 operator&(Float4 o) const { return map(*this, o, [](float a, float b) { return lane(a != 0.0f && b != 0.0f); }); }
+    Float4 operator<(Float4 o) const { return map(*this, o, [](float a, float b) { return lane(a < b); }); }
+    Float4 operator<=(Float4 o) const { return map(*this, o, [](float a, float b) { return lane(a <= b); }); }
+    Float4 operator>(Float4 o) const { return map(*this, o, [](float a, float b) { return lane(a > b); }); }
+    Float4 operator>=(Float4 o) const { return map(*this, o, [](float a, float b) { return lane(a >= b); }); }
+    Float4 abs() const { return {{std::abs(v[0]), std::abs(v[1]), std::abs(v[2]), std::abs(v[3])}}; }
+    Float4 sqrt() const { return {{std::sqrt(v[0]), std::sqrt(v[1]), std::sqrt(v[2]), std::sqrt(v[3])}}; }
+    Float4 reciprocal() const { return {{1.0f / v[0], 1.0f / v[1], 1.0f / v[2], 1.0f / v[3]}}; }
+    int mask() const {
+        return (v[0] != 0.0f ? 1 : 0) | (v[1] != 0.0f ? 2 : 0) | (v[2] != 0.0f ? 4 : 0) | (v[3] != 0.0f ? 8 : 0);
+    }
+    // Same operand order as minps/maxps: the second operand wins on NaN
+    friend Float4 min(Float4 a, Float4 b) { return map(a, b, [](float x, float y) { return x < y ? x : y; }); }
+    friend Float4 max(Float4 a, Float4 b) { return map(a, b, [](float x, float y) { return x > y ? x : y; }); }
+#endif
+};
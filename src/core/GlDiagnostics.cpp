@@ -0,0 +1,132 @@
+#include "GlDiagnostics.h"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+const char* glSeverityName(unsigned int severity) {
+    switch (severity) {
+        case GL_DEBUG_SEVERITY_HIGH:
+            return "HIGH";
+        case GL_DEBUG_SEVERITY_MEDIUM:
+            return "MEDIUM";
+        case GL_DEBUG_SEVERITY_LOW:
+            return "LOW";
+        case GL_DEBUG_SEVERITY_NOTIFICATION:
+            return "NOTIFY";
+        default:
+            return "UNKNOWN";
+    }
+}
+
+const char* glTypeName(unsigned int type) {
+    switch (type) {
+        case GL_DEBUG_TYPE_ERROR:
+            return "error";
+        case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR:
+            return "deprecated";
+        case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR:
+            return "undefined behavior";
+        case GL_DEBUG_TYPE_PORTABILITY:
+            return "portability";
+        case GL_DEBUG_TYPE_PERFORMANCE:
+            return "performance";
+        default:
+            return "other";
+    }
+}
+
+uint64_t messageKey(unsigned int source, unsigned int type, unsigned int id) {
+    // GL source and type enums fit in 16 bits
+    return (static_cast<uint64_t>(source & 0xFFFF) << 48) |
+           (static_cast<uint64_t>(type & 0xFFFF) << 32) |
+           static_cast<uint64_t>(id);
+}
+}
+
+GlDiagnostics::GlDiagnostics() {
+    for (size_t i = 0; i < kCapacity; ++i) {
+        m_Ring[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+// Bounded MPSC queue: a producer claims a slot by advancing the write index only if the
+// slot's sequence shows the consumer has released it, so a full ring drops instead of waiting.
+void GlDiagnostics::push(unsigned int source, unsigned int type, unsigned int id,
+                         unsigned int severity, int length, const char* message) {
+    if (severity == GL_DEBUG_SEVERITY_NOTIFICATION && !m_Notifications.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    size_t index = m_WriteIndex.load(std::memory_order_relaxed);
+    Message* slot = nullptr;
+    while (true) {
+        slot = &m_Ring[index % kCapacity];
+        size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        if (sequence == index) {
+            if (m_WriteIndex.compare_exchange_weak(index, index + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (sequence < index) {
+            m_Dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        } else {
+            index = m_WriteIndex.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->source = source;
+    slot->type = type;
+    slot->id = id;
+    slot->severity = severity;
+    size_t textLength = message ? (length >= 0 ? static_cast<size_t>(length) : std::strlen(message)) : 0;
+    textLength = std::min(textLength, kMaxMessageLength - 1);
+    if (textLength > 0) {
+        std::memcpy(slot->text, message, textLength);
+    }
+    slot->text[textLength] = '\0';
+    slot->sequence.store(index + 1, std::memory_order_release);
+}
+
+void GlDiagnostics::drain() {
+    std::string fatal;
+    while (true) {
+        Message& slot = m_Ring[m_ReadIndex % kCapacity];
+        if (slot.sequence.load(std::memory_order_acquire) != m_ReadIndex + 1) {
+            break;
+        }
+        record(slot);
+        if (slot.type == GL_DEBUG_TYPE_ERROR && fatal.empty()) {
+            fatal = std::string("OpenGL ") + glSeverityName(slot.severity) +
+                    " error (" + std::to_string(slot.id) + "): " + slot.text;
+        }
+        slot.sequence.store(m_ReadIndex + kCapacity, std::memory_order_release);
+        ++m_ReadIndex;
+    }
+    m_Counters.dropped = m_Dropped.load(std::memory_order_relaxed);
+
+    if (!fatal.empty()) {
+        throw std::runtime_error(fatal);
+    }
+}
+
+void GlDiagnostics::record(const Message& message) {
+    if (message.type == GL_DEBUG_TYPE_ERROR) {
+        m_Counters.errors++;
+    } else if (message.type == GL_DEBUG_TYPE_PERFORMANCE) {
+        m_Counters.performance++;
+    } else {
+        m_Counters.other++;
+    }
+
+    Entry& entry = m_Entries[messageKey(message.source, message.type, message.id)];
+    if (entry.count++ == 0) {
+        m_Counters.unique++;
+        std::cerr << "OpenGL " << glSeverityName(message.severity) << " " << glTypeName(message.type)
+                  << " (" << message.id << "): " << message.text << std::endl;
+    }
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+// Asynchronous KHR_debug sink. The driver callback may run on any driver thread, so it only
+// copies the message into a bounded lock-free ring (multi-producer, single-consumer). The
+// main thread drains the ring once per frame, de-duplicates by source/type/id, keeps
+// counters, logs each distinct message once and throws only for GL_DEBUG_TYPE_ERROR.
+class GlDiagnostics {
+   public:
+    struct Counters {
+        unsigned int errors = 0;
+        unsigned int performance = 0;
+        unsigned int other = 0;
+        unsigned int unique = 0;
+        unsigned int dropped = 0;
+    };
+
+    GlDiagnostics();
+
+    GlDiagnostics(const GlDiagnostics&) = delete;
+    GlDiagnostics& operator=(const GlDiagnostics&) = delete;
+
+    void setNotifications(bool enabled) { m_Notifications.store(enabled, std::memory_order_relaxed); }
+
+    // Called from the GL debug callback, never blocks or allocates
+    void push(unsigned int source, unsigned int type, unsigned int id,
+              unsigned int severity, int length, const char* message);
+    // Main thread only
+    void drain();
+
+    const Counters& getCounters() const { return m_Counters; }
+
+   private:
+    static constexpr size_t kCapacity = 256;
+    static constexpr size_t kMaxMessageLength = 256;
+
+    struct Message {
+        std::atomic<size_t> sequence{0};
+        unsigned int source = 0;
+        unsigned int type = 0;
+        unsigned int id = 0;
+        unsigned int severity = 0;
+        char text[kMaxMessageLength] = {};
+    };
+
+    struct Entry {
+        unsigned int count = 0;
+    };
+
+    void record(const Message& message);
+
+    std::array<Message, kCapacity> m_Ring;
+    std::atomic<size_t> m_WriteIndex{0};
+    size_t m_ReadIndex = 0;
+    std::atomic<unsigned int> m_Dropped{0};
+    std::atomic<bool> m_Notifications{false};
+
+    std::unordered_map<uint64_t, Entry> m_Entries;
+    Counters m_Counters;
+};
@@ -7,24 +7,15 @@
 
 #include "EventBus.h"
 
-void windowGlDebugCallback(unsigned int source, unsigned int type,
-                           unsigned int id, unsigned int severity,
-                           int length, const char* message, const void* userParam);
-
 namespace {
-std::string glSeverityName(unsigned int severity) {
-    switch (severity) {
-        case GL_DEBUG_SEVERITY_HIGH:
-            return "HIGH";
-        case GL_DEBUG_SEVERITY_MEDIUM:
-            return "MEDIUM";
-        case GL_DEBUG_SEVERITY_LOW:
-            return "LOW";
-        case GL_DEBUG_SEVERITY_NOTIFICATION:
-            return "NOTIFY";
-        default:
-            return "UNKNOWN";
+// May run on a driver thread: hand the message to the lock-free diagnostics ring and return
+void APIENTRY glDebugCallback(GLenum source, GLenum type, GLuint id, GLenum severity,
+                              GLsizei length, const GLchar* message, const void* userParam) {
+    auto* diagnostics = static_cast<GlDiagnostics*>(const_cast<void*>(userParam));
+    if (!diagnostics || !message) {
+        return;
     }
+    diagnostics->push(source, type, id, severity, length, message);
 }
 
 void framebufferSizeCallback(GLFWwindow* window, int width, int height) {
@@ -123,7 +114,9 @@ void Window::setupGlfwHints() {
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
     glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
-    glfwWindowHint(GLFW_SAMPLES, 4);
+    // The scene renders into single-sampled offscreen targets that are blitted to the back buffer,
+    // which is not allowed into a multisampled default framebuffer
+    glfwWindowHint(GLFW_SAMPLES, 0);
 }
 
 void Window::createWindow(int width, int height, const std::string& title) {
@@ -143,8 +136,9 @@ void Window::initGlad() {
 
 void Window::setupGlDebug() {
     glEnable(GL_DEBUG_OUTPUT);
-    glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
-    glDebugMessageCallback(windowGlDebugCallback, this);
+    // Asynchronous output keeps the driver free to batch work, messages are drained once per frame
+    glDisable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+    glDebugMessageCallback(glDebugCallback, &m_GlDiagnostics);
     setGlDebugNotifications(false);
 }
 
@@ -183,6 +177,8 @@ Window::~Window() {
 }
 
 void Window::pollEvents() const { glfwPollEvents(); }
+void Window::waitEvents(double timeout) const { glfwWaitEventsTimeout(timeout); }
+bool Window::isMinimized() const { return glfwGetWindowAttrib(m_Window, GLFW_ICONIFIED) != 0; }
 void Window::swapBuffers() const { glfwSwapBuffers(m_Window); }
 bool Window::shouldClose() const { return glfwWindowShouldClose(m_Window); }
 void Window::onFramebufferResize(int width, int height) {
@@ -284,29 +280,8 @@ void Window::setVsync(bool enabled) {
 }
 
 void Window::setGlDebugNotifications(bool enabled) {
-    m_GlDebugNotifications = enabled;
+    m_GlDiagnostics.setNotifications(enabled);
     glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE,
                           GL_DEBUG_SEVERITY_NOTIFICATION, 0, nullptr,
                           enabled ? GL_TRUE : GL_FALSE);
 }
-
-void windowGlDebugCallback(unsigned int source, unsigned int type,
-                           unsigned int id, unsigned int severity,
-                           int length, const char* message, const void* userParam) {
-    (void)source;
-    (void)type;
-    (void)length;
-
-    auto* window = static_cast<Window*>(const_cast<void*>(userParam));
-    if (!window || !message) {
-        return;
-    }
-
-    if (severity == GL_DEBUG_SEVERITY_NOTIFICATION && !window->m_GlDebugNotifications) {
-        return;
-    }
-
-    std::string text = std::string("OpenGL ") + glSeverityName(severity) +
-                       " error (" + std::to_string(id) + "): " + message;
-    throw std::runtime_error(text);
-}
@@ -3,6 +3,8 @@
 
 #include <string>
 
+#include "GlDiagnostics.h"
+
 class EventBus;
 
 class Window {
@@ -11,6 +13,9 @@ class Window {
     ~Window();
 
     void pollEvents() const;
+    // Blocks until an event arrives or the timeout (seconds) elapses
+    void waitEvents(double timeout) const;
+    bool isMinimized() const;
     void swapBuffers() const;
     bool shouldClose() const;
     void toggleFullscreen();
@@ -24,13 +29,11 @@ class Window {
     const std::string& baseTitle() const { return m_BaseTitle; }
     void setVsync(bool enabled);
     void setGlDebugNotifications(bool enabled);
+    GlDiagnostics& glDiagnostics() { return m_GlDiagnostics; }
 
     GLFWwindow* native() const { return m_Window; }
 
    private:
-    friend void windowGlDebugCallback(unsigned int source, unsigned int type,
-                                      unsigned int id, unsigned int severity,
-                                      int length, const char* message, const void* userParam);
     void initGlfw();
     void setupGlfwHints();
     void createWindow(int width, int height, const std::string& title);
@@ -50,5 +53,5 @@ class Window {
     std::string m_BaseTitle;
     int m_LastFramebufferWidth = 0;
     int m_LastFramebufferHeight = 0;
-    bool m_GlDebugNotifications = false;
+    GlDiagnostics m_GlDiagnostics;
 };
@@ -0,0 +1,101 @@
+#include "WorkerPool.h"
+
+#include <algorithm>
+
+namespace {
+// Chunks per thread, so uneven items still balance without one atomic per item
+const size_t kChunksPerThread = 4;
+}
+
+WorkerPool::WorkerPool(unsigned int threads) {
+    unsigned int count = threads > 0 ? threads : std::max(1u, std::thread::hardware_concurrency());
+    m_Workers.reserve(count - 1);
+    for (unsigned int i = 1; i < count; ++i) {
+        m_Workers.emplace_back([this]() { workerLoop(); });
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Running = false;
+    }
+    m_WorkReady.notify_all();
+    for (auto& worker : m_Workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+void WorkerPool::parallelFor(size_t count, const std::function<void(size_t, size_t)>& fn) {
+    if (count == 0) {
+        return;
+    }
+    if (m_Workers.empty() || count == 1) {
+        fn(0, count);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Job = &fn;
+        m_Count = count;
+        m_ChunkSize = std::max<size_t>(1, count / (getThreadCount() * kChunksPerThread));
+        m_NextChunk.store(0, std::memory_order_relaxed);
+        m_Busy = static_cast<unsigned int>(m_Workers.size());
+        m_Error = nullptr;
+        ++m_Generation;
+    }
+    m_WorkReady.notify_all();
+    runChunks();
+
+    std::exception_ptr error;
+    {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_WorkDone.wait(lock, [this]() { return m_Busy == 0; });
+        m_Job = nullptr;
+        error = m_Error;
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void WorkerPool::workerLoop() {
+    uint64_t seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_WorkReady.wait(lock, [&]() { return m_Generation != seen || !m_Running; });
+            if (!m_Running) {
+                break;
+            }
+            seen = m_Generation;
+        }
+
+        runChunks();
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (--m_Busy == 0) {
+            m_WorkDone.notify_one();
+        }
+    }
+}
+
+void WorkerPool::runChunks() {
+    while (true) {
+        size_t begin = m_NextChunk.fetch_add(1, std::memory_order_relaxed) * m_ChunkSize;
+        if (begin >= m_Count) {
+            return;
+        }
+        try {
+            (*m_Job)(begin, std::min(begin + m_ChunkSize, m_Count));
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            if (!m_Error) {
+                m_Error = std::current_exception();
+            }
+        }
+    }
+}
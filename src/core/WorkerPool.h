@@ -0,0 +1,45 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Persistent worker threads for per-frame data-parallel loops. The calling thread joins in
+// on every loop, so a pool of one thread runs everything inline.
+class WorkerPool {
+   public:
+    // 0 uses one thread per hardware thread, counting the caller
+    explicit WorkerPool(unsigned int threads = 0);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    unsigned int getThreadCount() const { return static_cast<unsigned int>(m_Workers.size()) + 1; }
+
+    // Splits [0, count) into chunks and calls fn(begin, end) for each across the pool, returning
+    // once all chunks are done. The first exception thrown by fn is rethrown here.
+    void parallelFor(size_t count, const std::function<void(size_t, size_t)>& fn);
+
+   private:
+    void workerLoop();
+    void runChunks();
+
+    std::vector<std::thread> m_Workers;
+    std::mutex m_Mutex;
+    std::condition_variable m_WorkReady;
+    std::condition_variable m_WorkDone;
+    const std::function<void(size_t, size_t)>* m_Job = nullptr;
+    size_t m_Count = 0;
+    size_t m_ChunkSize = 1;
+    std::atomic<size_t> m_NextChunk{0};
+    uint64_t m_Generation = 0;
+    unsigned int m_Busy = 0;
+    bool m_Running = true;
+    std::exception_ptr m_Error;
+};
@@ -3,5 +3,5 @@
 int main() {
     Application app;
     app.run();
-    return 0;
+    return app.exitCode();
 }
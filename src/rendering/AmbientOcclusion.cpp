@@ -0,0 +1,100 @@
+#include "AmbientOcclusion.h"
+
+#include "assets/Shader.h"
+
+namespace {
+const GLuint kGroupSize = 8;
+
+GLuint groupCount(int size) {
+    return (static_cast<GLuint>(size) + kGroupSize - 1) / kGroupSize;
+}
+}
+
+AmbientOcclusion::AmbientOcclusion() = default;
+AmbientOcclusion::~AmbientOcclusion() = default;
+
+void AmbientOcclusion::loadShaders() {
+    m_DepthShader = std::make_unique<Shader>("assets/shaders/ssao_depth");
+    m_OcclusionShader = std::make_unique<Shader>("assets/shaders/ssao");
+    m_BlurShader = std::make_unique<Shader>("assets/shaders/ssao_blur");
+    m_ApplyShader = std::make_unique<Shader>("assets/shaders/fullscreen.vert", "assets/shaders/ssao_apply.frag");
+}
+
+void AmbientOcclusion::ensureTargets(int width, int height) {
+    m_Scale = m_Settings.halfResolution ? 2 : 1;
+    int aoWidth = (width + m_Scale - 1) / m_Scale;
+    int aoHeight = (height + m_Scale - 1) / m_Scale;
+    if (m_LinearDepth && m_LinearDepth->width() == aoWidth && m_LinearDepth->height() == aoHeight) {
+        return;
+    }
+    m_LinearDepth = std::make_unique<RenderTexture>(aoWidth, aoHeight, GL_R32F);
+    m_Occlusion = std::make_unique<RenderTexture>(aoWidth, aoHeight, GL_R8);
+    m_BlurScratch = std::make_unique<RenderTexture>(aoWidth, aoHeight, GL_R8);
+}
+
+void AmbientOcclusion::compute(const RenderTexture& sceneDepth, const glm::mat4& projection) {
+    ensureTargets(sceneDepth.width(), sceneDepth.height());
+    int width = m_LinearDepth->width();
+    int height = m_LinearDepth->height();
+    // Linear view depth is projection[3][2] / (ndcDepth + projection[2][2]) for a perspective projection
+    m_DepthParams = glm::vec2(projection[3][2], projection[2][2]);
+
+    m_DepthShader->bind();
+    sceneDepth.bind(0);
+    m_DepthShader->setInt("u_SceneDepth", 0);
+    m_DepthShader->setInt("u_Scale", m_Scale);
+    m_DepthShader->setVec2("u_DepthParams", &m_DepthParams[0]);
+    glBindImageTexture(0, m_LinearDepth->id(), 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+    glDispatchCompute(groupCount(width), groupCount(height), 1);
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+
+    glm::vec2 invProjScale(1.0f / projection[0][0], 1.0f / projection[1][1]);
+    m_OcclusionShader->bind();
+    m_LinearDepth->bind(0);
+    m_OcclusionShader->setInt("u_LinearDepth", 0);
+    m_OcclusionShader->setVec2("u_InvProjScale", &invProjScale[0]);
+    m_OcclusionShader->setFloat("u_PixelsPerUnit", projection[1][1] * 0.5f * static_cast<float>(height));
+    // Cleared depth (1.0) linearizes to the far plane
+    m_OcclusionShader->setFloat("u_FarDepth", 0.999f * m_DepthParams.x / (1.0f + m_DepthParams.y));
+    m_OcclusionShader->setFloat("u_Radius", m_Settings.radius);
+    m_OcclusionShader->setFloat("u_Intensity", m_Settings.intensity);
+    m_OcclusionShader->setInt("u_SampleCount", m_Settings.samples);
+    glBindImageTexture(0, m_Occlusion->id(), 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R8);
+    glDispatchCompute(groupCount(width), groupCount(height), 1);
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+
+    if (m_Settings.blurRadius > 0) {
+        blur(*m_Occlusion, *m_BlurScratch, 0);
+        blur(*m_BlurScratch, *m_Occlusion, 1);
+    }
+}
+
+void AmbientOcclusion::blur(const RenderTexture& input, const RenderTexture& output, int axis) const {
+    m_BlurShader->bind();
+    input.bind(0);
+    m_LinearDepth->bind(1);
+    m_BlurShader->setInt("u_Input", 0);
+    m_BlurShader->setInt("u_LinearDepth", 1);
+    m_BlurShader->setInt("u_Axis", axis);
+    m_BlurShader->setInt("u_BlurRadius", m_Settings.blurRadius);
+    glBindImageTexture(0, output.id(), 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R8);
+    glDispatchCompute(groupCount(output.width()), groupCount(output.height()), 1);
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+}
+
+void AmbientOcclusion::apply(const RenderTexture& sceneDepth, const RenderTexture& ambient) const {
+    m_ApplyShader->bind();
+    m_Occlusion->bind(0);
+    m_LinearDepth->bind(1);
+    sceneDepth.bind(2);
+    ambient.bind(3);
+    m_ApplyShader->setInt("u_Occlusion", 0);
+    m_ApplyShader->setInt("u_LinearDepth", 1);
+    m_ApplyShader->setInt("u_SceneDepth", 2);
+    m_ApplyShader->setInt("u_Ambient", 3);
+    m_ApplyShader->setVec2("u_DepthParams", &m_DepthParams[0]);
+
+    m_FullscreenVao.bind();
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    VertexArray::unbind();
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+#include <memory>
+
+#include "RenderTexture.h"
+#include "VertexArray.h"
+
+class Shader;
+
+// Screen-space ambient occlusion at full or half resolution. A downsample pass turns scene
+// depth into linear view depth, an obscurance pass samples a spiral around every AO pixel
+// with a 4x4 interleaved rotation pattern, and a separable bilateral blur removes the
+// pattern. apply() upsamples the result depth-aware and takes the occluded share of the
+// opaque pass's ambient term out of scene color.
+class AmbientOcclusion {
+   public:
+    struct Settings {
+        bool enabled = false;
+        bool halfResolution = true;
+        int samples = 8;
+        float radius = 0.5f;  // World units
+        float intensity = 1.0f;
+        int blurRadius = 4;  // AO pixels on each side, 0 disables the blur
+    };
+
+    AmbientOcclusion();
+    ~AmbientOcclusion();
+
+    AmbientOcclusion(const AmbientOcclusion&) = delete;
+    AmbientOcclusion& operator=(const AmbientOcclusion&) = delete;
+
+    void loadShaders();
+    void configure(const Settings& settings) { m_Settings = settings; }
+    const Settings& getSettings() const { return m_Settings; }
+    bool isEnabled() const { return m_Settings.enabled; }
+
+    // Occlusion for `sceneDepth` rendered with `projection`; targets follow its size
+    void compute(const RenderTexture& sceneDepth, const glm::mat4& projection);
+    // Full-screen draw into the bound target, which must blend with GL_FUNC_REVERSE_SUBTRACT
+    void apply(const RenderTexture& sceneDepth, const RenderTexture& ambient) const;
+
+   private:
+    void ensureTargets(int width, int height);
+    void blur(const RenderTexture& input, const RenderTexture& output, int axis) const;
+
+    Settings m_Settings;
+    std::unique_ptr<Shader> m_DepthShader;
+    std::unique_ptr<Shader> m_OcclusionShader;
+    std::unique_ptr<Shader> m_BlurShader;
+    std::unique_ptr<Shader> m_ApplyShader;
+    std::unique_ptr<RenderTexture> m_LinearDepth;
+    std::unique_ptr<RenderTexture> m_Occlusion;
+    std::unique_ptr<RenderTexture> m_BlurScratch;
+    int m_Scale = 2;
+    glm::vec2 m_DepthParams{0.0f};
+    VertexArray m_FullscreenVao;
+};
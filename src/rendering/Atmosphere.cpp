@@ -0,0 +1,182 @@
+#include "Atmosphere.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "assets/Shader.h"
+
+namespace {
+const GLuint kGroupSize = 8;
+const int kTransmittanceWidth = 256;
+const int kTransmittanceHeight = 64;
+const int kMultiScatteringSize = 32;
+const int kSkyViewWidth = 192;
+const int kSkyViewHeight = 108;
+// Kilometers from the planet center; the scenes span a few hundred meters, so the viewer
+// stays at a fixed altitude and only the sun invalidates the sky-view LUT
+const float kViewHeight = 6360.0f + 0.2f;
+// Below this cosine between the latched and the current sun a new update starts
+const float kSunChangeCos = 0.99999f;
+
+GLuint groupCount(int size) {
+    return (static_cast<GLuint>(size) + kGroupSize - 1) / kGroupSize;
+}
+
+// The LUTs are sampled between texels
+std::unique_ptr<RenderTexture> createLut(int width, int height, GLenum format) {
+    auto lut = std::make_unique<RenderTexture>(width, height, format);
+    glTextureParameteri(lut->id(), GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTextureParameteri(lut->id(), GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    return lut;
+}
+
+struct LightingData {
+    glm::vec4 sunTransmittance;
+    glm::vec4 skyAmbient;
+};
+}
+
+Atmosphere::Atmosphere() = default;
+Atmosphere::~Atmosphere() = default;
+
+void Atmosphere::loadShaders() {
+    m_TransmittanceShader = std::make_unique<Shader>("assets/shaders/sky_transmittance");
+    m_MultiScatteringShader = std::make_unique<Shader>("assets/shaders/sky_multiscattering");
+    m_SkyViewShader = std::make_unique<Shader>("assets/shaders/fullscreen.vert", "assets/shaders/sky_view.frag");
+    m_LightingShader = std::make_unique<Shader>("assets/shaders/sky_lighting");
+    m_SkyShader = std::make_unique<Shader>("assets/shaders/sky");
+}
+
+void Atmosphere::computeStaticLuts() {
+    m_Transmittance = createLut(kTransmittanceWidth, kTransmittanceHeight, GL_RGBA16F);
+    m_MultiScattering = createLut(kMultiScatteringSize, kMultiScatteringSize, GL_RGBA16F);
+    for (int i = 0; i < 2; ++i) {
+        m_SkyView[i] = createLut(kSkyViewWidth, kSkyViewHeight, GL_R11F_G11F_B10F);
+        m_SkyViewFbo[i].attachTexture(GL_COLOR_ATTACHMENT0, m_SkyView[i]->id());
+        m_SkyViewFbo[i].setDrawBuffers({GL_COLOR_ATTACHMENT0});
+        m_SkyViewFbo[i].validate("sky view");
+    }
+    m_LightingBuffer.setData(sizeof(LightingData), nullptr, GL_DYNAMIC_COPY);
+
+    m_TransmittanceShader->bind();
+    glBindImageTexture(0, m_Transmittance->id(), 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+    glDispatchCompute(groupCount(kTransmittanceWidth), groupCount(kTransmittanceHeight), 1);
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+
+    m_MultiScatteringShader->bind();
+    m_Transmittance->bind(0);
+    m_MultiScatteringShader->setInt("u_Transmittance", 0);
+    glBindImageTexture(0, m_MultiScattering->id(), 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+    glDispatchCompute(groupCount(kMultiScatteringSize), groupCount(kMultiScatteringSize), 1);
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+}
+
+void Atmosphere::update(const glm::vec3& sunDirection) {
+    if (!m_Transmittance) {
+        computeStaticLuts();
+    }
+
+    glm::vec3 direction = glm::normalize(sunDirection);
+    if (!m_Updating) {
+        // The direction is latched for a whole update, a moving sun is caught up by the next one
+        if (m_SkyViewReady && glm::dot(direction, m_FrontDirection) >= kSunChangeCos) {
+            return;
+        }
+        m_Updating = true;
+        m_UpdateDirection = direction;
+        m_NextRow = 0;
+    }
+
+    // The first LUT has nothing to show in the meantime and is rendered at once
+    int updateFrames = m_SkyViewReady ? std::max(m_Settings.updateFrames, 1) : 1;
+    int rowsPerFrame = (kSkyViewHeight + updateFrames - 1) / updateFrames;
+    int rowCount = std::min(rowsPerFrame, kSkyViewHeight - m_NextRow);
+    int back = 1 - m_Front;
+    renderSkyViewRows(back, m_NextRow, rowCount);
+    m_NextRow += rowCount;
+    if (m_NextRow < kSkyViewHeight) {
+        return;
+    }
+
+    m_Front = back;
+    m_FrontDirection = m_UpdateDirection;
+    m_SkyViewReady = true;
+    m_Updating = false;
+    computeLighting();
+}
+
+// A full-screen triangle over the LUT, scissored to the rows of this frame's slice
+void Atmosphere::renderSkyViewRows(int target, int firstRow, int rowCount) {
+    m_SkyViewFbo[target].bind();
+    glViewport(0, 0, kSkyViewWidth, kSkyViewHeight);
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_CULL_FACE);
+    glDisable(GL_BLEND);
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    glEnable(GL_SCISSOR_TEST);
+    glScissor(0, firstRow, kSkyViewWidth, rowCount);
+
+    m_SkyViewShader->bind();
+    m_Transmittance->bind(0);
+    m_MultiScattering->bind(1);
+    m_SkyViewShader->setInt("u_Transmittance", 0);
+    m_SkyViewShader->setInt("u_MultiScattering", 1);
+    m_SkyViewShader->setVec3("u_SunDirection", &m_UpdateDirection[0]);
+    m_SkyViewShader->setFloat("u_ViewHeight", kViewHeight);
+
+    m_FullscreenVao.bind();
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    VertexArray::unbind();
+    glDisable(GL_SCISSOR_TEST);
+}
+
+void Atmosphere::bindLookups(const Shader& shader, const RenderTexture& skyView) const {
+    skyView.bind(0);
+    m_Transmittance->bind(1);
+    shader.setInt("u_SkyView", 0);
+    shader.setInt("u_Transmittance", 1);
+    shader.setVec3("u_SunDirection", &m_FrontDirection[0]);
+    shader.setFloat("u_ViewHeight", kViewHeight);
+}
+
+// Reduces the new front LUT to sun transmittance and ambient, read back a few frames late
+void Atmosphere::computeLighting() {
+    m_LightingShader->bind();
+    bindLookups(*m_LightingShader, *m_SkyView[m_Front]);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_LightingBuffer.id());
+    glDispatchCompute(1, 1, 1);
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+    // A dropped request leaves the previous values until the sun moves again
+    if (m_LightingReadback.request(m_LightingBuffer.id(), 0, sizeof(LightingData))) {
+        ++m_LightingInFlight;
+    }
+}
+
+void Atmosphere::endFrame() {
+    while (m_LightingReadback.poll(m_ReadbackData)) {
+        --m_LightingInFlight;
+        if (m_ReadbackData.size() < sizeof(LightingData)) {
+            continue;
+        }
+        LightingData data;
+        std::memcpy(&data, m_ReadbackData.data(), sizeof(LightingData));
+        m_SunTransmittance = glm::vec3(data.sunTransmittance);
+        m_SkyAmbient = glm::vec3(data.skyAmbient);
+        m_LightingReady = true;
+    }
+}
+
+void Atmosphere::render(const glm::mat4& viewProjection, const glm::vec3& sunIlluminance) const {
+    if (!m_SkyViewReady) {
+        return;
+    }
+    glm::mat4 inverseViewProjection = glm::inverse(viewProjection);
+    m_SkyShader->bind();
+    bindLookups(*m_SkyShader, *m_SkyView[m_Front]);
+    m_SkyShader->setMat4("u_InverseViewProjection", &inverseViewProjection[0][0]);
+    m_SkyShader->setVec3("u_SunIlluminance", &sunIlluminance[0]);
+
+    m_FullscreenVao.bind();
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    VertexArray::unbind();
+}
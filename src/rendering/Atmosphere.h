@@ -0,0 +1,90 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <array>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <memory>
+#include <vector>
+
+#include "BufferReadback.h"
+#include "Framebuffer.h"
+#include "GlBuffer.h"
+#include "RenderTexture.h"
+#include "VertexArray.h"
+
+class Shader;
+
+// Physically based sky after Hillaire 2020. Transmittance and multiple-scattering LUTs only
+// depend on the atmosphere and are computed once; the sky-view LUT (in-scattered radiance
+// per view direction for the current sun) is rendered a few rows per frame into a back
+// buffer and swapped in when complete, so sun changes are spread over several frames. Sun
+// transmittance and a cosine-weighted sky ambient are reduced from the LUTs on the GPU and
+// read back late; all radiance is relative to a sun of unit illuminance.
+class Atmosphere {
+   public:
+    struct Settings {
+        bool enabled = false;
+        int updateFrames = 4;  // Frames one sky-view LUT update is spread over
+    };
+
+    Atmosphere();
+    ~Atmosphere();
+
+    Atmosphere(const Atmosphere&) = delete;
+    Atmosphere& operator=(const Atmosphere&) = delete;
+
+    void loadShaders();
+    void configure(const Settings& settings) { m_Settings = settings; }
+    bool isEnabled() const { return m_Settings.enabled; }
+    // True while a sky-view update or its derived lighting is still in flight
+    bool isUpdating() const { return m_Updating || m_LightingInFlight > 0; }
+
+    // Advances the LUTs towards `sunDirection` (pointing at the sun); changes the viewport
+    void update(const glm::vec3& sunDirection);
+    // Full-screen sky at the far plane into the bound target; `sunIlluminance` scales the
+    // unit-sun radiance of the LUTs to the scene's light units
+    void render(const glm::mat4& viewProjection, const glm::vec3& sunIlluminance) const;
+    // Collects the derived lighting of finished updates
+    void endFrame();
+
+    bool hasSky() const { return m_SkyViewReady; }
+    bool hasLighting() const { return m_LightingReady; }
+    // Fraction of the sun's light reaching the ground
+    const glm::vec3& getSunTransmittance() const { return m_SunTransmittance; }
+    // Cosine-weighted mean sky radiance over the upper hemisphere
+    const glm::vec3& getSkyAmbient() const { return m_SkyAmbient; }
+
+   private:
+    void computeStaticLuts();
+    void renderSkyViewRows(int target, int firstRow, int rowCount);
+    void computeLighting();
+    void bindLookups(const Shader& shader, const RenderTexture& skyView) const;
+
+    Settings m_Settings;
+    std::unique_ptr<Shader> m_TransmittanceShader;
+    std::unique_ptr<Shader> m_MultiScatteringShader;
+    std::unique_ptr<Shader> m_SkyViewShader;
+    std::unique_ptr<Shader> m_LightingShader;
+    std::unique_ptr<Shader> m_SkyShader;
+    std::unique_ptr<RenderTexture> m_Transmittance;
+    std::unique_ptr<RenderTexture> m_MultiScattering;
+    // Front is sampled, back receives the rows of the update in progress
+    std::array<std::unique_ptr<RenderTexture>, 2> m_SkyView;
+    std::array<Framebuffer, 2> m_SkyViewFbo;
+    int m_Front = 0;
+    bool m_SkyViewReady = false;
+    bool m_Updating = false;
+    int m_NextRow = 0;
+    glm::vec3 m_UpdateDirection{0.0f, 1.0f, 0.0f};
+    glm::vec3 m_FrontDirection{0.0f, 1.0f, 0.0f};
+    GlBuffer m_LightingBuffer{GL_SHADER_STORAGE_BUFFER};
+    BufferReadback m_LightingReadback;
+    std::vector<uint8_t> m_ReadbackData;
+    int m_LightingInFlight = 0;
+    bool m_LightingReady = false;
+    glm::vec3 m_SunTransmittance{1.0f};
+    glm::vec3 m_SkyAmbient{0.0f};
+    VertexArray m_FullscreenVao;
+};
@@ -0,0 +1,54 @@
+#include "BufferReadback.h"
+
+BufferReadback::BufferReadback(size_t ringSize) : m_Slots(ringSize == 0 ? 1 : ringSize) {}
+
+BufferReadback::~BufferReadback() {
+    for (auto& slot : m_Slots) {
+        if (slot.fence) {
+            glDeleteSync(slot.fence);
+        }
+    }
+}
+
+bool BufferReadback::request(GLuint source, GLintptr offset, GLsizeiptr size, uint32_t tag) {
+    if (m_InFlight.size() == m_Slots.size() || size <= 0) {
+        return false;
+    }
+
+    size_t index = m_Next;
+    m_Next = (m_Next + 1) % m_Slots.size();
+    Slot& slot = m_Slots[index];
+    if (slot.capacity < size) {
+        slot.buffer.setData(size, nullptr, GL_STREAM_READ);
+        slot.capacity = size;
+    }
+    glCopyNamedBufferSubData(source, slot.buffer.id(), offset, 0, size);
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.size = size;
+    slot.tag = tag;
+    m_InFlight.push_back(index);
+    return true;
+}
+
+bool BufferReadback::poll(std::vector<uint8_t>& out, uint32_t* tag) {
+    if (m_InFlight.empty()) {
+        return false;
+    }
+
+    Slot& slot = m_Slots[m_InFlight.front()];
+    GLint status = GL_UNSIGNALED;
+    glGetSynciv(slot.fence, GL_SYNC_STATUS, 1, nullptr, &status);
+    if (status != GL_SIGNALED) {
+        return false;
+    }
+
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+    out.resize(static_cast<size_t>(slot.size));
+    glGetNamedBufferSubData(slot.buffer.id(), 0, slot.size, out.data());
+    if (tag) {
+        *tag = slot.tag;
+    }
+    m_InFlight.pop_front();
+    return true;
+}
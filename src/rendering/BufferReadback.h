@@ -0,0 +1,41 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "GlBuffer.h"
+
+// Non-stalling readback of small GPU buffers (counters, reductions). Each request copies
+// a buffer range into one slot of a ring and fences it; poll() only reads slots whose
+// fence has already signaled, so results arrive a few frames late but never block.
+class BufferReadback {
+   public:
+    explicit BufferReadback(size_t ringSize = 3);
+    ~BufferReadback();
+
+    BufferReadback(const BufferReadback&) = delete;
+    BufferReadback& operator=(const BufferReadback&) = delete;
+
+    // Returns false (dropping the request) when every slot is still in flight. The caller
+    // must have issued the memory barrier covering its shader writes to `source`.
+    bool request(GLuint source, GLintptr offset, GLsizeiptr size, uint32_t tag = 0);
+    // Fills `out` with the oldest completed readback and returns its tag
+    bool poll(std::vector<uint8_t>& out, uint32_t* tag = nullptr);
+
+   private:
+    struct Slot {
+        GlBuffer buffer{GL_COPY_WRITE_BUFFER};
+        GLsizeiptr capacity = 0;
+        GLsizeiptr size = 0;
+        GLsync fence = nullptr;
+        uint32_t tag = 0;
+    };
+
+    std::vector<Slot> m_Slots;
+    std::deque<size_t> m_InFlight;
+    size_t m_Next = 0;
+};
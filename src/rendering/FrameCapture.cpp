@@ -0,0 +1,363 @@
+#include "FrameCapture.h"
+
+#include <stb_image.h>
+#include <stb_image_write.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+#include "RenderTexture.h"
+
+namespace {
+void ensureParentDirectory(const std::string& path) {
+    std::filesystem::path parent = std::filesystem::path(path).parent_path();
+    if (!parent.empty()) {
+        std::error_code ec;
+        std::filesystem::create_directories(parent, ec);
+    }
+}
+}
+
+FrameCapture::FrameCapture() {
+    m_Worker = std::thread([this]() { workerLoop(); });
+}
+
+FrameCapture::~FrameCapture() {
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Running = false;
+    }
+    m_JobReady.notify_all();
+    if (m_Worker.joinable()) {
+        m_Worker.join();
+    }
+
+    for (auto& slot : m_Slots) {
+        if (slot.fence) {
+            glDeleteSync(slot.fence);
+        }
+    }
+}
+
+void FrameCapture::configure(const Settings& settings) {
+    m_Settings = settings;
+    m_Settings.latency = std::max(1, m_Settings.latency);
+    m_Settings.maxQueuedJobs = std::max(1, m_Settings.maxQueuedJobs);
+
+    // Readbacks still in flight keep their slot; only an idle ring can be resized
+    if (m_InFlight.empty()) {
+        m_Slots.clear();
+        m_Slots.resize(static_cast<size_t>(m_Settings.latency) + 1);
+        m_NextSlot = 0;
+    }
+}
+
+void FrameCapture::requestScreenshot(const std::string& path) {
+    Request request;
+    request.kind = JobKind::Png;
+    request.path = path.empty()
+                       ? m_Settings.outputDir + "/screenshot_" + std::to_string(m_ScreenshotCounter++) + ".png"
+                       : path;
+    m_PendingRequests.push_back(request);
+}
+
+void FrameCapture::requestCompare(const std::string& goldenPath, int tolerance, float maxMismatchPercent) {
+    Request request;
+    request.kind = JobKind::Compare;
+    request.path = goldenPath;
+    request.tolerance = tolerance;
+    request.maxMismatchPercent = maxMismatchPercent;
+    m_PendingRequests.push_back(request);
+}
+
+void FrameCapture::setContinuous(bool enabled) {
+    if (enabled && !m_Continuous) {
+        // Every capture session streams into its own file
+        std::filesystem::path path(m_Settings.videoPath);
+        std::string stem = path.stem().string() + "_" + std::to_string(m_VideoSession++);
+        m_VideoSessionPath = (path.parent_path() / (stem + path.extension().string())).string();
+    }
+    m_Continuous = enabled;
+}
+
+bool FrameCapture::hasPendingWork() const {
+    if (!m_PendingRequests.empty() || !m_InFlight.empty()) {
+        return true;
+    }
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return !m_Jobs.empty() || m_WorkerBusy;
+}
+
+FrameCapture::CompareResult FrameCapture::getLastCompareResult() const {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_LastCompare;
+}
+
+void FrameCapture::capture(const RenderTexture& color) {
+    if (m_Slots.empty()) {
+        configure(m_Settings);
+    }
+
+    collectReadbacks();
+
+    std::vector<Request> requests;
+    requests.swap(m_PendingRequests);
+    if (m_Continuous) {
+        Request video;
+        video.kind = JobKind::Video;
+        video.path = m_VideoSessionPath;
+        requests.push_back(video);
+    }
+
+    if (!requests.empty()) {
+        if (m_InFlight.size() >= m_Slots.size()) {
+            // Ring exhausted: one-shot requests wait for the next frame, streamed frames are dropped
+            for (auto& request : requests) {
+                if (request.kind != JobKind::Video) {
+                    m_PendingRequests.push_back(request);
+                }
+            }
+            m_Stats.dropped++;
+        } else {
+            issueReadback(color, std::move(requests));
+        }
+    }
+
+    m_Frame++;
+}
+
+bool FrameCapture::isSlotReady(const Slot& slot) const {
+    if (m_Frame - slot.frame < static_cast<uint64_t>(m_Settings.latency)) {
+        return false;
+    }
+    // Query the fence status without flushing or waiting
+    GLint status = GL_UNSIGNALED;
+    glGetSynciv(slot.fence, GL_SYNC_STATUS, 1, nullptr, &status);
+    return status == GL_SIGNALED;
+}
+
+void FrameCapture::collectReadbacks() {
+    // Slots complete in issue order, so stop at the first one that is not ready
+    while (!m_InFlight.empty()) {
+        Slot& slot = m_Slots[m_InFlight.front()];
+        if (!isSlotReady(slot)) {
+            break;
+        }
+        m_InFlight.pop_front();
+
+        glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+
+        const size_t rowBytes = static_cast<size_t>(slot.width) * 4;
+        const size_t size = rowBytes * static_cast<size_t>(slot.height);
+        const auto* mapped = static_cast<const uint8_t*>(
+            slot.buffer.mapRange(0, static_cast<GLsizeiptr>(size), GL_MAP_READ_BIT));
+        if (!mapped) {
+            m_Stats.dropped++;
+            continue;
+        }
+
+        // GL rows are bottom to top; flip while copying out of the mapped buffer
+        std::vector<uint8_t> pixels(size);
+        for (int y = 0; y < slot.height; ++y) {
+            std::memcpy(&pixels[static_cast<size_t>(y) * rowBytes],
+                        mapped + static_cast<size_t>(slot.height - 1 - y) * rowBytes,
+                        rowBytes);
+        }
+        slot.buffer.unmap();
+
+        for (size_t i = 0; i < slot.requests.size(); ++i) {
+            Job job;
+            job.request = slot.requests[i];
+            job.width = slot.width;
+            job.height = slot.height;
+            job.frame = slot.frame;
+            job.outputDir = m_Settings.outputDir;
+            // The last request takes ownership of the pixels instead of copying them
+            if (i + 1 == slot.requests.size()) {
+                job.pixels = std::move(pixels);
+            } else {
+                job.pixels = pixels;
+            }
+            enqueueJob(std::move(job));
+        }
+        slot.requests.clear();
+        m_Stats.captured++;
+    }
+}
+
+void FrameCapture::issueReadback(const RenderTexture& color, std::vector<Request> requests) {
+    size_t index = m_NextSlot;
+    m_NextSlot = (m_NextSlot + 1) % m_Slots.size();
+    Slot& slot = m_Slots[index];
+
+    const size_t size = static_cast<size_t>(color.width()) * static_cast<size_t>(color.height()) * 4;
+    if (slot.capacity < size) {
+        slot.buffer.setData(static_cast<GLsizeiptr>(size), nullptr, GL_STREAM_READ);
+        slot.capacity = size;
+    }
+
+    // With a pack buffer bound the pixel pointer is an offset, so the copy is queued on the GPU
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer.id());
+    glGetTextureImage(color.id(), 0, GL_RGBA, GL_UNSIGNED_BYTE, static_cast<GLsizei>(size), nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.width = color.width();
+    slot.height = color.height();
+    slot.frame = m_Frame;
+    slot.requests = std::move(requests);
+    m_InFlight.push_back(index);
+}
+
+void FrameCapture::enqueueJob(Job job) {
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        // Streamed frames are dropped when the encoder falls behind, one-shot jobs never are
+        if (job.request.kind == JobKind::Video &&
+            m_Jobs.size() >= static_cast<size_t>(m_Settings.maxQueuedJobs)) {
+            m_Stats.dropped++;
+            return;
+        }
+        m_Jobs.push_back(std::move(job));
+    }
+    m_JobReady.notify_one();
+}
+
+void FrameCapture::workerLoop() {
+    // Golden images must load top to bottom regardless of the texture loader's global flag
+    stbi_set_flip_vertically_on_load_thread(0);
+
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_JobReady.wait(lock, [this]() { return !m_Jobs.empty() || !m_Running; });
+            if (m_Jobs.empty()) {
+                break;  // Stopped and drained
+            }
+            job = std::move(m_Jobs.front());
+            m_Jobs.pop_front();
+            m_WorkerBusy = true;
+        }
+
+        runJob(job);
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_WorkerBusy = false;
+    }
+
+    if (m_Video.is_open()) {
+        m_Video.close();
+    }
+}
+
+void FrameCapture::runJob(Job& job) {
+    // The scene target's alpha is not meaningful for output images
+    for (size_t i = 3; i < job.pixels.size(); i += 4) {
+        job.pixels[i] = 255;
+    }
+
+    switch (job.request.kind) {
+        case JobKind::Png:
+            writePng(job);
+            break;
+        case JobKind::Video:
+            writeVideoFrame(job);
+            break;
+        case JobKind::Compare:
+            compareWithGolden(job);
+            break;
+    }
+}
+
+void FrameCapture::writePng(const Job& job) {
+    ensureParentDirectory(job.request.path);
+    if (!stbi_write_png(job.request.path.c_str(), job.width, job.height, 4, job.pixels.data(), job.width * 4)) {
+        std::cerr << "Capture: failed to write " << job.request.path << std::endl;
+        return;
+    }
+    std::cout << "Capture: saved frame " << job.frame << " to " << job.request.path << std::endl;
+}
+
+void FrameCapture::writeVideoFrame(const Job& job) {
+    if (job.request.path != m_VideoOpenPath) {
+        if (m_Video.is_open()) {
+            m_Video.close();
+        }
+        ensureParentDirectory(job.request.path);
+        m_Video.open(job.request.path, std::ios::binary | std::ios::trunc);
+        m_VideoOpenPath = job.request.path;
+        if (!m_Video.is_open()) {
+            std::cerr << "Capture: failed to open video stream " << job.request.path << std::endl;
+            return;
+        }
+        std::cout << "Capture: streaming raw RGBA " << job.width << "x" << job.height << " frames to "
+                  << job.request.path << " (ffmpeg -f rawvideo -pixel_format rgba -video_size "
+                  << job.width << "x" << job.height << " -i " << job.request.path << " out.mp4)" << std::endl;
+    }
+    if (m_Video.is_open()) {
+        m_Video.write(reinterpret_cast<const char*>(job.pixels.data()), static_cast<std::streamsize>(job.pixels.size()));
+    }
+}
+
+void FrameCapture::compareWithGolden(const Job& job) {
+    CompareResult result;
+    result.valid = true;
+    result.goldenPath = job.request.path;
+
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    unsigned char* golden = stbi_load(job.request.path.c_str(), &width, &height, &channels, 4);
+    if (!golden) {
+        std::cerr << "Capture: failed to load golden image " << job.request.path << std::endl;
+    } else if (width != job.width || height != job.height) {
+        std::cerr << "Capture: golden image is " << width << "x" << height << ", frame is "
+                  << job.width << "x" << job.height << std::endl;
+    } else {
+        const size_t pixelCount = static_cast<size_t>(width) * static_cast<size_t>(height);
+        std::vector<uint8_t> diff(pixelCount * 4, 255);
+        size_t mismatched = 0;
+        for (size_t p = 0; p < pixelCount; ++p) {
+            int pixelDelta = 0;
+            for (int c = 0; c < 3; ++c) {
+                int delta = std::abs(static_cast<int>(job.pixels[p * 4 + c]) - static_cast<int>(golden[p * 4 + c]));
+                pixelDelta = std::max(pixelDelta, delta);
+            }
+            result.maxDelta = std::max(result.maxDelta, pixelDelta);
+            bool mismatch = pixelDelta > job.request.tolerance;
+            if (mismatch) {
+                mismatched++;
+            }
+            // Diff image: mismatches in red, everything else as dimmed grey
+            uint8_t grey = static_cast<uint8_t>(job.pixels[p * 4 + 1] / 4);
+            diff[p * 4 + 0] = mismatch ? 255 : grey;
+            diff[p * 4 + 1] = mismatch ? 0 : grey;
+            diff[p * 4 + 2] = mismatch ? 0 : grey;
+        }
+        result.mismatchPercent = 100.0f * static_cast<float>(mismatched) / static_cast<float>(pixelCount);
+        result.passed = result.mismatchPercent <= job.request.maxMismatchPercent;
+
+        if (!result.passed) {
+            std::string actualPath = job.outputDir + "/compare_actual.png";
+            std::string diffPath = job.outputDir + "/compare_diff.png";
+            ensureParentDirectory(actualPath);
+            stbi_write_png(actualPath.c_str(), width, height, 4, job.pixels.data(), width * 4);
+            stbi_write_png(diffPath.c_str(), width, height, 4, diff.data(), width * 4);
+        }
+    }
+    if (golden) {
+        stbi_image_free(golden);
+    }
+
+    std::cout << "Capture: golden compare " << (result.passed ? "PASSED" : "FAILED")
+              << " (" << job.request.path << ", mismatch " << result.mismatchPercent
+              << "%, max delta " << result.maxDelta << ")" << std::endl;
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_LastCompare = result;
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "GlBuffer.h"
+
+class RenderTexture;
+
+// Non-stalling color readback. Each capture copies the scene color into one buffer of a
+// pixel-pack ring and fences it; the buffer is only mapped once it is at least
+// `latency` frames old and its fence has signaled. Encoding (PNG, raw video stream,
+// golden image comparison) happens on a background thread.
+class FrameCapture {
+   public:
+    struct Settings {
+        int latency = 3;
+        int maxQueuedJobs = 8;
+        std::string outputDir = "captures";
+        std::string videoPath = "captures/capture.rgba";
+    };
+
+    struct CompareResult {
+        bool valid = false;
+        bool passed = false;
+        int maxDelta = 0;
+        float mismatchPercent = 0.0f;
+        std::string goldenPath;
+    };
+
+    struct Stats {
+        unsigned int captured = 0;
+        unsigned int dropped = 0;
+    };
+
+    FrameCapture();
+    ~FrameCapture();
+
+    FrameCapture(const FrameCapture&) = delete;
+    FrameCapture& operator=(const FrameCapture&) = delete;
+
+    void configure(const Settings& settings);
+
+    void requestScreenshot(const std::string& path = std::string());
+    // `tolerance` is the allowed per-channel delta (0-255), `maxMismatchPercent` the share
+    // of pixels allowed to exceed it
+    void requestCompare(const std::string& goldenPath, int tolerance, float maxMismatchPercent);
+    void setContinuous(bool enabled);
+    bool isContinuous() const { return m_Continuous; }
+    bool hasPendingWork() const;
+
+    // Called once per frame after the scene color is final
+    void capture(const RenderTexture& color);
+
+    CompareResult getLastCompareResult() const;
+    const Stats& getStats() const { return m_Stats; }
+
+   private:
+    enum class JobKind : uint8_t {
+        Png,
+        Video,
+        Compare
+    };
+
+    struct Request {
+        JobKind kind = JobKind::Png;
+        std::string path;
+        int tolerance = 0;
+        float maxMismatchPercent = 0.0f;
+    };
+
+    struct Slot {
+        GlBuffer buffer{GL_PIXEL_PACK_BUFFER};
+        size_t capacity = 0;
+        GLsync fence = nullptr;
+        int width = 0;
+        int height = 0;
+        uint64_t frame = 0;
+        std::vector<Request> requests;
+    };
+
+    struct Job {
+        Request request;
+        int width = 0;
+        int height = 0;
+        uint64_t frame = 0;
+        std::vector<uint8_t> pixels;  // RGBA8, rows top to bottom
+        // Copied from the settings, which configure() may replace while the worker runs
+        std::string outputDir;
+    };
+
+    void collectReadbacks();
+    bool isSlotReady(const Slot& slot) const;
+    void issueReadback(const RenderTexture& color, std::vector<Request> requests);
+    void enqueueJob(Job job);
+    void workerLoop();
+    void runJob(Job& job);
+    void writePng(const Job& job);
+    void writeVideoFrame(const Job& job);
+    void compareWithGolden(const Job& job);
+
+    Settings m_Settings;
+    std::vector<Slot> m_Slots;
+    std::deque<size_t> m_InFlight;
+    size_t m_NextSlot = 0;
+    uint64_t m_Frame = 0;
+    std::vector<Request> m_PendingRequests;
+    bool m_Continuous = false;
+    unsigned int m_VideoSession = 0;
+    std::string m_VideoSessionPath;
+    unsigned int m_ScreenshotCounter = 0;
+    Stats m_Stats;
+
+    mutable std::mutex m_Mutex;
+    std::condition_variable m_JobReady;
+    std::deque<Job> m_Jobs;
+    bool m_Running = true;
+    bool m_WorkerBusy = false;
+    CompareResult m_LastCompare;
+    std::ofstream m_Video;
+    std::string m_VideoOpenPath;
+    std::thread m_Worker;
+};
@@ -0,0 +1,69 @@
+#include "Framebuffer.h"
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+Framebuffer::Framebuffer() {
+    glCreateFramebuffers(1, &m_Id);
+}
+
+Framebuffer::~Framebuffer() {
+    release();
+}
+
+Framebuffer::Framebuffer(Framebuffer&& other) noexcept : m_Id(other.m_Id) {
+    other.m_Id = 0;
+}
+
+Framebuffer& Framebuffer::operator=(Framebuffer&& other) noexcept {
+    if (this != &other) {
+        release();
+        m_Id = other.m_Id;
+        other.m_Id = 0;
+    }
+    return *this;
+}
+
+void Framebuffer::bind() const {
+    glBindFramebuffer(GL_FRAMEBUFFER, m_Id);
+}
+
+void Framebuffer::bindDefault() {
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void Framebuffer::attachTexture(GLenum attachment, GLuint texture, GLint level) const {
+    glNamedFramebufferTexture(m_Id, attachment, texture, level);
+}
+
+void Framebuffer::setDrawBuffers(std::initializer_list<GLenum> buffers) const {
+    std::vector<GLenum> list(buffers);
+    glNamedFramebufferDrawBuffers(m_Id, static_cast<GLsizei>(list.size()), list.data());
+}
+
+void Framebuffer::clearColor(GLint drawBuffer, const float* value) const {
+    glClearNamedFramebufferfv(m_Id, GL_COLOR, drawBuffer, value);
+}
+
+void Framebuffer::clearColorUint(GLint drawBuffer, const GLuint* value) const {
+    glClearNamedFramebufferuiv(m_Id, GL_COLOR, drawBuffer, value);
+}
+
+void Framebuffer::clearDepth(float value) const {
+    glClearNamedFramebufferfv(m_Id, GL_DEPTH, 0, &value);
+}
+
+void Framebuffer::validate(const char* name) const {
+    GLenum status = glCheckNamedFramebufferStatus(m_Id, GL_FRAMEBUFFER);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        throw std::runtime_error(std::string("Framebuffer incomplete: ") + name + " (" + std::to_string(status) + ")");
+    }
+}
+
+void Framebuffer::release() {
+    if (m_Id != 0) {
+        glDeleteFramebuffers(1, &m_Id);
+        m_Id = 0;
+    }
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <initializer_list>
+
+class Framebuffer {
+   public:
+    Framebuffer();
+    ~Framebuffer();
+
+    Framebuffer(const Framebuffer&) = delete;
+    Framebuffer& operator=(const Framebuffer&) = delete;
+    Framebuffer(Framebuffer&& other) noexcept;
+    Framebuffer& operator=(Framebuffer&& other) noexcept;
+
+    void bind() const;
+    static void bindDefault();
+    unsigned int id() const { return m_Id; }
+
+    void attachTexture(GLenum attachment, GLuint texture, GLint level = 0) const;
+    void setDrawBuffers(std::initializer_list<GLenum> buffers) const;
+    void clearColor(GLint drawBuffer, const float* value) const;
+    // For integer color attachments
+    void clearColorUint(GLint drawBuffer, const GLuint* value) const;
+    void clearDepth(float value) const;
+    // Throws if the attachments do not form a complete framebuffer
+    void validate(const char* name) const;
+
+   private:
+    void release();
+
+    GLuint m_Id = 0;
+};
@@ -31,6 +31,14 @@ void GlBuffer::updateSubData(GLintptr offset, GLsizeiptr size, const void* data)
     glNamedBufferSubData(m_Id, offset, size, data);
 }
 
+void* GlBuffer::mapRange(GLintptr offset, GLsizeiptr length, GLbitfield access) const {
+    return glMapNamedBufferRange(m_Id, offset, length, access);
+}
+
+void GlBuffer::unmap() const {
+    glUnmapNamedBuffer(m_Id);
+}
+
 void GlBuffer::release() {
     if (m_Id != 0) {
         glDeleteBuffers(1, &m_Id);
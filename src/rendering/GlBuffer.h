@@ -14,6 +14,8 @@ class GlBuffer {
 
     void setData(GLsizeiptr size, const void* data, GLenum usage) const;
     void updateSubData(GLintptr offset, GLsizeiptr size, const void* data) const;
+    void* mapRange(GLintptr offset, GLsizeiptr length, GLbitfield access) const;
+    void unmap() const;
     unsigned int id() const { return m_Id; }
 
    private:
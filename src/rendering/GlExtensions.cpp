@@ -0,0 +1,47 @@
+#include "GlExtensions.h"
+
+std::unordered_set<std::string> GlExtensions::s_Extensions;
+GlExtensions::MultiDrawElementsIndirectCountProc GlExtensions::multiDrawElementsIndirectCount = nullptr;
+GlExtensions::MaxShaderCompilerThreadsProc GlExtensions::maxShaderCompilerThreads = nullptr;
+
+void GlExtensions::load(ProcLoader loader) {
+    s_Extensions.clear();
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; ++i) {
+        const GLubyte* name = glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i));
+        if (name) {
+            s_Extensions.insert(reinterpret_cast<const char*>(name));
+        }
+    }
+
+    GLint major = 0;
+    GLint minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    bool gl46 = major > 4 || (major == 4 && minor >= 6);
+
+    multiDrawElementsIndirectCount = nullptr;
+    if (gl46) {
+        multiDrawElementsIndirectCount =
+            reinterpret_cast<MultiDrawElementsIndirectCountProc>(loader("glMultiDrawElementsIndirectCount"));
+    }
+    if (!multiDrawElementsIndirectCount && has("GL_ARB_indirect_parameters")) {
+        multiDrawElementsIndirectCount =
+            reinterpret_cast<MultiDrawElementsIndirectCountProc>(loader("glMultiDrawElementsIndirectCountARB"));
+    }
+
+    maxShaderCompilerThreads = nullptr;
+    if (has("GL_KHR_parallel_shader_compile")) {
+        maxShaderCompilerThreads =
+            reinterpret_cast<MaxShaderCompilerThreadsProc>(loader("glMaxShaderCompilerThreadsKHR"));
+    }
+    if (!maxShaderCompilerThreads && has("GL_ARB_parallel_shader_compile")) {
+        maxShaderCompilerThreads =
+            reinterpret_cast<MaxShaderCompilerThreadsProc>(loader("glMaxShaderCompilerThreadsARB"));
+    }
+}
+
+bool GlExtensions::has(const std::string& extension) {
+    return s_Extensions.count(extension) > 0;
+}
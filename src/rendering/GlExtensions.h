@@ -0,0 +1,32 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <string>
+#include <unordered_set>
+
+#ifndef GL_PARAMETER_BUFFER
+#define GL_PARAMETER_BUFFER 0x80EE
+#endif
+
+// Optional entry points beyond the 4.5 core profile that glad loads, resolved once after
+// context creation. Pointers stay null when the driver does not expose them.
+class GlExtensions {
+   public:
+    using ProcLoader = void* (*)(const char* name);
+    using MultiDrawElementsIndirectCountProc = void(APIENTRYP)(GLenum mode, GLenum type, const void* indirect,
+                                                               GLintptr drawcount, GLsizei maxdrawcount,
+                                                               GLsizei stride);
+    using MaxShaderCompilerThreadsProc = void(APIENTRYP)(GLuint count);
+
+    static void load(ProcLoader loader);
+    static bool has(const std::string& extension);
+
+    // GL 4.6 glMultiDrawElementsIndirectCount or ARB_indirect_parameters
+    static MultiDrawElementsIndirectCountProc multiDrawElementsIndirectCount;
+    // KHR/ARB_parallel_shader_compile
+    static MaxShaderCompilerThreadsProc maxShaderCompilerThreads;
+
+   private:
+    static std::unordered_set<std::string> s_Extensions;
+};
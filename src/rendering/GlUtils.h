@@ -1,19 +0,0 @@
-#pragma once
-
-#include <glad/glad.h>
-
-#include <stdexcept>
-#include <string>
-
-#ifndef NDEBUG
-inline void checkGlError(const char* context) {
-    GLenum err = glGetError();
-    if (err != GL_NO_ERROR) {
-        throw std::runtime_error(std::string("OpenGL error at ") + context + ": " + std::to_string(err));
-    }
-}
-#else
-inline void checkGlError(const char* context) {
-    (void)context;
-}
-#endif
@@ -0,0 +1,317 @@
+#include "GpuProfiler.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+
+namespace {
+constexpr size_t kSkippedScope = std::numeric_limits<size_t>::max();
+
+double queryDeltaMs(GLuint beginQuery, GLuint endQuery) {
+    GLuint64 begin = 0;
+    GLuint64 end = 0;
+    glGetQueryObjectui64v(beginQuery, GL_QUERY_RESULT, &begin);
+    glGetQueryObjectui64v(endQuery, GL_QUERY_RESULT, &end);
+    return end > begin ? static_cast<double>(end - begin) / 1.0e6 : 0.0;
+}
+
+std::string csvEscape(const std::string& text) {
+    std::string out = "\"";
+    for (char ch : text) {
+        if (ch == '"') out += '"';
+        out += ch;
+    }
+    out += '"';
+    return out;
+}
+
+std::string jsonEscape(const std::string& text) {
+    std::string out = "\"";
+    for (char ch : text) {
+        if (ch == '"' || ch == '\\') out += '\\';
+        out += ch;
+    }
+    out += '"';
+    return out;
+}
+
+bool endsWith(const std::string& text, const std::string& suffix) {
+    return text.size() >= suffix.size() &&
+           text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+}
+
+GpuProfiler::GpuProfiler() = default;
+
+GpuProfiler::~GpuProfiler() {
+    closeExport();
+    releaseQueries();
+}
+
+void GpuProfiler::configure(const Settings& settings) {
+    bool exportChanged = settings.exportPath != m_Settings.exportPath || settings.enabled != m_Settings.enabled;
+    m_Settings = settings;
+    if (m_Settings.averageFrames < 1) {
+        m_Settings.averageFrames = 1;
+    }
+
+    if (m_Settings.enabled && m_Slots[0].queries.empty()) {
+        createQueries();
+    }
+    if (exportChanged) {
+        closeExport();
+        if (m_Settings.enabled && !m_Settings.exportPath.empty()) {
+            openExport();
+        }
+    }
+}
+
+void GpuProfiler::createQueries() {
+    for (auto& slot : m_Slots) {
+        // Two timestamps per scope plus the frame begin/end pair
+        slot.queries.resize(kMaxScopesPerFrame * 2 + 2);
+        glCreateQueries(GL_TIMESTAMP, static_cast<GLsizei>(slot.queries.size()), slot.queries.data());
+    }
+}
+
+void GpuProfiler::releaseQueries() {
+    for (auto& slot : m_Slots) {
+        if (!slot.queries.empty()) {
+            glDeleteQueries(static_cast<GLsizei>(slot.queries.size()), slot.queries.data());
+            slot.queries.clear();
+        }
+        slot.pending = false;
+    }
+}
+
+GLuint GpuProfiler::acquireQuery(FrameSlot& slot) {
+    if (slot.nextQuery >= slot.queries.size()) {
+        return 0;
+    }
+    return slot.queries[slot.nextQuery++];
+}
+
+void GpuProfiler::beginFrame() {
+    if (!m_Settings.enabled) {
+        return;
+    }
+
+    m_CurrentSlot = static_cast<size_t>(m_FrameNumber % kFrameLatency);
+    FrameSlot& slot = m_Slots[m_CurrentSlot];
+    if (slot.pending && !resolveSlot(slot)) {
+        // The GPU is more than kFrameLatency frames behind; drop the frame instead of waiting
+        m_DroppedFrames++;
+    }
+
+    slot.records.clear();
+    slot.nextQuery = 0;
+    slot.pending = false;
+    slot.frameBegin = acquireQuery(slot);
+    glQueryCounter(slot.frameBegin, GL_TIMESTAMP);
+    m_OpenScopes.clear();
+    m_InFrame = true;
+}
+
+void GpuProfiler::endFrame() {
+    if (!m_Settings.enabled || !m_InFrame) {
+        return;
+    }
+
+    while (!m_OpenScopes.empty()) {
+        endScope();
+    }
+
+    FrameSlot& slot = m_Slots[m_CurrentSlot];
+    slot.frameEnd = acquireQuery(slot);
+    glQueryCounter(slot.frameEnd, GL_TIMESTAMP);
+    slot.frameNumber = m_FrameNumber;
+    slot.pending = true;
+    m_FrameNumber++;
+    m_InFrame = false;
+}
+
+void GpuProfiler::collect() {
+    if (!m_Settings.enabled || m_InFrame) {
+        return;
+    }
+
+    // Oldest first so averages and exported rows stay in frame order
+    uint64_t first = m_FrameNumber - std::min<uint64_t>(m_FrameNumber, kFrameLatency);
+    for (uint64_t frame = first; frame < m_FrameNumber; ++frame) {
+        FrameSlot& slot = m_Slots[frame % kFrameLatency];
+        if (!slot.pending) {
+            continue;
+        }
+        GLint available = 0;
+        glGetQueryObjectiv(slot.frameEnd, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) {
+            break;
+        }
+        resolveSlot(slot);
+    }
+}
+
+void GpuProfiler::beginScope(const std::string& name) {
+    if (!m_Settings.enabled || !m_InFrame) {
+        return;
+    }
+
+    FrameSlot& slot = m_Slots[m_CurrentSlot];
+    // Keep two queries in reserve for the frame end timestamp
+    if (slot.nextQuery + 3 > slot.queries.size()) {
+        m_OpenScopes.push_back(kSkippedScope);
+        return;
+    }
+
+    ScopeRecord record;
+    record.nameId = internName(name);
+    record.depth = static_cast<int>(m_OpenScopes.size());
+    record.beginQuery = acquireQuery(slot);
+    record.endQuery = 0;
+    glQueryCounter(record.beginQuery, GL_TIMESTAMP);
+
+    m_OpenScopes.push_back(slot.records.size());
+    slot.records.push_back(record);
+}
+
+void GpuProfiler::endScope() {
+    if (!m_Settings.enabled || !m_InFrame || m_OpenScopes.empty()) {
+        return;
+    }
+
+    size_t index = m_OpenScopes.back();
+    m_OpenScopes.pop_back();
+    if (index == kSkippedScope) {
+        return;
+    }
+
+    FrameSlot& slot = m_Slots[m_CurrentSlot];
+    ScopeRecord& record = slot.records[index];
+    record.endQuery = acquireQuery(slot);
+    glQueryCounter(record.endQuery, GL_TIMESTAMP);
+}
+
+bool GpuProfiler::resolveSlot(FrameSlot& slot) {
+    // Timestamps complete in submission order, so the frame end being ready implies all are
+    GLint available = 0;
+    glGetQueryObjectiv(slot.frameEnd, GL_QUERY_RESULT_AVAILABLE, &available);
+    slot.pending = false;
+    if (!available) {
+        return false;
+    }
+
+    double frameMs = queryDeltaMs(slot.frameBegin, slot.frameEnd);
+
+    std::vector<std::pair<uint32_t, double>> frameScopes;
+    std::unordered_map<uint32_t, size_t> scopeIndex;
+    for (const auto& record : slot.records) {
+        if (record.endQuery == 0) {
+            continue;
+        }
+        double ms = queryDeltaMs(record.beginQuery, record.endQuery);
+        auto [it, inserted] = scopeIndex.try_emplace(record.nameId, frameScopes.size());
+        if (inserted) {
+            frameScopes.emplace_back(record.nameId, 0.0);
+        }
+        frameScopes[it->second].second += ms;
+
+        auto [acc, isNew] = m_Accumulators.try_emplace(record.nameId);
+        if (isNew) {
+            acc->second.depth = record.depth;
+            m_AccumulatorOrder.push_back(record.nameId);
+        }
+        acc->second.totalMs += ms;
+    }
+
+    m_FrameAccumMs += frameMs;
+    m_AccumFrames++;
+    if (m_AccumFrames >= m_Settings.averageFrames) {
+        publishAverages();
+    }
+
+    if (m_Export.is_open()) {
+        exportFrame(slot.frameNumber, frameMs, frameScopes);
+    }
+    return true;
+}
+
+void GpuProfiler::publishAverages() {
+    float frames = static_cast<float>(m_AccumFrames);
+    m_AvgFrameMs = static_cast<float>(m_FrameAccumMs) / frames;
+
+    m_ScopeStats.clear();
+    m_ScopeStats.reserve(m_AccumulatorOrder.size());
+    for (uint32_t nameId : m_AccumulatorOrder) {
+        const auto& acc = m_Accumulators[nameId];
+        ScopeStat stat;
+        stat.name = m_Names[nameId];
+        stat.depth = acc.depth;
+        stat.avgMs = static_cast<float>(acc.totalMs) / frames;
+        m_ScopeStats.push_back(stat);
+    }
+
+    m_Accumulators.clear();
+    m_AccumulatorOrder.clear();
+    m_FrameAccumMs = 0.0;
+    m_AccumFrames = 0;
+    m_PublishCount++;
+}
+
+void GpuProfiler::openExport() {
+    m_Export.open(m_Settings.exportPath, std::ios::out | std::ios::trunc);
+    if (!m_Export.is_open()) {
+        std::cerr << "GPU profiler: failed to open export file " << m_Settings.exportPath << std::endl;
+        return;
+    }
+
+    m_ExportJson = endsWith(m_Settings.exportPath, ".json");
+    m_ExportFirstEntry = true;
+    m_Export << std::fixed << std::setprecision(4);
+    if (m_ExportJson) {
+        m_Export << "[\n";
+    } else {
+        m_Export << "frame,scope,ms\n";
+    }
+}
+
+void GpuProfiler::closeExport() {
+    if (!m_Export.is_open()) {
+        return;
+    }
+    if (m_ExportJson) {
+        m_Export << "\n]\n";
+    }
+    m_Export.close();
+}
+
+void GpuProfiler::exportFrame(uint64_t frameNumber, double frameMs,
+                              const std::vector<std::pair<uint32_t, double>>& scopes) {
+    if (m_ExportJson) {
+        if (!m_ExportFirstEntry) {
+            m_Export << ",\n";
+        }
+        m_Export << "  {\"frame\": " << frameNumber << ", \"gpuMs\": " << frameMs << ", \"scopes\": {";
+        for (size_t i = 0; i < scopes.size(); ++i) {
+            m_Export << (i > 0 ? ", " : "") << jsonEscape(m_Names[scopes[i].first]) << ": " << scopes[i].second;
+        }
+        m_Export << "}}";
+    } else {
+        m_Export << frameNumber << ",\"frame\"," << frameMs << "\n";
+        for (const auto& [nameId, ms] : scopes) {
+            m_Export << frameNumber << "," << csvEscape(m_Names[nameId]) << "," << ms << "\n";
+        }
+    }
+    m_ExportFirstEntry = false;
+}
+
+uint32_t GpuProfiler::internName(const std::string& name) {
+    auto it = m_NameIds.find(name);
+    if (it != m_NameIds.end()) {
+        return it->second;
+    }
+    uint32_t id = static_cast<uint32_t>(m_Names.size());
+    m_Names.push_back(name);
+    m_NameIds.emplace(name, id);
+    return id;
+}
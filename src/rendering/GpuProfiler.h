@@ -0,0 +1,123 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// GPU timings from GL_TIMESTAMP queries. Each frame records into its own slot of a
+// query ring and is read back kFrameLatency frames later, so results never stall the
+// pipeline. Scopes nest and scopes sharing a name within a frame are summed, which
+// turns per-batch scopes named after their material into per-material groups.
+class GpuProfiler {
+   public:
+    struct Settings {
+        bool enabled = false;
+        bool perBatchScopes = false;
+        int averageFrames = 30;
+        std::string exportPath;  // .json writes a JSON array, anything else CSV rows
+    };
+
+    struct ScopeStat {
+        std::string name;
+        int depth = 0;
+        float avgMs = 0.0f;
+    };
+
+    class Scope {
+       public:
+        Scope(GpuProfiler& profiler, const std::string& name) : m_Profiler(profiler) { m_Profiler.beginScope(name); }
+        ~Scope() { m_Profiler.endScope(); }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+       private:
+        GpuProfiler& m_Profiler;
+    };
+
+    GpuProfiler();
+    ~GpuProfiler();
+
+    GpuProfiler(const GpuProfiler&) = delete;
+    GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+    void configure(const Settings& settings);
+    bool isEnabled() const { return m_Settings.enabled; }
+    bool perBatchScopes() const { return m_Settings.enabled && m_Settings.perBatchScopes; }
+
+    void beginFrame();
+    void endFrame();
+    // Resolves finished frames without starting a new one, for loops that skip rendering
+    void collect();
+    void beginScope(const std::string& name);
+    void endScope();
+
+    float getFrameMs() const { return m_AvgFrameMs; }
+    const std::vector<ScopeStat>& getScopeStats() const { return m_ScopeStats; }
+    unsigned int getDroppedFrames() const { return m_DroppedFrames; }
+    // Incremented whenever a new set of averages is published
+    uint64_t getPublishCount() const { return m_PublishCount; }
+
+   private:
+    static constexpr size_t kFrameLatency = 3;
+    static constexpr size_t kMaxScopesPerFrame = 512;
+
+    struct ScopeRecord {
+        uint32_t nameId;
+        int depth;
+        GLuint beginQuery;
+        GLuint endQuery;
+    };
+
+    struct FrameSlot {
+        std::vector<GLuint> queries;
+        std::vector<ScopeRecord> records;
+        GLuint frameBegin = 0;
+        GLuint frameEnd = 0;
+        size_t nextQuery = 0;
+        uint64_t frameNumber = 0;
+        bool pending = false;
+    };
+
+    struct Accumulator {
+        int depth = 0;
+        double totalMs = 0.0;
+    };
+
+    void createQueries();
+    void releaseQueries();
+    GLuint acquireQuery(FrameSlot& slot);
+    bool resolveSlot(FrameSlot& slot);
+    void publishAverages();
+    void exportFrame(uint64_t frameNumber, double frameMs, const std::vector<std::pair<uint32_t, double>>& scopes);
+    void openExport();
+    void closeExport();
+    uint32_t internName(const std::string& name);
+
+    Settings m_Settings;
+    FrameSlot m_Slots[kFrameLatency];
+    size_t m_CurrentSlot = 0;
+    uint64_t m_FrameNumber = 0;
+    bool m_InFrame = false;
+    std::vector<size_t> m_OpenScopes;
+
+    std::vector<std::string> m_Names;
+    std::unordered_map<std::string, uint32_t> m_NameIds;
+
+    std::unordered_map<uint32_t, Accumulator> m_Accumulators;
+    std::vector<uint32_t> m_AccumulatorOrder;
+    double m_FrameAccumMs = 0.0;
+    int m_AccumFrames = 0;
+    float m_AvgFrameMs = 0.0f;
+    std::vector<ScopeStat> m_ScopeStats;
+    unsigned int m_DroppedFrames = 0;
+    uint64_t m_PublishCount = 0;
+
+    std::ofstream m_Export;
+    bool m_ExportJson = false;
+    bool m_ExportFirstEntry = true;
+};
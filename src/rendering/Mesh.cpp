@@ -4,8 +4,9 @@
 #include <glm/glm.hpp>
 #include <stdexcept>
 
-#include "GlUtils.h"
+#include "GlExtensions.h"
 #include "Renderer.h"
+#include "VertexAnimation.h"
 
 size_t Mesh::s_DefaultInstanceCapacityBytes = 0;
 
@@ -21,12 +22,13 @@ Mesh::Mesh(float* vertices, unsigned int vertSize,
     }
 
     m_Vbo.setData(vertSize, vertices, GL_STATIC_DRAW);
+    m_VertexBytes = vertSize;
 
     m_Ebo.setData(
         idxCount * sizeof(unsigned int),
         indices, GL_STATIC_DRAW);
 
-    m_Vao.setVertexBuffer(0, m_Vbo.id(), 0, 8 * sizeof(float));
+    m_Vao.setVertexBuffer(0, m_Vbo.id(), 0, kVertexFloats * sizeof(float));
     m_Vao.setElementBuffer(m_Ebo.id());
 
     // Position attribute (location = 0)
@@ -44,22 +46,17 @@ Mesh::Mesh(float* vertices, unsigned int vertSize,
     m_Vao.setAttribFormat(2, 2, GL_FLOAT, GL_FALSE, 6 * sizeof(float));
     m_Vao.setAttribBinding(2, 0);
 
+    // Baked ambient occlusion attribute (location = 10, after the instance attributes)
+    m_Vao.enableAttrib(10);
+    m_Vao.setAttribFormat(10, 1, GL_FLOAT, GL_FALSE, kOcclusionOffset * sizeof(float));
+    m_Vao.setAttribBinding(10, 0);
+
     if (s_DefaultInstanceCapacityBytes > 0) {
         m_InstanceVbo.setData(static_cast<GLsizeiptr>(s_DefaultInstanceCapacityBytes), nullptr, GL_DYNAMIC_DRAW);
         m_InstanceCapacityBytes = s_DefaultInstanceCapacityBytes;
     }
 
-    const GLsizei instanceStride = static_cast<GLsizei>(sizeof(InstanceData));
-    m_Vao.setVertexBuffer(1, m_InstanceVbo.id(), 0, instanceStride);
-
-    // Setup instance modelMatrix attributes (locations 3-6)
-    for (int i = 0; i < 4; i++) {
-        m_Vao.enableAttrib(3 + i);
-        m_Vao.setAttribFormat(
-            3 + i, 4, GL_FLOAT, GL_FALSE,
-            static_cast<GLuint>(offsetof(InstanceData, modelMatrix) + sizeof(glm::vec4) * i));
-        m_Vao.setAttribBinding(3 + i, 1);
-    }
+    setInstanceTransformAttributes(m_Vao);
 
     // Setup instance normalMatrix attributes (locations 7-9, only 3 vec4s for mat3)
     for (int i = 0; i < 3; i++) {
@@ -69,28 +66,145 @@ Mesh::Mesh(float* vertices, unsigned int vertSize,
             static_cast<GLuint>(offsetof(InstanceData, normalMatrix) + sizeof(glm::vec3) * i));
         m_Vao.setAttribBinding(7 + i, 1);
     }
-    m_Vao.setBindingDivisor(1, 1);
 
-    checkGlError("Mesh::Mesh");
+    // Setup instance joint palette offset (location = 13), only read by skinned variants
+    m_Vao.enableAttrib(13);
+    m_Vao.setAttribIFormat(13, 1, GL_UNSIGNED_INT, static_cast<GLuint>(offsetof(InstanceData, paletteOffset)));
+    m_Vao.setAttribBinding(13, 1);
+
+    // Setup instance clip and time offset (location = 14), only read by vertex animated variants.
+    // Both go through one integer attribute; the shader reinterprets the time bits as float.
+    m_Vao.enableAttrib(14);
+    m_Vao.setAttribIFormat(14, 2, GL_UNSIGNED_INT, static_cast<GLuint>(offsetof(InstanceData, animationClip)));
+    m_Vao.setAttribBinding(14, 1);
+}
+
+Mesh::~Mesh() = default;
+
+void Mesh::setInstanceTransformAttributes(const VertexArray& vao) const {
+    const GLsizei instanceStride = static_cast<GLsizei>(sizeof(InstanceData));
+    vao.setVertexBuffer(1, m_InstanceVbo.id(), 0, instanceStride);
+
+    // Setup instance modelMatrix attributes (locations 3-6)
+    for (int i = 0; i < 4; i++) {
+        vao.enableAttrib(3 + i);
+        vao.setAttribFormat(
+            3 + i, 4, GL_FLOAT, GL_FALSE,
+            static_cast<GLuint>(offsetof(InstanceData, modelMatrix) + sizeof(glm::vec4) * i));
+        vao.setAttribBinding(3 + i, 1);
+    }
+    vao.setBindingDivisor(1, 1);
 }
 
-void Mesh::drawInstanced(unsigned int count) const {
+void Mesh::setPositionStream(const std::vector<float>& positions) {
+    if (positions.size() % 3 != 0 || positions.size() / 3 * kVertexFloats * sizeof(float) != m_VertexBytes) {
+        throw std::invalid_argument("Position stream must hold one position per vertex");
+    }
+    m_PositionVbo.setData(static_cast<GLsizeiptr>(positions.size() * sizeof(float)), positions.data(), GL_STATIC_DRAW);
+    m_DepthVao.setVertexBuffer(3, m_PositionVbo.id(), 0, 3 * sizeof(float));
+    m_DepthVao.setElementBuffer(m_Ebo.id());
+
+    // Position attribute (location = 0), the only per-vertex input of depth-only shaders
+    m_DepthVao.enableAttrib(0);
+    m_DepthVao.setAttribFormat(0, 3, GL_FLOAT, GL_FALSE, 0);
+    m_DepthVao.setAttribBinding(0, 3);
+
+    setInstanceTransformAttributes(m_DepthVao);
+    m_HasPositionStream = true;
+}
+
+void Mesh::setVertexAnimation(const VertexAnimationData& data) {
+    if (static_cast<size_t>(data.vertexCount) * kVertexFloats * sizeof(float) != m_VertexBytes) {
+        throw std::invalid_argument("Vertex animation must hold one entry per vertex");
+    }
+    auto animation = std::make_unique<VertexAnimationTexture>();
+    animation->upload(data);
+    m_VertexAnimation = std::move(animation);
+}
+
+void Mesh::setSkin(const std::vector<SkinVertex>& skin) {
+    if (skin.size() * kVertexFloats * sizeof(float) != m_VertexBytes) {
+        throw std::invalid_argument("Skin stream must hold one entry per vertex");
+    }
+    m_SkinVbo.setData(static_cast<GLsizeiptr>(skin.size() * sizeof(SkinVertex)), skin.data(), GL_STATIC_DRAW);
+    m_Vao.setVertexBuffer(2, m_SkinVbo.id(), 0, sizeof(SkinVertex));
+
+    // Joint indices (location = 11) and weights (location = 12)
+    m_Vao.enableAttrib(11);
+    m_Vao.setAttribIFormat(11, 4, GL_UNSIGNED_BYTE, static_cast<GLuint>(offsetof(SkinVertex, joints)));
+    m_Vao.setAttribBinding(11, 2);
+    m_Vao.enableAttrib(12);
+    m_Vao.setAttribFormat(12, 4, GL_UNSIGNED_SHORT, GL_TRUE, static_cast<GLuint>(offsetof(SkinVertex, weights)));
+    m_Vao.setAttribBinding(12, 2);
+    m_Skinned = true;
+}
+
+void Mesh::drawInstanced(unsigned int count, unsigned int baseInstance) const {
     if (count == 0) return;
 
     m_Vao.bind();
 
-    glDrawElementsInstanced(
+    glDrawElementsInstancedBaseInstance(
         GL_TRIANGLES,
         indexCount,
         GL_UNSIGNED_INT,
         nullptr,
-        count);
+        count,
+        baseInstance);
+
+    VertexArray::unbind();
+}
 
-    checkGlError("Mesh::drawInstanced");
+void Mesh::drawDepthInstanced(unsigned int count) const {
+    if (!m_HasPositionStream) {
+        drawInstanced(count);
+        return;
+    }
+    if (count == 0) return;
 
+    m_DepthVao.bind();
+    glDrawElementsInstanced(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, nullptr, count);
     VertexArray::unbind();
 }
 
+void Mesh::drawIndirect(GLuint commandBuffer, GLintptr commandOffset, GLsizei maxDraws,
+                        GLuint countBuffer, GLintptr countOffset) const {
+    if (maxDraws <= 0) return;
+
+    m_Vao.bind();
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+    const void* indirect = reinterpret_cast<const void*>(commandOffset);
+    if (countBuffer != 0 && GlExtensions::multiDrawElementsIndirectCount) {
+        glBindBuffer(GL_PARAMETER_BUFFER, countBuffer);
+        GlExtensions::multiDrawElementsIndirectCount(GL_TRIANGLES, GL_UNSIGNED_INT, indirect,
+                                                     countOffset, maxDraws, 0);
+        glBindBuffer(GL_PARAMETER_BUFFER, 0);
+    } else {
+        glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, indirect, maxDraws, 0);
+    }
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+    VertexArray::unbind();
+}
+
+MeshData Mesh::readBack() const {
+    MeshData data;
+    data.vertices.resize(m_VertexBytes / sizeof(float));
+    data.indices.resize(indexCount);
+    data.aabb = m_AABB;
+    glGetNamedBufferSubData(m_Vbo.id(), 0, static_cast<GLsizeiptr>(data.vertices.size() * sizeof(float)),
+                            data.vertices.data());
+    glGetNamedBufferSubData(m_Ebo.id(), 0, static_cast<GLsizeiptr>(data.indices.size() * sizeof(unsigned int)),
+                            data.indices.data());
+    return data;
+}
+
+void Mesh::setMeshlets(const std::vector<Meshlet>& meshlets) {
+    m_MeshletCount = static_cast<unsigned int>(meshlets.size());
+    if (meshlets.empty()) return;
+    m_MeshletBuffer.setData(static_cast<GLsizeiptr>(meshlets.size() * sizeof(Meshlet)), meshlets.data(), GL_STATIC_DRAW);
+}
+
 void Mesh::updateInstanceBuffer(const void* data, size_t size) const {
     if (size == 0) return;
 
@@ -3,9 +3,13 @@
 #include <glad/glad.h>
 
 #include <cstddef>
+#include <cstdint>
 #include <glm/vec3.hpp>
+#include <memory>
+#include <vector>
 
 #include "GlBuffer.h"
+#include "Meshlets.h"
 #include "VertexArray.h"
 
 struct AABB {
@@ -13,18 +17,72 @@ struct AABB {
     glm::vec3 max;
 };
 
+struct VertexAnimationData;
+class VertexAnimationTexture;
+
+// Compact skinning stream: four 8-bit joint indices and four normalized 16-bit weights
+struct SkinVertex {
+    uint8_t joints[4];
+    uint16_t weights[4];
+};
+
+// CPU copy of a mesh: interleaved position/normal/uv/occlusion (Mesh::kVertexFloats per vertex) and indices
+struct MeshData {
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+    AABB aabb;
+    std::vector<SkinVertex> skin;  // One per vertex for skinned meshes, otherwise empty
+    std::vector<float> positions;  // Packed xyz for Mesh::setPositionStream, empty when not cooked
+};
+
 class Mesh {
    public:
+    // 3 position + 3 normal + 2 tex + 1 baked ambient occlusion
+    static constexpr size_t kVertexFloats = 9;
+    // Occlusion is the last float of each vertex
+    static constexpr size_t kOcclusionOffset = kVertexFloats - 1;
+
     Mesh(float* vertices, unsigned int vertSize,
          unsigned int* indices, unsigned int idxCount, const AABB& aabb);
+    ~Mesh();
     Mesh(const Mesh&) = delete;
     Mesh& operator=(const Mesh&) = delete;
     Mesh(Mesh&&) = delete;
     Mesh& operator=(Mesh&&) = delete;
 
-    void drawInstanced(unsigned int count) const;
+    // `baseInstance` offsets the per-instance attributes into the instance buffer
+    void drawInstanced(unsigned int count, unsigned int baseInstance = 0) const;
+    // Depth-only draw: reads positions and the instance transform only, from the position
+    // stream when the mesh has one (12 instead of 36 bytes per vertex)
+    void drawDepthInstanced(unsigned int count) const;
+    // Draws `maxDraws` DrawElementsIndirectCommands; with a count buffer only the first
+    // count of them (read on the GPU) are executed
+    void drawIndirect(GLuint commandBuffer, GLintptr commandOffset, GLsizei maxDraws,
+                      GLuint countBuffer = 0, GLintptr countOffset = 0) const;
+
+    // Copies the vertex and index buffers back from the GPU. Stalls, meant for build-time tools.
+    MeshData readBack() const;
+
+    // Adds the joint/weight stream; skinned meshes are drawn with the SKINNED shader variant
+    void setSkin(const std::vector<SkinVertex>& skin);
+    bool isSkinned() const { return m_Skinned; }
+    // Tightly packed copy of the positions (3 floats per vertex) behind the depth-only VAO
+    void setPositionStream(const std::vector<float>& positions);
+    bool hasPositionStream() const { return m_HasPositionStream; }
+    // Uploads baked clips; instances submitted with Renderer::submitAnimated play them on the GPU
+    void setVertexAnimation(const VertexAnimationData& data);
+    const VertexAnimationTexture* getVertexAnimation() const { return m_VertexAnimation.get(); }
+
+    void setMeshlets(const std::vector<Meshlet>& meshlets);
+    bool hasMeshlets() const { return m_MeshletCount > 0; }
+    unsigned int getMeshletCount() const { return m_MeshletCount; }
+    unsigned int getMeshletBuffer() const { return m_MeshletBuffer.id(); }
+    unsigned int getInstanceBuffer() const { return m_InstanceVbo.id(); }
 
     unsigned int getVAO() const { return m_Vao.id(); }
+    // Raw vertex and index buffers, fetched as storage buffers by the visibility resolve
+    unsigned int getVertexBuffer() const { return m_Vbo.id(); }
+    unsigned int getIndexBuffer() const { return m_Ebo.id(); }
     unsigned int getIndexCount() const { return indexCount; }
     void updateInstanceBuffer(const void* data, size_t size) const;
     static void setDefaultInstanceCapacityBytes(size_t bytes);
@@ -32,6 +90,9 @@ class Mesh {
     void setAABB(const AABB& aabb) { m_AABB = aabb; }
 
    private:
+    // Instance buffer at binding 1 with the model matrix at locations 3-6
+    void setInstanceTransformAttributes(const VertexArray& vao) const;
+
     VertexArray m_Vao;
     GlBuffer m_Vbo{GL_ARRAY_BUFFER};
     GlBuffer m_Ebo{GL_ELEMENT_ARRAY_BUFFER};
@@ -39,5 +100,15 @@ class Mesh {
     GlBuffer m_InstanceVbo{GL_ARRAY_BUFFER};
     mutable size_t m_InstanceCapacityBytes = 0;
     unsigned int indexCount = 0;
+    GlBuffer m_SkinVbo{GL_ARRAY_BUFFER};
+    bool m_Skinned = false;
+    // Position stream at binding 3, sharing the index and instance buffers
+    VertexArray m_DepthVao;
+    GlBuffer m_PositionVbo{GL_ARRAY_BUFFER};
+    bool m_HasPositionStream = false;
+    std::unique_ptr<VertexAnimationTexture> m_VertexAnimation;
+    GlBuffer m_MeshletBuffer{GL_SHADER_STORAGE_BUFFER};
+    unsigned int m_MeshletCount = 0;
+    size_t m_VertexBytes = 0;
     static size_t s_DefaultInstanceCapacityBytes;
 };
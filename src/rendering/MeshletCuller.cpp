@@ -0,0 +1,112 @@
+#include "MeshletCuller.h"
+
+#include <algorithm>
+
+#include "Frustum.h"
+#include "GlExtensions.h"
+#include "Mesh.h"
+#include "Renderer.h"
+#include "assets/Shader.h"
+
+namespace {
+const GLuint kCullGroupSize = 64;
+}
+
+MeshletCuller::MeshletCuller() = default;
+MeshletCuller::~MeshletCuller() = default;
+
+void MeshletCuller::loadShaders() {
+    m_CullShader = std::make_unique<Shader>("assets/shaders/meshlet_cull");
+    m_Compact = GlExtensions::multiDrawElementsIndirectCount != nullptr;
+}
+
+void MeshletCuller::beginFrame(const glm::mat4& viewProj, const glm::vec3& cameraPos) {
+    Frustum frustum = extractFrustum(viewProj);
+    for (int i = 0; i < 6; ++i) {
+        m_FrustumPlanes[i] = frustum.planes[i];
+    }
+    m_CameraPos = cameraPos;
+    m_CommandCursor = 0;
+    m_CountCursor = 0;
+    m_Tested = 0;
+}
+
+void MeshletCuller::reserve(size_t commands, size_t batches) {
+    // Growing orphans the old storage, which draws issued earlier this frame still reference
+    if (commands > m_CommandCapacity) {
+        m_CommandCapacity = std::max(commands, m_CommandCapacity * 2);
+        m_Commands.setData(static_cast<GLsizeiptr>(m_CommandCapacity * sizeof(DrawCommand)), nullptr, GL_DYNAMIC_DRAW);
+        m_CommandCursor = 0;
+    }
+    if (batches > m_CountCapacity) {
+        m_CountCapacity = std::max<size_t>(batches, std::max<size_t>(m_CountCapacity * 2, 64));
+        m_Counts.setData(static_cast<GLsizeiptr>(m_CountCapacity * sizeof(uint32_t)), nullptr, GL_DYNAMIC_DRAW);
+        m_CountCursor = 0;
+    }
+}
+
+MeshletCuller::Result MeshletCuller::cull(const Mesh& mesh, unsigned int instanceCount, bool coneCulling) {
+    Result result;
+    size_t commandCount = static_cast<size_t>(mesh.getMeshletCount()) * instanceCount;
+    if (commandCount == 0 || !m_CullShader) {
+        return result;
+    }
+
+    reserve(m_CommandCursor + commandCount, m_CountCursor + 1);
+    result.commandBuffer = m_Commands.id();
+    result.commandOffset = static_cast<GLintptr>(m_CommandCursor * sizeof(DrawCommand));
+    result.maxDraws = static_cast<GLsizei>(commandCount);
+    if (m_Compact) {
+        result.countBuffer = m_Counts.id();
+        result.countOffset = static_cast<GLintptr>(m_CountCursor * sizeof(uint32_t));
+        const uint32_t zero = 0;
+        glClearNamedBufferSubData(m_Counts.id(), GL_R32UI, result.countOffset, sizeof(uint32_t),
+                                  GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+    }
+
+    m_CullShader->bind();
+    m_CullShader->setInt("u_MeshletCount", static_cast<int>(mesh.getMeshletCount()));
+    m_CullShader->setInt("u_InstanceCount", static_cast<int>(instanceCount));
+    m_CullShader->setInt("u_InstanceStride", static_cast<int>(sizeof(InstanceData) / sizeof(float)));
+    m_CullShader->setInt("u_CommandOffset", static_cast<int>(m_CommandCursor));
+    m_CullShader->setInt("u_CountIndex", static_cast<int>(m_CountCursor));
+    m_CullShader->setBool("u_ConeCulling", coneCulling);
+    m_CullShader->setBool("u_Compact", m_Compact);
+    m_CullShader->setVec3("u_CameraPos", &m_CameraPos[0]);
+    for (int i = 0; i < 6; ++i) {
+        m_CullShader->setVec4("u_FrustumPlanes[" + std::to_string(i) + "]", &m_FrustumPlanes[i][0]);
+    }
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, mesh.getMeshletBuffer());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, mesh.getInstanceBuffer());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, m_Commands.id());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, m_Counts.id());
+
+    GLuint groups = static_cast<GLuint>((commandCount + kCullGroupSize - 1) / kCullGroupSize);
+    glDispatchCompute(groups, 1, 1);
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+
+    m_CommandCursor += commandCount;
+    if (m_Compact) {
+        m_CountCursor++;
+    }
+    m_Tested += static_cast<unsigned int>(commandCount);
+    return result;
+}
+
+void MeshletCuller::endFrame() {
+    if (m_Compact && m_CountCursor > 0) {
+        glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+        m_VisibleReadback.request(m_Counts.id(), 0, static_cast<GLsizeiptr>(m_CountCursor * sizeof(uint32_t)));
+    }
+
+    while (m_VisibleReadback.poll(m_ReadbackData)) {
+        const auto* counts = reinterpret_cast<const uint32_t*>(m_ReadbackData.data());
+        size_t batches = m_ReadbackData.size() / sizeof(uint32_t);
+        unsigned int visible = 0;
+        for (size_t i = 0; i < batches; ++i) {
+            visible += counts[i];
+        }
+        m_Visible = visible;
+    }
+}
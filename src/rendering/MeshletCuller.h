@@ -0,0 +1,73 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <memory>
+#include <vector>
+
+#include "BufferReadback.h"
+#include "GlBuffer.h"
+
+class Mesh;
+class Shader;
+
+// GPU cluster culling: one compute invocation per (instance, meshlet) tests the meshlet's
+// bounding sphere against the frustum and its normal cone against the camera, and writes a
+// DrawElementsIndirectCommand for each survivor. With indirect count support the commands
+// are compacted behind an atomic counter; otherwise culled commands get zero instances.
+class MeshletCuller {
+   public:
+    struct Result {
+        GLuint commandBuffer = 0;
+        GLintptr commandOffset = 0;
+        GLsizei maxDraws = 0;
+        GLuint countBuffer = 0;
+        GLintptr countOffset = 0;
+    };
+
+    MeshletCuller();
+    ~MeshletCuller();
+
+    MeshletCuller(const MeshletCuller&) = delete;
+    MeshletCuller& operator=(const MeshletCuller&) = delete;
+
+    void loadShaders();
+    void beginFrame(const glm::mat4& viewProj, const glm::vec3& cameraPos);
+    // Dispatches the cull for a batch whose instances are already uploaded to the mesh.
+    // Binds the cull program, so the caller binds its own program afterwards.
+    Result cull(const Mesh& mesh, unsigned int instanceCount, bool coneCulling);
+    void endFrame();
+
+    // Meshlets tested this frame and the compacted survivors, read back a few frames late
+    unsigned int getTested() const { return m_Tested; }
+    unsigned int getVisible() const { return m_Visible; }
+
+   private:
+    struct DrawCommand {
+        uint32_t count;
+        uint32_t instanceCount;
+        uint32_t firstIndex;
+        int32_t baseVertex;
+        uint32_t baseInstance;
+    };
+
+    void reserve(size_t commands, size_t batches);
+
+    std::unique_ptr<Shader> m_CullShader;
+    GlBuffer m_Commands{GL_DRAW_INDIRECT_BUFFER};
+    GlBuffer m_Counts{GL_PARAMETER_BUFFER};
+    size_t m_CommandCapacity = 0;
+    size_t m_CountCapacity = 0;
+    // Each batch gets its own region so no dispatch overwrites commands an earlier draw reads
+    size_t m_CommandCursor = 0;
+    size_t m_CountCursor = 0;
+    glm::vec4 m_FrustumPlanes[6];
+    glm::vec3 m_CameraPos{0.0f};
+    bool m_Compact = false;
+    unsigned int m_Tested = 0;
+    unsigned int m_Visible = 0;
+    BufferReadback m_VisibleReadback;
+    std::vector<uint8_t> m_ReadbackData;
+};
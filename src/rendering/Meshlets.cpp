@@ -0,0 +1,115 @@
+#include "Meshlets.h"
+
+#include <algorithm>
+#include <cmath>
+#include <glm/glm.hpp>
+#include <unordered_set>
+
+namespace {
+glm::vec3 vertexPosition(const float* vertices, size_t strideFloats, unsigned int index) {
+    const float* v = vertices + static_cast<size_t>(index) * strideFloats;
+    return glm::vec3(v[0], v[1], v[2]);
+}
+
+void computeBounds(Meshlet& meshlet, const float* vertices, size_t strideFloats,
+                   const std::vector<unsigned int>& indices) {
+    size_t begin = meshlet.indexOffset;
+    size_t end = begin + meshlet.indexCount;
+
+    // Sphere around the vertex centroid; looser than a minimal sphere but cheap and stable
+    glm::vec3 center(0.0f);
+    for (size_t i = begin; i < end; ++i) {
+        center += vertexPosition(vertices, strideFloats, indices[i]);
+    }
+    center /= static_cast<float>(meshlet.indexCount);
+    float radius = 0.0f;
+    for (size_t i = begin; i < end; ++i) {
+        radius = std::max(radius, glm::length(vertexPosition(vertices, strideFloats, indices[i]) - center));
+    }
+    meshlet.boundingSphere = glm::vec4(center, radius);
+
+    // Normal cone from the face normals, the winding the rasterizer culls by
+    std::vector<glm::vec3> normals;
+    normals.reserve(meshlet.indexCount / 3);
+    glm::vec3 axis(0.0f);
+    for (size_t i = begin; i + 2 < end; i += 3) {
+        glm::vec3 a = vertexPosition(vertices, strideFloats, indices[i]);
+        glm::vec3 b = vertexPosition(vertices, strideFloats, indices[i + 1]);
+        glm::vec3 c = vertexPosition(vertices, strideFloats, indices[i + 2]);
+        glm::vec3 n = glm::cross(b - a, c - a);
+        float length = glm::length(n);
+        if (length <= 1e-12f) {
+            continue;  // Degenerate triangles never rasterize
+        }
+        n /= length;
+        normals.push_back(n);
+        axis += n;
+    }
+
+    float axisLength = glm::length(axis);
+    if (normals.empty() || axisLength <= 1e-6f) {
+        meshlet.cone = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+        return;
+    }
+    axis /= axisLength;
+
+    float minDot = 1.0f;
+    for (const auto& n : normals) {
+        minDot = std::min(minDot, glm::dot(n, axis));
+    }
+    // A cone wider than a hemisphere can always be seen from somewhere
+    if (minDot <= 0.0f) {
+        meshlet.cone = glm::vec4(axis, 1.0f);
+        return;
+    }
+    float cutoff = std::sqrt(1.0f - minDot * minDot);
+    meshlet.cone = glm::vec4(axis, cutoff);
+}
+}
+
+std::vector<Meshlet> buildMeshlets(const float* vertices, size_t vertexCount, size_t strideFloats,
+                                   const std::vector<unsigned int>& indices,
+                                   const MeshletSettings& settings) {
+    std::vector<Meshlet> meshlets;
+    if (!vertices || vertexCount == 0 || indices.size() < 3) {
+        return meshlets;
+    }
+
+    std::unordered_set<unsigned int> uniqueVertices;
+    uniqueVertices.reserve(settings.maxVertices * 2);
+    Meshlet current{};
+    size_t triangles = 0;
+
+    auto finish = [&]() {
+        if (current.indexCount == 0) {
+            return;
+        }
+        computeBounds(current, vertices, strideFloats, indices);
+        meshlets.push_back(current);
+        current = Meshlet{};
+        current.indexOffset = static_cast<uint32_t>(meshlets.back().indexOffset + meshlets.back().indexCount);
+        uniqueVertices.clear();
+        triangles = 0;
+    };
+
+    size_t triangleIndexCount = indices.size() - indices.size() % 3;
+    for (size_t i = 0; i < triangleIndexCount; i += 3) {
+        size_t newVertices = 0;
+        for (size_t k = 0; k < 3; ++k) {
+            if (indices[i + k] >= vertexCount) {
+                return {};  // Malformed index buffer, draw the mesh as a whole
+            }
+            newVertices += uniqueVertices.count(indices[i + k]) ? 0 : 1;
+        }
+        if (uniqueVertices.size() + newVertices > settings.maxVertices || triangles + 1 > settings.maxTriangles) {
+            finish();
+        }
+        for (size_t k = 0; k < 3; ++k) {
+            uniqueVertices.insert(indices[i + k]);
+        }
+        current.indexCount += 3;
+        triangles++;
+    }
+    finish();
+    return meshlets;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/vec4.hpp>
+#include <vector>
+
+// std430 layout shared with meshlet_cull.comp
+struct Meshlet {
+    glm::vec4 boundingSphere;  // xyz center, w radius (object space)
+    glm::vec4 cone;            // xyz axis, w cutoff; w >= 1 disables backface culling
+    uint32_t indexOffset;
+    uint32_t indexCount;
+    uint32_t padding[2];
+};
+
+struct MeshletSettings {
+    size_t maxVertices = 64;
+    size_t maxTriangles = 124;
+};
+
+// Splits an indexed triangle list into contiguous clusters of at most `maxVertices` unique
+// vertices and `maxTriangles` triangles, each with a bounding sphere and a normal cone.
+// Clusters follow index order, so the index buffer is used as is. `vertices` are
+// interleaved with `strideFloats` floats per vertex and the position first.
+std::vector<Meshlet> buildMeshlets(const float* vertices, size_t vertexCount, size_t strideFloats,
+                                   const std::vector<unsigned int>& indices,
+                                   const MeshletSettings& settings = MeshletSettings());
@@ -0,0 +1,175 @@
+#include "ParticleSystem.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <numeric>
+#include <stdexcept>
+
+#include "assets/Shader.h"
+
+namespace {
+const GLuint kParticleGroupSize = 64;
+// Matches Particle in the particle shaders: position + age, velocity + lifetime
+const GLsizeiptr kParticleBytes = 2 * sizeof(glm::vec4);
+const GLsizei kBillboardVertices = 6;
+}
+
+ParticleSystem::ParticleSystem() = default;
+ParticleSystem::~ParticleSystem() = default;
+
+void ParticleSystem::loadShaders() {
+    m_EmitShader = std::make_unique<Shader>("assets/shaders/particle_emit");
+    m_ArgsShader = std::make_unique<Shader>("assets/shaders/particle_args");
+    m_SimulateShader = std::make_unique<Shader>("assets/shaders/particle_simulate");
+    m_RenderShader = std::make_unique<Shader>("assets/shaders/particle");
+}
+
+size_t ParticleSystem::addEmitter(const EmitterSettings& settings) {
+    if (settings.maxParticles == 0) {
+        throw std::runtime_error("Particle emitter needs maxParticles > 0");
+    }
+    auto emitter = std::make_unique<Emitter>();
+    emitter->settings = settings;
+    GLsizeiptr capacity = settings.maxParticles;
+
+    emitter->particles.setData(capacity * kParticleBytes, nullptr, GL_DYNAMIC_COPY);
+    emitter->aliveLists.setData(2 * capacity * static_cast<GLsizeiptr>(sizeof(uint32_t)), nullptr, GL_DYNAMIC_COPY);
+
+    // Every slot starts out dead
+    std::vector<uint32_t> dead(settings.maxParticles);
+    std::iota(dead.begin(), dead.end(), 0u);
+    emitter->deadList.setData(capacity * static_cast<GLsizeiptr>(sizeof(uint32_t)), dead.data(), GL_DYNAMIC_COPY);
+
+    GpuState state{};
+    state.deadCount = static_cast<int32_t>(settings.maxParticles);
+    state.dispatchArgs[1] = state.dispatchArgs[2] = 1;
+    state.drawArgs[0] = kBillboardVertices;
+    emitter->state.setData(sizeof(GpuState), &state, GL_DYNAMIC_COPY);
+
+    m_Emitters.push_back(std::move(emitter));
+    return m_Emitters.size() - 1;
+}
+
+void ParticleSystem::clear() {
+    m_Emitters.clear();
+    m_Alive = 0;
+}
+
+void ParticleSystem::update(float deltaTime) {
+    m_DeltaTime = deltaTime;
+    for (auto& emitter : m_Emitters) {
+        emitter->emitAccumulator += emitter->settings.emitRate * deltaTime;
+        auto whole = static_cast<uint32_t>(emitter->emitAccumulator);
+        emitter->emitAccumulator -= static_cast<float>(whole);
+        // The emit pass never pops more than the dead list holds, so capping here only
+        // bounds the dispatch size
+        emitter->pendingEmit = std::min(whole, emitter->settings.maxParticles);
+    }
+}
+
+void ParticleSystem::bindEmitterBuffers(const Emitter& emitter) const {
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, emitter.particles.id());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, emitter.deadList.id());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, emitter.aliveLists.id());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, emitter.state.id());
+}
+
+void ParticleSystem::simulate() {
+    if (m_Emitters.empty() || !m_SimulateShader) {
+        return;
+    }
+    m_Frame++;
+
+    for (auto& emitter : m_Emitters) {
+        const auto& settings = emitter->settings;
+        bindEmitterBuffers(*emitter);
+
+        if (emitter->pendingEmit > 0) {
+            m_EmitShader->bind();
+            m_EmitShader->setInt("u_EmitCount", static_cast<int>(emitter->pendingEmit));
+            m_EmitShader->setInt("u_Capacity", static_cast<int>(settings.maxParticles));
+            m_EmitShader->setInt("u_Current", static_cast<int>(m_Current));
+            m_EmitShader->setInt("u_Seed", static_cast<int>(m_Frame));
+            m_EmitShader->setVec3("u_Position", &settings.position[0]);
+            m_EmitShader->setVec3("u_Velocity", &settings.velocity[0]);
+            m_EmitShader->setFloat("u_VelocitySpread", settings.velocitySpread);
+            m_EmitShader->setFloat("u_Lifetime", settings.lifetime);
+            glDispatchCompute((emitter->pendingEmit + kParticleGroupSize - 1) / kParticleGroupSize, 1, 1);
+            glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+        }
+
+        m_ArgsShader->bind();
+        m_ArgsShader->setInt("u_Current", static_cast<int>(m_Current));
+        glDispatchCompute(1, 1, 1);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+
+        m_SimulateShader->bind();
+        m_SimulateShader->setInt("u_Capacity", static_cast<int>(settings.maxParticles));
+        m_SimulateShader->setInt("u_Current", static_cast<int>(m_Current));
+        m_SimulateShader->setFloat("u_DeltaTime", m_DeltaTime);
+        m_SimulateShader->setVec3("u_Gravity", &settings.gravity[0]);
+        glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, emitter->state.id());
+        glDispatchComputeIndirect(static_cast<GLintptr>(offsetof(GpuState, dispatchArgs)));
+    }
+    glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, 0);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+
+    m_Current = 1 - m_Current;
+    m_DeltaTime = 0.0f;
+}
+
+void ParticleSystem::render(const glm::vec3& cameraRight, const glm::vec3& cameraUp) {
+    if (m_Emitters.empty() || !m_RenderShader) {
+        return;
+    }
+
+    glDisable(GL_CULL_FACE);
+    m_RenderShader->bind();
+    m_RenderShader->setVec3("u_CameraRight", &cameraRight[0]);
+    m_RenderShader->setVec3("u_CameraUp", &cameraUp[0]);
+    m_BillboardVao.bind();
+    for (auto& emitter : m_Emitters) {
+        const auto& settings = emitter->settings;
+        // simulate() already flipped m_Current, so it names the list that was just written
+        m_RenderShader->setInt("u_AliveOffset", static_cast<int>(m_Current * settings.maxParticles));
+        m_RenderShader->setVec4("u_StartColor", &settings.startColor[0]);
+        m_RenderShader->setVec4("u_EndColor", &settings.endColor[0]);
+        m_RenderShader->setFloat("u_StartSize", settings.startSize);
+        m_RenderShader->setFloat("u_EndSize", settings.endSize);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, emitter->particles.id());
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, emitter->aliveLists.id());
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, emitter->state.id());
+        glDrawArraysIndirect(GL_TRIANGLES, reinterpret_cast<const void*>(offsetof(GpuState, drawArgs)));
+    }
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    VertexArray::unbind();
+}
+
+void ParticleSystem::endFrame() {
+    if (!m_Emitters.empty()) {
+        // Gather every emitter's instance count so one readback covers the whole system
+        auto size = static_cast<GLsizeiptr>(m_Emitters.size() * sizeof(uint32_t));
+        if (size > m_AliveCountsSize) {
+            m_AliveCounts.setData(size, nullptr, GL_DYNAMIC_COPY);
+            m_AliveCountsSize = size;
+        }
+        // The args pass writes the counts from a compute shader, copies need the update barrier
+        glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+        for (size_t i = 0; i < m_Emitters.size(); ++i) {
+            glCopyNamedBufferSubData(m_Emitters[i]->state.id(), m_AliveCounts.id(),
+                                     static_cast<GLintptr>(offsetof(GpuState, drawArgs) + sizeof(uint32_t)),
+                                     static_cast<GLintptr>(i * sizeof(uint32_t)), sizeof(uint32_t));
+        }
+        m_AliveReadback.request(m_AliveCounts.id(), 0, size);
+    }
+
+    while (m_AliveReadback.poll(m_ReadbackData)) {
+        const auto* counts = reinterpret_cast<const uint32_t*>(m_ReadbackData.data());
+        size_t emitters = m_ReadbackData.size() / sizeof(uint32_t);
+        unsigned int alive = 0;
+        for (size_t i = 0; i < emitters; ++i) {
+            alive += counts[i];
+        }
+        m_Alive = alive;
+    }
+}
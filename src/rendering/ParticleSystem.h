@@ -0,0 +1,96 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <memory>
+#include <vector>
+
+#include "BufferReadback.h"
+#include "GlBuffer.h"
+#include "VertexArray.h"
+
+class Shader;
+
+// GPU particles: every emitter keeps its particles in SSBOs and allocates them from a
+// dead list. Each frame an emit pass pops dead slots, a one-thread pass turns the alive
+// count into indirect dispatch/draw arguments, and the simulate pass integrates the alive
+// list, compacting survivors into the other alive list and returning expired particles to
+// the dead list. The CPU only computes how many particles to emit.
+class ParticleSystem {
+   public:
+    struct EmitterSettings {
+        glm::vec3 position{0.0f};
+        glm::vec3 velocity{0.0f, 2.0f, 0.0f};
+        float velocitySpread = 1.0f;  // Random velocity added per axis, in units/s
+        glm::vec3 gravity{0.0f, -1.0f, 0.0f};
+        float emitRate = 1000.0f;  // Particles per second
+        float lifetime = 3.0f;
+        glm::vec4 startColor{1.0f, 0.8f, 0.4f, 0.8f};
+        glm::vec4 endColor{1.0f, 0.2f, 0.0f, 0.0f};
+        float startSize = 0.05f;
+        float endSize = 0.01f;
+        uint32_t maxParticles = 65536;
+    };
+
+    ParticleSystem();
+    ~ParticleSystem();
+
+    ParticleSystem(const ParticleSystem&) = delete;
+    ParticleSystem& operator=(const ParticleSystem&) = delete;
+
+    void loadShaders();
+    // Returns the emitter index
+    size_t addEmitter(const EmitterSettings& settings);
+    void clear();
+    bool isActive() const { return !m_Emitters.empty(); }
+
+    // Advances the simulation clock; the GPU work is issued by simulate()
+    void update(float deltaTime);
+    void simulate();
+    // Draws each emitter with one indirect instanced billboard draw into the bound target
+    void render(const glm::vec3& cameraRight, const glm::vec3& cameraUp);
+    void endFrame();
+
+    // Live particles over all emitters, read back a few frames late
+    unsigned int getAlive() const { return m_Alive; }
+
+   private:
+    // Mirrors the State block in the particle shaders (std430)
+    struct GpuState {
+        int32_t deadCount;
+        uint32_t aliveCount[2];
+        uint32_t padding;
+        uint32_t dispatchArgs[4];
+        uint32_t drawArgs[4];  // DrawArraysIndirectCommand
+    };
+
+    struct Emitter {
+        EmitterSettings settings;
+        GlBuffer particles{GL_SHADER_STORAGE_BUFFER};
+        GlBuffer deadList{GL_SHADER_STORAGE_BUFFER};
+        GlBuffer aliveLists{GL_SHADER_STORAGE_BUFFER};  // Two lists of maxParticles each
+        GlBuffer state{GL_SHADER_STORAGE_BUFFER};
+        float emitAccumulator = 0.0f;
+        uint32_t pendingEmit = 0;
+    };
+
+    void bindEmitterBuffers(const Emitter& emitter) const;
+
+    std::unique_ptr<Shader> m_EmitShader;
+    std::unique_ptr<Shader> m_ArgsShader;
+    std::unique_ptr<Shader> m_SimulateShader;
+    std::unique_ptr<Shader> m_RenderShader;
+    std::vector<std::unique_ptr<Emitter>> m_Emitters;
+    VertexArray m_BillboardVao;
+    float m_DeltaTime = 0.0f;
+    uint32_t m_Frame = 0;
+    // Alive list the simulate pass reads; it writes the other one, which is then drawn
+    uint32_t m_Current = 0;
+    GlBuffer m_AliveCounts{GL_COPY_WRITE_BUFFER};
+    GLsizeiptr m_AliveCountsSize = 0;
+    BufferReadback m_AliveReadback;
+    std::vector<uint8_t> m_ReadbackData;
+    unsigned int m_Alive = 0;
+};
@@ -0,0 +1,148 @@
+#include "ProbeVolume.h"
+
+#include <cstring>
+#include <fstream>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/packing.hpp>
+#include <stdexcept>
+
+namespace {
+const char kMagic[4] = {'S', 'E', 'P', 'V'};
+const uint32_t kVersion = 1;
+
+struct FileHeader {
+    char magic[4];
+    uint32_t version;
+    int32_t resolution[3];
+    float boundsMin[3];
+    float boundsMax[3];
+    uint32_t coefficientCount;
+};
+}
+
+glm::vec3 ProbeGrid::getProbePosition(int x, int y, int z) const {
+    glm::vec3 cell = glm::vec3(x, y, z) / glm::max(glm::vec3(resolution - 1), glm::vec3(1.0f));
+    return boundsMin + (boundsMax - boundsMin) * cell;
+}
+
+void ProbeGrid::save(const std::string& path) const {
+    if (coefficients.size() != getProbeCount() * coefficientCount) {
+        throw std::runtime_error("Probe grid coefficient count does not match its resolution");
+    }
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Failed to open probe file for writing: " + path);
+    }
+
+    FileHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    for (int i = 0; i < 3; ++i) {
+        header.resolution[i] = resolution[i];
+        header.boundsMin[i] = boundsMin[i];
+        header.boundsMax[i] = boundsMax[i];
+    }
+    header.coefficientCount = coefficientCount;
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    std::vector<uint16_t> halves;
+    halves.reserve(coefficients.size() * 3);
+    for (const auto& c : coefficients) {
+        halves.push_back(glm::packHalf1x16(c.x));
+        halves.push_back(glm::packHalf1x16(c.y));
+        halves.push_back(glm::packHalf1x16(c.z));
+    }
+    file.write(reinterpret_cast<const char*>(halves.data()),
+               static_cast<std::streamsize>(halves.size() * sizeof(uint16_t)));
+    if (!file) {
+        throw std::runtime_error("Failed to write probe file: " + path);
+    }
+}
+
+ProbeGrid ProbeGrid::load(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Failed to open probe file: " + path);
+    }
+    FileHeader header{};
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file || std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion) {
+        throw std::runtime_error("Not a probe file or unsupported version: " + path);
+    }
+    if (header.coefficientCount != 4 && header.coefficientCount != 9) {
+        throw std::runtime_error("Probe file has an unsupported SH order: " + path);
+    }
+
+    ProbeGrid grid;
+    grid.resolution = glm::ivec3(header.resolution[0], header.resolution[1], header.resolution[2]);
+    grid.boundsMin = glm::vec3(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]);
+    grid.boundsMax = glm::vec3(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]);
+    grid.coefficientCount = header.coefficientCount;
+    if (grid.resolution.x < 1 || grid.resolution.y < 1 || grid.resolution.z < 1) {
+        throw std::runtime_error("Probe file has an invalid resolution: " + path);
+    }
+
+    std::vector<uint16_t> halves(grid.getProbeCount() * grid.coefficientCount * 3);
+    file.read(reinterpret_cast<char*>(halves.data()), static_cast<std::streamsize>(halves.size() * sizeof(uint16_t)));
+    if (!file) {
+        throw std::runtime_error("Probe file is truncated: " + path);
+    }
+    grid.coefficients.resize(halves.size() / 3);
+    for (size_t i = 0; i < grid.coefficients.size(); ++i) {
+        grid.coefficients[i] = glm::vec3(glm::unpackHalf1x16(halves[i * 3]), glm::unpackHalf1x16(halves[i * 3 + 1]),
+                                         glm::unpackHalf1x16(halves[i * 3 + 2]));
+    }
+    return grid;
+}
+
+ProbeVolume::~ProbeVolume() {
+    release();
+}
+
+void ProbeVolume::release() {
+    if (m_Textures[0]) {
+        glDeleteTextures(3, m_Textures);
+        m_Textures[0] = m_Textures[1] = m_Textures[2] = 0;
+    }
+}
+
+void ProbeVolume::upload(const ProbeGrid& grid) {
+    release();
+    m_BoundsMin = grid.boundsMin;
+    m_BoundsMax = grid.boundsMax;
+    m_Resolution = grid.resolution;
+
+    // Irradiance E(n) = pi * L00 * Y00 + 2pi/3 * sum(L1m * Y1m(n)) with the SH basis
+    // constants folded in, so the shader computes c0 + c1 * n.y + c2 * n.z + c3 * n.x
+    const float band0 = glm::pi<float>() * 0.282095f;
+    const float band1 = 2.0f * glm::pi<float>() / 3.0f * 0.488603f;
+    size_t probes = grid.getProbeCount();
+    std::vector<glm::vec4> channels[3];
+    for (auto& channel : channels) {
+        channel.resize(probes);
+    }
+    for (size_t p = 0; p < probes; ++p) {
+        const glm::vec3* sh = &grid.coefficients[p * grid.coefficientCount];
+        for (int c = 0; c < 3; ++c) {
+            channels[c][p] = glm::vec4(sh[0][c] * band0, sh[1][c] * band1, sh[2][c] * band1, sh[3][c] * band1);
+        }
+    }
+
+    glCreateTextures(GL_TEXTURE_3D, 3, m_Textures);
+    for (int c = 0; c < 3; ++c) {
+        glTextureStorage3D(m_Textures[c], 1, GL_RGBA16F, grid.resolution.x, grid.resolution.y, grid.resolution.z);
+        glTextureSubImage3D(m_Textures[c], 0, 0, 0, 0, grid.resolution.x, grid.resolution.y, grid.resolution.z,
+                            GL_RGBA, GL_FLOAT, channels[c].data());
+        glTextureParameteri(m_Textures[c], GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTextureParameteri(m_Textures[c], GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTextureParameteri(m_Textures[c], GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTextureParameteri(m_Textures[c], GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTextureParameteri(m_Textures[c], GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    }
+}
+
+void ProbeVolume::bind(unsigned int firstUnit) const {
+    for (unsigned int c = 0; c < 3; ++c) {
+        glBindTextureUnit(firstUnit + c, m_Textures[c]);
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+
+// Baked irradiance probes on a regular grid: spherical harmonic radiance coefficients per
+// probe. Written by the bake_probes tool, stored as half floats.
+struct ProbeGrid {
+    glm::ivec3 resolution{0};
+    glm::vec3 boundsMin{0.0f};
+    glm::vec3 boundsMax{0.0f};
+    uint32_t coefficientCount = 9;  // 4 for L1, 9 for L2
+    // RGB radiance coefficients, probe-major with x varying fastest
+    std::vector<glm::vec3> coefficients;
+
+    size_t getProbeCount() const {
+        return static_cast<size_t>(resolution.x) * resolution.y * resolution.z;
+    }
+    glm::vec3 getProbePosition(int x, int y, int z) const;
+
+    void save(const std::string& path) const;
+    static ProbeGrid load(const std::string& path);
+};
+
+// GPU side of a ProbeGrid. Only the L1 band is uploaded, pre-convolved to irradiance and
+// packed per color channel into three RGBA16F volume textures, so basic.frag evaluates
+// diffuse GI with one trilinear fetch per channel.
+class ProbeVolume {
+   public:
+    ProbeVolume() = default;
+    ~ProbeVolume();
+
+    ProbeVolume(const ProbeVolume&) = delete;
+    ProbeVolume& operator=(const ProbeVolume&) = delete;
+
+    void upload(const ProbeGrid& grid);
+    void release();
+    bool isLoaded() const { return m_Textures[0] != 0; }
+
+    // Binds the red, green and blue volumes to three consecutive units
+    void bind(unsigned int firstUnit) const;
+    const glm::vec3& getBoundsMin() const { return m_BoundsMin; }
+    const glm::vec3& getBoundsMax() const { return m_BoundsMax; }
+    const glm::ivec3& getResolution() const { return m_Resolution; }
+
+   private:
+    GLuint m_Textures[3] = {0, 0, 0};
+    glm::vec3 m_BoundsMin{0.0f};
+    glm::vec3 m_BoundsMax{0.0f};
+    glm::ivec3 m_Resolution{0};
+};
@@ -0,0 +1,49 @@
+#include "RenderTexture.h"
+
+#include <stdexcept>
+
+RenderTexture::RenderTexture(int width, int height, GLenum internalFormat)
+    : m_Width(width), m_Height(height), m_InternalFormat(internalFormat) {
+    if (width <= 0 || height <= 0) {
+        throw std::invalid_argument("Invalid render texture size!");
+    }
+
+    glCreateTextures(GL_TEXTURE_2D, 1, &m_Id);
+    glTextureStorage2D(m_Id, 1, internalFormat, width, height);
+    glTextureParameteri(m_Id, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTextureParameteri(m_Id, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTextureParameteri(m_Id, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTextureParameteri(m_Id, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+}
+
+RenderTexture::~RenderTexture() {
+    release();
+}
+
+RenderTexture::RenderTexture(RenderTexture&& other) noexcept
+    : m_Id(other.m_Id), m_Width(other.m_Width), m_Height(other.m_Height), m_InternalFormat(other.m_InternalFormat) {
+    other.m_Id = 0;
+}
+
+RenderTexture& RenderTexture::operator=(RenderTexture&& other) noexcept {
+    if (this != &other) {
+        release();
+        m_Id = other.m_Id;
+        m_Width = other.m_Width;
+        m_Height = other.m_Height;
+        m_InternalFormat = other.m_InternalFormat;
+        other.m_Id = 0;
+    }
+    return *this;
+}
+
+void RenderTexture::bind(unsigned int slot) const {
+    glBindTextureUnit(slot, m_Id);
+}
+
+void RenderTexture::release() {
+    if (m_Id != 0) {
+        glDeleteTextures(1, &m_Id);
+        m_Id = 0;
+    }
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <glad/glad.h>
+
+class RenderTexture {
+   public:
+    RenderTexture(int width, int height, GLenum internalFormat);
+    ~RenderTexture();
+
+    RenderTexture(const RenderTexture&) = delete;
+    RenderTexture& operator=(const RenderTexture&) = delete;
+    RenderTexture(RenderTexture&& other) noexcept;
+    RenderTexture& operator=(RenderTexture&& other) noexcept;
+
+    void bind(unsigned int slot = 0) const;
+    unsigned int id() const { return m_Id; }
+    int width() const { return m_Width; }
+    int height() const { return m_Height; }
+    GLenum internalFormat() const { return m_InternalFormat; }
+
+   private:
+    void release();
+
+    GLuint m_Id = 0;
+    int m_Width = 0;
+    int m_Height = 0;
+    GLenum m_InternalFormat = GL_RGBA8;
+};
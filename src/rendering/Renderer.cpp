@@ -3,12 +3,19 @@
 #include <glad/glad.h>
 
 #include <algorithm>
+#include <cmath>
 #include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
 #include <glm/gtc/matrix_inverse.hpp>
+#include <optional>
 #include <stdexcept>
+#include <string>
 
 #include "Frustum.h"
 #include "assets/Texture.h"
+#include "VertexAnimation.h"
+#include "scene/Crowd.h"
+#include "scene/ScatterField.h"
 
 namespace {
 struct PointLightUbo {
@@ -23,20 +30,157 @@ struct FrameUbo {
     glm::vec4 ambient;
     glm::vec4 lightCounts;
     PointLightUbo pointLights[4];
+    glm::vec4 time;
 };
+
+const float kClearColor[4] = {0.2f, 0.3f, 0.8f, 1.0f};
+const float kOitAccumClear[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+const float kOitRevealageClear[4] = {1.0f, 0.0f, 0.0f, 0.0f};
+const float kDebugClear[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+const GLuint kDebugReduceGroupSize = 16;
+// Probe volume channels use units 1-3, after the base color texture
+const int kProbeTextureUnit = 1;
+const GLuint kPaletteBinding = 4;
+// Vertex animation positions and normals use units 4-5, after the probe volume
+const int kVertexAnimationTextureUnit = 4;
+const GLuint kVertexAnimationClipBinding = 5;
+// Frame time wraps so float seconds keep sub-millisecond precision
+const double kTimeWrapSeconds = 3600.0;
+// Visibility ids of all ones mark pixels no visibility draw covered
+const GLuint kVisibilityClear = 0xFFFFFFFFu;
+// Record indices are stored as 16-bit material depth; the cleared 1.0 matches no record
+const size_t kMaxVisibilityRecords = 65535;
+const float kRecordDepthScale = 1.0f / 65535.0f;
+const int kVisibilityTextureUnit = 6;
+const GLuint kVisibilityRecordBinding = 6;
+const GLuint kVisibilityInstanceBinding = 7;
+const GLuint kResolveVertexBinding = 8;
+const GLuint kResolveIndexBinding = 9;
+// Larger batches are resolved over the whole screen instead of projecting every instance
+const size_t kScreenRectInstanceLimit = 64;
+const uint32_t kMainView = 1u;
+
+// Grows like the palette buffer; the contents are replaced every frame
+void uploadStorage(GlBuffer& buffer, size_t& capacity, const void* data, size_t bytes) {
+    if (bytes > capacity) {
+        capacity = std::max(bytes, capacity * 2);
+        buffer.setData(static_cast<GLsizeiptr>(capacity), nullptr, GL_DYNAMIC_DRAW);
+    }
+    buffer.updateSubData(0, static_cast<GLsizeiptr>(bytes), data);
+}
+}
+
+Renderer::RenderTargets::RenderTargets(int width, int height)
+    : width(width),
+      height(height),
+      sceneColor(width, height, GL_RGBA8),
+      sceneDepth(width, height, GL_DEPTH_COMPONENT32F),
+      oitAccum(width, height, GL_RGBA16F),
+      oitRevealage(width, height, GL_R8),
+      debugValue(width, height, GL_RG32F),
+      visibilityIds(width, height, GL_R32UI),
+      materialDepth(width, height, GL_DEPTH_COMPONENT16),
+      ambientColor(width, height, GL_R11F_G11F_B10F) {
+    // The ambient attachment is only drawn to in frames with SSAO, see Renderer::clear
+    sceneFbo.attachTexture(GL_COLOR_ATTACHMENT0, sceneColor.id());
+    sceneFbo.attachTexture(GL_COLOR_ATTACHMENT1, ambientColor.id());
+    sceneFbo.attachTexture(GL_DEPTH_ATTACHMENT, sceneDepth.id());
+    sceneFbo.setDrawBuffers({GL_COLOR_ATTACHMENT0});
+    sceneFbo.validate("scene");
+
+    sceneColorFbo.attachTexture(GL_COLOR_ATTACHMENT0, sceneColor.id());
+    sceneColorFbo.setDrawBuffers({GL_COLOR_ATTACHMENT0});
+    sceneColorFbo.validate("scene color");
+
+    // Shares the opaque depth so transparent fragments are still depth tested
+    oitFbo.attachTexture(GL_COLOR_ATTACHMENT0, oitAccum.id());
+    oitFbo.attachTexture(GL_COLOR_ATTACHMENT1, oitRevealage.id());
+    oitFbo.attachTexture(GL_DEPTH_ATTACHMENT, sceneDepth.id());
+    oitFbo.setDrawBuffers({GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1});
+    oitFbo.validate("oit");
+
+    debugFbo.attachTexture(GL_COLOR_ATTACHMENT0, debugValue.id());
+    debugFbo.attachTexture(GL_DEPTH_ATTACHMENT, sceneDepth.id());
+    debugFbo.setDrawBuffers({GL_COLOR_ATTACHMENT0});
+    debugFbo.validate("debug");
+
+    visibilityFbo.attachTexture(GL_COLOR_ATTACHMENT0, visibilityIds.id());
+    visibilityFbo.attachTexture(GL_DEPTH_ATTACHMENT, sceneDepth.id());
+    visibilityFbo.setDrawBuffers({GL_COLOR_ATTACHMENT0});
+    visibilityFbo.validate("visibility");
+
+    classifyFbo.attachTexture(GL_DEPTH_ATTACHMENT, materialDepth.id());
+    classifyFbo.setDrawBuffers({GL_NONE});
+    classifyFbo.validate("classify");
+
+    resolveFbo.attachTexture(GL_COLOR_ATTACHMENT0, sceneColor.id());
+    resolveFbo.attachTexture(GL_COLOR_ATTACHMENT1, ambientColor.id());
+    resolveFbo.attachTexture(GL_DEPTH_ATTACHMENT, materialDepth.id());
+    resolveFbo.setDrawBuffers({GL_COLOR_ATTACHMENT0});
+    resolveFbo.validate("resolve");
+}
+
+Renderer::View::View(const Camera& camera, int width, int height)
+    : camera(&camera),
+      color(width, height, GL_RGBA8),
+      depth(width, height, GL_DEPTH_COMPONENT32F) {
+    fbo.attachTexture(GL_COLOR_ATTACHMENT0, color.id());
+    fbo.attachTexture(GL_DEPTH_ATTACHMENT, depth.id());
+    fbo.setDrawBuffers({GL_COLOR_ATTACHMENT0});
+    fbo.validate("view");
 }
 
 Renderer::Renderer() {
     setupGlState();
     setupFrameUbo();
+    // White, so materials show their base color factor until the texture arrives
+    m_PlaceholderTexture = std::make_unique<Texture>("<placeholder>", TextureData{1, 1, 4, {255, 255, 255, 255}});
     Mesh::setDefaultInstanceCapacityBytes(m_MaxBatchSize * sizeof(InstanceData));
 }
 
+void Renderer::loadShaders() {
+    m_OitCompositeShader = std::make_unique<Shader>("assets/shaders/fullscreen.vert", "assets/shaders/oit_composite.frag");
+    m_DebugViewShader = std::make_unique<Shader>("assets/shaders/fullscreen.vert", "assets/shaders/debug_view.frag");
+    m_DebugReduceShader = std::make_unique<Shader>("assets/shaders/debug_reduce");
+    m_VisibilityShader = std::make_unique<Shader>("assets/shaders/visibility");
+    m_VisibilityShader->prepareVariant(ShaderFeature::AlphaMask);
+    m_VisibilityShader->prepareVariant(ShaderFeature::AlphaMask | ShaderFeature::HasTexture);
+    m_ClassifyShader = std::make_unique<Shader>("assets/shaders/fullscreen.vert",
+                                                "assets/shaders/visibility_classify.frag");
+    m_MeshletCuller.loadShaders();
+    m_Particles.loadShaders();
+    m_Terrain.loadShaders();
+    m_AmbientOcclusion.loadShaders();
+    m_Atmosphere.loadShaders();
+}
+
+void Renderer::resize(int width, int height) {
+    if (width <= 0 || height <= 0) {
+        return;
+    }
+    if (m_Targets && m_Targets->width == width && m_Targets->height == height) {
+        return;
+    }
+    m_Targets.reset();
+    m_Targets = std::make_unique<RenderTargets>(width, height);
+}
+
+void Renderer::requireTargets() const {
+    if (!m_Targets) {
+        throw std::runtime_error("Renderer error: Render targets not created, call resize() first!");
+    }
+}
+
 void Renderer::setBatchSize(size_t maxInstances) {
-    m_MaxBatchSize = maxInstances;
+    m_MaxBatchSize = std::max<size_t>(maxInstances, 1);
     Mesh::setDefaultInstanceCapacityBytes(m_MaxBatchSize * sizeof(InstanceData));
 }
 
+void Renderer::setMeshletCulling(bool enabled, bool coneCulling) {
+    m_MeshletCulling = enabled;
+    m_MeshletConeCulling = coneCulling;
+}
+
 void Renderer::setupGlState() {
     glEnable(GL_DEPTH_TEST); // For 3D rendering allows that closer objects occlude farther ones
     glDepthFunc(GL_LESS); // Accept fragment if it is closer to the camera than the former one
@@ -45,14 +189,14 @@ void Renderer::setupGlState() {
     glEnable(GL_CULL_FACE); // Enable back-face culling to improve performance by not rendering faces that are facing away from the camera
     glCullFace(GL_BACK); // Cull back faces. Disable culling for double-sided materials like water or foliage
     glFrontFace(GL_CCW); // Define front faces as counter-clockwise winding order
-    glEnable(GL_BLEND); // Enable blending for transparency
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA); // Says how to blend source and destination colors based on alpha
+    glDisable(GL_BLEND); // Blending is only enabled by the OIT passes, which set their own blend functions
     glEnable(GL_POLYGON_OFFSET_FILL); // Enable polygon offset to avoid z-fighting when rendering wireframes on top of filled polygons
     glPolygonOffset(0.5f, 1.0f); // Adjust these values as needed to reduce z-fighting without causing too much offset
 }
 
 void Renderer::resetGlState() {
-    glEnable(GL_BLEND);
+    glDisable(GL_BLEND);
+    glEnable(GL_DEPTH_TEST);
     glDepthMask(GL_TRUE);
     glEnable(GL_CULL_FACE);
     glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
@@ -60,13 +204,121 @@ void Renderer::resetGlState() {
     glDisable(GL_LINE_SMOOTH);
 }
 
+// One block per view, each at an offset the implementation can bind a range from
 void Renderer::setupFrameUbo() {
-    m_FrameUbo = UniformBuffer(sizeof(FrameUbo), 0);
+    GLint alignment = 256;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    alignment = std::max(alignment, 1);
+    m_FrameUboStride = (static_cast<GLsizeiptr>(sizeof(FrameUbo)) + alignment - 1) / alignment * alignment;
+    m_FrameUbo = UniformBuffer(m_FrameUboStride * kMaxViews, 0);
+}
+
+uint32_t Renderer::addView(const Camera& camera, int width, int height) {
+    if (width <= 0 || height <= 0) {
+        throw std::runtime_error("Renderer error: View size must be positive!");
+    }
+    auto slot = std::find(m_Views.begin(), m_Views.end(), nullptr);
+    if (slot == m_Views.end()) {
+        if (m_Views.size() + 1 >= kMaxViews) {
+            throw std::runtime_error("Renderer error: Too many views, at most " + std::to_string(kMaxViews - 1) +
+                                     " besides the main camera!");
+        }
+        slot = m_Views.insert(m_Views.end(), nullptr);
+    }
+    *slot = std::make_unique<View>(camera, width, height);
+    return static_cast<uint32_t>(slot - m_Views.begin()) + 1;
+}
+
+void Renderer::removeView(uint32_t id) {
+    getView(id);
+    m_Views[id - 1].reset();
+}
+
+void Renderer::setViewOverlay(uint32_t id, const glm::ivec4& rect) {
+    getView(id);
+    m_Views[id - 1]->overlay = rect;
+}
+
+const RenderTexture& Renderer::getViewColor(uint32_t id) const {
+    return getView(id).color;
+}
+
+const Renderer::View& Renderer::getView(uint32_t id) const {
+    if (id == 0 || id > m_Views.size() || !m_Views[id - 1]) {
+        throw std::runtime_error("Renderer error: Unknown view " + std::to_string(id) + "!");
+    }
+    return *m_Views[id - 1];
 }
 
 void Renderer::clear() {
-    glClearColor(0.2f, 0.3f, 0.8f, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    requireTargets();
+    // Per-frame counters start here because submit() already accumulates into them
+    m_Stats.reset();
+    m_Profiler.beginFrame();
+    m_AtmosphereFrame = usesAtmosphere();
+    if (m_AtmosphereFrame) {
+        // Before the scene target is bound: the sky-view rows render into the LUT
+        GpuProfiler::Scope atmosphereScope(m_Profiler, "atmosphere");
+        m_Atmosphere.update(-m_Lights.sunDir);
+        glEnable(GL_DEPTH_TEST);
+        glEnable(GL_CULL_FACE);
+    }
+    GpuProfiler::Scope scope(m_Profiler, "clear");
+    m_Targets->sceneFbo.bind();
+    glViewport(0, 0, m_Targets->width, m_Targets->height);
+    m_Targets->sceneFbo.clearColor(0, kClearColor);
+    m_Targets->sceneFbo.clearDepth(1.0f);
+    m_Palettes.clear();
+    m_PalettesUploaded = 0;
+    m_VisibilityFrame = m_RenderPath == RenderPath::Visibility && m_DebugView == DebugView::None && !m_Wireframe;
+    m_AmbientOcclusionFrame = m_AmbientOcclusion.isEnabled() && m_DebugView == DebugView::None && !m_Wireframe;
+    if (m_AmbientOcclusionFrame) {
+        m_Targets->sceneFbo.setDrawBuffers({GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1});
+        m_Targets->resolveFbo.setDrawBuffers({GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1});
+    } else {
+        m_Targets->sceneFbo.setDrawBuffers({GL_COLOR_ATTACHMENT0});
+        m_Targets->resolveFbo.setDrawBuffers({GL_COLOR_ATTACHMENT0});
+    }
+    m_VisibilityRecords.clear();
+    m_VisibilityInstances.clear();
+    m_VisibilityTriangles = 0;
+    if (m_VisibilityFrame) {
+        // Opaque batches that fill up during submission flush straight into the id buffer
+        m_Targets->visibilityFbo.clearColorUint(0, &kVisibilityClear);
+        m_Targets->visibilityFbo.bind();
+    }
+    glPolygonMode(GL_FRONT_AND_BACK, m_Wireframe ? GL_LINE : GL_FILL);
+    if (m_Camera) {
+        // Batches flushed during submission already draw with this frame's camera; the visibility
+        // resolve relies on it to rebuild the triangles they rasterized
+        updateFrameUbo();
+        m_MeshletCuller.beginFrame(m_Camera->getViewProjection(), m_Camera->getPosition());
+    }
+
+    // The frustums of every view are extracted once, submit() tests each renderable against all
+    m_ViewFrustums.resize(m_Views.size() + 1);
+    m_ActiveViews = 0;
+    if (m_Camera) {
+        m_ViewFrustums[0] = extractFrustum(m_Camera->getViewProjection());
+        m_ActiveViews |= kMainView;
+    }
+    for (size_t i = 0; i < m_Views.size(); ++i) {
+        if (m_Views[i]) {
+            m_ViewFrustums[i + 1] = extractFrustum(m_Views[i]->camera->getViewProjection());
+            m_ActiveViews |= 1u << (i + 1);
+        }
+    }
+}
+
+uint32_t Renderer::cullViews(const AABB& aabb, const glm::mat4& modelMatrix) const {
+    uint32_t mask = 0;
+    for (size_t view = 0; view < m_ViewFrustums.size(); ++view) {
+        uint32_t bit = 1u << view;
+        if ((m_ActiveViews & bit) && frustumIntersectsAABB(m_ViewFrustums[view], aabb, modelMatrix)) {
+            mask |= bit;
+        }
+    }
+    return mask;
 }
 
 void Renderer::submit(const Renderable& renderable) {
@@ -84,75 +336,377 @@ void Renderer::submit(const Renderable& renderable) {
     }
 
     glm::mat4 modelMatrix = renderable.transform.getMatrix();
-    Frustum frustum = extractFrustum(m_Camera->getViewProjection());
-    const AABB& aabb = renderable.mesh->getAABB();
-    if (!frustumIntersectsAABB(frustum, aabb, modelMatrix)) {
+    uint32_t viewMask = cullViews(renderable.mesh->getAABB(), modelMatrix);
+    if (viewMask == 0) {
         return;  // Culled
     }
 
-    BatchKey key{
-        renderable.mesh,
-        materialPtr.get()};
+    BatchKey key = makeBatchKey(renderable.mesh, materialPtr.get());
 
     InstanceData data;
     data.modelMatrix = modelMatrix;
     glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(data.modelMatrix)));
     data.normalMatrix = normalMatrix;
 
+    appendInstances(key, &data, 1, viewMask);
+}
+
+void Renderer::submitSkinned(const Renderable& renderable, const std::vector<glm::mat4>& palette,
+                             const AABB& bounds) {
+    if (!renderable.mesh || !renderable.mesh->isSkinned()) {
+        throw std::runtime_error("Skinned renderable missing skinned mesh");
+    }
+    auto materialPtr = renderable.material.get();
+    if (!materialPtr) {
+        throw std::runtime_error("Renderable missing material");
+    }
+    if (!m_Camera) {
+        throw std::runtime_error("Renderer error: No camera set for rendering!");
+    }
+
+    glm::mat4 modelMatrix = renderable.transform.getMatrix();
+    uint32_t viewMask = cullViews(bounds, modelMatrix);
+    if (viewMask == 0) {
+        return;  // Culled
+    }
+
+    InstanceData data;
+    data.modelMatrix = modelMatrix;
+    data.normalMatrix = glm::transpose(glm::inverse(glm::mat3(modelMatrix)));
+    data.paletteOffset = static_cast<uint32_t>(m_Palettes.size());
+    m_Palettes.insert(m_Palettes.end(), palette.begin(), palette.end());
+    m_Stats.skinnedInstances++;
+
+    appendInstances(makeBatchKey(renderable.mesh, materialPtr.get(), ShaderFeature::Skinned), &data, 1, viewMask);
+}
+
+void Renderer::uploadPalettes() {
+    if (m_PalettesUploaded == m_Palettes.size()) {
+        return;
+    }
+    // Growing reallocates the buffer, so everything staged so far goes up again
+    if (m_Palettes.size() > m_PaletteCapacity) {
+        m_PaletteCapacity = std::max(m_Palettes.size(), m_PaletteCapacity * 2);
+        m_PaletteBuffer.setData(static_cast<GLsizeiptr>(m_PaletteCapacity * sizeof(glm::mat4)), nullptr,
+                                GL_DYNAMIC_DRAW);
+        m_PalettesUploaded = 0;
+    }
+    m_PaletteBuffer.updateSubData(static_cast<GLintptr>(m_PalettesUploaded * sizeof(glm::mat4)),
+                                  static_cast<GLsizeiptr>((m_Palettes.size() - m_PalettesUploaded) * sizeof(glm::mat4)),
+                                  &m_Palettes[m_PalettesUploaded]);
+    m_PalettesUploaded = m_Palettes.size();
+}
+
+void Renderer::setProbeVolume(const ProbeGrid& grid) {
+    m_ProbeVolume.upload(grid);
+}
+
+void Renderer::submitScatter(const ScatterField& field) {
+    auto materialPtr = field.getMaterial().get();
+    if (!field.getMesh() || !materialPtr) {
+        throw std::runtime_error("Scatter field missing mesh or material");
+    }
+    if (!m_Camera) {
+        throw std::runtime_error("Renderer error: No camera set for rendering!");
+    }
+
+    m_CullScratch.clear();
+    Frustum frustum = extractFrustum(m_Camera->getViewProjection());
+    ScatterField::CullStats culled = field.cull(frustum, m_Camera->getPosition(), m_CullScratch);
+    m_Stats.scatterCells += culled.cells;
+    m_Stats.scatterInstances += culled.instances;
+
+    appendInstances(makeBatchKey(field.getMesh(), materialPtr.get()), m_CullScratch.data(), m_CullScratch.size());
+}
+
+void Renderer::submitCrowd(const Crowd& crowd) {
+    if (!m_Camera) {
+        throw std::runtime_error("Renderer error: No camera set for rendering!");
+    }
+
+    m_CullScratch.clear();
+    Frustum frustum = extractFrustum(m_Camera->getViewProjection());
+    m_Stats.crowdInstances += static_cast<unsigned int>(crowd.cull(frustum, m_CullScratch));
+    if (m_CullScratch.empty()) {
+        return;
+    }
+    for (const auto& part : crowd.getParts()) {
+        auto materialPtr = part.material.get();
+        if (!part.mesh || !materialPtr) {
+            throw std::runtime_error("Crowd part missing mesh or material");
+        }
+        uint32_t features = part.mesh->getVertexAnimation() ? ShaderFeature::VertexAnimation : ShaderFeature::None;
+        appendInstances(makeBatchKey(part.mesh, materialPtr.get(), features), m_CullScratch.data(),
+                        m_CullScratch.size());
+    }
+}
+
+BatchKey Renderer::makeBatchKey(Mesh* mesh, Material* material, uint32_t features) const {
+    uint32_t variant = material->getShaderFeatures() | features;
+    if (!m_Lights.pointLights.empty()) {
+        variant |= ShaderFeature::PointLights;
+    }
+    if (m_ProbeVolume.isLoaded()) {
+        variant |= ShaderFeature::ProbeVolume;
+    }
+    return BatchKey{mesh, material, variant};
+}
+
+void Renderer::appendInstances(const BatchKey& key, const InstanceData* instances, size_t count,
+                               uint32_t viewMask) {
     auto& batch = m_Batches[key];
-    batch.instances.push_back(data);
+    // Blended batches are drawn in the OIT pass after all opaque geometry, so only opaque ones flush early.
+    // Debug views render every batch into their own target at flush time. In a visibility frame the
+    // forward opaque batches draw after the resolve, so only visibility batches flush early. Extra
+    // views need the whole frame's instances of a batch to share them, nothing flushes early then.
+    bool extraViews = (m_ActiveViews & ~kMainView) != 0;
+    if (extraViews) {
+        batch.viewMasks.resize(batch.instances.size(), kMainView);
+        batch.viewMasks.insert(batch.viewMasks.end(), count, viewMask);
+    }
+    bool visibility = usesVisibility(key);
+    bool flushEarly = !key.material->getState().blend && m_DebugView == DebugView::None &&
+                      (!m_VisibilityFrame || visibility) && !extraViews;
+    while (count > 0) {
+        size_t take = count;
+        if (flushEarly) {
+            size_t room = m_MaxBatchSize > batch.instances.size() ? m_MaxBatchSize - batch.instances.size() : 1;
+            take = std::min(count, room);
+        }
+        batch.instances.insert(batch.instances.end(), instances, instances + take);
+        instances += take;
+        count -= take;
 
-    if (batch.instances.size() >= m_MaxBatchSize) {
-        flushBatch(key, batch);
-        batch.instances.clear();
+        if (flushEarly && batch.instances.size() >= m_MaxBatchSize) {
+            if (visibility && !drawVisibility(key, batch)) {
+                flushEarly = false;  // Out of visibility ids, the rest of the batch draws forward
+                continue;
+            }
+            if (!visibility) {
+                flushBatch(key, batch, RenderPass::Opaque);
+            }
+            batch.instances.clear();
+        }
     }
 }
 
-void Renderer::flushBatch(const BatchKey& key, BatchData& batch) {
+void Renderer::flushBatch(const BatchKey& key, BatchData& batch, RenderPass pass) {
     if (batch.instances.empty()) return;
 
     const RenderState& state = key.material->getState();
-    if (state.blend) {
-        glEnable(GL_BLEND);
-    } else {
-        glDisable(GL_BLEND);
+    applyRenderState(state, pass);
+
+    std::optional<GpuProfiler::Scope> batchScope;
+    if (m_Profiler.perBatchScopes()) {
+        batchScope.emplace(m_Profiler, key.material->getPath());
+    }
+
+    // Blended batches and the debug and extra view frames hold the whole frame's instances;
+    // they draw in chunks of the batch size, so the mesh instance buffers keep that capacity
+    bool shaderBound = false;
+    for (size_t first = 0; first < batch.instances.size(); first += m_MaxBatchSize) {
+        size_t count = std::min(m_MaxBatchSize, batch.instances.size() - first);
+        key.mesh->updateInstanceBuffer(batch.instances.data() + first, count * sizeof(InstanceData));
+
+        // The cull dispatch binds its own program, so it runs before the material shader is bound.
+        // Cone culling only holds for materials that cull back faces.
+        std::optional<MeshletCuller::Result> clusters;
+        if (m_MeshletCulling && key.mesh->hasMeshlets()) {
+            clusters = m_MeshletCuller.cull(*key.mesh, static_cast<unsigned int>(count),
+                                            m_MeshletConeCulling && state.cull);
+        }
+
+        if (clusters || !shaderBound) {
+            if (!bindBatchShader(key, pass)) {
+                return;
+            }
+            shaderBound = true;
+        }
+
+        if (clusters) {
+            key.mesh->drawIndirect(clusters->commandBuffer, clusters->commandOffset, clusters->maxDraws,
+                                   clusters->countBuffer, clusters->countOffset);
+        } else {
+            key.mesh->drawInstanced(static_cast<unsigned int>(count));
+        }
+        m_Stats.drawCalls++;
+    }
+
+    m_Stats.triangles += (key.mesh->getIndexCount() / 3) * batch.instances.size();
+}
+
+void Renderer::applyRenderState(const RenderState& state, RenderPass pass) {
+    // The OIT and debug passes own depth writes and blending, opaque batches follow the material state
+    if (pass == RenderPass::Opaque) {
+        glDepthMask(state.depthWrite ? GL_TRUE : GL_FALSE);
     }
-    glDepthMask(state.depthWrite ? GL_TRUE : GL_FALSE);
     if (state.cull) {
         glEnable(GL_CULL_FACE);
     } else {
         glDisable(GL_CULL_FACE);
     }
+}
 
+std::optional<uint32_t> Renderer::bindBatchShader(const BatchKey& key, RenderPass pass) {
     auto shader = key.material->getShaderHandle().get();
     if (!shader) {
         throw std::runtime_error("Material missing shader");
     }
-    shader->bind();
+
+    uint32_t features = key.variant;
+    if (pass == RenderPass::Debug) {
+        features |= ShaderFeature::DebugView;
+    }
+    // Draw with a fallback while the exact variant compiles
+    auto bound = shader->bindAvailable(features, ShaderFeature::PassFeatures);
+    if (!bound) {
+        return std::nullopt;
+    }
+    features = *bound;
 
     shader->bindUniformBlock("FrameData", 0);
+    if (pass == RenderPass::Debug) {
+        shader->setInt("u_DebugView", static_cast<int>(m_DebugView));
+        shader->setFloat("u_DebugId", static_cast<float>(m_DebugBatchCount++));
+    }
 
-    auto texture = key.material->getBaseColorHandle().get();
-    if (texture) {
-        texture->bind(0);
-        shader->setInt("u_Texture", 0);
-        shader->setBool("u_HasTexture", true);
-    } else {
-        shader->setBool("u_HasTexture", false);
+    bindMaterial(key, *shader, features);
+
+    if (features & ShaderFeature::Skinned) {
+        uploadPalettes();
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, kPaletteBinding, m_PaletteBuffer.id());
+    }
+
+    if (features & ShaderFeature::VertexAnimation) {
+        const VertexAnimationTexture* animation = key.mesh->getVertexAnimation();
+        animation->bind(kVertexAnimationTextureUnit, kVertexAnimationClipBinding);
+        shader->setInt("u_VatPositions", kVertexAnimationTextureUnit);
+        shader->setInt("u_VatNormals", kVertexAnimationTextureUnit + 1);
+        shader->setInt("u_VatVertexCount", static_cast<int>(animation->getVertexCount()));
+        shader->setInt("u_VatWidth", VertexAnimationTexture::kWidth);
+    }
+    return features;
+}
+
+void Renderer::bindMaterial(const BatchKey& key, const Shader& shader, uint32_t features) {
+    if (features & ShaderFeature::HasTexture) {
+        auto texture = key.material->getBaseColorHandle().get();
+        (texture ? *texture : *m_PlaceholderTexture).bind(0);
+        shader.setInt("u_Texture", 0);
+    }
+
+    if (features & ShaderFeature::ProbeVolume) {
+        m_ProbeVolume.bind(kProbeTextureUnit);
+        shader.setInt("u_ProbeRed", kProbeTextureUnit);
+        shader.setInt("u_ProbeGreen", kProbeTextureUnit + 1);
+        shader.setInt("u_ProbeBlue", kProbeTextureUnit + 2);
+        glm::vec3 resolution(m_ProbeVolume.getResolution());
+        shader.setVec3("u_ProbeMin", &m_ProbeVolume.getBoundsMin()[0]);
+        shader.setVec3("u_ProbeMax", &m_ProbeVolume.getBoundsMax()[0]);
+        shader.setVec3("u_ProbeResolution", &resolution[0]);
     }
 
     const auto& params = key.material->getParams();
-    shader->setVec4("u_BaseColorFactor", &params.baseColorFactor[0]);
-    shader->setFloat("u_AlphaCutoff", params.alphaCutoff);
+    shader.setVec4("u_BaseColorFactor", &params.baseColorFactor[0]);
+    shader.setFloat("u_AlphaCutoff", params.alphaCutoff);
+}
 
-    key.mesh->updateInstanceBuffer(
-        batch.instances.data(),
-        batch.instances.size() * sizeof(InstanceData));
+bool Renderer::usesVisibility(const BatchKey& key) const {
+    return m_VisibilityFrame && !(key.variant & (ShaderFeature::Skinned | ShaderFeature::VertexAnimation)) &&
+           !key.material->getState().blend;
+}
+
+bool Renderer::drawVisibility(const BatchKey& key, BatchData& batch) {
+    if (batch.instances.empty()) return true;
+
+    auto trianglesPerInstance = static_cast<uint32_t>(key.mesh->getIndexCount() / 3);
+    uint64_t triangles = static_cast<uint64_t>(trianglesPerInstance) * batch.instances.size();
+    if (trianglesPerInstance == 0 || m_VisibilityTriangles + triangles >= kVisibilityClear ||
+        m_VisibilityRecords.size() >= kMaxVisibilityRecords) {
+        return false;
+    }
+
+    applyRenderState(key.material->getState(), RenderPass::Opaque);
 
-    key.mesh->drawInstanced(batch.instances.size());
+    std::optional<GpuProfiler::Scope> batchScope;
+    if (m_Profiler.perBatchScopes()) {
+        batchScope.emplace(m_Profiler, key.material->getPath());
+    }
+
+    // Only alpha tested materials read anything but positions; the few variants are compiled at load
+    uint32_t features = ShaderFeature::None;
+    if (key.variant & ShaderFeature::AlphaMask) {
+        features = key.variant & (ShaderFeature::AlphaMask | ShaderFeature::HasTexture);
+    }
+    // A variant that failed to build leaves the batch to the forward path
+    if (!m_VisibilityShader->bindAvailable(features, features)) {
+        return false;
+    }
+    m_VisibilityShader->bindUniformBlock("FrameData", 0);
+    if (features & ShaderFeature::AlphaMask) {
+        bindMaterial(key, *m_VisibilityShader, features);
+    }
+    m_VisibilityShader->setUint("u_TriangleBase", static_cast<uint32_t>(m_VisibilityTriangles));
+    m_VisibilityShader->setUint("u_TriangleCount", trianglesPerInstance);
+
+    key.mesh->updateInstanceBuffer(batch.instances.data(), batch.instances.size() * sizeof(InstanceData));
+    // Without the alpha test the id pass needs nothing but positions and the model matrix
+    if (features & ShaderFeature::AlphaMask) {
+        key.mesh->drawInstanced(batch.instances.size());
+    } else {
+        key.mesh->drawDepthInstanced(batch.instances.size());
+    }
+
+    VisibilityRecord record{key,
+                            static_cast<uint32_t>(m_VisibilityTriangles),
+                            trianglesPerInstance,
+                            static_cast<uint32_t>(m_VisibilityInstances.size()),
+                            static_cast<uint32_t>(batch.instances.size()),
+                            computeScreenRect(*key.mesh, batch.instances.data(), batch.instances.size())};
+    m_VisibilityRecords.push_back(record);
+    m_VisibilityInstances.insert(m_VisibilityInstances.end(), batch.instances.begin(), batch.instances.end());
+    m_VisibilityTriangles += triangles;
+
+    // The resolve variant compiles while the rest of the frame is rasterized
+    key.material->getShaderHandle().get()->prepareVariant(key.variant | ShaderFeature::VisibilityResolve);
 
     m_Stats.drawCalls++;
-    m_Stats.triangles += (key.mesh->getIndexCount() / 3) * batch.instances.size();
+    m_Stats.triangles += static_cast<unsigned int>(triangles);
+    return true;
+}
+
+// Union of the projected instance bounds, the whole screen when any corner is behind the camera
+glm::ivec4 Renderer::computeScreenRect(const Mesh& mesh, const InstanceData* instances, size_t count) const {
+    glm::ivec4 fullScreen(0, 0, m_Targets->width, m_Targets->height);
+    if (count > kScreenRectInstanceLimit) {
+        return fullScreen;
+    }
+
+    const AABB& aabb = mesh.getAABB();
+    glm::mat4 viewProj = m_Camera->getViewProjection();
+    glm::vec2 low(1.0f);
+    glm::vec2 high(-1.0f);
+    for (size_t i = 0; i < count; ++i) {
+        glm::mat4 modelViewProj = viewProj * instances[i].modelMatrix;
+        for (int corner = 0; corner < 8; ++corner) {
+            glm::vec4 point((corner & 1) ? aabb.max.x : aabb.min.x, (corner & 2) ? aabb.max.y : aabb.min.y,
+                            (corner & 4) ? aabb.max.z : aabb.min.z, 1.0f);
+            glm::vec4 clip = modelViewProj * point;
+            if (clip.w <= 1e-4f) {
+                return fullScreen;
+            }
+            glm::vec2 ndc = glm::vec2(clip) / clip.w;
+            low = glm::min(low, ndc);
+            high = glm::max(high, ndc);
+        }
+    }
+
+    glm::vec2 size(static_cast<float>(m_Targets->width), static_cast<float>(m_Targets->height));
+    glm::vec2 minPixel = glm::floor((glm::clamp(low, -1.0f, 1.0f) * 0.5f + 0.5f) * size);
+    glm::vec2 maxPixel = glm::ceil((glm::clamp(high, -1.0f, 1.0f) * 0.5f + 0.5f) * size);
+    glm::ivec2 origin(minPixel);
+    glm::ivec2 extent = glm::max(glm::ivec2(maxPixel) - origin, glm::ivec2(0));
+    return glm::ivec4(origin, extent);
 }
 
 void Renderer::flush() {
@@ -160,30 +714,573 @@ void Renderer::flush() {
         throw std::runtime_error("Renderer error: No camera set for rendering!");
     }
 
-    m_Stats.reset();
+    requireTargets();
 
     updateFrameUbo();
 
-    // Flush all remaining batches
-    for (auto& [key, batch] : m_Batches) {
-        if (!batch.instances.empty()) {
-            flushBatch(key, batch);
+    sortBatches();
+    if (m_Particles.isActive()) {
+        GpuProfiler::Scope scope(m_Profiler, "particles");
+        m_Particles.simulate();
+    }
+    if (m_Terrain.isActive()) {
+        // Tile uploads are kept out of the opaque timings
+        GpuProfiler::Scope scope(m_Profiler, "terrain stream");
+        m_Terrain.update(m_Camera->getPosition());
+    }
+    renderViews();
+    if (m_DebugView != DebugView::None) {
+        renderDebugView();
+    } else {
+        renderOpaquePass();
+        if (m_AmbientOcclusionFrame) {
+            renderAmbientOcclusion();
         }
+        if (m_AtmosphereFrame) {
+            renderSky();
+        }
+        renderTransparentPass();
+        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+        compositeTransparency();
     }
 
+    m_SortedBatches.clear();
     m_Batches.clear();
 
     resetGlState();
 }
 
+// Extra views draw the opaque batches and the sky into their own targets before the main
+// passes. Each batch's instances are grouped by view mask and only the ones extra views see
+// are uploaded, every view then draws its base-instance ranges out of that one upload.
+// Afterwards the batches keep just the main view's instances.
+void Renderer::renderViews() {
+    uint32_t views = m_ActiveViews & ~kMainView;
+    for (size_t i = 0; i < m_Views.size(); ++i) {
+        if (!m_Views[i]) {
+            views &= ~(1u << (i + 1));  // Removed since clear()
+        }
+    }
+    if (views != 0) {
+        GpuProfiler::Scope scope(m_Profiler, "views");
+        for (size_t i = 0; i < m_Views.size(); ++i) {
+            if (views & (1u << (i + 1))) {
+                writeFrameUbo(*m_Views[i]->camera, m_FrameUboStride * static_cast<GLsizeiptr>(i + 1));
+                m_Views[i]->fbo.clearColor(0, kClearColor);
+                m_Views[i]->fbo.clearDepth(1.0f);
+            }
+        }
+        glDisable(GL_BLEND);
+    }
+
+    for (auto& [key, batch] : m_SortedBatches) {
+        if (batch->viewMasks.empty()) {
+            continue;
+        }
+        groupByView(*batch);
+        uint32_t mainCount = 0;
+        uint32_t firstShared = static_cast<uint32_t>(batch->instances.size());
+        for (const auto& range : m_ViewRanges) {
+            if (range.mask & kMainView) {
+                mainCount += range.count;
+            }
+            if (range.mask & views) {
+                firstShared = std::min(firstShared, range.first);
+            }
+        }
+
+        if (!key->material->getState().blend && firstShared < batch->instances.size() &&
+            bindBatchShader(*key, RenderPass::Opaque)) {
+            applyRenderState(key->material->getState(), RenderPass::Opaque);
+            key->mesh->updateInstanceBuffer(&batch->instances[firstShared],
+                                            (batch->instances.size() - firstShared) * sizeof(InstanceData));
+            auto trianglesPerInstance = static_cast<unsigned int>(key->mesh->getIndexCount() / 3);
+            for (size_t i = 0; i < m_Views.size(); ++i) {
+                uint32_t bit = 1u << (i + 1);
+                if (!(views & bit)) {
+                    continue;
+                }
+                const View& view = *m_Views[i];
+                view.fbo.bind();
+                glViewport(0, 0, view.color.width(), view.color.height());
+                m_FrameUbo.bindRange(m_FrameUboStride * static_cast<GLsizeiptr>(i + 1), sizeof(FrameUbo));
+                for (const auto& range : m_ViewRanges) {
+                    if (range.mask & bit) {
+                        key->mesh->drawInstanced(range.count, range.first - firstShared);
+                        m_Stats.drawCalls++;
+                        m_Stats.viewDraws++;
+                        m_Stats.triangles += trianglesPerInstance * range.count;
+                    }
+                }
+            }
+        }
+
+        batch->instances.resize(mainCount);
+        batch->viewMasks.clear();
+    }
+
+    if (views != 0) {
+        if (m_AtmosphereFrame) {
+            for (size_t i = 0; i < m_Views.size(); ++i) {
+                if (views & (1u << (i + 1))) {
+                    m_Views[i]->fbo.bind();
+                    glViewport(0, 0, m_Views[i]->color.width(), m_Views[i]->color.height());
+                    drawSky(m_Views[i]->camera->getViewProjection());
+                }
+            }
+        }
+        m_FrameUbo.bind();
+        glViewport(0, 0, m_Targets->width, m_Targets->height);
+    }
+}
+
+// Instances only the main view sees come first, then the shared ones, then the ones only extra
+// views see, so the main view keeps a prefix and the extra views read one contiguous suffix
+void Renderer::groupByView(BatchData& batch) {
+    m_ViewOrder.clear();
+    for (size_t i = 0; i < batch.viewMasks.size(); ++i) {
+        m_ViewOrder.emplace_back(batch.viewMasks[i], static_cast<uint32_t>(i));
+    }
+    auto rank = [](uint32_t mask) { return mask == kMainView ? 0 : (mask & kMainView) ? 1 : 2; };
+    std::stable_sort(m_ViewOrder.begin(), m_ViewOrder.end(), [&rank](const auto& a, const auto& b) {
+        if (rank(a.first) != rank(b.first)) return rank(a.first) < rank(b.first);
+        return a.first < b.first;
+    });
+
+    m_ViewScratch.clear();
+    m_ViewRanges.clear();
+    for (const auto& [mask, index] : m_ViewOrder) {
+        if (m_ViewRanges.empty() || m_ViewRanges.back().mask != mask) {
+            m_ViewRanges.push_back({mask, static_cast<uint32_t>(m_ViewScratch.size()), 0});
+        }
+        m_ViewRanges.back().count++;
+        m_ViewScratch.push_back(batch.instances[index]);
+    }
+    batch.instances.swap(m_ViewScratch);
+}
+
+void Renderer::composeViewOverlays() {
+    for (size_t i = 0; i < m_Views.size(); ++i) {
+        const auto& view = m_Views[i];
+        if (!view || !(m_ActiveViews & (1u << (i + 1))) || view->overlay.z <= 0 || view->overlay.w <= 0) {
+            continue;
+        }
+        const glm::ivec4& rect = view->overlay;
+        glBlitNamedFramebuffer(view->fbo.id(), m_Targets->sceneColorFbo.id(),
+                               0, 0, view->color.width(), view->color.height(),
+                               rect.x, rect.y, rect.x + rect.z, rect.y + rect.w,
+                               GL_COLOR_BUFFER_BIT, GL_LINEAR);
+    }
+}
+
+void Renderer::sortBatches() {
+    m_SortedBatches.clear();
+    m_SortedBatches.reserve(m_Batches.size());
+    for (auto& [key, batch] : m_Batches) {
+        if (!batch.instances.empty()) {
+            m_SortedBatches.emplace_back(&key, &batch);
+        }
+    }
+    std::sort(m_SortedBatches.begin(), m_SortedBatches.end(), [](const auto& a, const auto& b) {
+        auto shaderA = static_cast<uint64_t>(a.first->material->getShaderHandle().getId());
+        auto shaderB = static_cast<uint64_t>(b.first->material->getShaderHandle().getId());
+        if (shaderA != shaderB) return shaderA < shaderB;
+        if (a.first->variant != b.first->variant) return a.first->variant < b.first->variant;
+        return a.first->material < b.first->material;
+    });
+}
+
+void Renderer::renderOpaquePass() {
+    GpuProfiler::Scope scope(m_Profiler, "opaque");
+    if (m_VisibilityFrame) {
+        renderVisibilityPass();
+    }
+    // Batches the visibility pass consumed are empty by now
+    m_Targets->sceneFbo.bind();
+    glDisable(GL_BLEND);
+    for (auto& [key, batch] : m_SortedBatches) {
+        if (!key->material->getState().blend) {
+            flushBatch(*key, *batch, RenderPass::Opaque);
+        }
+    }
+    if (m_Terrain.isActive()) {
+        GpuProfiler::Scope terrainScope(m_Profiler, "terrain");
+        glEnable(GL_DEPTH_TEST);
+        glEnable(GL_CULL_FACE);
+        m_Stats.terrainNodes = m_Terrain.render(m_Camera->getViewProjection(), m_Camera->getPosition());
+        m_Stats.terrainTiles = m_Terrain.getResidentTiles();
+        if (m_Stats.terrainNodes > 0) {
+            m_Stats.drawCalls++;
+            m_Stats.triangles += m_Stats.terrainNodes * m_Terrain.getTrianglesPerNode();
+        }
+    }
+}
+
+void Renderer::renderVisibilityPass() {
+    {
+        GpuProfiler::Scope scope(m_Profiler, "visibility");
+        m_Targets->visibilityFbo.bind();
+        glDisable(GL_BLEND);
+        for (auto& [key, batch] : m_SortedBatches) {
+            if (usesVisibility(*key) && drawVisibility(*key, *batch)) {
+                batch->instances.clear();
+            }
+        }
+    }
+    if (m_VisibilityRecords.empty()) {
+        return;
+    }
+
+    uploadStorage(m_VisibilityInstanceBuffer, m_VisibilityInstanceCapacity, m_VisibilityInstances.data(),
+                  m_VisibilityInstances.size() * sizeof(InstanceData));
+    classifyVisibility();
+    resolveVisibility();
+    m_Stats.visibilityDraws = static_cast<unsigned int>(m_VisibilityRecords.size());
+}
+
+// Full-screen pass mapping every pixel's triangle id to its record (binary search over the
+// ascending record bases) and storing the record index as depth
+void Renderer::classifyVisibility() {
+    GpuProfiler::Scope scope(m_Profiler, "classify");
+    m_VisibilityRecordBases.clear();
+    for (const auto& record : m_VisibilityRecords) {
+        m_VisibilityRecordBases.push_back(record.triangleBase);
+    }
+    uploadStorage(m_VisibilityRecordBuffer, m_VisibilityRecordCapacity, m_VisibilityRecordBases.data(),
+                  m_VisibilityRecordBases.size() * sizeof(uint32_t));
+
+    m_Targets->classifyFbo.bind();
+    m_Targets->classifyFbo.clearDepth(1.0f);
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_ALWAYS);
+    glDepthMask(GL_TRUE);
+    glDisable(GL_CULL_FACE);
+
+    m_ClassifyShader->bind();
+    m_Targets->visibilityIds.bind(0);
+    m_ClassifyShader->setInt("u_VisibilityIds", 0);
+    m_ClassifyShader->setInt("u_RecordCount", static_cast<int>(m_VisibilityRecords.size()));
+    m_ClassifyShader->setFloat("u_RecordDepthScale", kRecordDepthScale);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, kVisibilityRecordBinding, m_VisibilityRecordBuffer.id());
+
+    m_FullscreenVao.bind();
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    VertexArray::unbind();
+    glDepthFunc(GL_LESS);
+}
+
+// One full-screen triangle per record at the record's material depth: the depth-equal test
+// rejects every other pixel before shading, so each pixel runs exactly one material shader.
+// Records are in shader order, so consecutive resolves mostly share a program.
+void Renderer::resolveVisibility() {
+    GpuProfiler::Scope scope(m_Profiler, "resolve");
+    m_Targets->resolveFbo.bind();
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_EQUAL);
+    glDepthMask(GL_FALSE);
+    glDisable(GL_CULL_FACE);
+    glDisable(GL_POLYGON_OFFSET_FILL);  // Would move the resolve off its record's depth
+    glEnable(GL_SCISSOR_TEST);
+
+    m_Targets->visibilityIds.bind(kVisibilityTextureUnit);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, kVisibilityInstanceBinding, m_VisibilityInstanceBuffer.id());
+    m_FullscreenVao.bind();
+    for (size_t i = 0; i < m_VisibilityRecords.size(); ++i) {
+        const VisibilityRecord& record = m_VisibilityRecords[i];
+        if (record.screenRect.z <= 0 || record.screenRect.w <= 0) {
+            continue;
+        }
+        auto shader = record.key.material->getShaderHandle().get();
+        if (!shader) {
+            throw std::runtime_error("Material missing shader");
+        }
+
+        // The fallback keeps the resolve path, anything less would draw nothing useful
+        uint32_t features = record.key.variant | ShaderFeature::VisibilityResolve;
+        auto bound = shader->bindAvailable(features, ShaderFeature::VisibilityResolve);
+        if (!bound) {
+            continue;
+        }
+        shader->bindUniformBlock("FrameData", 0);
+        bindMaterial(record.key, *shader, *bound);
+        shader->setInt("u_VisibilityIds", kVisibilityTextureUnit);
+        shader->setUint("u_TriangleBase", record.triangleBase);
+        shader->setUint("u_TriangleCount", record.triangleCount);
+        shader->setUint("u_InstanceBase", record.instanceBase);
+        shader->setUint("u_InstanceCount", record.instanceCount);
+        shader->setInt("u_InstanceStride", static_cast<int>(sizeof(InstanceData) / sizeof(float)));
+        shader->setFloat("u_ResolveDepth", static_cast<float>(i) * kRecordDepthScale);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, kResolveVertexBinding, record.key.mesh->getVertexBuffer());
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, kResolveIndexBinding, record.key.mesh->getIndexBuffer());
+
+        glScissor(record.screenRect.x, record.screenRect.y, record.screenRect.z, record.screenRect.w);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        m_Stats.drawCalls++;
+    }
+    VertexArray::unbind();
+
+    glDisable(GL_SCISSOR_TEST);
+    glDepthFunc(GL_LESS);
+    glDepthMask(GL_TRUE);
+}
+
+// Runs between the opaque and transparent passes, blended geometry keeps its full ambient term
+void Renderer::renderAmbientOcclusion() {
+    GpuProfiler::Scope scope(m_Profiler, "ssao");
+    m_AmbientOcclusion.compute(m_Targets->sceneDepth, m_Camera->getProjection());
+
+    // scene color -= ambient * (1 - occlusion)
+    m_Targets->sceneColorFbo.bind();
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_CULL_FACE);
+    glEnable(GL_BLEND);
+    glBlendEquation(GL_FUNC_REVERSE_SUBTRACT);
+    glBlendFunc(GL_ONE, GL_ONE);
+    m_AmbientOcclusion.apply(m_Targets->sceneDepth, m_Targets->ambientColor);
+    glBlendEquation(GL_FUNC_ADD);
+    glDisable(GL_BLEND);
+    glEnable(GL_DEPTH_TEST);
+}
+
+// Only pixels the opaque passes left at the cleared far depth are shaded
+void Renderer::renderSky() {
+    GpuProfiler::Scope scope(m_Profiler, "sky");
+    m_Targets->sceneFbo.bind();
+    drawSky(m_Camera->getViewProjection());
+}
+
+void Renderer::drawSky(const glm::mat4& viewProjection) {
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LEQUAL);
+    glDepthMask(GL_FALSE);
+    glDisable(GL_CULL_FACE);
+    glDisable(GL_BLEND);
+    glDisable(GL_POLYGON_OFFSET_FILL);  // Would push the sky behind the far plane
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    // The shading convention drops the 1/pi of Lambert, so the sun color is illuminance / pi
+    m_Atmosphere.render(viewProjection, glm::pi<float>() * m_Lights.sunColor);
+    glPolygonMode(GL_FRONT_AND_BACK, m_Wireframe ? GL_LINE : GL_FILL);
+    glDepthFunc(GL_LESS);
+    glDepthMask(GL_TRUE);
+    glEnable(GL_CULL_FACE);
+}
+
+// Weighted blended OIT (McGuire & Bavoil 2013): accumulate premultiplied, depth weighted
+// color and the product of (1 - alpha) in any order, so blended batches need no sorting.
+void Renderer::renderTransparentPass() {
+    GpuProfiler::Scope scope(m_Profiler, "transparent");
+    m_Targets->oitFbo.clearColor(0, kOitAccumClear);
+    m_Targets->oitFbo.clearColor(1, kOitRevealageClear);
+
+    m_Targets->oitFbo.bind();
+    glDepthMask(GL_FALSE);
+    glEnable(GL_BLEND);
+    glBlendFunci(0, GL_ONE, GL_ONE);
+    glBlendFunci(1, GL_ZERO, GL_ONE_MINUS_SRC_COLOR);
+    for (auto& [key, batch] : m_SortedBatches) {
+        if (key->material->getState().blend) {
+            flushBatch(*key, *batch, RenderPass::Transparent);
+        }
+    }
+    // Billboards are depth tested against the opaque scene and weighted like other blended geometry
+    glEnable(GL_DEPTH_TEST);
+    m_Particles.render(m_Camera->getRight(), m_Camera->getUp());
+    glDepthMask(GL_TRUE);
+}
+
+void Renderer::compositeTransparency() {
+    GpuProfiler::Scope scope(m_Profiler, "composite");
+    m_Targets->sceneFbo.bind();
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_CULL_FACE);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE_MINUS_SRC_ALPHA, GL_SRC_ALPHA);
+
+    m_OitCompositeShader->bind();
+    m_Targets->oitAccum.bind(0);
+    m_Targets->oitRevealage.bind(1);
+    m_OitCompositeShader->setInt("u_Accum", 0);
+    m_OitCompositeShader->setInt("u_Revealage", 1);
+
+    m_FullscreenVao.bind();
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    VertexArray::unbind();
+}
+
+void Renderer::renderDebugView() {
+    GpuProfiler::Scope scope(m_Profiler, "debug view");
+    m_Targets->debugFbo.bind();
+    m_Targets->debugFbo.clearColor(0, kDebugClear);
+    m_Targets->debugFbo.clearDepth(1.0f);
+
+    // Overdraw counts every rasterized fragment, the other views keep the nearest surface
+    bool overdraw = m_DebugView == DebugView::Overdraw;
+    if (overdraw) {
+        glDisable(GL_DEPTH_TEST);
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_ONE, GL_ONE);
+    } else {
+        glDisable(GL_BLEND);
+    }
+    glDepthMask(overdraw ? GL_FALSE : GL_TRUE);
+
+    m_DebugBatchCount = 0;
+    for (auto& [key, batch] : m_SortedBatches) {
+        flushBatch(*key, *batch, RenderPass::Debug);
+    }
+
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    glEnable(GL_DEPTH_TEST);
+    glDisable(GL_BLEND);
+    glDepthMask(GL_TRUE);
+
+    if (m_DebugView == DebugView::BatchId) {
+        m_Stats.debugViewValue = static_cast<float>(m_DebugBatchCount);
+    } else {
+        reduceDebugView();
+    }
+    visualizeDebugView();
+}
+
+// Sums (value, coverage) per 16x16 tile on the GPU and reads the partial sums back without stalling
+void Renderer::reduceDebugView() {
+    GLuint groupsX = (static_cast<GLuint>(m_Targets->width) + kDebugReduceGroupSize - 1) / kDebugReduceGroupSize;
+    GLuint groupsY = (static_cast<GLuint>(m_Targets->height) + kDebugReduceGroupSize - 1) / kDebugReduceGroupSize;
+    GLsizeiptr size = static_cast<GLsizeiptr>(groupsX) * groupsY * 2 * sizeof(float);
+    if (size > m_DebugPartialsSize) {
+        m_DebugPartials.setData(size, nullptr, GL_DYNAMIC_COPY);
+        m_DebugPartialsSize = size;
+    }
+
+    m_DebugReduceShader->bind();
+    m_Targets->debugValue.bind(0);
+    m_DebugReduceShader->setInt("u_DebugValue", 0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_DebugPartials.id());
+    glDispatchCompute(groupsX, groupsY, 1);
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+
+    m_DebugReadback.request(m_DebugPartials.id(), 0, size, static_cast<uint32_t>(m_DebugView));
+}
+
+void Renderer::visualizeDebugView() {
+    m_Targets->sceneFbo.bind();
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_CULL_FACE);
+
+    m_DebugViewShader->bind();
+    m_Targets->debugValue.bind(0);
+    m_DebugViewShader->setInt("u_DebugValue", 0);
+    m_DebugViewShader->setInt("u_DebugView", static_cast<int>(m_DebugView));
+
+    m_FullscreenVao.bind();
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    VertexArray::unbind();
+}
+
+void Renderer::updateDebugStats() {
+    uint32_t tag = 0;
+    while (m_DebugReadback.poll(m_DebugReadbackData, &tag)) {
+        auto view = static_cast<DebugView>(tag);
+        if (view != m_DebugView || !m_Targets) {
+            continue;  // Result of a view that has since been switched off
+        }
+
+        const float* partials = reinterpret_cast<const float*>(m_DebugReadbackData.data());
+        size_t count = m_DebugReadbackData.size() / (2 * sizeof(float));
+        double valueSum = 0.0;
+        double coverageSum = 0.0;
+        for (size_t i = 0; i < count; ++i) {
+            valueSum += partials[i * 2];
+            coverageSum += partials[i * 2 + 1];
+        }
+
+        // Overdraw is averaged over the whole screen, the other views over the pixels they cover
+        double pixels = static_cast<double>(m_Targets->width) * m_Targets->height;
+        double denominator = view == DebugView::Overdraw ? pixels : coverageSum;
+        m_Stats.debugViewValue = denominator > 0.0 ? static_cast<float>(valueSum / denominator) : 0.0f;
+    }
+}
+
+void Renderer::present() {
+    requireTargets();
+    {
+        GpuProfiler::Scope scope(m_Profiler, "present");
+        composeViewOverlays();
+        int width = m_Targets->width;
+        int height = m_Targets->height;
+        glBlitNamedFramebuffer(m_Targets->sceneFbo.id(), 0,
+                               0, 0, width, height,
+                               0, 0, width, height,
+                               GL_COLOR_BUFFER_BIT, GL_NEAREST);
+        Framebuffer::bindDefault();
+    }
+    {
+        GpuProfiler::Scope scope(m_Profiler, "capture");
+        m_Capture.capture(m_Targets->sceneColor);
+    }
+    m_Profiler.endFrame();
+    m_Stats.shaderWaitMs = static_cast<float>(Shader::consumeWaitMs());
+    m_Stats.shadersPending = Shader::getPendingPrograms();
+    m_MeshletCuller.endFrame();
+    m_Stats.meshletsTested = m_MeshletCuller.getTested();
+    m_Stats.meshletsVisible = m_MeshletCuller.getVisible();
+    m_Particles.endFrame();
+    m_Stats.particlesAlive = m_Particles.getAlive();
+    m_Atmosphere.endFrame();
+    updateGpuStats();
+    updateDebugStats();
+}
+
+void Renderer::presentCached() {
+    if (!m_Targets) {
+        return;
+    }
+    glBlitNamedFramebuffer(m_Targets->sceneFbo.id(), 0,
+                           0, 0, m_Targets->width, m_Targets->height,
+                           0, 0, m_Targets->width, m_Targets->height,
+                           GL_COLOR_BUFFER_BIT, GL_NEAREST);
+}
+
+void Renderer::updateSkippedFrame() {
+    m_Profiler.collect();
+    m_Stats.shaderWaitMs = static_cast<float>(Shader::consumeWaitMs());
+    m_Stats.shadersPending = Shader::getPendingPrograms();
+    updateGpuStats();
+}
+
+bool Renderer::needsRedraw() const {
+    return Shader::getPendingPrograms() > 0 || m_Capture.isContinuous() || m_Capture.hasPendingWork() ||
+           m_Particles.isActive() || m_Terrain.isStreaming() || (usesAtmosphere() && m_Atmosphere.isUpdating());
+}
+
+void Renderer::updateGpuStats() {
+    if (m_Profiler.getPublishCount() == m_GpuStatsVersion) {
+        return;
+    }
+    m_GpuStatsVersion = m_Profiler.getPublishCount();
+    m_Stats.gpuFrameMs = m_Profiler.getFrameMs();
+    m_Stats.gpuScopes = m_Profiler.getScopeStats();
+}
+
 void Renderer::updateFrameUbo() {
+    writeFrameUbo(*m_Camera, 0);
+}
+
+void Renderer::writeFrameUbo(const Camera& camera, GLintptr offset) {
     FrameUbo data{};
-    data.viewProj = m_Camera->getViewProjection();
+    data.viewProj = camera.getViewProjection();
 
     glm::vec3 sunDir = glm::normalize(m_Lights.sunDir);
+    glm::vec3 sunColor = m_Lights.sunColor;
+    glm::vec3 ambientColor = m_Lights.ambientColor;
+    if (m_Atmosphere.isEnabled() && m_Atmosphere.hasLighting()) {
+        // The LUTs are for a unit sun above the atmosphere, the light set's sun color takes its place
+        sunColor = m_Lights.sunColor * m_Atmosphere.getSunTransmittance();
+        ambientColor = glm::pi<float>() * m_Lights.sunColor * m_Atmosphere.getSkyAmbient();
+    }
     data.sunDir = glm::vec4(sunDir, 0.0f);
-    data.sunColor = glm::vec4(m_Lights.sunColor, 0.0f);
-    data.ambient = glm::vec4(m_Lights.ambientColor, m_Lights.ambientStrength);
+    data.sunColor = glm::vec4(sunColor, 0.0f);
+    data.ambient = glm::vec4(ambientColor, m_Lights.ambientStrength);
 
     int pointCount = static_cast<int>(m_Lights.pointLights.size());
     pointCount = std::min(pointCount, 4);
@@ -195,16 +1292,53 @@ void Renderer::updateFrameUbo() {
         data.pointLights[i].colorIntensity = glm::vec4(light.color, light.intensity);
     }
 
-    m_FrameUbo.updateSubData(0, sizeof(FrameUbo), &data);
+    data.time = glm::vec4(static_cast<float>(std::fmod(m_Time, kTimeWrapSeconds)), 0.0f, 0.0f, 0.0f);
+
+    m_FrameUbo.updateSubData(offset, sizeof(FrameUbo), &data);
 }
 
 void Renderer::reset() {
+    m_SortedBatches.clear();
     m_Batches.clear();
+    m_Particles.clear();
+    m_Terrain.clear();
+    m_ProbeVolume.release();
     m_Stats.reset();
 }
 
 void Renderer::toggleWireframe() {
-    static bool wireframe = false;
-    wireframe = !wireframe;
-    glPolygonMode(GL_FRONT_AND_BACK, wireframe ? GL_LINE : GL_FILL);
+    m_Wireframe = !m_Wireframe;
+}
+
+void Renderer::toggleRenderPath() {
+    m_RenderPath = m_RenderPath == RenderPath::Forward ? RenderPath::Visibility : RenderPath::Forward;
+}
+
+void Renderer::toggleDebugView(DebugView view) {
+    m_DebugView = m_DebugView == view ? DebugView::None : view;
+    m_Stats.debugViewValue = 0.0f;
+}
+
+const char* Renderer::debugViewName(DebugView view) {
+    switch (view) {
+        case DebugView::Overdraw:
+            return "Overdraw avg";
+        case DebugView::LightCount:
+            return "Lights/px";
+        case DebugView::MipLevel:
+            return "Mip avg";
+        case DebugView::BatchId:
+            return "Batches";
+        default:
+            return "None";
+    }
+}
+
+const char* Renderer::renderPathName(RenderPath path) {
+    switch (path) {
+        case RenderPath::Visibility:
+            return "visibility";
+        default:
+            return "forward";
+    }
 }
@@ -1,39 +1,70 @@
 #pragma once
 #include <glm/glm.hpp>
+#include <memory>
+#include <optional>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include "AmbientOcclusion.h"
+#include "Atmosphere.h"
+#include "BufferReadback.h"
+#include "FrameCapture.h"
+#include "Framebuffer.h"
+#include "Frustum.h"
+#include "GpuProfiler.h"
 #include "Mesh.h"
+#include "MeshletCuller.h"
+#include "ParticleSystem.h"
+#include "ProbeVolume.h"
+#include "RenderTexture.h"
+#include "Terrain.h"
 #include "UniformBuffer.h"
+#include "VertexArray.h"
 #include "assets/Shader.h"
+#include "assets/Texture.h"
 #include "scene/Camera.h"
 #include "scene/Renderable.h"
 
+class Crowd;
+class ScatterField;
+
 struct InstanceData {
     glm::mat4 modelMatrix;
     glm::mat3 normalMatrix;
+    uint32_t paletteOffset = 0;  // First joint matrix of a skinned instance in the palette buffer
+    // Vertex animated instances: clip index and seconds added to the frame time. Kept adjacent,
+    // the mesh reads both through one attribute.
+    uint32_t animationClip = 0;
+    float animationTime = 0.0f;
 };
 
 struct BatchKey {
     Mesh* mesh;
     Material* material;
+    uint32_t variant;  // ShaderFeature bits the batch is drawn with
 
     struct Hash {
         size_t operator()(const BatchKey& key) const {
             size_t h1 = std::hash<uintptr_t>{}(reinterpret_cast<uintptr_t>(key.mesh));
             size_t h2 = std::hash<uintptr_t>{}(reinterpret_cast<uintptr_t>(key.material));
-            return h1 ^ (h2 << 1);
+            size_t h3 = std::hash<uint32_t>{}(key.variant);
+            return h1 ^ (h2 << 1) ^ (h3 << 2);
         }
     };
 
     bool operator==(const BatchKey& other) const {
         return mesh == other.mesh &&
-               material == other.material;
+               material == other.material &&
+               variant == other.variant;
     }
 };
 
 struct BatchData {
     std::vector<InstanceData> instances;
+    // Views that see each instance (bit 0: the main camera), only recorded while extra views
+    // are registered; empty means every instance belongs to the main view
+    std::vector<uint32_t> viewMasks;
 };
 
 class Renderer {
@@ -52,38 +83,302 @@ class Renderer {
         float ambientStrength = 0.2f;
         std::vector<PointLightData> pointLights;
     };
+    // Fill-rate debug views; the ids are mirrored in basic.frag and debug_view.frag
+    enum class DebugView : uint8_t {
+        None = 0,
+        Overdraw,
+        LightCount,
+        MipLevel,
+        BatchId
+    };
+    // Forward shades every rasterized fragment. Visibility rasterizes triangle ids first and
+    // shades each covered pixel once in a per-batch resolve; skinned, vertex animated and
+    // blended batches, terrain and debug views still draw forward.
+    enum class RenderPath : uint8_t {
+        Forward = 0,
+        Visibility
+    };
+
     Renderer();
 
+    // Built-in pass shaders, loaded once the shader binary cache is configured
+    void loadShaders();
+
     void setCamera(const Camera& camera) { m_Camera = &camera; }
+    // Extra views (minimap, security camera, split screen) drawn from the same submission into
+    // their own targets. The main camera is view 0; submit() culls each renderable against all
+    // views in one pass, and an instance seen by several extra views is stored and uploaded once.
+    // Extra views draw opaque batches and the sky; scatter fields, crowds, terrain, particles,
+    // blended batches and the screen-space passes stay in the main view.
+    static constexpr uint32_t kMaxViews = 32;
+    uint32_t addView(const Camera& camera, int width, int height);
+    void removeView(uint32_t id);
+    // Copies the view into the main image at `rect` (x, y, width, height) before presenting;
+    // an empty rect turns the overlay off
+    void setViewOverlay(uint32_t id, const glm::ivec4& rect);
+    const RenderTexture& getViewColor(uint32_t id) const;
+    void resize(int width, int height);
     void clear();
     void submit(const Renderable& renderable);
+    // Culls the field by cell and instance and appends the survivors to its mesh's batch
+    void submitScatter(const ScatterField& field);
+    // Skinned instance posed by `palette` (one matrix per skin joint). `bounds` are the posed
+    // model-space bounds used for culling; instances sharing a mesh still draw as one batch.
+    void submitSkinned(const Renderable& renderable, const std::vector<glm::mat4>& palette, const AABB& bounds);
+    // Culls the crowd once and appends the survivors to the batch of every part; parts with
+    // vertex animation play each instance's clip on the GPU
+    void submitCrowd(const Crowd& crowd);
     void flush();
+    void present();
+    // Re-shows the last rendered frame without drawing the scene
+    void presentCached();
+    // Keeps profiler results and per-frame counters current on frames that skip rendering
+    void updateSkippedFrame();
+    // True while the image changes without scene changes (shader variants compiling,
+    // capture in flight, particles animating, terrain tiles streaming)
+    bool needsRedraw() const;
     void toggleWireframe();
+    // Selecting the active view again switches back to normal shading
+    void toggleDebugView(DebugView view);
+    DebugView getDebugView() const { return m_DebugView; }
+    static const char* debugViewName(DebugView view);
+    // Takes effect from the next clear()
+    void setRenderPath(RenderPath path) { m_RenderPath = path; }
+    void toggleRenderPath();
+    RenderPath getRenderPath() const { return m_RenderPath; }
+    static const char* renderPathName(RenderPath path);
     void setLights(const LightSet& lights) { m_Lights = lights; }
+    // Seconds since start, drives vertex animation playback
+    void setTime(double seconds) { m_Time = seconds; }
     void setBatchSize(size_t maxInstances);
+    // Cluster culling for meshes that were split into meshlets at import
+    void setMeshletCulling(bool enabled, bool coneCulling);
+    void setProfilerSettings(const GpuProfiler::Settings& settings) { m_Profiler.configure(settings); }
+    FrameCapture& getCapture() { return m_Capture; }
+    ParticleSystem& getParticles() { return m_Particles; }
+    Terrain& getTerrain() { return m_Terrain; }
+    AmbientOcclusion& getAmbientOcclusion() { return m_AmbientOcclusion; }
+    // While enabled the sky replaces the clear color and the sun color and ambient term of the
+    // light set are derived from its LUTs
+    Atmosphere& getAtmosphere() { return m_Atmosphere; }
+    // Baked irradiance replaces the constant ambient term while a probe volume is set
+    void setProbeVolume(const ProbeGrid& grid);
+    void clearProbeVolume() { m_ProbeVolume.release(); }
     void reset();
 
     struct Stats {
         unsigned int drawCalls = 0;
         unsigned int triangles = 0;
+        // Main-thread time spent on shader compilation last frame and programs still compiling
+        float shaderWaitMs = 0.0f;
+        unsigned int shadersPending = 0;
+        // Meshlets tested by the cull pass last frame and the survivors (read back late)
+        unsigned int meshletsTested = 0;
+        unsigned int meshletsVisible = 0;
+        // Live GPU particles (read back late)
+        unsigned int particlesAlive = 0;
+        // Terrain quadtree nodes drawn last frame and height tiles resident on the GPU
+        unsigned int terrainNodes = 0;
+        unsigned int terrainTiles = 0;
+        // Scatter cells and instances that survived culling and density LOD last frame
+        unsigned int scatterCells = 0;
+        unsigned int scatterInstances = 0;
+        // Skinned instances that survived culling last frame
+        unsigned int skinnedInstances = 0;
+        // Crowd instances that survived culling last frame
+        unsigned int crowdInstances = 0;
+        // Batch draws shaded by the visibility resolve last frame
+        unsigned int visibilityDraws = 0;
+        // Draws issued for the extra views last frame
+        unsigned int viewDraws = 0;
+        // GPU timings are averaged by the profiler and survive the per-frame reset
+        float gpuFrameMs = 0.0f;
+        std::vector<GpuProfiler::ScopeStat> gpuScopes;
+        // Whole-frame summary of the active debug view (average overdraw, lights or mip
+        // level per covered pixel, batch count), read back a few frames late
+        float debugViewValue = 0.0f;
 
         void reset() {
             drawCalls = triangles = 0;
+            terrainNodes = 0;
+            scatterCells = scatterInstances = 0;
+            skinnedInstances = crowdInstances = 0;
+            visibilityDraws = 0;
+            viewDraws = 0;
         }
     } m_Stats;
 
     const Stats& getStats() const { return m_Stats; }
 
    private:
+    // Offscreen targets: opaque geometry renders into scene color/depth, blended
+    // geometry accumulates into the weighted-blended OIT targets sharing that depth.
+    // The visibility path rasterizes triangle ids against the same depth, then shades
+    // into scene color through a record index stored as material depth. With SSAO the
+    // opaque passes also write their ambient term, which is attenuated after the AO pass.
+    // All targets are single-sampled; the scene has no MSAA since it moved offscreen.
+    struct RenderTargets {
+        RenderTargets(int width, int height);
+
+        int width;
+        int height;
+        RenderTexture sceneColor;
+        RenderTexture sceneDepth;
+        RenderTexture oitAccum;
+        RenderTexture oitRevealage;
+        RenderTexture debugValue;
+        RenderTexture visibilityIds;
+        RenderTexture materialDepth;
+        RenderTexture ambientColor;
+        Framebuffer sceneFbo;
+        Framebuffer sceneColorFbo;  // Without depth, for passes that sample scene depth
+        Framebuffer oitFbo;
+        Framebuffer debugFbo;
+        Framebuffer visibilityFbo;
+        Framebuffer classifyFbo;
+        Framebuffer resolveFbo;
+    };
+
+    // One visibility draw: its instances, starting at instanceBase in the frame's visibility
+    // instances, own the triangle ids [triangleBase, triangleBase + instanceCount * triangleCount)
+    struct VisibilityRecord {
+        BatchKey key;
+        uint32_t triangleBase;
+        uint32_t triangleCount;  // Per instance
+        uint32_t instanceBase;
+        uint32_t instanceCount;
+        glm::ivec4 screenRect;  // x, y, width, height the resolve draw is scissored to
+    };
+
+    enum class RenderPass : uint8_t {
+        Opaque,
+        Transparent,
+        Debug
+    };
+
+    struct View {
+        View(const Camera& camera, int width, int height);
+
+        const Camera* camera;
+        RenderTexture color;
+        RenderTexture depth;
+        Framebuffer fbo;
+        glm::ivec4 overlay{0};
+    };
+
+    // Instances [first, first + count) of a batch grouped by view, all seen by the views in `mask`
+    struct ViewRange {
+        uint32_t mask;
+        uint32_t first;
+        uint32_t count;
+    };
+
     void setupGlState();
     void setupFrameUbo();
-    void flushBatch(const BatchKey& key, BatchData& batch);
+    void requireTargets() const;
+    void flushBatch(const BatchKey& key, BatchData& batch, RenderPass pass);
+    void applyRenderState(const RenderState& state, RenderPass pass);
+    // Binds the batch's shader variant and everything it samples; returns the bound features,
+    // or nothing when no usable variant builds and the batch has to be skipped
+    std::optional<uint32_t> bindBatchShader(const BatchKey& key, RenderPass pass);
+    const View& getView(uint32_t id) const;
+    // Bit per registered view whose frustum the bounds intersect
+    uint32_t cullViews(const AABB& aabb, const glm::mat4& modelMatrix) const;
+    // Orders the instances by view mask and fills m_ViewRanges with the runs of equal masks
+    void groupByView(BatchData& batch);
+    void renderViews();
+    void composeViewOverlays();
+    void drawSky(const glm::mat4& viewProjection);
+    // Textures and parameters of the material for the variant bound with `features`
+    void bindMaterial(const BatchKey& key, const Shader& shader, uint32_t features);
+    bool usesVisibility(const BatchKey& key) const;
+    // Debug views replace the sky, so the atmosphere neither draws nor advances its LUTs
+    bool usesAtmosphere() const { return m_Atmosphere.isEnabled() && m_DebugView == DebugView::None; }
+    // False when the frame ran out of triangle ids or records or the id variant failed to
+    // build, the batch then draws forward
+    bool drawVisibility(const BatchKey& key, BatchData& batch);
+    glm::ivec4 computeScreenRect(const Mesh& mesh, const InstanceData* instances, size_t count) const;
+    void renderVisibilityPass();
+    void classifyVisibility();
+    void resolveVisibility();
+    void renderAmbientOcclusion();
+    void renderSky();
+    // `features` adds the submit path's bits (skinning, vertex animation) to the material's
+    BatchKey makeBatchKey(Mesh* mesh, Material* material, uint32_t features = ShaderFeature::None) const;
+    void appendInstances(const BatchKey& key, const InstanceData* instances, size_t count, uint32_t viewMask = 1);
+    void uploadPalettes();
+    void sortBatches();
+    void renderOpaquePass();
+    void renderTransparentPass();
+    void compositeTransparency();
+    void renderDebugView();
+    void reduceDebugView();
+    void visualizeDebugView();
+    void updateDebugStats();
     void updateFrameUbo();
+    void writeFrameUbo(const Camera& camera, GLintptr offset);
     void resetGlState();
+    void updateGpuStats();
 
     const Camera* m_Camera = nullptr;
     std::unordered_map<BatchKey, BatchData, BatchKey::Hash> m_Batches;
+    // Batches ordered by shader and variant so consecutive draws share a program
+    std::vector<std::pair<const BatchKey*, BatchData*>> m_SortedBatches;
     size_t m_MaxBatchSize = 1000;
     LightSet m_Lights;
+    double m_Time = 0.0;
+    std::vector<InstanceData> m_CullScratch;
+    // Joint matrices of every skinned instance this frame, uploaded before the first skinned draw
+    std::vector<glm::mat4> m_Palettes;
+    size_t m_PalettesUploaded = 0;
+    GlBuffer m_PaletteBuffer{GL_SHADER_STORAGE_BUFFER};
+    size_t m_PaletteCapacity = 0;
     UniformBuffer m_FrameUbo{0, 0};
+    // Bound in place of base color textures that are still loading
+    std::unique_ptr<Texture> m_PlaceholderTexture;
+    // Frame data of view i starts at i * m_FrameUboStride, the main view at 0
+    GLsizeiptr m_FrameUboStride = 0;
+    std::vector<std::unique_ptr<View>> m_Views;  // Index id - 1, null once removed
+    std::vector<Frustum> m_ViewFrustums;  // Index id, rebuilt by clear()
+    uint32_t m_ActiveViews = 0;
+    std::vector<ViewRange> m_ViewRanges;
+    std::vector<std::pair<uint32_t, uint32_t>> m_ViewOrder;
+    std::vector<InstanceData> m_ViewScratch;
+    std::unique_ptr<RenderTargets> m_Targets;
+    std::unique_ptr<Shader> m_OitCompositeShader;
+    std::unique_ptr<Shader> m_DebugViewShader;
+    std::unique_ptr<Shader> m_DebugReduceShader;
+    VertexArray m_FullscreenVao;
+    bool m_Wireframe = false;
+    DebugView m_DebugView = DebugView::None;
+    RenderPath m_RenderPath = RenderPath::Forward;
+    bool m_VisibilityFrame = false;  // Path in effect for the frame being built
+    bool m_AmbientOcclusionFrame = false;
+    bool m_AtmosphereFrame = false;
+    std::unique_ptr<Shader> m_VisibilityShader;
+    std::unique_ptr<Shader> m_ClassifyShader;
+    std::vector<VisibilityRecord> m_VisibilityRecords;
+    std::vector<InstanceData> m_VisibilityInstances;
+    std::vector<uint32_t> m_VisibilityRecordBases;
+    uint64_t m_VisibilityTriangles = 0;
+    GlBuffer m_VisibilityRecordBuffer{GL_SHADER_STORAGE_BUFFER};
+    size_t m_VisibilityRecordCapacity = 0;
+    GlBuffer m_VisibilityInstanceBuffer{GL_SHADER_STORAGE_BUFFER};
+    size_t m_VisibilityInstanceCapacity = 0;
+    unsigned int m_DebugBatchCount = 0;
+    GlBuffer m_DebugPartials{GL_SHADER_STORAGE_BUFFER};
+    GLsizeiptr m_DebugPartialsSize = 0;
+    BufferReadback m_DebugReadback;
+    std::vector<uint8_t> m_DebugReadbackData;
+    MeshletCuller m_MeshletCuller;
+    bool m_MeshletCulling = true;
+    bool m_MeshletConeCulling = true;
+    ParticleSystem m_Particles;
+    Terrain m_Terrain;
+    AmbientOcclusion m_AmbientOcclusion;
+    Atmosphere m_Atmosphere;
+    ProbeVolume m_ProbeVolume;
+    GpuProfiler m_Profiler;
+    FrameCapture m_Capture;
+    uint64_t m_GpuStatsVersion = 0;
 };
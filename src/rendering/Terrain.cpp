@@ -0,0 +1,418 @@
+#include "Terrain.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+
+#include "assets/Shader.h"
+
+namespace {
+const int kMaxLodLevels = 16;
+// LOD range of the finest level in multiples of its node size; each level doubles it
+const float kLodRangeScale = 2.0f;
+// Fraction of a level's range after which its vertices start morphing to the coarser grid
+const float kMorphStart = 0.7f;
+// The coarse map misses peaks between its samples, so node bounds get some slack
+const float kBoundsMargin = 0.02f;
+const GLuint kInstanceBinding = 1;
+
+uint32_t hash2(int x, int z) {
+    uint32_t h = static_cast<uint32_t>(x) * 0x8da6b343u ^ static_cast<uint32_t>(z) * 0xd8163841u;
+    h ^= h >> 13;
+    h *= 0x5bd1e995u;
+    h ^= h >> 15;
+    return h;
+}
+
+float valueNoise(float x, float z) {
+    int ix = static_cast<int>(std::floor(x));
+    int iz = static_cast<int>(std::floor(z));
+    float fx = x - static_cast<float>(ix);
+    float fz = z - static_cast<float>(iz);
+    auto corner = [](int cx, int cz) { return static_cast<float>(hash2(cx, cz) & 0xFFFF) / 65535.0f; };
+    float sx = fx * fx * (3.0f - 2.0f * fx);
+    float sz = fz * fz * (3.0f - 2.0f * fz);
+    float top = corner(ix, iz) + (corner(ix + 1, iz) - corner(ix, iz)) * sx;
+    float bottom = corner(ix, iz + 1) + (corner(ix + 1, iz + 1) - corner(ix, iz + 1)) * sx;
+    return top + (bottom - top) * sz;
+}
+
+// Six octaves of value noise with a 1 km base wavelength, normalized to [0, 1]
+float proceduralHeight(float x, float z) {
+    float sum = 0.0f;
+    float amplitude = 0.5f;
+    float frequency = 1.0f / 1024.0f;
+    float total = 0.0f;
+    for (int octave = 0; octave < 6; ++octave) {
+        sum += valueNoise(x * frequency, z * frequency) * amplitude;
+        total += amplitude;
+        amplitude *= 0.5f;
+        frequency *= 2.0f;
+    }
+    return sum / total;
+}
+
+float distanceToBox(const glm::vec3& point, const AABB& box) {
+    glm::vec3 closest = glm::clamp(point, box.min, box.max);
+    return glm::length(point - closest);
+}
+}
+
+Terrain::Terrain() = default;
+
+Terrain::~Terrain() {
+    clear();
+}
+
+void Terrain::loadShaders() {
+    m_Shader = std::make_unique<Shader>("assets/shaders/terrain");
+}
+
+float Terrain::nodeSize(int level) const {
+    return m_Settings.size / static_cast<float>(1 << (m_Settings.lodLevels - 1 - level));
+}
+
+void Terrain::initialize(const Settings& settings, HeightFunction heights) {
+    if (settings.lodLevels < 1 || settings.lodLevels > kMaxLodLevels) {
+        throw std::runtime_error("Terrain lodLevels must be in [1, " + std::to_string(kMaxLodLevels) + "]");
+    }
+    if (settings.tileResolution < 2 || settings.coarseResolution < 2 || settings.gridResolution < 2 ||
+        settings.tilesPerSide < 1 || settings.maxResidentTiles < 1) {
+        throw std::runtime_error("Terrain resolutions and tile counts are out of range");
+    }
+    clear();
+    m_Settings = settings;
+    m_Heights = heights ? std::move(heights) : HeightFunction(proceduralHeight);
+
+    m_LodRanges.resize(static_cast<size_t>(settings.lodLevels));
+    for (int level = 0; level < settings.lodLevels; ++level) {
+        m_LodRanges[level] = nodeSize(0) * kLodRangeScale * static_cast<float>(1 << level);
+    }
+
+    buildGrid();
+    buildCoarseMap();
+
+    int res = settings.tileResolution;
+    glCreateTextures(GL_TEXTURE_2D_ARRAY, 1, &m_TileArray);
+    glTextureStorage3D(m_TileArray, 1, GL_R32F, res, res, settings.maxResidentTiles);
+    glTextureParameteri(m_TileArray, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTextureParameteri(m_TileArray, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTextureParameteri(m_TileArray, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTextureParameteri(m_TileArray, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    // Slot of every tile in the array, -1 while only the coarse map covers it
+    int tiles = settings.tilesPerSide;
+    glCreateTextures(GL_TEXTURE_2D, 1, &m_PageTable);
+    glTextureStorage2D(m_PageTable, 1, GL_R16I, tiles, tiles);
+    glTextureParameteri(m_PageTable, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTextureParameteri(m_PageTable, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    std::vector<int16_t> empty(static_cast<size_t>(tiles) * tiles, -1);
+    glTextureSubImage2D(m_PageTable, 0, 0, 0, tiles, tiles, GL_RED_INTEGER, GL_SHORT, empty.data());
+
+    m_Tiles.assign(static_cast<size_t>(tiles) * tiles, Tile());
+    m_SlotOwners.assign(static_cast<size_t>(settings.maxResidentTiles), -1);
+    m_ResidentCount = 0;
+    m_Frame = 0;
+    m_Active = true;
+}
+
+void Terrain::clear() {
+    if (m_CoarseTexture) {
+        glDeleteTextures(1, &m_CoarseTexture);
+        m_CoarseTexture = 0;
+    }
+    if (m_TileArray) {
+        glDeleteTextures(1, &m_TileArray);
+        m_TileArray = 0;
+    }
+    if (m_PageTable) {
+        glDeleteTextures(1, &m_PageTable);
+        m_PageTable = 0;
+    }
+    m_NodeBounds.clear();
+    m_Tiles.clear();
+    m_SlotOwners.clear();
+    m_ResidentCount = 0;
+    m_Active = false;
+    m_Streaming = false;
+}
+
+void Terrain::buildGrid() {
+    int g = m_Settings.gridResolution;
+    std::vector<float> vertices;
+    vertices.reserve(static_cast<size_t>(g + 1) * (g + 1) * 2);
+    for (int z = 0; z <= g; ++z) {
+        for (int x = 0; x <= g; ++x) {
+            vertices.push_back(static_cast<float>(x) / static_cast<float>(g));
+            vertices.push_back(static_cast<float>(z) / static_cast<float>(g));
+        }
+    }
+    std::vector<unsigned int> indices;
+    indices.reserve(static_cast<size_t>(g) * g * 6);
+    for (int z = 0; z < g; ++z) {
+        for (int x = 0; x < g; ++x) {
+            auto i0 = static_cast<unsigned int>(z * (g + 1) + x);
+            unsigned int i1 = i0 + 1;
+            auto i2 = static_cast<unsigned int>(i0 + g + 1);
+            unsigned int i3 = i2 + 1;
+            indices.insert(indices.end(), {i0, i2, i1, i1, i2, i3});
+        }
+    }
+    m_GridIndexCount = static_cast<GLsizei>(indices.size());
+
+    m_GridVbo.setData(static_cast<GLsizeiptr>(vertices.size() * sizeof(float)), vertices.data(), GL_STATIC_DRAW);
+    m_GridEbo.setData(static_cast<GLsizeiptr>(indices.size() * sizeof(unsigned int)), indices.data(), GL_STATIC_DRAW);
+
+    m_GridVao.setVertexBuffer(0, m_GridVbo.id(), 0, 2 * sizeof(float));
+    m_GridVao.setElementBuffer(m_GridEbo.id());
+    m_GridVao.enableAttrib(0);
+    m_GridVao.setAttribFormat(0, 2, GL_FLOAT, GL_FALSE, 0);
+    m_GridVao.setAttribBinding(0, 0);
+
+    m_InstanceCapacity = 0;
+    m_GridVao.enableAttrib(1);
+    m_GridVao.setAttribFormat(1, 4, GL_FLOAT, GL_FALSE, offsetof(NodeInstance, node));
+    m_GridVao.setAttribBinding(1, kInstanceBinding);
+    m_GridVao.enableAttrib(2);
+    m_GridVao.setAttribFormat(2, 2, GL_FLOAT, GL_FALSE, offsetof(NodeInstance, morph));
+    m_GridVao.setAttribBinding(2, kInstanceBinding);
+    m_GridVao.setBindingDivisor(kInstanceBinding, 1);
+}
+
+void Terrain::buildCoarseMap() {
+    int res = m_Settings.coarseResolution;
+    std::vector<float> coarse(static_cast<size_t>(res) * res);
+    float step = m_Settings.size / static_cast<float>(res - 1);
+    for (int z = 0; z < res; ++z) {
+        for (int x = 0; x < res; ++x) {
+            coarse[static_cast<size_t>(z) * res + x] =
+                m_Heights(m_Settings.origin.x + x * step, m_Settings.origin.y + z * step);
+        }
+    }
+
+    glCreateTextures(GL_TEXTURE_2D, 1, &m_CoarseTexture);
+    glTextureStorage2D(m_CoarseTexture, 1, GL_R32F, res, res);
+    glTextureParameteri(m_CoarseTexture, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTextureParameteri(m_CoarseTexture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTextureParameteri(m_CoarseTexture, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTextureParameteri(m_CoarseTexture, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTextureSubImage2D(m_CoarseTexture, 0, 0, 0, res, res, GL_RED, GL_FLOAT, coarse.data());
+
+    buildNodeBounds(coarse);
+}
+
+void Terrain::buildNodeBounds(const std::vector<float>& coarse) {
+    int levels = m_Settings.lodLevels;
+    int res = m_Settings.coarseResolution;
+    m_NodeBounds.assign(static_cast<size_t>(levels), {});
+
+    // Finest level from the coarse samples each node covers
+    int finest = 1 << (levels - 1);
+    auto& leaf = m_NodeBounds[0];
+    leaf.resize(static_cast<size_t>(finest) * finest);
+    float samplesPerNode = static_cast<float>(res - 1) / static_cast<float>(finest);
+    for (int nz = 0; nz < finest; ++nz) {
+        for (int nx = 0; nx < finest; ++nx) {
+            int x0 = static_cast<int>(std::floor(nx * samplesPerNode));
+            int x1 = std::min(res - 1, static_cast<int>(std::ceil((nx + 1) * samplesPerNode)));
+            int z0 = static_cast<int>(std::floor(nz * samplesPerNode));
+            int z1 = std::min(res - 1, static_cast<int>(std::ceil((nz + 1) * samplesPerNode)));
+            glm::vec2 bounds(1.0f, 0.0f);
+            for (int z = z0; z <= z1; ++z) {
+                for (int x = x0; x <= x1; ++x) {
+                    float h = coarse[static_cast<size_t>(z) * res + x];
+                    bounds.x = std::min(bounds.x, h);
+                    bounds.y = std::max(bounds.y, h);
+                }
+            }
+            leaf[static_cast<size_t>(nz) * finest + nx] = bounds + glm::vec2(-kBoundsMargin, kBoundsMargin);
+        }
+    }
+
+    // Each parent spans its four children
+    for (int level = 1; level < levels; ++level) {
+        int count = 1 << (levels - 1 - level);
+        int childCount = count * 2;
+        const auto& children = m_NodeBounds[level - 1];
+        auto& nodes = m_NodeBounds[level];
+        nodes.resize(static_cast<size_t>(count) * count);
+        for (int nz = 0; nz < count; ++nz) {
+            for (int nx = 0; nx < count; ++nx) {
+                glm::vec2 bounds(1.0f, 0.0f);
+                for (int c = 0; c < 4; ++c) {
+                    const glm::vec2& child =
+                        children[static_cast<size_t>(nz * 2 + c / 2) * childCount + nx * 2 + c % 2];
+                    bounds.x = std::min(bounds.x, child.x);
+                    bounds.y = std::max(bounds.y, child.y);
+                }
+                nodes[static_cast<size_t>(nz) * count + nx] = bounds;
+            }
+        }
+    }
+}
+
+void Terrain::update(const glm::vec3& cameraPos) {
+    if (!m_Active) {
+        return;
+    }
+    m_Frame++;
+
+    int tiles = m_Settings.tilesPerSide;
+    float tileSize = m_Settings.size / static_cast<float>(tiles);
+    glm::vec2 camera = (glm::vec2(cameraPos.x, cameraPos.z) - m_Settings.origin) / tileSize;
+    int radius = static_cast<int>(std::ceil(m_Settings.streamRadius / tileSize));
+    int cx = static_cast<int>(std::floor(camera.x));
+    int cz = static_cast<int>(std::floor(camera.y));
+
+    std::vector<std::pair<float, int>> wanted;
+    for (int z = std::max(0, cz - radius); z <= std::min(tiles - 1, cz + radius); ++z) {
+        for (int x = std::max(0, cx - radius); x <= std::min(tiles - 1, cx + radius); ++x) {
+            glm::vec2 closest = glm::clamp(camera, glm::vec2(x, z), glm::vec2(x + 1, z + 1));
+            float distance = glm::length(camera - closest) * tileSize;
+            if (distance <= m_Settings.streamRadius) {
+                wanted.emplace_back(distance, z * tiles + x);
+            }
+        }
+    }
+    std::sort(wanted.begin(), wanted.end());
+
+    for (const auto& [distance, index] : wanted) {
+        m_Tiles[index].lastUsed = m_Frame;
+    }
+
+    m_Streaming = false;
+    int loads = 0;
+    for (const auto& [distance, index] : wanted) {
+        if (m_Tiles[index].slot >= 0) {
+            continue;
+        }
+        if (loads == m_Settings.tilesPerFrame) {
+            m_Streaming = true;
+            break;
+        }
+
+        // Free slot, else the least recently wanted tile outside the stream radius
+        int slot = -1;
+        uint32_t oldest = m_Frame;
+        for (size_t s = 0; s < m_SlotOwners.size(); ++s) {
+            int owner = m_SlotOwners[s];
+            if (owner < 0) {
+                slot = static_cast<int>(s);
+                break;
+            }
+            if (m_Tiles[owner].lastUsed < oldest) {
+                oldest = m_Tiles[owner].lastUsed;
+                slot = static_cast<int>(s);
+            }
+        }
+        if (slot < 0) {
+            // The pool cannot hold every tile in the radius; the rest stay coarse
+            break;
+        }
+        loadTile(index % tiles, index / tiles, slot);
+        loads++;
+    }
+}
+
+void Terrain::loadTile(int tileX, int tileZ, int slot) {
+    int tiles = m_Settings.tilesPerSide;
+    int owner = m_SlotOwners[slot];
+    if (owner >= 0) {
+        const int16_t none = -1;
+        glTextureSubImage2D(m_PageTable, 0, owner % tiles, owner / tiles, 1, 1, GL_RED_INTEGER, GL_SHORT, &none);
+        m_Tiles[owner].slot = -1;
+    } else {
+        m_ResidentCount++;
+    }
+
+    int res = m_Settings.tileResolution;
+    float tileSize = m_Settings.size / static_cast<float>(tiles);
+    float step = tileSize / static_cast<float>(res - 1);
+    glm::vec2 origin = m_Settings.origin + glm::vec2(tileX, tileZ) * tileSize;
+    std::vector<float> heights(static_cast<size_t>(res) * res);
+    for (int z = 0; z < res; ++z) {
+        for (int x = 0; x < res; ++x) {
+            heights[static_cast<size_t>(z) * res + x] = m_Heights(origin.x + x * step, origin.y + z * step);
+        }
+    }
+    glTextureSubImage3D(m_TileArray, 0, 0, 0, slot, res, res, 1, GL_RED, GL_FLOAT, heights.data());
+
+    int index = tileZ * tiles + tileX;
+    auto value = static_cast<int16_t>(slot);
+    glTextureSubImage2D(m_PageTable, 0, tileX, tileZ, 1, 1, GL_RED_INTEGER, GL_SHORT, &value);
+    m_Tiles[index].slot = slot;
+    m_SlotOwners[slot] = index;
+}
+
+void Terrain::selectNode(int level, int x, int z, const Frustum& frustum, const glm::vec3& cameraPos) {
+    float size = nodeSize(level);
+    int count = 1 << (m_Settings.lodLevels - 1 - level);
+    const glm::vec2& bounds = m_NodeBounds[level][static_cast<size_t>(z) * count + x];
+    glm::vec2 corner = m_Settings.origin + glm::vec2(x, z) * size;
+
+    AABB box;
+    box.min = glm::vec3(corner.x, m_Settings.baseHeight + bounds.x * m_Settings.heightScale, corner.y);
+    box.max = glm::vec3(corner.x + size, m_Settings.baseHeight + bounds.y * m_Settings.heightScale, corner.y + size);
+    if (!frustumIntersectsAABB(frustum, box, glm::mat4(1.0f))) {
+        return;
+    }
+
+    if (level > 0 && distanceToBox(cameraPos, box) <= m_LodRanges[level - 1]) {
+        for (int c = 0; c < 4; ++c) {
+            selectNode(level - 1, x * 2 + c % 2, z * 2 + c / 2, frustum, cameraPos);
+        }
+        return;
+    }
+
+    float previous = level > 0 ? m_LodRanges[level - 1] : 0.0f;
+    float end = m_LodRanges[level];
+    NodeInstance instance;
+    instance.node = glm::vec4(corner.x, corner.y, size, static_cast<float>(level));
+    instance.morph = glm::vec2(previous + (end - previous) * kMorphStart, end);
+    m_Selected.push_back(instance);
+}
+
+unsigned int Terrain::render(const glm::mat4& viewProj, const glm::vec3& cameraPos) {
+    if (!m_Active || !m_Shader) {
+        return 0;
+    }
+
+    m_Selected.clear();
+    selectNode(m_Settings.lodLevels - 1, 0, 0, extractFrustum(viewProj), cameraPos);
+    if (m_Selected.empty()) {
+        return 0;
+    }
+
+    auto bytes = static_cast<GLsizeiptr>(m_Selected.size() * sizeof(NodeInstance));
+    if (bytes > m_InstanceCapacity) {
+        m_InstanceCapacity = std::max(bytes, m_InstanceCapacity * 2);
+        m_InstanceVbo.setData(m_InstanceCapacity, nullptr, GL_DYNAMIC_DRAW);
+        m_GridVao.setVertexBuffer(kInstanceBinding, m_InstanceVbo.id(), 0, sizeof(NodeInstance));
+    }
+    m_InstanceVbo.updateSubData(0, bytes, m_Selected.data());
+
+    glm::vec4 terrain(m_Settings.origin, m_Settings.size, 0.0f);
+    m_Shader->bind();
+    m_Shader->setVec3("u_CameraPos", &cameraPos[0]);
+    m_Shader->setVec4("u_Terrain", &terrain[0]);
+    m_Shader->setFloat("u_BaseHeight", m_Settings.baseHeight);
+    m_Shader->setFloat("u_HeightScale", m_Settings.heightScale);
+    m_Shader->setFloat("u_GridResolution", static_cast<float>(m_Settings.gridResolution));
+    m_Shader->setInt("u_TilesPerSide", m_Settings.tilesPerSide);
+    m_Shader->setFloat("u_TileResolution", static_cast<float>(m_Settings.tileResolution));
+    m_Shader->setFloat("u_CoarseResolution", static_cast<float>(m_Settings.coarseResolution));
+    m_Shader->setInt("u_CoarseHeights", 0);
+    m_Shader->setInt("u_TileHeights", 1);
+    m_Shader->setInt("u_PageTable", 2);
+    glBindTextureUnit(0, m_CoarseTexture);
+    glBindTextureUnit(1, m_TileArray);
+    glBindTextureUnit(2, m_PageTable);
+
+    m_GridVao.bind();
+    glDrawElementsInstanced(GL_TRIANGLES, m_GridIndexCount, GL_UNSIGNED_INT, nullptr,
+                            static_cast<GLsizei>(m_Selected.size()));
+    VertexArray::unbind();
+    return static_cast<unsigned int>(m_Selected.size());
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <functional>
+#include <glm/glm.hpp>
+#include <memory>
+#include <vector>
+
+#include "Frustum.h"
+#include "GlBuffer.h"
+#include "VertexArray.h"
+
+class Shader;
+
+// CDLOD terrain (Strugar 2009). One shared grid mesh is instanced per selected quadtree
+// node; vertices morph towards the next coarser grid as they approach the end of their LOD
+// range, so levels meet without cracks or popping. Heights come from a low resolution map
+// that is always resident and full resolution tiles that are streamed into a fixed pool of
+// texture array layers around the camera, so GPU memory stays bounded for any terrain size.
+class Terrain {
+   public:
+    // Normalized height in [0, 1] at a world-space xz position
+    using HeightFunction = std::function<float(float x, float z)>;
+
+    struct Settings {
+        glm::vec2 origin{-2048.0f, -2048.0f};  // World xz of the minimum corner
+        float size = 4096.0f;
+        float baseHeight = -50.0f;
+        float heightScale = 300.0f;
+        int gridResolution = 32;  // Quads per node side
+        int lodLevels = 8;
+        int tilesPerSide = 32;
+        int tileResolution = 129;  // Samples per tile side, edges shared with neighbours
+        int coarseResolution = 513;
+        int maxResidentTiles = 64;
+        int tilesPerFrame = 2;
+        float streamRadius = 512.0f;
+    };
+
+    Terrain();
+    ~Terrain();
+
+    Terrain(const Terrain&) = delete;
+    Terrain& operator=(const Terrain&) = delete;
+
+    void loadShaders();
+    // An empty height function selects the built-in procedural fbm noise
+    void initialize(const Settings& settings, HeightFunction heights = HeightFunction());
+    void clear();
+    bool isActive() const { return m_Active; }
+    // True while tiles around the camera are still waiting to be streamed in
+    bool isStreaming() const { return m_Streaming; }
+
+    // Streams up to tilesPerFrame tiles closest to the camera
+    void update(const glm::vec3& cameraPos);
+    // Selects and draws the visible nodes with a single instanced draw; returns the node count
+    unsigned int render(const glm::mat4& viewProj, const glm::vec3& cameraPos);
+
+    unsigned int getResidentTiles() const { return m_ResidentCount; }
+    unsigned int getTrianglesPerNode() const {
+        return static_cast<unsigned int>(m_Settings.gridResolution * m_Settings.gridResolution * 2);
+    }
+
+   private:
+    // Mirrors the per-instance attributes in terrain.vert
+    struct NodeInstance {
+        glm::vec4 node;   // xz origin, size, level
+        glm::vec2 morph;  // Morph start and end distance
+    };
+
+    struct Tile {
+        int slot = -1;
+        uint32_t lastUsed = 0;
+    };
+
+    void buildGrid();
+    void buildCoarseMap();
+    void buildNodeBounds(const std::vector<float>& coarse);
+    void selectNode(int level, int x, int z, const Frustum& frustum, const glm::vec3& cameraPos);
+    void loadTile(int tileX, int tileZ, int slot);
+    float nodeSize(int level) const;
+
+    Settings m_Settings;
+    HeightFunction m_Heights;
+    bool m_Active = false;
+    bool m_Streaming = false;
+
+    std::unique_ptr<Shader> m_Shader;
+    VertexArray m_GridVao;
+    GlBuffer m_GridVbo{GL_ARRAY_BUFFER};
+    GlBuffer m_GridEbo{GL_ELEMENT_ARRAY_BUFFER};
+    GlBuffer m_InstanceVbo{GL_ARRAY_BUFFER};
+    GLsizeiptr m_InstanceCapacity = 0;
+    GLsizei m_GridIndexCount = 0;
+
+    GLuint m_CoarseTexture = 0;
+    GLuint m_TileArray = 0;
+    GLuint m_PageTable = 0;
+
+    // Per level (0 = finest) min/max normalized height of every node, row-major
+    std::vector<std::vector<glm::vec2>> m_NodeBounds;
+    std::vector<float> m_LodRanges;
+    std::vector<NodeInstance> m_Selected;
+
+    std::vector<Tile> m_Tiles;       // tilesPerSide^2
+    std::vector<int> m_SlotOwners;   // Tile index per slot, -1 when free
+    unsigned int m_ResidentCount = 0;
+    uint32_t m_Frame = 0;
+};
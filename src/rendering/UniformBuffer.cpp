@@ -13,3 +13,11 @@ void UniformBuffer::update(GLsizeiptr size, const void* data) const {
 void UniformBuffer::updateSubData(GLintptr offset, GLsizeiptr size, const void* data) const {
     m_Buffer.updateSubData(offset, size, data);
 }
+
+void UniformBuffer::bind() const {
+    glBindBufferBase(GL_UNIFORM_BUFFER, m_Binding, m_Buffer.id());
+}
+
+void UniformBuffer::bindRange(GLintptr offset, GLsizeiptr size) const {
+    glBindBufferRange(GL_UNIFORM_BUFFER, m_Binding, m_Buffer.id(), offset, size);
+}
@@ -14,6 +14,9 @@ class UniformBuffer {
 
     void update(GLsizeiptr size, const void* data) const;
     void updateSubData(GLintptr offset, GLsizeiptr size, const void* data) const;
+    // Rebinds the whole buffer, or one block of several packed into it, to the binding point
+    void bind() const;
+    void bindRange(GLintptr offset, GLsizeiptr size) const;
 
    private:
     GlBuffer m_Buffer;
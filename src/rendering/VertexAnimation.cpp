@@ -0,0 +1,77 @@
+#include "VertexAnimation.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace {
+// std430 layout of one clip table entry in basic.vert
+struct ClipGpu {
+    uint32_t firstFrame;
+    uint32_t frameCount;
+    float frameRate;
+    float duration;
+};
+}
+
+VertexAnimationTexture::~VertexAnimationTexture() {
+    release();
+}
+
+void VertexAnimationTexture::release() {
+    if (m_Textures[0]) {
+        glDeleteTextures(2, m_Textures);
+        m_Textures[0] = m_Textures[1] = 0;
+    }
+    m_Clips.clear();
+    m_VertexCount = 0;
+}
+
+void VertexAnimationTexture::upload(const VertexAnimationData& data) {
+    size_t texels = data.positions.size();
+    if (data.vertexCount == 0 || data.clips.empty() || texels == 0 || data.normals.size() != texels ||
+        texels % data.vertexCount != 0) {
+        throw std::invalid_argument("Vertex animation data is empty or inconsistent");
+    }
+    GLint maxSize = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+    size_t rows = (texels + kWidth - 1) / kWidth;
+    if (rows > static_cast<size_t>(maxSize)) {
+        throw std::runtime_error("Vertex animation needs " + std::to_string(rows) +
+                                 " texture rows, more than GL_MAX_TEXTURE_SIZE; lower the frame rate");
+    }
+
+    release();
+    m_VertexCount = data.vertexCount;
+    m_Clips = data.clips;
+
+    // Pad the last row so both uploads cover whole rows
+    std::vector<glm::vec4> positions(rows * kWidth, glm::vec4(0.0f));
+    std::vector<glm::vec4> normals(rows * kWidth, glm::vec4(0.0f));
+    std::copy(data.positions.begin(), data.positions.end(), positions.begin());
+    std::copy(data.normals.begin(), data.normals.end(), normals.begin());
+
+    const GLenum formats[2] = {GL_RGBA16F, GL_RGBA8_SNORM};
+    const std::vector<glm::vec4>* sources[2] = {&positions, &normals};
+    glCreateTextures(GL_TEXTURE_2D, 2, m_Textures);
+    for (int t = 0; t < 2; ++t) {
+        glTextureStorage2D(m_Textures[t], 1, formats[t], kWidth, static_cast<GLsizei>(rows));
+        glTextureSubImage2D(m_Textures[t], 0, 0, 0, kWidth, static_cast<GLsizei>(rows), GL_RGBA, GL_FLOAT,
+                            sources[t]->data());
+        glTextureParameteri(m_Textures[t], GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTextureParameteri(m_Textures[t], GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    }
+
+    std::vector<ClipGpu> clips;
+    clips.reserve(m_Clips.size());
+    for (const auto& clip : m_Clips) {
+        clips.push_back({clip.firstFrame, clip.frameCount, clip.frameRate, clip.duration});
+    }
+    m_ClipBuffer.setData(static_cast<GLsizeiptr>(clips.size() * sizeof(ClipGpu)), clips.data(), GL_STATIC_DRAW);
+}
+
+void VertexAnimationTexture::bind(unsigned int firstUnit, GLuint clipBinding) const {
+    glBindTextureUnit(firstUnit, m_Textures[0]);
+    glBindTextureUnit(firstUnit + 1, m_Textures[1]);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, clipBinding, m_ClipBuffer.id());
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "GlBuffer.h"
+#include "Mesh.h"
+
+// One baked clip: frames [firstFrame, firstFrame + frameCount) sampled at frameRate over
+// duration seconds, with the last frame at the clip end so playback loops by wrapping time
+struct VertexAnimationClip {
+    uint32_t firstFrame = 0;
+    uint32_t frameCount = 0;
+    float frameRate = 30.0f;
+    float duration = 0.0f;
+    AABB bounds{glm::vec3(0.0f), glm::vec3(0.0f)};  // Union of every frame, model space
+};
+
+// Skinned clips baked to per-frame vertex positions and normals, frame-major
+struct VertexAnimationData {
+    uint32_t vertexCount = 0;
+    std::vector<VertexAnimationClip> clips;
+    std::vector<glm::vec4> positions;  // xyz, one per vertex per frame
+    std::vector<glm::vec4> normals;    // xyz unit normals
+};
+
+// GPU side of VertexAnimationData. Frames are laid out row by row in an RGBA16F position
+// texture and an RGBA8 snorm normal texture kWidth texels wide, so the vertex shader finds
+// vertex v of frame f at texel f * vertexCount + v. The clip table is a small SSBO.
+class VertexAnimationTexture {
+   public:
+    static const int kWidth = 2048;
+
+    VertexAnimationTexture() = default;
+    ~VertexAnimationTexture();
+
+    VertexAnimationTexture(const VertexAnimationTexture&) = delete;
+    VertexAnimationTexture& operator=(const VertexAnimationTexture&) = delete;
+
+    void upload(const VertexAnimationData& data);
+    void release();
+
+    // Binds positions and normals to two consecutive units and the clip table to `clipBinding`
+    void bind(unsigned int firstUnit, GLuint clipBinding) const;
+    uint32_t getVertexCount() const { return m_VertexCount; }
+    const std::vector<VertexAnimationClip>& getClips() const { return m_Clips; }
+
+   private:
+    GLuint m_Textures[2] = {0, 0};
+    GlBuffer m_ClipBuffer{GL_SHADER_STORAGE_BUFFER};
+    uint32_t m_VertexCount = 0;
+    std::vector<VertexAnimationClip> m_Clips;
+};
@@ -63,6 +63,12 @@ void Camera::processKeyboard(bool forward, bool backward, bool left, bool right,
     if (down) m_Position.y -= velocity;
 }
 
+void Camera::setOrientation(float yawDegrees, float pitchDegrees) {
+    m_Yaw = yawDegrees;
+    m_Pitch = glm::clamp(pitchDegrees, -89.0f, 89.0f);
+    updateVectors();
+}
+
 void Camera::setMoveSpeed(float speed) {
     if (speed > 0.0f) {
         m_Speed = speed;
@@ -98,6 +104,9 @@ void Camera::applySettings(const Settings& settings) {
 
 glm::mat4 Camera::getViewProjection() const {
     glm::mat4 view = glm::lookAt(m_Position, m_Position + m_Front, m_Up);
-    glm::mat4 proj = glm::perspective(glm::radians(m_Fov), m_Aspect, m_Near, m_Far);
-    return proj * view;
+    return getProjection() * view;
+}
+
+glm::mat4 Camera::getProjection() const {
+    return glm::perspective(glm::radians(m_Fov), m_Aspect, m_Near, m_Far);
 }
\ No newline at end of file
@@ -18,8 +18,14 @@ class Camera {
     void processKeyboard(bool forward, bool backward, bool left, bool right, bool up, bool down, float deltaTime);
 
     glm::mat4 getViewProjection() const;
+    glm::mat4 getProjection() const;
+    const glm::vec3& getPosition() const { return m_Position; }
+    const glm::vec3& getRight() const { return m_Right; }
+    const glm::vec3& getUp() const { return m_Up; }
     void setAspect(float aspect) { m_Aspect = aspect; }
     void setPosition(const glm::vec3& position) { m_Position = position; }
+    // Pitch is clamped like mouse look, short of straight up or down
+    void setOrientation(float yawDegrees, float pitchDegrees);
     void setMoveSpeed(float speed);
     void setMouseSensitivity(float sensitivity);
     void setFov(float fovDegrees);
@@ -0,0 +1,79 @@
+#include "Crowd.h"
+
+#include <stdexcept>
+
+#include "rendering/VertexAnimation.h"
+
+namespace {
+void expand(AABB& bounds, const AABB& other) {
+    bounds.min = glm::min(bounds.min, other.min);
+    bounds.max = glm::max(bounds.max, other.max);
+}
+}
+
+Crowd::Crowd(const Model& model) {
+    const VertexAnimationTexture* animated = nullptr;
+    for (const auto& sub : model.getSubMeshes()) {
+        if (!sub.mesh) {
+            continue;
+        }
+        m_Parts.push_back({sub.mesh.get(), sub.material});
+        if (!animated && sub.mesh->getVertexAnimation()) {
+            animated = sub.mesh->getVertexAnimation();
+        }
+    }
+    if (!animated) {
+        throw std::runtime_error("Crowd model '" + model.getPath() + "' has no vertex animation");
+    }
+
+    // Every animated part bakes the same clips; static parts contribute their rest bounds
+    m_ClipBounds.resize(animated->getClips().size());
+    for (size_t c = 0; c < m_ClipBounds.size(); ++c) {
+        m_ClipBounds[c] = animated->getClips()[c].bounds;
+        for (const auto& part : m_Parts) {
+            const VertexAnimationTexture* animation = part.mesh->getVertexAnimation();
+            expand(m_ClipBounds[c], animation && c < animation->getClips().size() ? animation->getClips()[c].bounds
+                                                                                  : part.mesh->getAABB());
+        }
+    }
+}
+
+void Crowd::add(const Transform& transform, uint32_t clip, float timeOffset) {
+    if (clip >= m_ClipBounds.size()) {
+        clip = 0;
+    }
+    InstanceData data;
+    data.modelMatrix = transform.getMatrix();
+    data.normalMatrix = glm::transpose(glm::inverse(glm::mat3(data.modelMatrix)));
+    data.animationClip = clip;
+    data.animationTime = timeOffset;
+    m_Instances.push_back(data);
+
+    // World bounds from the eight transformed corners of the clip bounds
+    const AABB& local = m_ClipBounds[clip];
+    AABB world{};
+    for (int corner = 0; corner < 8; ++corner) {
+        glm::vec3 p((corner & 1) ? local.max.x : local.min.x, (corner & 2) ? local.max.y : local.min.y,
+                    (corner & 4) ? local.max.z : local.min.z);
+        glm::vec3 w(data.modelMatrix * glm::vec4(p, 1.0f));
+        if (corner == 0) {
+            world = {w, w};
+        } else {
+            world.min = glm::min(world.min, w);
+            world.max = glm::max(world.max, w);
+        }
+    }
+    m_Bounds.push_back(world);
+}
+
+size_t Crowd::cull(const Frustum& frustum, std::vector<InstanceData>& out) const {
+    const glm::mat4 identity(1.0f);
+    size_t visible = 0;
+    for (size_t i = 0; i < m_Instances.size(); ++i) {
+        if (frustumIntersectsAABB(frustum, m_Bounds[i], identity)) {
+            out.push_back(m_Instances[i]);
+            ++visible;
+        }
+    }
+    return visible;
+}
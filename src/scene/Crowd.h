@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Transform.h"
+#include "assets/Model.h"
+#include "rendering/Frustum.h"
+#include "rendering/Renderer.h"
+
+// Thousands of animated copies of a model whose skinned clips were baked into vertex
+// animation textures at import. Each instance only carries its transform, clip and time
+// offset in its instance data and the vertex shader plays the clip, so the CPU does no
+// per-frame animation work; culling tests each instance's clip bounds once for all parts.
+class Crowd {
+   public:
+    struct Part {
+        Mesh* mesh = nullptr;
+        MaterialHandle material;
+    };
+
+    // Every submesh of `model` becomes a part; throws if none has vertex animation
+    explicit Crowd(const Model& model);
+
+    // A clip outside the baked clips plays clip 0
+    void add(const Transform& transform, uint32_t clip, float timeOffset);
+
+    // Appends the instances whose bounds intersect the frustum and returns how many
+    size_t cull(const Frustum& frustum, std::vector<InstanceData>& out) const;
+
+    const std::vector<Part>& getParts() const { return m_Parts; }
+    size_t getInstanceCount() const { return m_Instances.size(); }
+    size_t getClipCount() const { return m_ClipBounds.size(); }
+
+   private:
+    std::vector<Part> m_Parts;
+    std::vector<AABB> m_ClipBounds;  // Model space, union over parts and frames
+    std::vector<InstanceData> m_Instances;
+    std::vector<AABB> m_Bounds;  // World space, parallel to m_Instances
+};
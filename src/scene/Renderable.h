@@ -4,9 +4,14 @@
 #include "Transform.h"
 
 class Mesh;
+struct MeshData;
 
 struct Renderable {
     Mesh* mesh = nullptr;
     MaterialHandle material;
     Transform transform;
+    // Never moves after scene build, so it may be merged by the static batcher
+    bool isStatic = false;
+    // CPU copy of the mesh's vertices and indices, the static batcher merges from it
+    const MeshData* source = nullptr;
 };
@@ -0,0 +1,145 @@
+#include "ScatterField.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <unordered_map>
+
+namespace {
+bool frustumContainsAABB(const Frustum& frustum, const AABB& box) {
+    for (int p = 0; p < 6; ++p) {
+        const glm::vec3 n = glm::vec3(frustum.planes[p]);
+        // Least positive corner must be inside every plane
+        glm::vec3 v;
+        v.x = n.x >= 0.0f ? box.min.x : box.max.x;
+        v.y = n.y >= 0.0f ? box.min.y : box.max.y;
+        v.z = n.z >= 0.0f ? box.min.z : box.max.z;
+        if (glm::dot(n, v) + frustum.planes[p].w < 0.0f) return false;
+    }
+    return true;
+}
+
+bool frustumIntersectsSphere(const Frustum& frustum, const glm::vec4& sphere) {
+    for (int p = 0; p < 6; ++p) {
+        if (glm::dot(glm::vec3(frustum.planes[p]), glm::vec3(sphere)) + frustum.planes[p].w < -sphere.w) {
+            return false;
+        }
+    }
+    return true;
+}
+
+float nearestDistance(const glm::vec3& point, const AABB& box) {
+    return glm::length(point - glm::clamp(point, box.min, box.max));
+}
+
+float farthestDistance(const glm::vec3& point, const AABB& box) {
+    glm::vec3 far = glm::max(glm::abs(point - box.min), glm::abs(point - box.max));
+    return glm::length(far);
+}
+}
+
+ScatterField::ScatterField(Mesh* mesh, MaterialHandle material, const Settings& settings)
+    : m_Mesh(mesh), m_Material(std::move(material)), m_Settings(settings) {
+}
+
+void ScatterField::build(const std::vector<Transform>& transforms) {
+    m_Cells.clear();
+    m_Instances.clear();
+    m_Spheres.clear();
+    if (!m_Mesh || transforms.empty()) {
+        return;
+    }
+
+    const AABB& local = m_Mesh->getAABB();
+    glm::vec3 localCenter = (local.min + local.max) * 0.5f;
+    float localRadius = glm::length(local.max - local.min) * 0.5f;
+
+    // Bucket by xz cell, keeping cells in first-seen order
+    std::unordered_map<uint64_t, size_t> cellIndex;
+    std::vector<std::vector<size_t>> members;
+    for (size_t i = 0; i < transforms.size(); ++i) {
+        const glm::vec3& p = transforms[i].position;
+        auto cx = static_cast<int32_t>(std::floor(p.x / m_Settings.cellSize));
+        auto cz = static_cast<int32_t>(std::floor(p.z / m_Settings.cellSize));
+        uint64_t key = (static_cast<uint64_t>(static_cast<uint32_t>(cx)) << 32) | static_cast<uint32_t>(cz);
+        auto [it, inserted] = cellIndex.emplace(key, members.size());
+        if (inserted) {
+            members.emplace_back();
+        }
+        members[it->second].push_back(i);
+    }
+
+    // Fixed seed so density LOD picks the same instances every run
+    std::mt19937 rng(0x5CA77E5u);
+    m_Instances.reserve(transforms.size());
+    m_Spheres.reserve(transforms.size());
+    m_Cells.reserve(members.size());
+    for (auto& indices : members) {
+        std::shuffle(indices.begin(), indices.end(), rng);
+
+        Cell cell;
+        cell.first = m_Instances.size();
+        cell.count = indices.size();
+        cell.bounds.min = glm::vec3(std::numeric_limits<float>::max());
+        cell.bounds.max = glm::vec3(std::numeric_limits<float>::lowest());
+        for (size_t index : indices) {
+            InstanceData data;
+            data.modelMatrix = transforms[index].getMatrix();
+            data.normalMatrix = glm::transpose(glm::inverse(glm::mat3(data.modelMatrix)));
+
+            const glm::vec3& scale = transforms[index].scale;
+            float maxScale = std::max(std::abs(scale.x), std::max(std::abs(scale.y), std::abs(scale.z)));
+            glm::vec3 center = glm::vec3(data.modelMatrix * glm::vec4(localCenter, 1.0f));
+            float radius = localRadius * maxScale;
+            cell.bounds.min = glm::min(cell.bounds.min, center - glm::vec3(radius));
+            cell.bounds.max = glm::max(cell.bounds.max, center + glm::vec3(radius));
+
+            m_Instances.push_back(data);
+            m_Spheres.emplace_back(center, radius);
+        }
+        m_Cells.push_back(cell);
+    }
+}
+
+ScatterField::CullStats ScatterField::cull(const Frustum& frustum, const glm::vec3& cameraPos,
+                                           std::vector<InstanceData>& out) const {
+    CullStats stats;
+    const float fadeRange = std::max(m_Settings.fadeEnd - m_Settings.fadeStart, 1e-3f);
+    const float lodRange = std::max(m_Settings.fadeStart - m_Settings.lodStart, 1e-3f);
+
+    for (const Cell& cell : m_Cells) {
+        float nearest = nearestDistance(cameraPos, cell.bounds);
+        if (nearest >= m_Settings.fadeEnd || !frustumIntersectsAABB(frustum, cell.bounds, glm::mat4(1.0f))) {
+            continue;
+        }
+
+        float density = 1.0f - glm::clamp((nearest - m_Settings.lodStart) / lodRange, 0.0f, 1.0f) *
+                                   (1.0f - m_Settings.minDensity);
+        auto keep = static_cast<size_t>(std::ceil(static_cast<float>(cell.count) * density));
+        if (keep == 0) {
+            continue;
+        }
+        stats.cells++;
+
+        // Whole prefix when the cell is inside the frustum and closer than the fade band
+        if (farthestDistance(cameraPos, cell.bounds) <= m_Settings.fadeStart && frustumContainsAABB(frustum, cell.bounds)) {
+            out.insert(out.end(), m_Instances.begin() + cell.first, m_Instances.begin() + cell.first + keep);
+            stats.instances += static_cast<unsigned int>(keep);
+            continue;
+        }
+
+        for (size_t i = 0; i < keep; ++i) {
+            const glm::vec4& sphere = m_Spheres[cell.first + i];
+            // Later instances in the shuffled order fade out closer to the camera
+            float fadeOut = m_Settings.fadeEnd - fadeRange * static_cast<float>(i) / static_cast<float>(keep);
+            if (glm::length(glm::vec3(sphere) - cameraPos) > fadeOut || !frustumIntersectsSphere(frustum, sphere)) {
+                continue;
+            }
+            out.push_back(m_Instances[cell.first + i]);
+            stats.instances++;
+        }
+    }
+    return stats;
+}
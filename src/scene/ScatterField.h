@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "Transform.h"
+#include "assets/Material.h"
+#include "rendering/Frustum.h"
+#include "rendering/Renderer.h"
+
+// Many copies of one mesh (props, foliage) kept out of the per-Renderable path. Instances
+// are bucketed into square xz cells with their own AABB and shuffled inside each cell, so
+// culling tests a cell first, then only the instances of cells that straddle the frustum
+// or the fade band. Density LOD keeps a distance-dependent prefix of each cell and the
+// distance fade drops instances one by one in shuffled order, so both thin out evenly.
+class ScatterField {
+   public:
+    struct Settings {
+        float cellSize = 32.0f;
+        float lodStart = 50.0f;    // Cells closer than this draw every instance
+        float fadeStart = 150.0f;  // Instances start fading out
+        float fadeEnd = 200.0f;    // Nothing is drawn beyond this
+        float minDensity = 0.25f;  // Fraction of a cell kept at fadeStart
+    };
+
+    struct CullStats {
+        unsigned int cells = 0;
+        unsigned int instances = 0;
+    };
+
+    ScatterField(Mesh* mesh, MaterialHandle material, const Settings& settings);
+
+    void build(const std::vector<Transform>& transforms);
+
+    // Appends the surviving instances to `out`
+    CullStats cull(const Frustum& frustum, const glm::vec3& cameraPos, std::vector<InstanceData>& out) const;
+
+    Mesh* getMesh() const { return m_Mesh; }
+    const MaterialHandle& getMaterial() const { return m_Material; }
+    size_t getInstanceCount() const { return m_Instances.size(); }
+    size_t getCellCount() const { return m_Cells.size(); }
+
+   private:
+    struct Cell {
+        AABB bounds;
+        size_t first = 0;
+        size_t count = 0;
+    };
+
+    Mesh* m_Mesh;
+    MaterialHandle m_Material;
+    Settings m_Settings;
+    std::vector<Cell> m_Cells;
+    // Grouped by cell; spheres (world center, radius) parallel the instance data
+    std::vector<InstanceData> m_Instances;
+    std::vector<glm::vec4> m_Spheres;
+};
@@ -1,7 +1,10 @@
 #include "Scene.h"
 
+#include <cmath>
 #include <stdexcept>
+#include <glm/gtc/constants.hpp>
 #include <iostream>
+#include <random>
 
 #include "core/Input.h"
 #include "core/Timer.h"
@@ -11,25 +14,273 @@ Scene::Scene(float aspectRatio, AssetManager& assetManager) : m_Player(aspectRat
 
 void Scene::initialize() {
     createSponzaModel();
+    if (m_StaticBatching) {
+        batchStaticRenderables();
+    }
+    if (m_CharacterCount > 0) {
+        createSkinnedCharacters();
+    }
+    if (m_CrowdCount > 0) {
+        createCrowd();
+    }
 }
 
-void Scene::createSponzaModel() {
+void Scene::setCrowd(const std::string& modelPath, int count, float spacing, float scale) {
+    m_CrowdModelPath = modelPath;
+    m_CrowdCount = count;
+    m_CrowdSpacing = spacing;
+    m_CrowdScale = scale;
+}
+
+void Scene::createCrowd() {
     Timer timer;
-    Transform t;
-    t.position = {0.0f, 0.0f, 0.0f};
-    t.scale = {0.1f, 0.1f, 0.1f};
+    auto model = m_AssetManager.getOrLoadModel(m_CrowdModelPath, "assets/shaders/basic");
+    auto modelPtr = model.get();
+    if (!modelPtr) {
+        throw std::runtime_error("Crowd model handle is invalid");
+    }
+    m_Crowd = std::make_unique<Crowd>(*modelPtr);
+
+    // Square grid centred on the origin with random heading, clip and phase per instance
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    auto clipCount = static_cast<uint32_t>(m_Crowd->getClipCount());
+    int side = static_cast<int>(std::ceil(std::sqrt(static_cast<float>(m_CrowdCount))));
+    float origin = -0.5f * m_CrowdSpacing * static_cast<float>(side - 1);
+    for (int i = 0; i < m_CrowdCount; ++i) {
+        Transform transform;
+        transform.position = {origin + m_CrowdSpacing * static_cast<float>(i % side), 0.0f,
+                              origin + m_CrowdSpacing * static_cast<float>(i / side)};
+        transform.rotation = glm::angleAxis(unit(rng) * glm::two_pi<float>(), glm::vec3(0.0f, 1.0f, 0.0f));
+        transform.scale = glm::vec3(m_CrowdScale);
+        auto clip = static_cast<uint32_t>(unit(rng) * static_cast<float>(clipCount)) % clipCount;
+        m_Crowd->add(transform, clip, unit(rng) * 10.0f);
+    }
+    ++m_Revision;
+    std::cout << "Crowd: " << m_CrowdCount << " instances of " << m_CrowdModelPath << " playing " << clipCount
+              << " clips, placed in " << timer.get_milliseconds() << " ms" << std::endl;
+}
+
+void Scene::setSkinnedCharacters(const std::string& modelPath, int count, float spacing, float scale,
+                                 unsigned int animationThreads) {
+    m_CharacterModelPath = modelPath;
+    m_CharacterCount = count;
+    m_CharacterSpacing = spacing;
+    m_CharacterScale = scale;
+    m_AnimationThreads = animationThreads;
+}
+
+void Scene::createSkinnedCharacters() {
+    Timer timer;
+    auto model = m_AssetManager.getOrLoadModel(m_CharacterModelPath, "assets/shaders/basic");
+    auto modelPtr = model.get();
+    if (!modelPtr) {
+        throw std::runtime_error("Skinned model handle is invalid");
+    }
+
+    // Square grid centred on the origin, clips offset so the instances do not move in lockstep
+    int side = static_cast<int>(std::ceil(std::sqrt(static_cast<float>(m_CharacterCount))));
+    float origin = -0.5f * m_CharacterSpacing * static_cast<float>(side - 1);
+    for (int i = 0; i < m_CharacterCount; ++i) {
+        Transform transform;
+        transform.position = {origin + m_CharacterSpacing * static_cast<float>(i % side), 0.0f,
+                              origin + m_CharacterSpacing * static_cast<float>(i / side)};
+        transform.scale = glm::vec3(m_CharacterScale);
+        float startTime = 0.37f * static_cast<float>(i);
+        m_Characters.push_back(std::make_unique<SkinnedCharacter>(*modelPtr, transform, 0, startTime));
+    }
+    m_AnimationWorkers = std::make_unique<WorkerPool>(m_AnimationThreads);
+    ++m_Revision;
+    std::cout << "Skinned characters: " << m_CharacterCount << " instances of " << m_CharacterModelPath
+              << " placed in " << timer.get_milliseconds() << " ms, animated on "
+              << m_AnimationWorkers->getThreadCount() << " threads" << std::endl;
+}
+
+void Scene::setScatterBenchmark(size_t instances, float area, const ScatterField::Settings& settings) {
+    m_ScatterInstances = instances;
+    m_ScatterArea = area;
+    m_ScatterSettings = settings;
+}
+
+void Scene::createScatterBenchmark(const Model& model) {
+    // Smallest submesh, so the benchmark measures culling and submission rather than vertex load
+    const SubMesh* source = nullptr;
+    for (const auto& sub : model.getSubMeshes()) {
+        if (sub.mesh && (!source || sub.mesh->getIndexCount() < source->mesh->getIndexCount())) {
+            source = &sub;
+        }
+    }
+    if (!source) {
+        return;
+    }
+
+    Timer timer;
+    std::mt19937 rng(1234u);
+    std::uniform_real_distribution<float> position(-0.5f * m_ScatterArea, 0.5f * m_ScatterArea);
+    std::uniform_real_distribution<float> angle(0.0f, glm::two_pi<float>());
+    std::uniform_real_distribution<float> scale(0.05f, 0.15f);
+    std::vector<Transform> transforms(m_ScatterInstances);
+    for (auto& transform : transforms) {
+        transform.position = {position(rng), 0.0f, position(rng)};
+        transform.rotation = glm::angleAxis(angle(rng), glm::vec3(0.0f, 1.0f, 0.0f));
+        transform.scale = glm::vec3(scale(rng));
+    }
+
+    auto field = std::make_unique<ScatterField>(source->mesh.get(), source->material, m_ScatterSettings);
+    field->build(transforms);
+    std::cout << "Scatter benchmark: " << field->getInstanceCount() << " instances in " << field->getCellCount()
+              << " cells built in " << timer.get_milliseconds() << " ms" << std::endl;
+    m_ScatterFields.push_back(std::move(field));
+    ++m_Revision;
+}
+
+void Scene::setStaticBatching(bool enabled, float chunkSize) {
+    m_StaticBatching = enabled;
+    m_StaticChunkSize = chunkSize;
+}
+
+std::vector<Renderable> Scene::collectStatics() const {
+    std::vector<Renderable> statics;
+    for (const auto& renderable : m_Renderables) {
+        if (renderable.isStatic && renderable.source) {
+            statics.push_back(renderable);
+        }
+    }
+    return statics;
+}
+
+void Scene::replaceStatics(StaticBatcher::Result batched, double ms) {
+    std::vector<Renderable> dynamics;
+    for (const auto& renderable : m_Renderables) {
+        if (!(renderable.isStatic && renderable.source)) {
+            dynamics.push_back(renderable);
+        }
+    }
+    m_Renderables = std::move(dynamics);
+    m_Renderables.insert(m_Renderables.end(), batched.renderables.begin(), batched.renderables.end());
+    for (auto& mesh : batched.meshes) {
+        m_BatchedMeshes.push_back(std::move(mesh));
+    }
+    ++m_Revision;
+    std::cout << "Static batching: " << batched.sourceCount << " renderables -> " << batched.renderables.size()
+              << " chunks in " << ms << " ms" << std::endl;
+}
+
+void Scene::batchStaticRenderables() {
+    Timer timer;
+    std::vector<Renderable> statics = collectStatics();
+    if (statics.empty()) {
+        return;
+    }
+
+    StaticBatcher::Settings settings;
+    settings.chunkSize = m_StaticChunkSize;
+    replaceStatics(StaticBatcher::build(statics, settings), timer.get_milliseconds());
+}
+
+void Scene::startStaticBatching() {
+    std::vector<Renderable> statics = collectStatics();
+    if (statics.empty()) {
+        return;
+    }
+
+    m_BatchTimer.reset();
+    m_BatchResult = StaticBatcher::Result();
+    m_BatchResult.sourceCount = statics.size();
+    m_BatchChunks.clear();
+    m_NextBatchChunk = 0;
+    StaticBatcher::Settings settings;
+    settings.chunkSize = m_StaticChunkSize;
+    // The sources are the model's CPU mesh data, which m_SponzaModel keeps alive
+    m_BatchMerge = std::async(std::launch::async, [statics = std::move(statics), settings]() {
+        return StaticBatcher::merge(statics, settings);
+    });
+    m_BatchPending = true;
+}
+
+void Scene::updateStaticBatching() {
+    if (m_BatchMerge.valid()) {
+        if (m_BatchMerge.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            return;
+        }
+        try {
+            m_BatchChunks = m_BatchMerge.get();
+        } catch (const std::exception& e) {
+            // The unbatched renderables stay in the scene
+            std::cerr << "Static batching failed: " << e.what() << std::endl;
+            m_BatchPending = false;
+            return;
+        }
+    }
+
+    // The original renderables keep drawing until every merged mesh exists
+    Timer timer;
+    size_t first = m_NextBatchChunk;
+    while (m_NextBatchChunk < m_BatchChunks.size()) {
+        if (m_NextBatchChunk > first && timer.get_milliseconds() >= m_UploadBudgetMs) {
+            return;
+        }
+        StaticBatcher::upload(m_BatchChunks[m_NextBatchChunk++], m_BatchResult);
+    }
+    m_BatchChunks.clear();
+    m_BatchPending = false;
+    replaceStatics(std::move(m_BatchResult), m_BatchTimer.get_milliseconds());
+    m_BatchResult = StaticBatcher::Result();
+}
+
+void Scene::createSponzaModel() {
+    m_ModelTimer.reset();
     std::string shaderPath = "assets/shaders/basic";
     std::string modelPath = "assets/models/sponza_glb/sponza.glb";
     // std::string modelPath = "assets/models/sponza/sponza.gltf";
     auto shader = m_AssetManager.getOrLoadShader(shaderPath);
+    if (m_AsyncLoading) {
+        m_PendingModel = m_AssetManager.loadModelAsync(modelPath, shaderPath);
+        return;
+    }
     auto model = m_AssetManager.getOrLoadModel(modelPath, shaderPath);
 
-    auto modelPtr = model.get();
-    if (!modelPtr) {
+    m_SponzaModel = model.get();
+    if (!m_SponzaModel) {
         throw std::runtime_error("Model handle is invalid");
     }
+    addSponzaSubMeshes(*m_SponzaModel);
+    finishSponzaModel(*m_SponzaModel);
+}
+
+void Scene::updatePendingModel() {
+    AssetState state = m_PendingModel.getState();
+    if (state == AssetState::Ready) {
+        m_SponzaModel = m_PendingModel.get();
+    } else if (!m_SponzaModel) {
+        m_SponzaModel = m_AssetManager.getLoadingModel(m_PendingModel);
+    }
+    if (m_SponzaModel) {
+        addSponzaSubMeshes(*m_SponzaModel);
+    }
+    if (state == AssetState::Pending) {
+        return;
+    }
 
-    for (const auto& sub : modelPtr->getSubMeshes()) {
+    m_PendingModel = ModelHandle();
+    if (state != AssetState::Ready || !m_SponzaModel) {
+        // The asset manager logged the cause; whatever was uploaded before stays in the scene
+        std::cerr << "Sponza model failed to load after " << m_SponzaSubMeshes << " submeshes" << std::endl;
+        return;
+    }
+    finishSponzaModel(*m_SponzaModel);
+    if (m_StaticBatching) {
+        startStaticBatching();
+    }
+}
+
+void Scene::addSponzaSubMeshes(const Model& model) {
+    Transform t;
+    t.position = {0.0f, 0.0f, 0.0f};
+    t.scale = {0.1f, 0.1f, 0.1f};
+    const auto& subMeshes = model.getSubMeshes();
+    for (; m_SponzaSubMeshes < subMeshes.size(); ++m_SponzaSubMeshes) {
+        const SubMesh& sub = subMeshes[m_SponzaSubMeshes];
         if (!sub.mesh) {
             throw std::runtime_error("SubMesh is missing mesh data");
         }
@@ -37,11 +288,43 @@ void Scene::createSponzaModel() {
         renderable.mesh = sub.mesh.get();
         renderable.material = sub.material;
         renderable.transform = t;
+        renderable.isStatic = true;
+        renderable.source = sub.data.get();
         addRenderable(renderable);
     }
-    std::cout << "Sponza model loaded in " << timer.get_milliseconds() << " ms" << std::endl;
+}
+
+void Scene::finishSponzaModel(const Model& model) {
+    std::cout << "Sponza model loaded in " << m_ModelTimer.get_milliseconds() << " ms" << std::endl;
+    if (m_ScatterInstances > 0) {
+        createScatterBenchmark(model);
+    }
 }
 
 void Scene::update(float deltaTime, const Input& input) {
     m_Player.update(deltaTime, input);
+    if (m_PendingModel.isValid()) {
+        updatePendingModel();
+    }
+    if (m_BatchPending) {
+        updateStaticBatching();
+    }
+
+    bool animated = false;
+    for (auto& character : m_Characters) {
+        character->update(deltaTime);
+        animated = animated || character->isAnimated();
+    }
+    // The crowd animates on the GPU, every frame differs
+    if (m_Crowd) {
+        ++m_Revision;
+    }
+    if (animated) {
+        m_AnimationWorkers->parallelFor(m_Characters.size(), [this](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                m_Characters[i]->animate();
+            }
+        });
+        ++m_Revision;
+    }
 }
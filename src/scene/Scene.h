@@ -1,12 +1,21 @@
 #pragma once
+#include <cstdint>
+#include <future>
 #include <memory>
+#include <string>
 #include <vector>
 
+#include "Crowd.h"
 #include "Player.h"
 #include "Renderable.h"
+#include "ScatterField.h"
+#include "SkinnedCharacter.h"
 #include "Sky.h"
+#include "StaticBatcher.h"
 #include "assets/AssetManager.h"
 #include "assets/Model.h"
+#include "core/Timer.h"
+#include "core/WorkerPool.h"
 
 class Input;
 class Scene {
@@ -14,7 +23,10 @@ class Scene {
     Scene(float aspectRatio, AssetManager& assetManager);
     ~Scene() = default;
 
-    void addRenderable(const Renderable& renderable) { m_Renderables.push_back(renderable); }
+    void addRenderable(const Renderable& renderable) {
+        m_Renderables.push_back(renderable);
+        ++m_Revision;
+    }
     const std::vector<Renderable>& getRenderables() const { return m_Renderables; }
 
     Player& getPlayer() { return m_Player; }
@@ -29,15 +41,88 @@ class Scene {
     AssetManager& getAssetManager() { return m_AssetManager; }
     const AssetManager& getAssetManager() const { return m_AssetManager; }
 
+    // Bumped whenever the renderable set changes
+    uint64_t getRevision() const { return m_Revision; }
+
     void update(float deltaTime, const Input& input);
     void initialize();
 
+    // Load the Sponza model in the background: initialize() returns at once and update() adds
+    // each submesh as the asset manager uploads it. Static batching then merges on a worker
+    // thread and creates the merged meshes within `uploadBudgetMs` per update.
+    void setAsyncLoading(bool enabled, float uploadBudgetMs) {
+        m_AsyncLoading = enabled;
+        m_UploadBudgetMs = uploadBudgetMs;
+    }
+
+    // Merge static renderables into per-material world-space chunks once the scene is loaded
+    void setStaticBatching(bool enabled, float chunkSize);
+    // Scatter `instances` copies of a Sponza submesh over a square of side `area` during initialize()
+    void setScatterBenchmark(size_t instances, float area, const ScatterField::Settings& settings);
+    const std::vector<std::unique_ptr<ScatterField>>& getScatterFields() const { return m_ScatterFields; }
+    // Place a grid of `count` animated instances of a skinned glTF model during initialize(),
+    // animated by `animationThreads` workers each update (0: one per hardware thread)
+    void setSkinnedCharacters(const std::string& modelPath, int count, float spacing, float scale,
+                              unsigned int animationThreads);
+    const std::vector<std::unique_ptr<SkinnedCharacter>>& getSkinnedCharacters() const { return m_Characters; }
+    // Place a grid of `count` vertex animated instances of a model during initialize(); the
+    // model must be loaded with Model::setVertexAnimationFrameRate enabled
+    void setCrowd(const std::string& modelPath, int count, float spacing, float scale);
+    const Crowd* getCrowd() const { return m_Crowd.get(); }
+
    private:
     void createSponzaModel();
+    // Adds the submeshes uploaded since the last call
+    void addSponzaSubMeshes(const Model& model);
+    void finishSponzaModel(const Model& model);
+    void updatePendingModel();
+    std::vector<Renderable> collectStatics() const;
+    void replaceStatics(StaticBatcher::Result batched, double ms);
+    void batchStaticRenderables();
+    void startStaticBatching();
+    void updateStaticBatching();
+    void createScatterBenchmark(const Model& model);
+    void createSkinnedCharacters();
+    void createCrowd();
 
     std::vector<Renderable> m_Renderables;
     Player m_Player;
     Sky m_Sky;
     std::vector<Light> m_PointLights;
     AssetManager& m_AssetManager;
+    bool m_AsyncLoading = false;
+    float m_UploadBudgetMs = 2.0f;
+    ModelHandle m_PendingModel;
+    // Keeps the submeshes already in the scene alive, also when the rest of the load failed
+    std::shared_ptr<const Model> m_SponzaModel;
+    size_t m_SponzaSubMeshes = 0;
+    Timer m_ModelTimer;
+    bool m_StaticBatching = false;
+    float m_StaticChunkSize = 16.0f;
+    std::vector<std::unique_ptr<Mesh>> m_BatchedMeshes;
+    // Asynchronous static batching: merge on a worker, then chunk uploads under the budget.
+    // Declared after m_SponzaModel, so a running merge is joined before its sources go away.
+    bool m_BatchPending = false;
+    std::future<std::vector<StaticBatcher::MergedChunk>> m_BatchMerge;
+    std::vector<StaticBatcher::MergedChunk> m_BatchChunks;
+    size_t m_NextBatchChunk = 0;
+    StaticBatcher::Result m_BatchResult;
+    Timer m_BatchTimer;
+    std::vector<std::unique_ptr<ScatterField>> m_ScatterFields;
+    size_t m_ScatterInstances = 0;
+    float m_ScatterArea = 100.0f;
+    ScatterField::Settings m_ScatterSettings;
+    std::vector<std::unique_ptr<SkinnedCharacter>> m_Characters;
+    std::string m_CharacterModelPath;
+    int m_CharacterCount = 0;
+    float m_CharacterSpacing = 2.0f;
+    float m_CharacterScale = 1.0f;
+    unsigned int m_AnimationThreads = 0;
+    std::unique_ptr<WorkerPool> m_AnimationWorkers;
+    std::unique_ptr<Crowd> m_Crowd;
+    std::string m_CrowdModelPath;
+    int m_CrowdCount = 0;
+    float m_CrowdSpacing = 1.5f;
+    float m_CrowdScale = 1.0f;
+    uint64_t m_Revision = 0;
 };
@@ -0,0 +1,55 @@
+#include "SkinnedCharacter.h"
+
+#include "Renderable.h"
+#include "rendering/Renderer.h"
+
+SkinnedCharacter::SkinnedCharacter(const Model& model, const Transform& transform, int clip, float startTime)
+    : m_Model(model), m_Transform(transform), m_Time(startTime) {
+    const auto& animations = m_Model.getAnimations();
+    if (clip >= 0 && clip < static_cast<int>(animations.size())) {
+        m_Clip = &animations[clip];
+    }
+    m_Model.getSkeleton().getRestPose(m_Pose);
+    m_Palettes.resize(m_Model.getSubMeshes().size());
+    m_Bounds.resize(m_Model.getSubMeshes().size(), AABB{glm::vec3(0.0f), glm::vec3(0.0f)});
+    animate();
+}
+
+void SkinnedCharacter::animate() {
+    if (m_Posed && !m_Clip) {
+        return;
+    }
+    if (m_Clip) {
+        m_Clip->sample(m_Time, m_Cursor, m_Pose);
+    }
+    m_Model.getSkeleton().computeGlobals(m_Pose, m_Globals);
+
+    const auto& subMeshes = m_Model.getSubMeshes();
+    for (size_t i = 0; i < subMeshes.size(); ++i) {
+        const SubMesh& sub = subMeshes[i];
+        if (sub.mesh && sub.skin >= 0 && sub.mesh->isSkinned()) {
+            m_Bounds[i] = Skeleton::computePalette(m_Model.getSkins()[sub.skin], m_Globals, sub.mesh->getAABB(),
+                                                   m_Palettes[i]);
+        }
+    }
+    m_Posed = true;
+}
+
+void SkinnedCharacter::submit(Renderer& renderer) const {
+    const auto& subMeshes = m_Model.getSubMeshes();
+    for (size_t i = 0; i < subMeshes.size(); ++i) {
+        const SubMesh& sub = subMeshes[i];
+        if (!sub.mesh) {
+            continue;
+        }
+        Renderable renderable;
+        renderable.mesh = sub.mesh.get();
+        renderable.material = sub.material;
+        renderable.transform = m_Transform;
+        if (m_Palettes[i].empty()) {
+            renderer.submit(renderable);
+            continue;
+        }
+        renderer.submitSkinned(renderable, m_Palettes[i], m_Bounds[i]);
+    }
+}
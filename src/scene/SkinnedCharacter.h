@@ -0,0 +1,40 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "Transform.h"
+#include "assets/Model.h"
+
+class Renderer;
+
+// One animated instance of a skinned model. Plays a clip in a loop; animate() samples it and
+// rebuilds the joint palettes, submit() hands every skinned submesh to the renderer with its
+// palette, so characters sharing a model batch together.
+class SkinnedCharacter {
+   public:
+    // A clip index outside the model's animations leaves the character in its rest pose
+    SkinnedCharacter(const Model& model, const Transform& transform, int clip, float startTime);
+
+    void update(float deltaTime) { m_Time += deltaTime; }
+    // Touches only this character's state, so different characters can animate concurrently
+    void animate();
+    void submit(Renderer& renderer) const;
+
+    const Transform& getTransform() const { return m_Transform; }
+    bool isAnimated() const { return m_Clip != nullptr; }
+    size_t getTrackCount() const { return m_Clip ? m_Clip->getTrackCount() : 0; }
+
+   private:
+    const Model& m_Model;
+    Transform m_Transform;
+    const AnimationClip* m_Clip = nullptr;
+    float m_Time = 0.0f;
+    bool m_Posed = false;
+    AnimationCursor m_Cursor;
+    Pose m_Pose;
+    std::vector<glm::mat4> m_Globals;
+    // Per submesh, empty for submeshes drawn unskinned
+    std::vector<std::vector<glm::mat4>> m_Palettes;
+    std::vector<AABB> m_Bounds;
+};
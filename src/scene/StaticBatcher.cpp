@@ -0,0 +1,182 @@
+#include "StaticBatcher.h"
+
+#include <cmath>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <utility>
+#include <glm/gtc/matrix_inverse.hpp>
+#include <unordered_map>
+
+#include "assets/Model.h"
+#include "rendering/Meshlets.h"
+
+namespace {
+const size_t kVertexFloats = Mesh::kVertexFloats;
+
+struct ChunkBuilder {
+    MeshData data;
+    // Source (renderable, vertex) -> merged vertex, so shared vertices stay shared
+    std::unordered_map<uint64_t, unsigned int> remap;
+};
+
+uint64_t cellKey(const glm::ivec3& cell) {
+    // 21 bits per axis covers +-1M chunks
+    auto pack = [](int v) { return static_cast<uint64_t>(v + (1 << 20)) & 0x1FFFFF; };
+    return (pack(cell.x) << 42) | (pack(cell.y) << 21) | pack(cell.z);
+}
+
+struct BakedMesh {
+    std::vector<float> vertices;  // World space
+    std::vector<unsigned int> indices;
+};
+
+BakedMesh bakeToWorld(const Renderable& renderable) {
+    const MeshData& source = *renderable.source;
+    glm::mat4 model = renderable.transform.getMatrix();
+    glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(model)));
+
+    BakedMesh baked;
+    baked.indices = source.indices;
+    baked.vertices = source.vertices;
+    // A mirroring transform turns front faces into back faces once it is baked in
+    if (glm::determinant(glm::mat3(model)) < 0.0f) {
+        for (size_t i = 0; i + 2 < baked.indices.size(); i += 3) {
+            std::swap(baked.indices[i + 1], baked.indices[i + 2]);
+        }
+    }
+    for (size_t v = 0; v + kVertexFloats <= baked.vertices.size(); v += kVertexFloats) {
+        float* vertex = &baked.vertices[v];
+        glm::vec3 position = glm::vec3(model * glm::vec4(vertex[0], vertex[1], vertex[2], 1.0f));
+        glm::vec3 normal = normalMatrix * glm::vec3(vertex[3], vertex[4], vertex[5]);
+        float length = glm::length(normal);
+        normal = length > 0.0f ? normal / length : glm::vec3(0.0f, 1.0f, 0.0f);
+        vertex[0] = position.x;
+        vertex[1] = position.y;
+        vertex[2] = position.z;
+        vertex[3] = normal.x;
+        vertex[4] = normal.y;
+        vertex[5] = normal.z;
+    }
+    return baked;
+}
+}
+
+std::vector<StaticBatcher::MergedChunk> StaticBatcher::merge(const std::vector<Renderable>& statics,
+                                                             const Settings& settings) {
+    float chunkSize = settings.chunkSize > 0.0f ? settings.chunkSize : 16.0f;
+
+    // Material -> chunk cell -> merged geometry, in first-seen order for deterministic output
+    std::vector<MaterialHandle> materialOrder;
+    std::unordered_map<MaterialHandle, std::unordered_map<uint64_t, ChunkBuilder>> groups;
+    std::unordered_map<MaterialHandle, std::vector<uint64_t>> cellOrder;
+
+    for (size_t r = 0; r < statics.size(); ++r) {
+        const Renderable& renderable = statics[r];
+        if (!renderable.mesh || !renderable.source) {
+            continue;
+        }
+        if (!groups.count(renderable.material)) {
+            materialOrder.push_back(renderable.material);
+        }
+        auto& chunks = groups[renderable.material];
+        auto& cells = cellOrder[renderable.material];
+
+        BakedMesh baked = bakeToWorld(renderable);
+        size_t vertexCount = baked.vertices.size() / kVertexFloats;
+        for (size_t i = 0; i + 2 < baked.indices.size(); i += 3) {
+            unsigned int tri[3] = {baked.indices[i], baked.indices[i + 1], baked.indices[i + 2]};
+            if (tri[0] >= vertexCount || tri[1] >= vertexCount || tri[2] >= vertexCount) {
+                continue;
+            }
+
+            glm::vec3 centroid(0.0f);
+            for (unsigned int index : tri) {
+                const float* v = &baked.vertices[index * kVertexFloats];
+                centroid += glm::vec3(v[0], v[1], v[2]);
+            }
+            centroid /= 3.0f;
+            glm::ivec3 cell(static_cast<int>(std::floor(centroid.x / chunkSize)),
+                            static_cast<int>(std::floor(centroid.y / chunkSize)),
+                            static_cast<int>(std::floor(centroid.z / chunkSize)));
+            uint64_t key = cellKey(cell);
+            if (!chunks.count(key)) {
+                cells.push_back(key);
+            }
+            ChunkBuilder& chunk = chunks[key];
+
+            for (unsigned int index : tri) {
+                uint64_t sourceKey = (static_cast<uint64_t>(r) << 32) | index;
+                auto [it, inserted] = chunk.remap.emplace(
+                    sourceKey, static_cast<unsigned int>(chunk.data.vertices.size() / kVertexFloats));
+                if (inserted) {
+                    const float* v = &baked.vertices[index * kVertexFloats];
+                    chunk.data.vertices.insert(chunk.data.vertices.end(), v, v + kVertexFloats);
+                }
+                chunk.data.indices.push_back(it->second);
+            }
+        }
+    }
+
+    std::vector<MergedChunk> merged;
+    size_t meshletMinTriangles = Model::getMeshletMinTriangles();
+    const bool positionStream = Model::getPositionStreams();
+    for (const auto& material : materialOrder) {
+        auto& chunks = groups[material];
+        for (uint64_t key : cellOrder[material]) {
+            MeshData& data = chunks[key].data;
+            if (data.indices.empty()) {
+                continue;
+            }
+
+            // Bounds and the packed position stream come out of the same walk over the vertices
+            if (positionStream) data.positions.reserve(data.vertices.size() / kVertexFloats * 3);
+            data.aabb.min = data.aabb.max = glm::vec3(data.vertices[0], data.vertices[1], data.vertices[2]);
+            for (size_t v = 0; v < data.vertices.size(); v += kVertexFloats) {
+                glm::vec3 position(data.vertices[v], data.vertices[v + 1], data.vertices[v + 2]);
+                data.aabb.min = glm::min(data.aabb.min, position);
+                data.aabb.max = glm::max(data.aabb.max, position);
+                if (positionStream) data.positions.insert(data.positions.end(), &data.vertices[v], &data.vertices[v] + 3);
+            }
+
+            MergedChunk chunk;
+            chunk.material = material;
+            if (meshletMinTriangles > 0 && data.indices.size() / 3 >= meshletMinTriangles) {
+                chunk.meshlets = buildMeshlets(data.vertices.data(), data.vertices.size() / kVertexFloats,
+                                               kVertexFloats, data.indices);
+            }
+            chunk.data = std::move(data);
+            merged.push_back(std::move(chunk));
+        }
+    }
+    return merged;
+}
+
+void StaticBatcher::upload(MergedChunk& chunk, Result& result) {
+    MeshData& data = chunk.data;
+    auto mesh = std::make_unique<Mesh>(data.vertices.data(),
+                                       static_cast<unsigned int>(data.vertices.size() * sizeof(float)),
+                                       data.indices.data(),
+                                       static_cast<unsigned int>(data.indices.size()), data.aabb);
+    if (!chunk.meshlets.empty()) {
+        mesh->setMeshlets(chunk.meshlets);
+    }
+    if (!data.positions.empty()) {
+        mesh->setPositionStream(data.positions);
+    }
+
+    Renderable renderable;
+    renderable.mesh = mesh.get();
+    renderable.material = chunk.material;
+    renderable.isStatic = true;
+    result.renderables.push_back(renderable);
+    result.meshes.push_back(std::move(mesh));
+}
+
+StaticBatcher::Result StaticBatcher::build(const std::vector<Renderable>& statics, const Settings& settings) {
+    Result result;
+    result.sourceCount = statics.size();
+    for (auto& chunk : merge(statics, settings)) {
+        upload(chunk, result);
+    }
+    return result;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "Renderable.h"
+#include "rendering/Mesh.h"
+#include "rendering/Meshlets.h"
+
+// Build-time merge of immovable geometry. World transforms are baked into the vertices and
+// all static renderables sharing a material are merged, split into cubic world-space chunks
+// by triangle centroid so each chunk keeps a tight AABB for frustum culling. Works on the
+// renderables' CPU mesh data (Renderable::source), which every input must have.
+class StaticBatcher {
+   public:
+    struct Settings {
+        float chunkSize = 16.0f;
+    };
+
+    struct Result {
+        std::vector<Renderable> renderables;  // One per (material, chunk), identity transform
+        std::vector<std::unique_ptr<Mesh>> meshes;  // Owns the merged meshes
+        size_t sourceCount = 0;
+    };
+
+    // One merged (material, chunk) mesh: world-space vertices with bounds, packed positions and
+    // meshlets already computed, so only the GL objects remain
+    struct MergedChunk {
+        MaterialHandle material;
+        MeshData data;
+        std::vector<Meshlet> meshlets;
+    };
+
+    // CPU half of build(), safe on any thread while the renderables' sources stay alive
+    static std::vector<MergedChunk> merge(const std::vector<Renderable>& statics, const Settings& settings);
+    // GL half: creates the mesh of one chunk and appends it to `result`
+    static void upload(MergedChunk& chunk, Result& result);
+    static Result build(const std::vector<Renderable>& statics, const Settings& settings);
+};
@@ -0,0 +1,116 @@
+// Offline irradiance probe baker: loads the same scene as the engine through a hidden GL
+// context, path-traces a probe grid over it and writes the [probes] path from config.ini.
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <chrono>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#include "assets/AssetManager.h"
+#include "assets/Material.h"
+#include "bake/ProbeBaker.h"
+#include "core/Config.h"
+#include "rendering/GlExtensions.h"
+#include "scene/Scene.h"
+
+namespace {
+// Scene loading needs a context for the GPU buffers it reads back, nothing is presented
+GLFWwindow* createHiddenContext() {
+    if (!glfwInit()) {
+        throw std::runtime_error("GLFW initialization failed");
+    }
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    GLFWwindow* window = glfwCreateWindow(1, 1, "bake_probes", nullptr, nullptr);
+    if (!window) {
+        glfwTerminate();
+        throw std::runtime_error("Window creation failed");
+    }
+    glfwMakeContextCurrent(window);
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        throw std::runtime_error("Failed to initialize GLAD");
+    }
+    GlExtensions::load(reinterpret_cast<GlExtensions::ProcLoader>(glfwGetProcAddress));
+    return window;
+}
+
+void addSceneGeometry(const Scene& scene, ProbeBaker& baker) {
+    for (const auto& renderable : scene.getRenderables()) {
+        if (!renderable.mesh) {
+            continue;
+        }
+        MeshData data = renderable.mesh->readBack();
+        glm::mat4 model = renderable.transform.getMatrix();
+
+        std::vector<glm::vec3> positions;
+        positions.reserve(data.vertices.size() / Mesh::kVertexFloats);
+        for (size_t v = 0; v + Mesh::kVertexFloats <= data.vertices.size(); v += Mesh::kVertexFloats) {
+            glm::vec4 position(data.vertices[v], data.vertices[v + 1], data.vertices[v + 2], 1.0f);
+            positions.push_back(glm::vec3(model * position));
+        }
+
+        // Textures are not kept on the CPU, the base color factor stands in for albedo
+        glm::vec3 albedo(1.0f);
+        if (auto material = renderable.material.get()) {
+            albedo = glm::vec3(material->getParams().baseColorFactor);
+        }
+        baker.addMesh(positions, data.indices, albedo);
+    }
+}
+}  // namespace
+
+int main() {
+    try {
+        Config config = Config::load("config.ini");
+        const auto& probes = config.probes();
+        GLFWwindow* window = createHiddenContext();
+
+        ProbeBaker baker;
+        {
+            AssetManager assets;
+            Scene scene(1.0f, assets);
+            scene.initialize();
+            addSceneGeometry(scene, baker);
+
+            ProbeBaker::Environment environment;
+            const Sky& sky = scene.getSky();
+            const Light& sun = sky.getSun().getLight();
+            environment.skyRadiance = sky.getAmbientColor() * sky.getAmbientStrength();
+            environment.sunDirection = sun.direction;
+            environment.sunColor = sun.color * sun.intensity;
+
+            ProbeBaker::Settings settings;
+            settings.resolution = glm::ivec3(probes.resolutionX, probes.resolutionY, probes.resolutionZ);
+            settings.samplesPerProbe = probes.samples;
+            settings.bounces = probes.bounces;
+            settings.coefficientCount = probes.shOrder == 1 ? 4u : 9u;
+
+            std::cout << "Baking " << settings.resolution.x * settings.resolution.y * settings.resolution.z
+                      << " probes over " << baker.getTriangleCount() << " triangles" << std::endl;
+            auto start = std::chrono::steady_clock::now();
+            ProbeGrid grid = baker.bake(settings, environment, [](size_t done, size_t total) {
+                std::cout << "\r" << done << " / " << total << std::flush;
+            });
+            float seconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+            std::cout << "\nBaked in " << seconds << " s, writing " << probes.path << std::endl;
+            grid.save(probes.path);
+
+            assets.clear();
+        }
+
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "bake_probes: " << e.what() << std::endl;
+        return 1;
+    }
+}
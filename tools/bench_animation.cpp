@@ -0,0 +1,125 @@
+// Animation sampling benchmark: plays a synthetic clip on many instances, single threaded and
+// across a WorkerPool, and reports sampled tracks per second.
+// Usage: bench_animation [instances] [joints] [frames]
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <exception>
+#include <glm/gtc/quaternion.hpp>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "assets/AnimationClip.h"
+#include "assets/Skeleton.h"
+#include "core/WorkerPool.h"
+
+namespace {
+const float kClipLength = 2.0f;
+const int kKeysPerTrack = 60;
+const float kFrameStep = 1.0f / 60.0f;
+
+struct Instance {
+    AnimationCursor cursor;
+    Pose pose;
+    std::vector<glm::mat4> globals;
+    float time = 0.0f;
+};
+
+// Binary tree of joints with a translation, rotation and scale track each
+AnimationClip makeClip(Skeleton& skeleton, int joints) {
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+    std::vector<SkeletonNode> nodes(joints);
+    for (int i = 1; i < joints; ++i) {
+        nodes[i].parent = (i - 1) / 2;
+        nodes[i].translation = glm::vec3(0.0f, 0.5f, 0.0f);
+    }
+    skeleton.setNodes(nodes);
+
+    std::vector<AnimationChannel> channels;
+    for (int joint = 0; joint < joints; ++joint) {
+        for (auto path : {AnimationChannel::Path::Translation, AnimationChannel::Path::Rotation,
+                          AnimationChannel::Path::Scale}) {
+            AnimationChannel channel;
+            channel.node = joint;
+            channel.path = path;
+            for (int k = 0; k < kKeysPerTrack; ++k) {
+                channel.times.push_back(kClipLength * static_cast<float>(k) / (kKeysPerTrack - 1));
+                glm::vec4 value(unit(rng), unit(rng), unit(rng), 0.0f);
+                if (path == AnimationChannel::Path::Rotation) {
+                    glm::quat q = glm::angleAxis(unit(rng) * 3.14159f, glm::normalize(glm::vec3(value) + 1e-3f));
+                    value = glm::vec4(q.x, q.y, q.z, q.w);
+                } else if (path == AnimationChannel::Path::Scale) {
+                    value = glm::vec4(1.0f) + 0.1f * value;
+                }
+                channel.values.push_back(value);
+            }
+            channels.push_back(std::move(channel));
+        }
+    }
+    return AnimationClip("benchmark", channels, nodes.size());
+}
+
+void run(const char* label, WorkerPool& pool, const AnimationClip& clip, const Skeleton& skeleton,
+         std::vector<Instance>& instances, int frames) {
+    double sampleSeconds = 0.0;
+    double poseSeconds = 0.0;
+    for (int frame = 0; frame < frames; ++frame) {
+        auto start = std::chrono::steady_clock::now();
+        pool.parallelFor(instances.size(), [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                instances[i].time += kFrameStep;
+                clip.sample(instances[i].time, instances[i].cursor, instances[i].pose);
+            }
+        });
+        auto sampled = std::chrono::steady_clock::now();
+        pool.parallelFor(instances.size(), [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                skeleton.computeGlobals(instances[i].pose, instances[i].globals);
+            }
+        });
+        auto posed = std::chrono::steady_clock::now();
+        sampleSeconds += std::chrono::duration<double>(sampled - start).count();
+        poseSeconds += std::chrono::duration<double>(posed - sampled).count();
+    }
+
+    double tracks = static_cast<double>(clip.getTrackCount()) * instances.size() * frames;
+    std::cout << label << " (" << pool.getThreadCount() << " threads): " << tracks / sampleSeconds / 1e6
+              << " M tracks/s, sample " << 1000.0 * sampleSeconds / frames << " ms/frame, globals "
+              << 1000.0 * poseSeconds / frames << " ms/frame" << std::endl;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+    try {
+        int instanceCount = argc > 1 ? std::atoi(argv[1]) : 1024;
+        int joints = argc > 2 ? std::atoi(argv[2]) : 64;
+        int frames = argc > 3 ? std::atoi(argv[3]) : 600;
+        if (instanceCount <= 0 || joints <= 0 || frames <= 0) {
+            std::cerr << "usage: bench_animation [instances] [joints] [frames]" << std::endl;
+            return 1;
+        }
+
+        Skeleton skeleton;
+        AnimationClip clip = makeClip(skeleton, joints);
+        std::cout << instanceCount << " instances x " << clip.getTrackCount() << " tracks, " << kKeysPerTrack
+                  << " keys per track, " << frames << " frames" << std::endl;
+
+        std::vector<Instance> instances(instanceCount);
+        for (size_t i = 0; i < instances.size(); ++i) {
+            skeleton.getRestPose(instances[i].pose);
+            instances[i].time = 0.37f * static_cast<float>(i);
+        }
+
+        WorkerPool single(1);
+        run("single", single, clip, skeleton, instances, frames);
+        WorkerPool pool;
+        run("pool", pool, clip, skeleton, instances, frames);
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "bench_animation: " << e.what() << std::endl;
+        return 1;
+    }
+}